@@ -0,0 +1,144 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/TextureBuffer.h"
+#include "Assets/TextureKernels.h"
+#include "BenchmarkUtils.h"
+
+#include <vecmath/vec.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+namespace
+{
+constexpr size_t Sizes[] = {256, 512, 1024, 2048};
+
+std::vector<unsigned char> makeRandomBytes(const size_t count)
+{
+  auto engine = std::mt19937{1};
+  auto distribution = std::uniform_int_distribution<int>{0, 255};
+
+  auto result = std::vector<unsigned char>(count);
+  for (auto& b : result)
+  {
+    b = static_cast<unsigned char>(distribution(engine));
+  }
+  return result;
+}
+
+std::string message(
+  const std::string& kernel,
+  const size_t size,
+  const KernelInstructionSet instructionSet,
+  const size_t repetitions)
+{
+  auto str = std::stringstream{};
+  str << kernel << " " << size << "x" << size << " (" << instructionSet << ", "
+      << repetitions << "x)";
+  return str.str();
+}
+
+size_t repetitions(const size_t size)
+{
+  // process about the same number of pixels for every size
+  return 2048 * 2048 * 16 / (size * size);
+}
+} // namespace
+
+TEST_CASE("TextureKernelsBenchmark.expandPalette")
+{
+  const auto palette = makeRandomBytes(1024);
+
+  for (const auto size : Sizes)
+  {
+    const auto indices = makeRandomBytes(size * size);
+    auto rgba = std::vector<unsigned char>(4 * size * size);
+
+    for (const auto instructionSet : availableKernelInstructionSets())
+    {
+      auto checksum = uint64_t(0);
+      timeLambda(
+        [&]() {
+          for (size_t i = 0; i < repetitions(size); ++i)
+          {
+            const auto result = expandPalette(
+              indices.data(), size * size, palette.data(), rgba.data(), instructionSet);
+            checksum += result.colorSum[0];
+          }
+        },
+        message("expandPalette", size, instructionSet, repetitions(size)));
+      CHECK(checksum > 0);
+    }
+  }
+}
+
+TEST_CASE("TextureKernelsBenchmark.sumColors")
+{
+  for (const auto size : Sizes)
+  {
+    const auto rgba = makeRandomBytes(4 * size * size);
+
+    for (const auto instructionSet : availableKernelInstructionSets())
+    {
+      auto checksum = uint64_t(0);
+      timeLambda(
+        [&]() {
+          for (size_t i = 0; i < repetitions(size); ++i)
+          {
+            checksum += sumColors(rgba.data(), size * size, instructionSet)[0];
+          }
+        },
+        message("sumColors", size, instructionSet, repetitions(size)));
+      CHECK(checksum > 0);
+    }
+  }
+}
+
+TEST_CASE("TextureKernelsBenchmark.downsampleBox")
+{
+  for (const auto size : Sizes)
+  {
+    const auto rgba = makeRandomBytes(4 * size * size);
+    const auto dstSize = sizeAtMipLevel(size, size, 1);
+    auto dst = std::vector<unsigned char>(4 * dstSize.x() * dstSize.y());
+
+    for (const auto instructionSet : availableKernelInstructionSets())
+    {
+      timeLambda(
+        [&]() {
+          for (size_t i = 0; i < repetitions(size); ++i)
+          {
+            downsampleBox(rgba.data(), size, size, dst.data(), instructionSet);
+          }
+        },
+        message("downsampleBox", size, instructionSet, repetitions(size)));
+    }
+  }
+}
+} // namespace Assets
+} // namespace TrenchBroom
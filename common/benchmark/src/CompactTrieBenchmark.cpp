@@ -0,0 +1,175 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <kdl/compact_trie.h>
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace
+{
+constexpr auto NumEntries = size_t(200'000);
+constexpr auto NumQueries = size_t(10'000);
+
+using Entry = std::pair<std::string, size_t>;
+
+/**
+ * Generates keys that resemble entity property keys and values, e.g. "target12" or
+ * "light_flame_large_yellow_4711".
+ */
+std::vector<Entry> makeEntries()
+{
+  static const auto prefixes = std::vector<std::string>{
+    "target",
+    "targetname",
+    "killtarget",
+    "light",
+    "light_flame_large_yellow",
+    "func_door",
+    "func_button",
+    "trigger_multiple",
+    "info_player_deathmatch",
+    "monster_ogre",
+  };
+
+  auto engine = std::mt19937{1};
+  auto prefix = std::uniform_int_distribution<size_t>{0, prefixes.size() - 1u};
+  auto number = std::uniform_int_distribution<size_t>{0, 99'999};
+
+  auto entries = std::vector<Entry>{};
+  entries.reserve(NumEntries);
+  for (size_t i = 0; i < NumEntries; ++i)
+  {
+    auto key = prefixes[prefix(engine)];
+    if (i % 2u == 0u)
+    {
+      key += "_";
+    }
+    key += std::to_string(number(engine));
+    entries.emplace_back(std::move(key), i);
+  }
+  return entries;
+}
+
+/**
+ * Runs a query for a sample of the given entries and returns the total number of
+ * matches. The pattern for each query is created by the given function from the key of
+ * the sampled entry.
+ */
+template <typename F>
+size_t findMatches(
+  const kdl::compact_trie<size_t>& trie,
+  const std::vector<Entry>& entries,
+  const F& makePattern)
+{
+  auto matches = std::vector<size_t>{};
+  auto numMatches = size_t(0);
+  for (size_t i = 0; i < NumQueries; ++i)
+  {
+    const auto& key = entries[i * (entries.size() / NumQueries)].first;
+    matches.clear();
+    trie.find_matches(makePattern(key), std::back_inserter(matches));
+    numMatches += matches.size();
+  }
+  return numMatches;
+}
+
+void benchmarkQueries(
+  const kdl::compact_trie<size_t>& trie, const std::vector<Entry>& entries)
+{
+  auto numMatches = size_t(0);
+  timeLambda(
+    [&]() {
+      numMatches = findMatches(trie, entries, [](const auto& key) { return key; });
+    },
+    "compact_trie: " + std::to_string(NumQueries) + " exact queries");
+  CHECK(numMatches >= NumQueries);
+
+  timeLambda(
+    [&]() {
+      numMatches = findMatches(trie, entries, [](const auto& key) {
+        return key.substr(0, key.size() - 2u) + "*";
+      });
+    },
+    "compact_trie: " + std::to_string(NumQueries) + " prefix queries");
+  CHECK(numMatches >= NumQueries);
+
+  timeLambda(
+    [&]() {
+      numMatches = findMatches(trie, entries, [](const auto& key) {
+        return key.substr(0, key.size() - 2u) + "%*";
+      });
+    },
+    "compact_trie: " + std::to_string(NumQueries) + " numbered queries");
+  CHECK(numMatches >= NumQueries);
+
+  timeLambda(
+    [&]() {
+      numMatches = findMatches(trie, entries, [](const auto& key) {
+        return "?" + key.substr(1, key.size() - 3u) + "*";
+      });
+    },
+    "compact_trie: " + std::to_string(NumQueries) + " wildcard queries");
+  CHECK(numMatches >= NumQueries);
+}
+} // namespace
+
+TEST_CASE("CompactTrieBenchmark.compact_trie")
+{
+  const auto entries = makeEntries();
+  auto trie = kdl::compact_trie<size_t>{};
+
+  timeLambda(
+    [&]() {
+      for (const auto& [key, value] : entries)
+      {
+        trie.insert(key, value);
+      }
+    },
+    "compact_trie: insert " + std::to_string(entries.size()) + " entries");
+
+  benchmarkQueries(trie, entries);
+
+  auto numRemoved = size_t(0);
+  timeLambda(
+    [&]() {
+      for (const auto& [key, value] : entries)
+      {
+        numRemoved += trie.remove(key, value) ? 1u : 0u;
+      }
+    },
+    "compact_trie: remove " + std::to_string(entries.size()) + " entries");
+  CHECK(numRemoved == entries.size());
+
+  timeLambda(
+    [&]() { trie.build(entries); },
+    "compact_trie: build from " + std::to_string(entries.size()) + " entries");
+
+  benchmarkQueries(trie, entries);
+}
+} // namespace TrenchBroom
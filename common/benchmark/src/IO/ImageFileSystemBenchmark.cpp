@@ -0,0 +1,105 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "IO/File.h"
+#include "IO/IdPakFileSystem.h"
+#include "IO/PathInfo.h"
+#include "IO/PathMatcher.h"
+#include "IO/TestFileUtils.h"
+
+#include <kdl/invoke.h>
+#include <kdl/string_format.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+constexpr auto EntryCount = size_t(50'000);
+
+std::vector<std::filesystem::path> makeEntryPaths(const bool upperCase)
+{
+  auto result = std::vector<std::filesystem::path>{};
+  result.reserve(EntryCount);
+  for (size_t i = 0; i < EntryCount; ++i)
+  {
+    const auto path = "maps/entry" + std::to_string(i) + ".bsp";
+    result.emplace_back(upperCase ? kdl::str_to_upper(path) : path);
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("ImageFileSystemBenchmark.findEntries")
+{
+  const auto tempDir = std::filesystem::temp_directory_path();
+  const auto pakPath =
+    makePak(tempDir / "ImageFileSystemBenchmark.pak", EntryCount, size_t(16));
+  auto removePak = kdl::invoke_later{[&]() { std::filesystem::remove(pakPath); }};
+
+  const auto fs = IdPakFileSystem{pakPath};
+  const auto paths = makeEntryPaths(false);
+  const auto upperCasePaths = makeEntryPaths(true);
+
+  auto fileCount = size_t(0);
+  timeLambda(
+    [&]() {
+      for (const auto& path : upperCasePaths)
+      {
+        if (fs.pathInfo(path) == PathInfo::File)
+        {
+          ++fileCount;
+        }
+      }
+    },
+    "get path info of 50000 entries in one directory");
+  CHECK(fileCount == EntryCount);
+
+  auto totalSize = size_t(0);
+  timeLambda(
+    [&]() {
+      for (const auto& path : paths)
+      {
+        totalSize += fs.openFile(path)->size();
+      }
+    },
+    "open 50000 files in one directory");
+  CHECK(totalSize == EntryCount * 16u);
+
+  auto found = std::vector<std::filesystem::path>{};
+  timeLambda(
+    [&]() { found = fs.find("maps", makeExtensionPathMatcher({".bsp"})); },
+    "find 50000 files in one directory");
+  CHECK(found.size() == EntryCount);
+
+  timeLambda(
+    [&]() { found = fs.findRecursively("", makeExtensionPathMatcher({".bsp"})); },
+    "find 50000 files recursively");
+  CHECK(found.size() == EntryCount);
+}
+} // namespace IO
+} // namespace TrenchBroom
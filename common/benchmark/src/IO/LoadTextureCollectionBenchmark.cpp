@@ -0,0 +1,136 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/TextureCollection.h"
+#include "Assets/TextureManager.h"
+#include "BenchmarkUtils.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/LoadTextureCollection.h"
+#include "IO/TestFileUtils.h"
+#include "IO/TextureCache.h"
+#include "IO/VirtualFileSystem.h"
+#include "IO/WadFileSystem.h"
+#include "Logger.h"
+#include "Model/GameConfig.h"
+
+#include <kdl/invoke.h>
+#include <kdl/result.h>
+#include <kdl/thread_pool.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+TEST_CASE("LoadTextureCollectionBenchmark.loadTextures")
+{
+  const auto tempDir =
+    std::filesystem::temp_directory_path() / "LoadTextureCollectionBenchmark";
+  std::filesystem::create_directories(tempDir / "textures" / "png");
+  auto removeTempDir = kdl::invoke_later{[&]() { std::filesystem::remove_all(tempDir); }};
+
+  makeGrayPaletteFile(tempDir / "palette.lmp");
+  for (size_t i = 0; i < 500; ++i)
+  {
+    makePng(tempDir / "textures" / "png" / ("image" + std::to_string(i) + ".png"), 128);
+  }
+
+  auto fs = VirtualFileSystem{};
+  fs.mount("", std::make_unique<DiskFileSystem>(tempDir));
+  for (size_t i = 0; i < 4; ++i)
+  {
+    const auto wadName = "wad" + std::to_string(i) + ".wad";
+    const auto wadPath = makeWad(tempDir / wadName, 1'000, 128);
+    fs.mount("textures" / wadPath.filename(), std::make_unique<WadFileSystem>(wadPath));
+  }
+
+  const auto textureConfig = Model::TextureConfig{
+    "textures",
+    {".D", ".png"},
+    "palette.lmp",
+    "wad",
+    "",
+    {},
+  };
+
+  const auto threads =
+    " using " + std::to_string(kdl::default_thread_pool().thread_count()) + " threads";
+
+  auto logger = NullLogger{};
+
+  auto textureCount = size_t(0);
+  timeLambda(
+    [&]() {
+      textureCount = loadTextureCollection("textures/wad0.wad", fs, textureConfig, logger)
+                       .value()
+                       .textures()
+                       .size();
+    },
+    "load wad with 1000 textures" + threads);
+  CHECK(textureCount == 1'000u);
+
+  timeLambda(
+    [&]() {
+      textureCount = loadTextureCollection("textures/png", fs, textureConfig, logger)
+                       .value()
+                       .textures()
+                       .size();
+    },
+    "load directory with 500 png images" + threads);
+  CHECK(textureCount == 500u);
+
+  auto textureManager = Assets::TextureManager{0, 0, logger};
+  timeLambda(
+    [&]() { textureManager.reload(fs, textureConfig); },
+    "load 4 wads and a directory of png images" + threads);
+
+  textureCount = 0;
+  for (const auto& collection : textureManager.collections())
+  {
+    textureCount += collection.textures().size();
+  }
+  CHECK(textureCount == 4'500u);
+
+  auto textureCache = TextureCache{tempDir / "cache"};
+  const auto loadWadWithCache = [&]() {
+    return loadTextureCollection(
+             "textures/wad0.wad", fs, textureConfig, logger, &textureCache)
+      .value()
+      .textures()
+      .size();
+  };
+
+  timeLambda(
+    [&]() { textureCount = loadWadWithCache(); },
+    "load wad with 1000 textures and fill texture cache" + threads);
+  CHECK(textureCount == 1'000u);
+
+  timeLambda(
+    [&]() { textureCount = loadWadWithCache(); },
+    "load wad with 1000 textures from texture cache" + threads);
+  CHECK(textureCount == 1'000u);
+  CHECK(textureCache.stats() == TextureCacheStats{1'000, 1'000});
+}
+} // namespace IO
+} // namespace TrenchBroom
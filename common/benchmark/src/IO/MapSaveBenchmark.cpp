@@ -0,0 +1,129 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "IO/DiskIO.h"
+#include "IO/NodeSerializationCache.h"
+#include "IO/NodeWriter.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/Entity.h"
+#include "Model/EntityProperties.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/invoke.h>
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+constexpr auto NumBrushes = size_t(100'000);
+const auto WorldBounds = vm::bbox3{8192.0};
+
+std::unique_ptr<Model::WorldNode> makeWorld()
+{
+  const auto builder = Model::BrushBuilder{Model::MapFormat::Valve, WorldBounds};
+
+  auto engine = std::mt19937{1};
+  auto coord = std::uniform_real_distribution<FloatType>{-4096.0, 4096.0};
+  auto size = std::uniform_real_distribution<FloatType>{8.0, 128.0};
+
+  auto brushes = std::vector<Model::Node*>{};
+  brushes.reserve(NumBrushes);
+  for (size_t i = 0; i < NumBrushes; ++i)
+  {
+    const auto min = vm::vec3{coord(engine), coord(engine), coord(engine)};
+    const auto max = min + vm::vec3{size(engine), size(engine), size(engine)};
+    brushes.push_back(new Model::BrushNode{
+      builder.createCuboid(vm::bbox3{min, max}, "some/texture").value()});
+  }
+
+  auto world = std::make_unique<Model::WorldNode>(
+    Model::EntityPropertyConfig{}, Model::Entity{}, Model::MapFormat::Valve);
+  world->defaultLayer()->addChildren(brushes);
+  return world;
+}
+
+void writeMap(
+  const Model::WorldNode& world,
+  const std::filesystem::path& path,
+  NodeSerializationCache* cache)
+{
+  Disk::withAtomicOutputStream(path, [&](auto& stream) {
+    if (cache)
+    {
+      auto writer = NodeWriter{world, stream, *cache};
+      writer.writeMap();
+    }
+    else
+    {
+      auto writer = NodeWriter{world, stream};
+      writer.writeMap();
+    }
+  });
+}
+} // namespace
+
+TEST_CASE("MapSaveBenchmark.saveAfterEdit")
+{
+  const auto world = makeWorld();
+  auto* brushNode = static_cast<Model::BrushNode*>(world->defaultLayer()->children()[0]);
+
+  const auto path = std::filesystem::temp_directory_path() / "MapSaveBenchmark.map";
+  auto removeMap = kdl::invoke_later{[&]() { std::filesystem::remove(path); }};
+
+  timeLambda([&]() { writeMap(*world, path, nullptr); }, "save map without cache");
+  printf("Map file size: %ju MiB\n", std::filesystem::file_size(path) / 1024u / 1024u);
+
+  auto cache = NodeSerializationCache{};
+  timeLambda([&]() { writeMap(*world, path, &cache); }, "save map with empty cache");
+  CHECK(cache.size() == NumBrushes);
+
+  auto brush = brushNode->brush();
+  REQUIRE(
+    brush.transform(WorldBounds, vm::translation_matrix(vm::vec3{16, 0, 0}), false)
+      .is_success());
+  brushNode->setBrush(std::move(brush));
+
+  timeLambda(
+    [&]() { writeMap(*world, path, &cache); },
+    "save map with cache after editing one brush");
+  CHECK(cache.size() == NumBrushes);
+}
+} // namespace IO
+} // namespace TrenchBroom
@@ -0,0 +1,121 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/Palette.h"
+#include "Assets/Texture.h"
+#include "BenchmarkUtils.h"
+#include "IO/File.h"
+#include "IO/IdPakFileSystem.h"
+#include "IO/ReadMipTexture.h"
+#include "IO/Reader.h"
+#include "IO/TestFileUtils.h"
+#include "IO/WadFileSystem.h"
+
+#include <kdl/invoke.h>
+#include <kdl/result.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+Assets::Palette makeGrayPalette()
+{
+  auto data = std::vector<unsigned char>(768);
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    data[i] = static_cast<unsigned char>(i / 3);
+  }
+  return Assets::makePalette(data).value();
+}
+
+std::string mappingName(const bool enableMapping)
+{
+  return enableMapping ? "memory mapped" : "stdio";
+}
+} // namespace
+
+TEST_CASE("MmapFileBenchmark.scanPakDirectory")
+{
+  const auto tempDir = std::filesystem::temp_directory_path();
+  // archives must be large enough to be mapped
+  const auto pakPath = makePak(tempDir / "MmapFileBenchmark.pak", 2'000, 4096);
+  auto removePak = kdl::invoke_later{[&]() { std::filesystem::remove(pakPath); }};
+
+  auto resetMapping = kdl::invoke_later{[]() { setMemoryMappingEnabled(true); }};
+  for (const auto enableMapping : {false, true})
+  {
+    setMemoryMappingEnabled(enableMapping);
+
+    auto totalSize = size_t(0);
+    timeLambda(
+      [&]() {
+        for (size_t i = 0; i < 10; ++i)
+        {
+          auto fs = IdPakFileSystem{pakPath};
+          totalSize += fs.openFile("maps/entry0.bsp")->size();
+        }
+      },
+      "scan pak directory with 2000 entries 10 times ("
+        + mappingName(enableMapping) + ")");
+
+    CHECK(totalSize == 10u * 4096u);
+  }
+}
+
+TEST_CASE("MmapFileBenchmark.loadTextures")
+{
+  const auto tempDir = std::filesystem::temp_directory_path();
+  const auto wadPath = makeWad(tempDir / "MmapFileBenchmark.wad", 2'000, 64);
+  auto removeWad = kdl::invoke_later{[&]() { std::filesystem::remove(wadPath); }};
+
+  const auto palette = makeGrayPalette();
+
+  auto resetMapping = kdl::invoke_later{[]() { setMemoryMappingEnabled(true); }};
+  for (const auto enableMapping : {false, true})
+  {
+    setMemoryMappingEnabled(enableMapping);
+
+    auto textureCount = size_t(0);
+    timeLambda(
+      [&]() {
+        auto fs = WadFileSystem{wadPath};
+        for (const auto& path : fs.directoryContents(""))
+        {
+          auto reader = fs.openFile(path)->reader();
+          if (readIdMipTexture(path.stem().string(), reader, palette).is_success())
+          {
+            ++textureCount;
+          }
+        }
+      },
+      "load 2000 textures from wad (" + mappingName(enableMapping) + ")");
+
+    CHECK(textureCount == 2000u);
+  }
+}
+} // namespace IO
+} // namespace TrenchBroom
@@ -0,0 +1,103 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/PathMatcher.h"
+#include "IO/Quake3ShaderFileSystem.h"
+#include "Logger.h"
+
+#include <kdl/invoke.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+constexpr auto ShaderFileCount = size_t(100);
+constexpr auto ShadersPerFile = size_t(100);
+constexpr auto ImageCount = size_t(30'000);
+
+std::string imageName(const size_t i)
+{
+  return "image" + std::to_string(i);
+}
+
+/**
+ * Writes shader scripts for every third image and empty image files.
+ */
+void makeShaderDirectory(const std::filesystem::path& path)
+{
+  std::filesystem::create_directories(path / "scripts");
+  std::filesystem::create_directories(path / "textures/benchmark");
+
+  for (size_t i = 0; i < ShaderFileCount; ++i)
+  {
+    auto stream =
+      std::ofstream{path / "scripts" / ("shaders" + std::to_string(i) + ".shader")};
+    for (size_t j = 0; j < ShadersPerFile; ++j)
+    {
+      const auto name = imageName(3 * (i * ShadersPerFile + j));
+      stream << "textures/benchmark/" << name << "\n"
+             << "{\n"
+             << "  qer_editorimage textures/benchmark/" << name << ".tga\n"
+             << "  surfaceparm nonsolid\n"
+             << "  {\n"
+             << "    map $lightmap\n"
+             << "    rgbGen identity\n"
+             << "  }\n"
+             << "}\n";
+    }
+  }
+
+  for (size_t i = 0; i < ImageCount; ++i)
+  {
+    std::ofstream{path / "textures/benchmark" / (imageName(i) + ".tga")};
+  }
+}
+} // namespace
+
+TEST_CASE("Quake3ShaderFileSystemBenchmark.loadShaders")
+{
+  const auto testDir =
+    std::filesystem::temp_directory_path() / "Quake3ShaderFileSystemBenchmark";
+  makeShaderDirectory(testDir);
+  auto removeTestDir = kdl::invoke_later{[&]() { std::filesystem::remove_all(testDir); }};
+
+  auto logger = NullLogger{};
+  const auto fs = DiskFileSystem{testDir};
+
+  timeLambda(
+    [&]() {
+      const auto shaderFs = Quake3ShaderFileSystem{fs, "scripts", {"textures"}, logger};
+      CHECK(
+        shaderFs.find("textures/benchmark", makeExtensionPathMatcher({""})).size()
+        == ImageCount);
+    },
+    "load 10000 shaders and link 30000 images");
+}
+} // namespace IO
+} // namespace TrenchBroom
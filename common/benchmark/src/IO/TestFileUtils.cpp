@@ -0,0 +1,167 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestFileUtils.h"
+
+#include <miniz/miniz.h>
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+void writeInt32(std::ostream& stream, const size_t value)
+{
+  const auto i = static_cast<int32_t>(value);
+  stream.write(reinterpret_cast<const char*>(&i), sizeof(i));
+}
+
+void writeName(std::ostream& stream, const std::string& name, const size_t length)
+{
+  auto buffer = std::string(length, '\0');
+  buffer.replace(0, name.size(), name);
+  stream.write(buffer.data(), static_cast<std::streamsize>(length));
+}
+} // namespace
+
+std::filesystem::path makePak(
+  const std::filesystem::path& path,
+  const size_t entryCount,
+  const size_t entrySize,
+  const std::string& entryPrefix)
+{
+  auto stream = std::ofstream{path, std::ios::binary};
+
+  const auto headerSize = size_t(12);
+  const auto directoryEntrySize = size_t(64);
+
+  stream.write("PACK", 4);
+  writeInt32(stream, headerSize + entryCount * entrySize);
+  writeInt32(stream, entryCount * directoryEntrySize);
+
+  const auto data = std::string(entrySize, 'x');
+  for (size_t i = 0; i < entryCount; ++i)
+  {
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+
+  for (size_t i = 0; i < entryCount; ++i)
+  {
+    writeName(stream, entryPrefix + std::to_string(i) + ".bsp", 56);
+    writeInt32(stream, headerSize + i * entrySize);
+    writeInt32(stream, entrySize);
+  }
+
+  return path;
+}
+
+std::filesystem::path makeWad(
+  const std::filesystem::path& path, const size_t textureCount, const size_t textureSize)
+{
+  auto stream = std::ofstream{path, std::ios::binary};
+
+  const auto headerSize = size_t(12);
+  const auto mipHeaderSize = size_t(40);
+  auto pixelCount = size_t(0);
+  for (size_t i = 0; i < 4; ++i)
+  {
+    pixelCount += (textureSize >> i) * (textureSize >> i);
+  }
+  const auto mipSize = mipHeaderSize + pixelCount;
+
+  stream.write("WAD2", 4);
+  writeInt32(stream, textureCount);
+  writeInt32(stream, headerSize + textureCount * mipSize);
+
+  auto pixels = std::string(pixelCount, '\0');
+  for (size_t i = 0; i < pixels.size(); ++i)
+  {
+    pixels[i] = static_cast<char>(i % 255);
+  }
+
+  for (size_t i = 0; i < textureCount; ++i)
+  {
+    writeName(stream, "texture" + std::to_string(i), 16);
+    writeInt32(stream, textureSize);
+    writeInt32(stream, textureSize);
+
+    auto offset = mipHeaderSize;
+    for (size_t j = 0; j < 4; ++j)
+    {
+      writeInt32(stream, offset);
+      offset += (textureSize >> j) * (textureSize >> j);
+    }
+    stream.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+  }
+
+  for (size_t i = 0; i < textureCount; ++i)
+  {
+    writeInt32(stream, headerSize + i * mipSize);
+    writeInt32(stream, mipSize);
+    writeInt32(stream, mipSize);
+    stream.write("D", 1);
+    stream.write("\0\0\0", 3);
+    writeName(stream, "texture" + std::to_string(i), 16);
+  }
+
+  return path;
+}
+
+std::filesystem::path makeGrayPaletteFile(const std::filesystem::path& path)
+{
+  auto stream = std::ofstream{path, std::ios::binary};
+  for (size_t i = 0; i < 768; ++i)
+  {
+    stream.put(static_cast<char>(i / 3));
+  }
+
+  return path;
+}
+
+std::filesystem::path makePng(const std::filesystem::path& path, const size_t size)
+{
+  auto pixels = std::vector<unsigned char>(size * size * 4);
+  for (size_t i = 0; i < pixels.size(); ++i)
+  {
+    pixels[i] = static_cast<unsigned char>((i * 7) % 251);
+  }
+
+  auto length = size_t(0);
+  auto* data = tdefl_write_image_to_png_file_in_memory(
+    pixels.data(), int(size), int(size), 4, &length);
+  if (data == nullptr)
+  {
+    throw std::runtime_error{"Could not encode PNG image"};
+  }
+
+  auto stream = std::ofstream{path, std::ios::binary};
+  stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(length));
+  mz_free(data);
+
+  return path;
+}
+} // namespace IO
+} // namespace TrenchBroom
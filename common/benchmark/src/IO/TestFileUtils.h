@@ -0,0 +1,55 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+/**
+ * Writes a Quake pak file with the given number of entries of the given size. The entries
+ * are named by appending their index and ".bsp" to the given prefix.
+ */
+std::filesystem::path makePak(
+  const std::filesystem::path& path,
+  size_t entryCount,
+  size_t entrySize,
+  const std::string& entryPrefix = "maps/entry");
+
+/**
+ * Writes a Quake wad file with the given number of square mip textures of the given size.
+ */
+std::filesystem::path makeWad(
+  const std::filesystem::path& path, size_t textureCount, size_t textureSize);
+
+/**
+ * Writes a palette file that maps every index to a gray value.
+ */
+std::filesystem::path makeGrayPaletteFile(const std::filesystem::path& path);
+
+/**
+ * Writes a square RGBA PNG image of the given size.
+ */
+std::filesystem::path makePng(const std::filesystem::path& path, size_t size);
+} // namespace IO
+} // namespace TrenchBroom
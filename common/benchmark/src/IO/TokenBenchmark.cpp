@@ -0,0 +1,135 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "IO/Token.h"
+
+#include <kdl/string_utils.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+using TestToken = TokenTemplate<unsigned int>;
+
+constexpr size_t NumNumbers = 4'000'000;
+
+std::string makeNumbers(const bool integers)
+{
+  auto rng = std::mt19937{0};
+  auto dist = std::uniform_real_distribution<double>{-4096.0, 4096.0};
+
+  auto result = std::string{};
+  for (size_t i = 0; i < NumNumbers; ++i)
+  {
+    const auto value = dist(rng);
+    result += integers ? std::to_string(static_cast<long>(value)) : std::to_string(value);
+    result += ' ';
+  }
+  return result;
+}
+
+std::vector<TestToken> tokenize(const std::string& str)
+{
+  auto result = std::vector<TestToken>{};
+  result.reserve(NumNumbers);
+
+  const auto* begin = str.data();
+  const auto* end = str.data() + str.size();
+  const auto* cur = begin;
+  while (cur < end)
+  {
+    const auto* tokenEnd = cur;
+    while (tokenEnd < end && *tokenEnd != ' ')
+    {
+      ++tokenEnd;
+    }
+    result.emplace_back(
+      0u, cur, tokenEnd, static_cast<size_t>(cur - begin), size_t(1), size_t(1));
+    cur = tokenEnd + 1;
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("TokenBenchmark.toFloat")
+{
+  const auto str = makeNumbers(false);
+  const auto tokens = tokenize(str);
+
+  auto sum = 0.0;
+  timeLambda(
+    [&]() {
+      for (const auto& token : tokens)
+      {
+        sum += kdl::str_to_double(std::string(token.begin(), token.end())).value_or(0.0);
+      }
+    },
+    "convert " + std::to_string(tokens.size()) + " floats via std::string");
+
+  auto rangeSum = 0.0;
+  timeLambda(
+    [&]() {
+      for (const auto& token : tokens)
+      {
+        rangeSum += token.toFloat<double>();
+      }
+    },
+    "convert " + std::to_string(tokens.size()) + " floats via token range");
+
+  CHECK(rangeSum == sum);
+}
+
+TEST_CASE("TokenBenchmark.toInteger")
+{
+  const auto str = makeNumbers(true);
+  const auto tokens = tokenize(str);
+
+  auto sum = 0l;
+  timeLambda(
+    [&]() {
+      for (const auto& token : tokens)
+      {
+        sum += kdl::str_to_long(std::string(token.begin(), token.end())).value_or(0l);
+      }
+    },
+    "convert " + std::to_string(tokens.size()) + " integers via std::string");
+
+  auto rangeSum = 0l;
+  timeLambda(
+    [&]() {
+      for (const auto& token : tokens)
+      {
+        rangeSum += token.toInteger<long>();
+      }
+    },
+    "convert " + std::to_string(tokens.size()) + " integers via token range");
+
+  CHECK(rangeSum == sum);
+}
+} // namespace IO
+} // namespace TrenchBroom
@@ -0,0 +1,120 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/File.h"
+#include "IO/IdPakFileSystem.h"
+#include "IO/PathInfo.h"
+#include "IO/PathMatcher.h"
+#include "IO/TestFileUtils.h"
+#include "IO/VirtualFileSystem.h"
+
+#include <kdl/invoke.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+constexpr auto PakCount = size_t(40);
+constexpr auto EntriesPerPak = size_t(1'000);
+
+std::string entryPrefix(const size_t pakIndex)
+{
+  return "textures/pak" + std::to_string(pakIndex) + "/entry";
+}
+} // namespace
+
+TEST_CASE("VirtualFileSystemBenchmark.findEntries")
+{
+  const auto testDir =
+    std::filesystem::temp_directory_path() / "VirtualFileSystemBenchmark";
+  std::filesystem::create_directories(testDir);
+  auto removeTestDir = kdl::invoke_later{[&]() { std::filesystem::remove_all(testDir); }};
+
+  auto vfs = VirtualFileSystem{};
+  vfs.mount("", std::make_unique<DiskFileSystem>(testDir));
+
+  auto paths = std::vector<std::filesystem::path>{};
+  for (size_t i = 0; i < PakCount; ++i)
+  {
+    const auto pakPath = makePak(
+      testDir / ("pak" + std::to_string(i) + ".pak"),
+      EntriesPerPak,
+      size_t(16),
+      entryPrefix(i));
+    vfs.mount("", std::make_unique<IdPakFileSystem>(pakPath));
+
+    for (size_t j = 0; j < EntriesPerPak; ++j)
+    {
+      paths.push_back(entryPrefix(i) + std::to_string(j) + ".bsp");
+    }
+  }
+
+  timeLambda(
+    [&]() { CHECK(vfs.pathInfo("textures") == PathInfo::Directory); },
+    "first lookup after mounting 40 paks");
+
+  auto fileCount = size_t(0);
+  timeLambda(
+    [&]() {
+      for (const auto& path : paths)
+      {
+        if (vfs.pathInfo(path) == PathInfo::File)
+        {
+          ++fileCount;
+        }
+      }
+    },
+    "get path info of 40000 entries in 40 paks");
+  CHECK(fileCount == paths.size());
+
+  auto totalSize = size_t(0);
+  timeLambda(
+    [&]() {
+      for (const auto& path : paths)
+      {
+        totalSize += vfs.openFile(path)->size();
+      }
+    },
+    "open 40000 files in 40 paks");
+  CHECK(totalSize == paths.size() * 16u);
+
+  auto found = std::vector<std::filesystem::path>{};
+  timeLambda(
+    [&]() {
+      for (size_t i = 0; i < 10; ++i)
+      {
+        found = vfs.findRecursively("textures", makeExtensionPathMatcher({".bsp"}));
+      }
+    },
+    "find 40000 files in 40 paks recursively 10 times");
+  CHECK(found.size() == paths.size());
+}
+} // namespace IO
+} // namespace TrenchBroom
@@ -0,0 +1,156 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/EntityDefinition.h"
+#include "Assets/ModelDefinition.h"
+#include "BenchmarkUtils.h"
+#include "IO/ELParser.h"
+#include "Model/Entity.h"
+#include "Model/EntityProperties.h"
+#include "Model/EntityPropertiesVariableStore.h"
+
+#include <vecmath/bbox.h>
+
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+constexpr auto NumEntities = size_t(20'000);
+
+const auto ModelExpression = R"({{
+  spawnflags & 1 -> { path: "models/items/armor.mdl", skin: 0 + 1, frame: frame },
+  spawnflags & 2 -> { path: "models/items/armor.mdl", skin: 1 + 1, frame: frame },
+  spawnflags & 4 -> { path: "models/items/armor.mdl", skin: [0, 1, 2][2] },
+                    { path: "models/items/armor.mdl", skin: skin, frame: frame }
+}})";
+
+std::vector<Entity> makeEntities(Assets::PointEntityDefinition& definition)
+{
+  auto entities = std::vector<Entity>{};
+  entities.reserve(NumEntities);
+  for (size_t i = 0; i < NumEntities; ++i)
+  {
+    auto entity = Entity{
+      {},
+      {{EntityPropertyKeys::Classname, definition.name()},
+       {EntityPropertyKeys::Spawnflags, std::to_string(i % 8)},
+       {"frame", std::to_string(i % 4)},
+       {"target", "target_" + std::to_string(i)}}};
+    entity.setDefinition({}, &definition);
+    entities.push_back(std::move(entity));
+  }
+  return entities;
+}
+
+std::vector<Assets::ModelSpecification> evaluateModelSpecifications(
+  const Assets::ModelDefinition& modelDefinition, const std::vector<Entity>& entities)
+{
+  auto result = std::vector<Assets::ModelSpecification>{};
+  result.reserve(entities.size());
+  for (const auto& entity : entities)
+  {
+    const auto variableStore = EntityPropertiesVariableStore{entity};
+    result.push_back(modelDefinition.modelSpecification(variableStore));
+  }
+  return result;
+}
+
+std::vector<Assets::ModelSpecification> cachedModelSpecifications(
+  const std::vector<Entity>& entities)
+{
+  auto result = std::vector<Assets::ModelSpecification>{};
+  result.reserve(entities.size());
+  for (const auto& entity : entities)
+  {
+    result.push_back(entity.modelSpecification());
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("EntityModelSpecificationBenchmark.modelSpecification")
+{
+  const auto expression = IO::ELParser::parseStrict(ModelExpression);
+  const auto unoptimizedModelDefinition = Assets::ModelDefinition{expression};
+  const auto optimizedModelDefinition = Assets::ModelDefinition{expression.optimize()};
+
+  auto definition = Assets::PointEntityDefinition{
+    "item_armor", Color{}, vm::bbox3{16.0}, "", {}, optimizedModelDefinition};
+
+  auto entities = std::vector<Entity>{};
+  timeLambda(
+    [&]() { entities = makeEntities(definition); },
+    "create " + std::to_string(NumEntities) + " point entities");
+
+  auto unoptimizedSpecifications = std::vector<Assets::ModelSpecification>{};
+  timeLambda(
+    [&]() {
+      unoptimizedSpecifications =
+        evaluateModelSpecifications(unoptimizedModelDefinition, entities);
+    },
+    "evaluate unoptimized model expression");
+
+  auto optimizedSpecifications = std::vector<Assets::ModelSpecification>{};
+  timeLambda(
+    [&]() {
+      optimizedSpecifications =
+        evaluateModelSpecifications(optimizedModelDefinition, entities);
+    },
+    "evaluate optimized model expression");
+
+  CHECK(optimizedSpecifications == unoptimizedSpecifications);
+
+  auto cachedSpecifications = std::vector<Assets::ModelSpecification>{};
+  timeLambda(
+    [&]() { cachedSpecifications = cachedModelSpecifications(entities); },
+    "get cached model specifications");
+
+  CHECK(cachedSpecifications == unoptimizedSpecifications);
+
+  timeLambda(
+    [&]() {
+      for (auto& entity : entities)
+      {
+        entity.addOrUpdateProperty({}, "target", "other_target");
+      }
+    },
+    "update a property that is not read by the model expression");
+
+  timeLambda(
+    [&]() {
+      for (auto& entity : entities)
+      {
+        entity.addOrUpdateProperty({}, "frame", "1");
+      }
+    },
+    "update a property that is read by the model expression");
+
+  CHECK(
+    cachedModelSpecifications(entities)
+    == evaluateModelSpecifications(unoptimizedModelDefinition, entities));
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,207 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "Model/Entity.h"
+#include "Model/EntityNode.h"
+#include "Model/EntityNodeBase.h"
+#include "Model/EntityNodeIndex.h"
+#include "Model/EntityProperties.h"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+constexpr auto NumEntities = size_t(50'000);
+
+const auto Classnames = std::vector<std::string>{
+  "light",
+  "light_fluoro",
+  "light_torch_small_walltorch",
+  "info_player_deathmatch",
+  "item_health",
+  "item_armor1",
+  "item_shells",
+  "item_spikes",
+  "monster_army",
+  "monster_dog",
+  "monster_ogre",
+  "monster_knight",
+  "func_door",
+  "func_button",
+  "trigger_multiple",
+  "trigger_once",
+  "path_corner",
+  "ambient_drip",
+};
+
+std::vector<std::unique_ptr<EntityNode>> makeEntityNodes()
+{
+  auto engine = std::mt19937{1};
+  auto coord = std::uniform_int_distribution<int>{-4096, 4096};
+
+  auto result = std::vector<std::unique_ptr<EntityNode>>{};
+  result.reserve(NumEntities);
+  for (size_t i = 0; i < NumEntities; ++i)
+  {
+    auto properties = std::vector<EntityProperty>{
+      {EntityPropertyKeys::Classname, Classnames[i % Classnames.size()]},
+      {EntityPropertyKeys::Origin,
+       std::to_string(coord(engine)) + " " + std::to_string(coord(engine)) + " "
+         + std::to_string(coord(engine))},
+      {EntityPropertyKeys::Angle, std::to_string((i % 8) * 45)},
+      {EntityPropertyKeys::Spawnflags, std::to_string(i % 4)},
+    };
+    if (i % 3 == 0)
+    {
+      properties.emplace_back("light", "300");
+      properties.emplace_back("_color", "1 0.9 0.8");
+    }
+    if (i % 10 == 0)
+    {
+      properties.emplace_back(
+        EntityPropertyKeys::Targetname, "target_" + std::to_string(i / 10));
+    }
+    if (i % 10 == 1)
+    {
+      properties.emplace_back(
+        EntityPropertyKeys::Target, "target_" + std::to_string(i / 10));
+    }
+    result.push_back(std::make_unique<EntityNode>(Entity{{}, std::move(properties)}));
+  }
+  return result;
+}
+
+size_t estimateStringMemoryUsage(const std::string& str)
+{
+  // short strings are stored inline
+  return sizeof(std::string) + (str.capacity() > 15u ? str.capacity() + 1u : 0u);
+}
+
+size_t estimateInternedStringMemoryUsage(const std::string& str)
+{
+  // a hash table node holding the string and its reference count, and a bucket
+  return estimateStringMemoryUsage(str) + sizeof(size_t) + 3u * sizeof(void*);
+}
+
+void printMemoryUsage(const std::vector<std::unique_ptr<EntityNode>>& entityNodes)
+{
+  auto numProperties = size_t(0);
+  auto stringMemoryUsage = size_t(0);
+  auto internedStrings = std::unordered_set<const std::string*>{};
+  auto internedMemoryUsage = size_t(0);
+
+  const auto countString = [&](const std::string& str) {
+    stringMemoryUsage += estimateStringMemoryUsage(str);
+    if (internedStrings.insert(&str).second)
+    {
+      internedMemoryUsage += estimateInternedStringMemoryUsage(str);
+    }
+  };
+
+  for (const auto& entityNode : entityNodes)
+  {
+    for (const auto& property : entityNode->entity().properties())
+    {
+      ++numProperties;
+      countString(property.key());
+      countString(property.value());
+    }
+  }
+  internedMemoryUsage += numProperties * sizeof(EntityProperty);
+
+  printf(
+    "Entity properties: %zu, distinct keys and values: %zu\n",
+    numProperties,
+    internedStrings.size());
+  printf(
+    "Estimated memory used by property strings stored per property: %zu KiB\n",
+    stringMemoryUsage / 1024u);
+  printf(
+    "Estimated memory used by interned property strings: %zu KiB\n",
+    internedMemoryUsage / 1024u);
+}
+} // namespace
+
+TEST_CASE("EntityPropertyMemoryBenchmark.largeMap")
+{
+  auto entityNodes = std::vector<std::unique_ptr<EntityNode>>{};
+  timeLambda(
+    [&]() { entityNodes = makeEntityNodes(); },
+    "create " + std::to_string(NumEntities) + " entities");
+
+  printMemoryUsage(entityNodes);
+
+  auto index = EntityNodeIndex{};
+  timeLambda(
+    [&]() {
+      for (auto& entityNode : entityNodes)
+      {
+        index.addEntityNode(entityNode.get());
+      }
+    },
+    "add " + std::to_string(NumEntities) + " entities to the property index");
+
+  auto found = std::vector<EntityNodeBase*>{};
+  timeLambda(
+    [&]() {
+      for (size_t i = 0; i < 1000; ++i)
+      {
+        found = index.findEntityNodes(
+          EntityNodeIndexQuery::exact(EntityPropertyKeys::Targetname),
+          "target_" + std::to_string(i));
+      }
+    },
+    "find entities by targetname 1000 times");
+  CHECK(found.size() == 1u);
+
+  timeLambda(
+    [&]() {
+      for (const auto& classname : Classnames)
+      {
+        found = index.findEntityNodes(
+          EntityNodeIndexQuery::exact(EntityPropertyKeys::Classname), classname);
+      }
+    },
+    "find entities by classname " + std::to_string(Classnames.size()) + " times");
+  CHECK(found.size() == NumEntities / Classnames.size());
+
+  timeLambda(
+    [&]() {
+      for (auto& entityNode : entityNodes)
+      {
+        index.removeEntityNode(entityNode.get());
+      }
+    },
+    "remove " + std::to_string(NumEntities) + " entities from the property index");
+  CHECK(index.allKeys().empty());
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,217 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushGeometry.h"
+#include "Model/BrushNode.h"
+#include "Model/EntityNode.h"
+#include "Model/Group.h"
+#include "Model/GroupNode.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/PatchNode.h"
+#include "Model/Polyhedron.h"
+#include "Model/UpdateLinkedGroupsError.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/overload.h>
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+constexpr auto NumBrushes = size_t(2'000);
+constexpr auto NumLinkedGroups = size_t(100);
+const auto WorldBounds = vm::bbox3{8192.0};
+
+std::unique_ptr<GroupNode> makeSourceGroup()
+{
+  const auto builder = BrushBuilder{MapFormat::Standard, WorldBounds};
+
+  auto engine = std::mt19937{1};
+  auto coord = std::uniform_real_distribution<FloatType>{-256.0, 256.0};
+  auto size = std::uniform_real_distribution<FloatType>{8.0, 64.0};
+
+  auto groupNode = std::make_unique<GroupNode>(Group{"prefab"});
+  for (size_t i = 0; i < NumBrushes; ++i)
+  {
+    const auto min = vm::round(vm::vec3{coord(engine), coord(engine), coord(engine)});
+    const auto max = min + vm::round(vm::vec3{size(engine), size(engine), size(engine)});
+    groupNode->addChild(
+      new BrushNode{builder.createCuboid(vm::bbox3{min, max}, "texture").value()});
+  }
+  return groupNode;
+}
+
+std::vector<std::unique_ptr<GroupNode>> makeLinkedGroups(const GroupNode& sourceGroupNode)
+{
+  auto result = std::vector<std::unique_ptr<GroupNode>>{};
+  result.reserve(NumLinkedGroups);
+  for (size_t i = 0; i < NumLinkedGroups; ++i)
+  {
+    auto* groupNode =
+      static_cast<GroupNode*>(sourceGroupNode.cloneRecursively(WorldBounds));
+    auto group = groupNode->group();
+    group.transform(vm::translation_matrix(vm::vec3{
+      FloatType(i % 10) * 512.0 - 2560.0, FloatType(i / 10) * 512.0 - 2560.0, 0.0}));
+    groupNode->setGroup(std::move(group));
+    result.emplace_back(groupNode);
+  }
+  return result;
+}
+
+size_t estimateGeometryMemoryUsage(const Brush& brush)
+{
+  return sizeof(BrushGeometry) + brush.vertexCount() * sizeof(BrushVertex)
+         + brush.edgeCount() * (sizeof(BrushEdge) + 2u * sizeof(BrushHalfEdge))
+         + brush.faceCount() * sizeof(BrushFaceGeometry);
+}
+
+template <typename N>
+void printGeometryMemoryUsage(const std::vector<N>& nodes, const std::string& what)
+{
+  auto numBrushes = size_t(0);
+  auto geometries = std::unordered_set<const void*>{};
+  auto memoryUsage = size_t(0);
+  auto sharedMemoryUsage = size_t(0);
+
+  for (const auto& node : nodes)
+  {
+    node->accept(kdl::overload(
+      [](auto&& thisLambda, const GroupNode* groupNode) {
+        groupNode->visitChildren(thisLambda);
+      },
+      [&](const BrushNode* brushNode) {
+        const auto& brush = brushNode->brush();
+        const auto geometryMemoryUsage = estimateGeometryMemoryUsage(brush);
+        ++numBrushes;
+        memoryUsage += geometryMemoryUsage;
+        if (geometries.insert(&brush.vertices()).second)
+        {
+          sharedMemoryUsage += geometryMemoryUsage;
+        }
+      },
+      [](const WorldNode*) {},
+      [](const LayerNode*) {},
+      [](const EntityNode*) {},
+      [](const PatchNode*) {}));
+  }
+
+  printf(
+    "%s: %zu brushes, %zu distinct geometries, estimated geometry memory %zu KiB "
+    "(%zu KiB without sharing)\n",
+    what.c_str(),
+    numBrushes,
+    geometries.size(),
+    sharedMemoryUsage / 1024u,
+    memoryUsage / 1024u);
+}
+} // namespace
+
+TEST_CASE("LinkedGroupBenchmark.updateLinkedGroups")
+{
+  auto sourceGroupNode = std::unique_ptr<GroupNode>{};
+  auto linkedGroupNodes = std::vector<std::unique_ptr<GroupNode>>{};
+
+  timeLambda(
+    [&]() { sourceGroupNode = makeSourceGroup(); },
+    "create source group with " + std::to_string(NumBrushes) + " brushes");
+
+  timeLambda(
+    [&]() { linkedGroupNodes = makeLinkedGroups(*sourceGroupNode); },
+    "clone source group " + std::to_string(NumLinkedGroups) + " times");
+
+  auto allGroupNodes = std::vector<const GroupNode*>{sourceGroupNode.get()};
+  for (const auto& linkedGroupNode : linkedGroupNodes)
+  {
+    allGroupNodes.push_back(linkedGroupNode.get());
+  }
+  printGeometryMemoryUsage(allGroupNodes, "Cloned groups");
+
+  auto targetGroupNodes = std::vector<GroupNode*>{};
+  for (auto& linkedGroupNode : linkedGroupNodes)
+  {
+    targetGroupNodes.push_back(linkedGroupNode.get());
+  }
+
+  auto result = UpdateLinkedGroupsResult{};
+  timeLambda(
+    [&]() {
+      result = updateLinkedGroups(*sourceGroupNode, targetGroupNodes, WorldBounds)
+                 .value();
+    },
+    "update " + std::to_string(NumLinkedGroups) + " linked groups");
+  REQUIRE(result.size() == NumLinkedGroups);
+
+  auto newChildren = std::vector<const Node*>{};
+  for (const auto& [groupNode, children] : result)
+  {
+    for (const auto& child : children)
+    {
+      newChildren.push_back(child.get());
+    }
+  }
+  printGeometryMemoryUsage(newChildren, "Updated groups");
+
+  // for comparison, rebuild every brush from its transformed faces
+  auto rebuiltBrushes = std::vector<Brush>{};
+  auto success = true;
+  rebuiltBrushes.reserve(NumBrushes * NumLinkedGroups);
+  timeLambda(
+    [&]() {
+      for (const auto* targetGroupNode : targetGroupNodes)
+      {
+        const auto& transformation = targetGroupNode->group().transformation();
+        for (const auto* child : sourceGroupNode->children())
+        {
+          auto faces = static_cast<const BrushNode*>(child)->brush().faces();
+          for (auto& face : faces)
+          {
+            success = face.transform(transformation, true).is_success() && success;
+          }
+          rebuiltBrushes.push_back(Brush::create(WorldBounds, std::move(faces)).value());
+        }
+      }
+    },
+    "rebuild " + std::to_string(NumLinkedGroups) + " linked groups from their faces");
+  CHECK(success);
+  CHECK(rebuiltBrushes.size() == NumBrushes * NumLinkedGroups);
+}
+} // namespace Model
+} // namespace TrenchBroom
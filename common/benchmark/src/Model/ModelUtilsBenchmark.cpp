@@ -0,0 +1,170 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/Entity.h"
+#include "Model/EntityProperties.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/ModelUtils.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/result.h>
+#include <kdl/vector_utils.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+constexpr auto NumBrushes = size_t(100'000);
+constexpr auto WorldSize = 8192.0;
+
+std::unique_ptr<WorldNode> makeWorld(const BrushBuilder& builder)
+{
+  auto engine = std::mt19937{1};
+  auto coord = std::uniform_real_distribution<FloatType>{-4096.0, 4096.0};
+  auto size = std::uniform_real_distribution<FloatType>{8.0, 128.0};
+
+  auto brushes = std::vector<Node*>{};
+  brushes.reserve(NumBrushes);
+  for (size_t i = 0; i < NumBrushes; ++i)
+  {
+    const auto min = vm::vec3{coord(engine), coord(engine), coord(engine)};
+    const auto max = min + vm::vec3{size(engine), size(engine), size(engine)};
+    brushes.push_back(
+      new BrushNode{builder.createCuboid(vm::bbox3{min, max}, "texture").value()});
+  }
+
+  auto world =
+    std::make_unique<WorldNode>(EntityPropertyConfig{}, Entity{}, MapFormat::Standard);
+  world->defaultLayer()->addChildren(brushes);
+  return world;
+}
+
+template <typename P>
+std::vector<Node*> collectMatchingNodesExhaustively(
+  const WorldNode& world, const std::vector<BrushNode*>& brushes, const P& predicate)
+{
+  auto result = std::vector<Node*>{};
+  for (auto* node : world.defaultLayer()->children())
+  {
+    for (const auto* brush : brushes)
+    {
+      if (brush != node && predicate(node, brush))
+      {
+        result.push_back(node);
+        break;
+      }
+    }
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("ModelUtilsBenchmark.collectTouchingNodes")
+{
+  const auto worldBounds = vm::bbox3{WorldSize};
+  const auto builder = BrushBuilder{MapFormat::Standard, worldBounds};
+  const auto world = makeWorld(builder);
+
+  SECTION("one large brush")
+  {
+    const auto queryBounds = vm::bbox3{1024.0};
+    auto queryBrush = BrushNode{builder.createCuboid(queryBounds, "texture").value()};
+    const auto queryBrushes = std::vector<BrushNode*>{&queryBrush};
+
+    auto touchingNodes = std::vector<Node*>{};
+    timeLambda(
+      [&]() { touchingNodes = collectTouchingNodes({world.get()}, queryBrushes); },
+      "collect nodes touching a large brush");
+
+    auto exhaustiveTouchingNodes = std::vector<Node*>{};
+    timeLambda(
+      [&]() {
+        exhaustiveTouchingNodes = collectMatchingNodesExhaustively(
+          *world, queryBrushes, [](const auto* node, const auto* brush) {
+            return brush->intersects(node);
+          });
+      },
+      "collect nodes touching a large brush by testing all nodes");
+
+    CHECK(kdl::vec_sort(touchingNodes) == kdl::vec_sort(exhaustiveTouchingNodes));
+
+    auto containedNodes = std::vector<Node*>{};
+    timeLambda(
+      [&]() { containedNodes = collectContainedNodes({world.get()}, queryBrushes); },
+      "collect nodes contained in a large brush");
+
+    auto exhaustiveContainedNodes = std::vector<Node*>{};
+    timeLambda(
+      [&]() {
+        exhaustiveContainedNodes = collectMatchingNodesExhaustively(
+          *world, queryBrushes, [](const auto* node, const auto* brush) {
+            return brush->contains(node);
+          });
+      },
+      "collect nodes contained in a large brush by testing all nodes");
+
+    CHECK(kdl::vec_sort(containedNodes) == kdl::vec_sort(exhaustiveContainedNodes));
+  }
+
+  SECTION("many small brushes")
+  {
+    const auto& layerChildren = world->defaultLayer()->children();
+    auto queryBrushes = std::vector<BrushNode*>{};
+    for (size_t i = 0; i < layerChildren.size(); i += layerChildren.size() / 100)
+    {
+      queryBrushes.push_back(static_cast<BrushNode*>(layerChildren[i]));
+    }
+
+    auto touchingNodes = std::vector<Node*>{};
+    timeLambda(
+      [&]() { touchingNodes = collectTouchingNodes({world.get()}, queryBrushes); },
+      "collect nodes touching " + std::to_string(queryBrushes.size()) + " brushes");
+
+    auto exhaustiveTouchingNodes = std::vector<Node*>{};
+    timeLambda(
+      [&]() {
+        exhaustiveTouchingNodes = collectMatchingNodesExhaustively(
+          *world, queryBrushes, [](const auto* node, const auto* brush) {
+            return brush->intersects(node);
+          });
+      },
+      "collect nodes touching " + std::to_string(queryBrushes.size())
+        + " brushes by testing all nodes");
+
+    CHECK(kdl::vec_sort(touchingNodes) == kdl::vec_sort(exhaustiveTouchingNodes));
+  }
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,206 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/EmptyBrushEntityValidator.h"
+#include "Model/EmptyGroupValidator.h"
+#include "Model/EmptyPropertyKeyValidator.h"
+#include "Model/EmptyPropertyValueValidator.h"
+#include "Model/Entity.h"
+#include "Model/EntityNode.h"
+#include "Model/EntityProperties.h"
+#include "Model/GroupNode.h"
+#include "Model/InvalidTextureScaleValidator.h"
+#include "Model/Issue.h"
+#include "Model/LayerNode.h"
+#include "Model/LinkSourceValidator.h"
+#include "Model/LinkTargetValidator.h"
+#include "Model/LongPropertyKeyValidator.h"
+#include "Model/LongPropertyValueValidator.h"
+#include "Model/MapFormat.h"
+#include "Model/MissingClassnameValidator.h"
+#include "Model/MissingDefinitionValidator.h"
+#include "Model/MixedBrushContentsValidator.h"
+#include "Model/NonIntegerVerticesValidator.h"
+#include "Model/PatchNode.h"
+#include "Model/PointEntityWithBrushesValidator.h"
+#include "Model/PropertyKeyWithDoubleQuotationMarksValidator.h"
+#include "Model/PropertyValueWithDoubleQuotationMarksValidator.h"
+#include "Model/ValidationEngine.h"
+#include "Model/WorldBoundsValidator.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/overload.h>
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+constexpr auto NumBrushes = size_t(90'000);
+constexpr auto NumEntities = size_t(10'000);
+constexpr auto WorldSize = 8192.0;
+
+std::unique_ptr<WorldNode> makeWorld()
+{
+  const auto worldBounds = vm::bbox3{WorldSize};
+  const auto builder = BrushBuilder{MapFormat::Standard, worldBounds};
+
+  auto engine = std::mt19937{1};
+  auto coord = std::uniform_real_distribution<FloatType>{-4096.0, 4096.0};
+  auto size = std::uniform_real_distribution<FloatType>{8.0, 128.0};
+
+  auto nodes = std::vector<Node*>{};
+  nodes.reserve(NumBrushes + NumEntities);
+  for (size_t i = 0; i < NumBrushes; ++i)
+  {
+    const auto min = vm::vec3{coord(engine), coord(engine), coord(engine)};
+    const auto max = min + vm::vec3{size(engine), size(engine), size(engine)};
+    nodes.push_back(
+      new BrushNode{builder.createCuboid(vm::bbox3{min, max}, "texture").value()});
+  }
+
+  for (size_t i = 0; i < NumEntities; ++i)
+  {
+    const auto index = std::to_string(i);
+    nodes.push_back(new EntityNode{Entity{
+      {},
+      {{EntityPropertyKeys::Classname, "info_null"},
+       {EntityPropertyKeys::Origin, "0 0 0"},
+       {EntityPropertyKeys::Target, "target" + index},
+       {EntityPropertyKeys::Targetname, "target" + std::to_string(i + 1)}}}});
+  }
+
+  auto world =
+    std::make_unique<WorldNode>(EntityPropertyConfig{}, Entity{}, MapFormat::Standard);
+  world->defaultLayer()->addChildren(nodes);
+
+  world->registerValidator(std::make_unique<MissingClassnameValidator>());
+  world->registerValidator(std::make_unique<MissingDefinitionValidator>());
+  world->registerValidator(std::make_unique<EmptyGroupValidator>());
+  world->registerValidator(std::make_unique<EmptyBrushEntityValidator>());
+  world->registerValidator(std::make_unique<PointEntityWithBrushesValidator>());
+  world->registerValidator(std::make_unique<LinkSourceValidator>());
+  world->registerValidator(std::make_unique<LinkTargetValidator>());
+  world->registerValidator(std::make_unique<NonIntegerVerticesValidator>());
+  world->registerValidator(std::make_unique<MixedBrushContentsValidator>());
+  world->registerValidator(std::make_unique<WorldBoundsValidator>(worldBounds));
+  world->registerValidator(std::make_unique<EmptyPropertyKeyValidator>());
+  world->registerValidator(std::make_unique<EmptyPropertyValueValidator>());
+  world->registerValidator(std::make_unique<LongPropertyKeyValidator>(32));
+  world->registerValidator(std::make_unique<LongPropertyValueValidator>(1024));
+  world->registerValidator(
+    std::make_unique<PropertyKeyWithDoubleQuotationMarksValidator>());
+  world->registerValidator(
+    std::make_unique<PropertyValueWithDoubleQuotationMarksValidator>());
+  world->registerValidator(std::make_unique<InvalidTextureScaleValidator>());
+
+  return world;
+}
+
+std::vector<const Issue*> validateSequentially(
+  WorldNode& world, const std::vector<const Validator*>& validators)
+{
+  auto result = std::vector<const Issue*>{};
+  const auto collectIssues = [&](auto* node) {
+    const auto issues = node->issues(validators);
+    result.insert(result.end(), issues.begin(), issues.end());
+  };
+
+  world.accept(kdl::overload(
+    [&](auto&& thisLambda, WorldNode* worldNode) {
+      collectIssues(worldNode);
+      worldNode->visitChildren(thisLambda);
+    },
+    [&](auto&& thisLambda, LayerNode* layer) {
+      collectIssues(layer);
+      layer->visitChildren(thisLambda);
+    },
+    [&](auto&& thisLambda, GroupNode* group) {
+      collectIssues(group);
+      group->visitChildren(thisLambda);
+    },
+    [&](auto&& thisLambda, EntityNode* entity) {
+      collectIssues(entity);
+      entity->visitChildren(thisLambda);
+    },
+    [&](BrushNode* brush) { collectIssues(brush); },
+    [&](PatchNode* patch) { collectIssues(patch); }));
+
+  return result;
+}
+} // namespace
+
+TEST_CASE("ValidationEngineBenchmark.validate")
+{
+  const auto sequentialWorld = makeWorld();
+  const auto nodeCount = std::to_string(sequentialWorld->descendantCount() + 1);
+
+  auto sequentialIssues = std::vector<const Issue*>{};
+  timeLambda(
+    [&]() {
+      sequentialIssues = validateSequentially(
+        *sequentialWorld, sequentialWorld->registeredValidators());
+    },
+    "validate " + nodeCount + " nodes sequentially");
+
+  const auto world = makeWorld();
+  const auto validators = world->registeredValidators();
+
+  auto validationEngine = ValidationEngine{};
+  auto parallelIssues = std::vector<const Issue*>{};
+  timeLambda(
+    [&]() {
+      validationEngine.reset(*world);
+      parallelIssues = validationEngine.validateAll(validators);
+    },
+    "validate " + nodeCount + " nodes in parallel batches");
+
+  CHECK(parallelIssues.size() == sequentialIssues.size());
+
+  auto* entityNode = static_cast<EntityNode*>(world->defaultLayer()->children().back());
+  auto entity = entityNode->entity();
+  entity.addOrUpdateProperty({}, "key", "value");
+  entityNode->setEntity(std::move(entity));
+
+  timeLambda(
+    [&]() {
+      validationEngine.reset(*world);
+      parallelIssues = validationEngine.validateAll(validators);
+    },
+    "validate " + nodeCount + " nodes after changing one entity");
+
+  CHECK(parallelIssues.size() == sequentialIssues.size());
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,288 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/EditorContext.h"
+#include "Model/Entity.h"
+#include "Model/EntityProperties.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/PickResult.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/plane.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+constexpr auto NumBrushes = size_t(100'000);
+constexpr auto NumRays = size_t(1'000);
+constexpr auto WorldSize = 8192.0;
+
+std::unique_ptr<WorldNode> makeWorld()
+{
+  const auto worldBounds = vm::bbox3{WorldSize};
+  const auto builder = BrushBuilder{MapFormat::Standard, worldBounds};
+
+  auto engine = std::mt19937{1};
+  auto coord = std::uniform_real_distribution<FloatType>{-4096.0, 4096.0};
+  auto size = std::uniform_real_distribution<FloatType>{8.0, 128.0};
+
+  auto brushes = std::vector<Node*>{};
+  brushes.reserve(NumBrushes);
+  for (size_t i = 0; i < NumBrushes; ++i)
+  {
+    const auto min = vm::vec3{coord(engine), coord(engine), coord(engine)};
+    const auto max = min + vm::vec3{size(engine), size(engine), size(engine)};
+    brushes.push_back(
+      new BrushNode{builder.createCuboid(vm::bbox3{min, max}, "texture").value()});
+  }
+
+  auto world =
+    std::make_unique<WorldNode>(EntityPropertyConfig{}, Entity{}, MapFormat::Standard);
+  world->defaultLayer()->addChildren(brushes);
+  return world;
+}
+
+/**
+ * Creates a world where the brushes are arranged in 25 long rows along the X axis, so
+ * that a ray along a row has thousands of candidates.
+ */
+std::unique_ptr<WorldNode> makeRowWorld()
+{
+  constexpr auto RowCount = size_t(25);
+  constexpr auto BrushesPerRow = NumBrushes / RowCount;
+
+  const auto worldBounds = vm::bbox3{WorldSize};
+  const auto builder = BrushBuilder{MapFormat::Standard, worldBounds};
+
+  auto brushes = std::vector<Node*>{};
+  brushes.reserve(NumBrushes);
+  for (size_t row = 0; row < RowCount; ++row)
+  {
+    const auto y = double(row % 5) * 64.0 - 160.0;
+    const auto z = double(row / 5) * 64.0 - 160.0;
+    for (size_t i = 0; i < BrushesPerRow; ++i)
+    {
+      const auto min = vm::vec3{double(i) * 2.0 - 4000.0, y, z};
+      const auto max = min + vm::vec3{1.0, 48.0, 48.0};
+      brushes.push_back(
+        new BrushNode{builder.createCuboid(vm::bbox3{min, max}, "texture").value()});
+    }
+  }
+
+  auto world =
+    std::make_unique<WorldNode>(EntityPropertyConfig{}, Entity{}, MapFormat::Standard);
+  world->defaultLayer()->addChildren(brushes);
+  return world;
+}
+
+std::vector<vm::ray3> makeRays()
+{
+  auto engine = std::mt19937{2};
+  auto coord = std::uniform_real_distribution<FloatType>{-4096.0, 4096.0};
+  auto direction = std::uniform_real_distribution<FloatType>{-1.0, 1.0};
+
+  auto rays = std::vector<vm::ray3>{};
+  rays.reserve(NumRays);
+  for (size_t i = 0; i < NumRays; ++i)
+  {
+    const auto origin = vm::vec3{coord(engine), coord(engine), coord(engine)};
+    const auto dir =
+      vm::normalize(vm::vec3{direction(engine), direction(engine), direction(engine)});
+    rays.emplace_back(origin, dir);
+  }
+  return rays;
+}
+
+std::vector<vm::ray3> makeRowRays()
+{
+  auto engine = std::mt19937{4};
+  auto coord = std::uniform_real_distribution<FloatType>{-160.0, 160.0};
+  auto slope = std::uniform_real_distribution<FloatType>{-0.01, 0.01};
+
+  auto rays = std::vector<vm::ray3>{};
+  rays.reserve(NumRays);
+  for (size_t i = 0; i < NumRays; ++i)
+  {
+    const auto origin = vm::vec3{-4096.0, coord(engine), coord(engine)};
+    const auto dir = vm::normalize(vm::vec3{1.0, slope(engine), slope(engine)});
+    rays.emplace_back(origin, dir);
+  }
+  return rays;
+}
+
+size_t countHits(const std::vector<PickResult>& pickResults)
+{
+  auto result = size_t(0);
+  for (const auto& pickResult : pickResults)
+  {
+    result += pickResult.size();
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("WorldNodeBenchmark.pickRays")
+{
+  const auto world = makeWorld();
+  const auto rays = makeRays();
+  const auto editorContext = EditorContext{};
+
+  auto singlePickResults = std::vector<PickResult>(rays.size(), PickResult::byDistance());
+  timeLambda(
+    [&]() {
+      for (size_t i = 0; i < rays.size(); ++i)
+      {
+        world->pick(editorContext, rays[i], singlePickResults[i]);
+      }
+    },
+    "pick " + std::to_string(rays.size()) + " rays one by one");
+
+  auto batchPickResults = std::vector<PickResult>(rays.size(), PickResult::byDistance());
+  timeLambda(
+    [&]() { world->pick(editorContext, rays, batchPickResults); },
+    "pick " + std::to_string(rays.size()) + " rays at once");
+
+  CHECK(countHits(batchPickResults) == countHits(singlePickResults));
+}
+
+TEST_CASE("WorldNodeBenchmark.pickRaysAlongRows")
+{
+  const auto world = makeRowWorld();
+  const auto rays = makeRowRays();
+  const auto editorContext = EditorContext{};
+
+  // picking a single ray splits the candidates across threads, picking all rays at once
+  // visits the candidates of every ray on the calling thread
+  auto singlePickResults = std::vector<PickResult>(rays.size(), PickResult::byDistance());
+  timeLambda(
+    [&]() {
+      for (size_t i = 0; i < rays.size(); ++i)
+      {
+        world->pick(editorContext, rays[i], singlePickResults[i]);
+      }
+    },
+    "pick " + std::to_string(rays.size()) + " rays along rows one by one");
+
+  auto batchPickResults = std::vector<PickResult>(rays.size(), PickResult::byDistance());
+  timeLambda(
+    [&]() { world->pick(editorContext, rays, batchPickResults); },
+    "pick " + std::to_string(rays.size()) + " rays along rows at once");
+
+  CHECK(countHits(batchPickResults) == countHits(singlePickResults));
+}
+
+TEST_CASE("WorldNodeBenchmark.findNodesIntersecting")
+{
+  const auto world = makeWorld();
+  auto* layer = world->defaultLayer();
+
+  SECTION("bounding boxes")
+  {
+    auto engine = std::mt19937{3};
+    auto coord = std::uniform_real_distribution<FloatType>{-4096.0, 3584.0};
+
+    auto queries = std::vector<vm::bbox3>{};
+    for (size_t i = 0; i < 100; ++i)
+    {
+      const auto min = vm::vec3{coord(engine), coord(engine), coord(engine)};
+      queries.emplace_back(min, min + vm::vec3::fill(512.0));
+    }
+
+    auto worldResult = std::vector<Node*>{};
+    timeLambda(
+      [&]() {
+        for (const auto& query : queries)
+        {
+          world->findNodesIntersecting(query, worldResult);
+        }
+      },
+      "find nodes intersecting 100 boxes using the spatial index");
+
+    auto layerResult = std::vector<Node*>{};
+    timeLambda(
+      [&]() {
+        for (const auto& query : queries)
+        {
+          layer->findNodesIntersecting(query, layerResult);
+        }
+      },
+      "find nodes intersecting 100 boxes by visiting all nodes");
+
+    CHECK(worldResult.size() == layerResult.size());
+  }
+
+  SECTION("frustum")
+  {
+    // a frustum with a 90 degree field of view looking down the X axis from the origin
+    const auto s = 1.0 / std::sqrt(2.0);
+    const auto planes = std::vector<vm::plane3>{
+      {vm::vec3{0, 0, 0}, vm::vec3{-s, s, 0}},
+      {vm::vec3{0, 0, 0}, vm::vec3{-s, -s, 0}},
+      {vm::vec3{0, 0, 0}, vm::vec3{-s, 0, s}},
+      {vm::vec3{0, 0, 0}, vm::vec3{-s, 0, -s}},
+      {vm::vec3{2048, 0, 0}, vm::vec3{1, 0, 0}},
+    };
+
+    auto worldResult = std::vector<Node*>{};
+    timeLambda(
+      [&]() {
+        for (size_t i = 0; i < 100; ++i)
+        {
+          worldResult.clear();
+          world->findNodesIntersecting(planes, worldResult);
+        }
+      },
+      "find nodes in frustum 100 times using the spatial index");
+
+    auto layerResult = std::vector<Node*>{};
+    timeLambda(
+      [&]() {
+        for (size_t i = 0; i < 100; ++i)
+        {
+          layerResult.clear();
+          layer->findNodesIntersecting(planes, layerResult);
+        }
+      },
+      "find nodes in frustum 100 times by visiting all nodes");
+
+    CHECK(worldResult.size() == layerResult.size());
+  }
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,174 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "flat_octree.h"
+#include "octree.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace
+{
+constexpr auto NumItems = size_t(100'000);
+constexpr auto NumRays = size_t(1'000);
+
+using Item = std::pair<vm::bbox3d, size_t>;
+
+std::vector<Item> makeItems(const unsigned int seed)
+{
+  auto engine = std::mt19937{seed};
+  auto coord = std::uniform_real_distribution<double>{-4096.0, 4096.0};
+  auto size = std::uniform_real_distribution<double>{8.0, 128.0};
+
+  auto items = std::vector<Item>{};
+  items.reserve(NumItems);
+  for (size_t i = 0; i < NumItems; ++i)
+  {
+    const auto min = vm::vec3d{coord(engine), coord(engine), coord(engine)};
+    const auto max = min + vm::vec3d{size(engine), size(engine), size(engine)};
+    items.emplace_back(vm::bbox3d{min, max}, i);
+  }
+  return items;
+}
+
+std::vector<Item> moveItems(std::vector<Item> items)
+{
+  auto engine = std::mt19937{3};
+  auto delta = std::uniform_real_distribution<double>{-16.0, 16.0};
+
+  for (auto& [bounds, data] : items)
+  {
+    bounds = bounds.translate(vm::vec3d{delta(engine), delta(engine), delta(engine)});
+  }
+  return items;
+}
+
+std::vector<vm::ray3d> makeRays()
+{
+  auto engine = std::mt19937{2};
+  auto coord = std::uniform_real_distribution<double>{-4096.0, 4096.0};
+  auto direction = std::uniform_real_distribution<double>{-1.0, 1.0};
+
+  auto rays = std::vector<vm::ray3d>{};
+  rays.reserve(NumRays);
+  for (size_t i = 0; i < NumRays; ++i)
+  {
+    const auto origin = vm::vec3d{coord(engine), coord(engine), coord(engine)};
+    const auto dir =
+      vm::normalize(vm::vec3d{direction(engine), direction(engine), direction(engine)});
+    rays.emplace_back(origin, dir);
+  }
+  return rays;
+}
+
+template <typename Tree>
+void benchmarkTree(const std::string& name, Tree& tree)
+{
+  const auto items = makeItems(1);
+  const auto movedItems = moveItems(items);
+  const auto rays = makeRays();
+
+  timeLambda(
+    [&]() {
+      for (const auto& [bounds, data] : items)
+      {
+        tree.insert(bounds, data);
+      }
+    },
+    name + ": insert " + std::to_string(items.size()) + " items");
+
+  auto numHits = size_t(0);
+  timeLambda(
+    [&]() {
+      for (const auto& ray : rays)
+      {
+        numHits += tree.find_intersectors(ray).size();
+      }
+    },
+    name + ": find intersectors of " + std::to_string(rays.size()) + " rays");
+
+  auto numBatchHits = size_t(0);
+  timeLambda(
+    [&]() {
+      tree.visit_intersectors(rays, [&](const auto&, const auto&) { ++numBatchHits; });
+    },
+    name + ": visit intersectors of " + std::to_string(rays.size()) + " rays at once");
+  CHECK(numBatchHits == numHits);
+
+  timeLambda(
+    [&]() {
+      for (const auto& [bounds, data] : movedItems)
+      {
+        tree.update(bounds, data);
+      }
+    },
+    name + ": update " + std::to_string(items.size()) + " items");
+
+  timeLambda(
+    [&]() {
+      for (const auto& [bounds, data] : items)
+      {
+        tree.remove(data);
+      }
+    },
+    name + ": remove " + std::to_string(items.size()) + " items");
+  CHECK(tree.empty());
+}
+} // namespace
+
+TEST_CASE("OctreeBenchmark.octree")
+{
+  auto tree = octree<double, size_t>{256.0};
+  benchmarkTree("octree", tree);
+}
+
+TEST_CASE("OctreeBenchmark.flat_octree")
+{
+  auto tree = flat_octree<double, size_t>{256.0};
+  benchmarkTree("flat_octree", tree);
+
+  const auto items = makeItems(1);
+  timeLambda(
+    [&]() { tree.build(items); },
+    "flat_octree: build from " + std::to_string(items.size()) + " items");
+  CHECK(tree.size() == items.size());
+
+  const auto rays = makeRays();
+  timeLambda(
+    [&]() {
+      for (const auto& ray : rays)
+      {
+        tree.find_intersectors(ray);
+      }
+    },
+    "flat_octree: find intersectors of " + std::to_string(rays.size())
+      + " rays after building");
+}
+} // namespace TrenchBroom
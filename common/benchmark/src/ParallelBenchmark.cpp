@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+
+#include <kdl/parallel.h>
+#include <kdl/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+TEST_CASE("ParallelBenchmark.smallBatches")
+{
+  constexpr auto OuterLoop = size_t(1'000);
+  constexpr auto InnerLoop = size_t(10);
+
+  auto counter = std::atomic<size_t>{0};
+  timeLambda(
+    [&]() {
+      for (size_t i = 0; i < OuterLoop * InnerLoop; ++i)
+      {
+        ++counter;
+      }
+    },
+    "sequential: " + std::to_string(OuterLoop * InnerLoop) + " increments");
+  CHECK(counter == OuterLoop * InnerLoop);
+
+  counter = 0;
+  timeLambda(
+    [&]() {
+      for (size_t i = 0; i < OuterLoop; ++i)
+      {
+        kdl::parallel_for(InnerLoop, [&](const size_t) { ++counter; });
+      }
+    },
+    "parallel_for: " + std::to_string(OuterLoop) + " batches of "
+      + std::to_string(InnerLoop) + " increments");
+  CHECK(counter == OuterLoop * InnerLoop);
+}
+
+TEST_CASE("ParallelBenchmark.largeBatch")
+{
+  constexpr auto Count = size_t(10'000'000);
+  auto values = std::vector<double>(Count);
+
+  timeLambda(
+    [&]() {
+      for (size_t i = 0; i < Count; ++i)
+      {
+        values[i] = static_cast<double>(i) * 0.5;
+      }
+    },
+    "sequential: " + std::to_string(Count) + " values");
+  CHECK(values[Count - 1] == static_cast<double>(Count - 1) * 0.5);
+
+  std::fill(values.begin(), values.end(), 0.0);
+  timeLambda(
+    [&]() {
+      kdl::parallel_for(
+        Count, [&](const size_t i) { values[i] = static_cast<double>(i) * 0.5; });
+    },
+    "parallel_for: " + std::to_string(Count) + " values on the default thread pool");
+  CHECK(values[Count - 1] == static_cast<double>(Count - 1) * 0.5);
+
+  auto pool = kdl::thread_pool{std::thread::hardware_concurrency()};
+  std::fill(values.begin(), values.end(), 0.0);
+  timeLambda(
+    [&]() {
+      kdl::parallel_for(
+        pool, Count, [&](const size_t i) { values[i] = static_cast<double>(i) * 0.5; });
+    },
+    "parallel_for: " + std::to_string(Count) + " values on a new thread pool");
+  CHECK(values[Count - 1] == static_cast<double>(Count - 1) * 0.5);
+}
+} // namespace TrenchBroom
@@ -0,0 +1,229 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkUtils.h"
+#include "FloatType.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/MapFormat.h"
+#include "Model/PickResult.h"
+#include "Model/Polyhedron.h"
+#include "PreferenceManager.h"
+#include "Preferences.h"
+#include "Renderer/PerspectiveCamera.h"
+#include "View/Lasso.h"
+#include "View/VertexHandleManager.h"
+
+#include <kdl/result.h>
+#include <kdl/vector_utils.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test/src/Catch2.h"
+
+namespace TrenchBroom
+{
+namespace View
+{
+namespace
+{
+constexpr auto NumBrushes = size_t(5'000);
+
+std::vector<std::unique_ptr<Model::BrushNode>> makeBrushes()
+{
+  const auto builder = Model::BrushBuilder{Model::MapFormat::Standard, vm::bbox3{8192.0}};
+
+  auto engine = std::mt19937{1};
+  auto coord = std::uniform_real_distribution<FloatType>{-2048.0, 2048.0};
+  auto size = std::uniform_real_distribution<FloatType>{8.0, 128.0};
+
+  auto result = std::vector<std::unique_ptr<Model::BrushNode>>{};
+  result.reserve(NumBrushes);
+  for (size_t i = 0; i < NumBrushes; ++i)
+  {
+    const auto min = vm::round(vm::vec3{coord(engine), coord(engine), coord(engine)});
+    const auto max = min + vm::round(vm::vec3{size(engine), size(engine), size(engine)});
+    result.push_back(std::make_unique<Model::BrushNode>(
+      builder.createCuboid(vm::bbox3{min, max}, "texture").value()));
+  }
+  return result;
+}
+
+Renderer::PerspectiveCamera makeCamera()
+{
+  return Renderer::PerspectiveCamera{
+    90.0f,
+    1.0f,
+    65536.0f,
+    Renderer::Camera::Viewport{0, 0, 1024, 768},
+    vm::vec3f{-3072.0f, 0.0f, 0.0f},
+    vm::vec3f{1.0f, 0.0f, 0.0f},
+    vm::vec3f{0.0f, 0.0f, 1.0f}};
+}
+} // namespace
+
+TEST_CASE("VertexHandleManagerBenchmark")
+{
+  const auto brushes = makeBrushes();
+  const auto brushNodes =
+    kdl::vec_transform(brushes, [](const auto& b) { return b.get(); });
+  const auto camera = makeCamera();
+
+  auto manager = VertexHandleManager{};
+  timeLambda(
+    [&]() { manager.addHandles(std::begin(brushNodes), std::end(brushNodes)); },
+    "add handles of " + std::to_string(brushNodes.size()) + " brushes");
+
+  const auto allHandles = manager.allHandles();
+  REQUIRE(allHandles.size() > 10'000u);
+
+  SECTION("pick")
+  {
+    auto pickRays = std::vector<vm::ray3>{};
+    for (int x = 0; x < 1024; x += 32)
+    {
+      for (int y = 0; y < 768; y += 32)
+      {
+        pickRays.emplace_back(camera.pickRay(float(x), float(y)));
+      }
+    }
+
+    auto indexedHits = size_t(0);
+    timeLambda(
+      [&]() {
+        for (const auto& pickRay : pickRays)
+        {
+          auto pickResult = Model::PickResult{};
+          manager.pick(pickRay, camera, pickResult);
+          indexedHits += pickResult.size();
+        }
+      },
+      "pick " + std::to_string(pickRays.size()) + " rays against "
+        + std::to_string(allHandles.size()) + " handles using the spatial index");
+
+    const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+    auto exhaustiveHits = size_t(0);
+    timeLambda(
+      [&]() {
+        for (const auto& pickRay : pickRays)
+        {
+          for (const auto& handle : allHandles)
+          {
+            if (!vm::is_nan(camera.pickPointHandle(pickRay, handle, handleRadius)))
+            {
+              ++exhaustiveHits;
+            }
+          }
+        }
+      },
+      "pick " + std::to_string(pickRays.size()) + " rays against "
+        + std::to_string(allHandles.size()) + " handles by testing every handle");
+
+    CHECK(indexedHits == exhaustiveHits);
+  }
+
+  SECTION("findIncidentBrushes")
+  {
+    const auto handles = std::vector<vm::vec3>{
+      std::begin(allHandles), std::next(std::begin(allHandles), 1'000)};
+
+    auto recordedCount = size_t(0);
+    timeLambda(
+      [&]() {
+        for (const auto& handle : handles)
+        {
+          recordedCount += manager
+                             .findIncidentBrushes(
+                               handle, std::begin(brushNodes), std::end(brushNodes))
+                             .size();
+        }
+      },
+      "find incident brushes of 1000 handles using the recorded brushes");
+
+    auto testedCount = size_t(0);
+    timeLambda(
+      [&]() {
+        for (const auto& handle : handles)
+        {
+          for (const auto* brushNode : brushNodes)
+          {
+            if (brushNode->brush().hasVertex(handle))
+            {
+              ++testedCount;
+            }
+          }
+        }
+      },
+      "find incident brushes of 1000 handles by testing every brush");
+
+    CHECK(recordedCount == testedCount);
+  }
+
+  SECTION("lasso")
+  {
+    const auto start = vm::vec3{camera.unproject(256.0f, 192.0f, 0.5f)};
+    const auto end = vm::vec3{camera.unproject(512.0f, 384.0f, 0.5f)};
+
+    auto lasso = Lasso{camera, 2048.0, start};
+    lasso.update(end);
+
+    auto indexedSelection = std::vector<vm::vec3>{};
+    timeLambda(
+      [&]() {
+        for (size_t i = 0; i < 100; ++i)
+        {
+          indexedSelection.clear();
+          const auto candidates = manager.findCandidateHandles(lasso.boundingPlanes());
+          lasso.selected(
+            std::begin(candidates),
+            std::end(candidates),
+            std::back_inserter(indexedSelection));
+        }
+      },
+      "lasso select 100 times using the spatial index");
+
+    auto exhaustiveSelection = std::vector<vm::vec3>{};
+    timeLambda(
+      [&]() {
+        for (size_t i = 0; i < 100; ++i)
+        {
+          exhaustiveSelection.clear();
+          const auto handles = manager.allHandles();
+          lasso.selected(
+            std::begin(handles),
+            std::end(handles),
+            std::back_inserter(exhaustiveSelection));
+        }
+      },
+      "lasso select 100 times by testing every handle");
+
+    CHECK(indexedSelection == exhaustiveSelection);
+  }
+}
+} // namespace View
+} // namespace TrenchBroom
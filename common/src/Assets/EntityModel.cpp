@@ -24,7 +24,7 @@
 #include "Renderer/PrimType.h"
 #include "Renderer/TexturedIndexRangeMap.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
-#include "octree.h"
+#include "flat_octree.h"
 
 #include <kdl/vector_utils.h>
 
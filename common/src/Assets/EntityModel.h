@@ -31,7 +31,7 @@
 namespace TrenchBroom
 {
 template <typename T, typename U>
-class octree;
+class flat_octree;
 
 namespace Renderer
 {
@@ -165,7 +165,7 @@ private:
   // For hit testing
   std::vector<vm::vec3f> m_tris;
   using TriNum = size_t;
-  using SpacialTree = octree<float, TriNum>;
+  using SpacialTree = flat_octree<float, TriNum>;
   std::unique_ptr<SpacialTree> m_spacialTree;
 
 public:
@@ -28,6 +28,12 @@
 #include "Model/EntityNode.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 
+#include <kdl/map_utils.h>
+#include <kdl/thread_pool.h>
+#include <kdl/vector_utils.h>
+
+#include <utility>
+
 namespace TrenchBroom
 {
 namespace Assets
@@ -39,6 +45,9 @@ EntityModelManager::EntityModelManager(
   , m_minFilter(minFilter)
   , m_magFilter(magFilter)
   , m_resetTextureMode(false)
+  , m_cancelled(false)
+  , m_loadedModelCount(0)
+  , m_failedModelCount(0)
 {
 }
 
@@ -49,6 +58,9 @@ EntityModelManager::~EntityModelManager()
 
 void EntityModelManager::clear()
 {
+  cancelPendingModels();
+  m_suspendedModels.clear();
+
   m_renderers.clear();
   m_models.clear();
   m_rendererMismatches.clear();
@@ -57,6 +69,12 @@ void EntityModelManager::clear()
   m_unpreparedModels.clear();
   m_unpreparedRenderers.clear();
 
+  m_replacedRenderers.clear();
+  m_replacedModels.clear();
+
+  m_loadedModelCount = 0;
+  m_failedModelCount = 0;
+
   // Remove logging because it might fail when the document is already destroyed.
 }
 
@@ -76,7 +94,7 @@ void EntityModelManager::setLoader(const IO::EntityModelLoader* loader)
 Renderer::TexturedRenderer* EntityModelManager::renderer(
   const Assets::ModelSpecification& spec) const
 {
-  auto* entityModel = safeGetModel(spec.path);
+  auto* entityModel = loadedModel(spec);
 
   if (entityModel == nullptr)
   {
@@ -118,7 +136,191 @@ Renderer::TexturedRenderer* EntityModelManager::renderer(
 const EntityModelFrame* EntityModelManager::frame(
   const Assets::ModelSpecification& spec) const
 {
-  auto* model = this->safeGetModel(spec.path);
+  return modelFrame(spec, model(spec));
+}
+
+const EntityModelFrame* EntityModelManager::loadedFrame(
+  const Assets::ModelSpecification& spec) const
+{
+  return modelFrame(spec, loadedModel(spec));
+}
+
+void EntityModelManager::prefetch(const std::vector<ModelSpecification>& specs) const
+{
+  auto frameIndices = std::map<std::filesystem::path, std::vector<size_t>>{};
+  for (const auto& spec : specs)
+  {
+    if (
+      !spec.path.empty() && m_models.count(spec.path) == 0
+      && m_modelMismatches.count(spec.path) == 0
+      && m_pendingModels.count(spec.path) == 0)
+    {
+      frameIndices[spec.path].push_back(spec.frameIndex);
+    }
+  }
+
+  for (auto& [path, pathFrameIndices] : frameIndices)
+  {
+    queueModel(path, std::move(pathFrameIndices));
+  }
+}
+
+std::vector<std::filesystem::path> EntityModelManager::processLoadedModels()
+{
+  auto result = std::vector<std::filesystem::path>{};
+
+  auto it = m_pendingModels.begin();
+  while (it != m_pendingModels.end())
+  {
+    if (it->second.ready())
+    {
+      auto path = it->first;
+      auto loadedModel = it->second.get();
+      it = m_pendingModels.erase(it);
+
+      installModel(path, std::move(loadedModel));
+      result.push_back(std::move(path));
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  return result;
+}
+
+std::vector<std::filesystem::path> EntityModelManager::modelPaths() const
+{
+  auto result = kdl::map_keys(m_models);
+  result.insert(result.end(), m_modelMismatches.begin(), m_modelMismatches.end());
+  return result;
+}
+
+void EntityModelManager::reloadModels(const std::vector<std::filesystem::path>& paths)
+{
+  for (const auto& path : paths)
+  {
+    if (m_pendingModels.count(path) > 0)
+    {
+      continue;
+    }
+
+    const auto it = m_models.find(path);
+    if (it != std::end(m_models))
+    {
+      // load the frames that are in use together with the model
+      auto frameIndices = std::vector<size_t>{};
+      if (const auto* model = it->second.get())
+      {
+        for (size_t i = 0; i < model->frameCount(); ++i)
+        {
+          if (model->frame(i)->loaded())
+          {
+            frameIndices.push_back(i);
+          }
+        }
+      }
+      queueModel(path, std::move(frameIndices));
+    }
+    else if (m_modelMismatches.erase(path) > 0)
+    {
+      --m_failedModelCount;
+      queueModel(path, {});
+    }
+  }
+}
+
+void EntityModelManager::suspendPendingModels()
+{
+  for (const auto& [path, future] : m_pendingModels)
+  {
+    m_suspendedModels.push_back(path);
+  }
+  cancelPendingModels();
+}
+
+void EntityModelManager::resumePendingModels()
+{
+  const auto suspendedModels = std::exchange(m_suspendedModels, {});
+  if (m_loader == nullptr)
+  {
+    return;
+  }
+
+  // reloads the models that were already loaded before they were suspended
+  reloadModels(suspendedModels);
+
+  for (const auto& path : suspendedModels)
+  {
+    if (
+      m_models.count(path) == 0 && m_modelMismatches.count(path) == 0
+      && m_pendingModels.count(path) == 0)
+    {
+      queueModel(path, {});
+    }
+  }
+}
+
+size_t EntityModelManager::queuedModelCount() const
+{
+  return m_pendingModels.size();
+}
+
+size_t EntityModelManager::loadedModelCount() const
+{
+  return m_loadedModelCount;
+}
+
+size_t EntityModelManager::failedModelCount() const
+{
+  return m_failedModelCount;
+}
+
+EntityModel* EntityModelManager::model(const ModelSpecification& spec) const
+{
+  if (auto* model = loadedModel(spec))
+  {
+    return model;
+  }
+
+  auto it = m_pendingModels.find(spec.path);
+  if (it == std::end(m_pendingModels))
+  {
+    return nullptr;
+  }
+
+  // loads the model on this thread if no worker has started loading it yet
+  auto loadedModel = kdl::default_thread_pool().wait(it->second);
+  m_pendingModels.erase(it);
+
+  return installModel(spec.path, std::move(loadedModel));
+}
+
+EntityModel* EntityModelManager::loadedModel(const ModelSpecification& spec) const
+{
+  if (spec.path.empty())
+  {
+    return nullptr;
+  }
+
+  auto it = m_models.find(spec.path);
+  if (it != std::end(m_models))
+  {
+    return it->second.get();
+  }
+
+  if (m_modelMismatches.count(spec.path) == 0 && m_pendingModels.count(spec.path) == 0)
+  {
+    queueModel(spec.path, {spec.frameIndex});
+  }
+
+  return nullptr;
+}
+
+const EntityModelFrame* EntityModelManager::modelFrame(
+  const ModelSpecification& spec, EntityModel* model) const
+{
   if (model == nullptr)
   {
     return nullptr;
@@ -131,87 +333,167 @@ const EntityModelFrame* EntityModelManager::frame(
   {
     if (!model->frame(spec.frameIndex)->loaded())
     {
-      loadFrame(spec, *model);
+      loadFrame(spec, *model, m_logger);
     }
     return model->frame(spec.frameIndex);
   }
 }
 
-EntityModel* EntityModelManager::model(const std::filesystem::path& path) const
+void EntityModelManager::queueModel(
+  const std::filesystem::path& path, std::vector<size_t> frameIndices) const
+{
+  ensure(m_loader != nullptr, "loader is null");
+
+  m_pendingModels.emplace(
+    path,
+    kdl::default_thread_pool().submit(
+      [this, path, frameIndices = std::move(frameIndices)]() {
+        return loadModel(path, frameIndices);
+      }));
+}
+
+EntityModelManager::LoadedModel EntityModelManager::loadModel(
+  const std::filesystem::path& path, const std::vector<size_t>& frameIndices) const
 {
-  if (path.empty())
+  auto result = LoadedModel{};
+  if (m_cancelled)
   {
-    return nullptr;
+    return result;
   }
 
-  auto it = m_models.find(path);
-  if (it != std::end(m_models))
+  try
   {
-    return it->second.get();
+    result.model = m_loader->initializeModel(path, result.logger);
+    if (result.model != nullptr)
+    {
+      for (const auto frameIndex : frameIndices)
+      {
+        if (
+          frameIndex < result.model->frameCount()
+          && !result.model->frame(frameIndex)->loaded())
+        {
+          loadFrame(
+            ModelSpecification{path, 0, frameIndex}, *result.model, result.logger);
+        }
+      }
+    }
+  }
+  catch (const GameException& e)
+  {
+    result.error = e.what();
   }
 
-  if (m_modelMismatches.count(path) > 0)
+  return result;
+}
+
+EntityModel* EntityModelManager::installModel(
+  const std::filesystem::path& path, LoadedModel loadedModel) const
+{
+  loadedModel.logger.replay(m_logger);
+
+  if (loadedModel.error)
   {
+    m_logger.error() << *loadedModel.error;
+
+    // keep using the current model if it could not be reloaded
+    if (m_models.count(path) == 0)
+    {
+      m_modelMismatches.insert(path);
+      ++m_failedModelCount;
+    }
     return nullptr;
   }
 
-  try
+  if (m_models.count(path) > 0)
   {
-    const auto [pos, success] = m_models.emplace(path, loadModel(path));
-    assert(success);
-    unused(success);
-
-    auto* model = pos->second.get();
-    m_unpreparedModels.push_back(model);
+    replaceModel(path);
+  }
 
-    m_logger.debug() << "Loaded entity model " << path;
+  const auto [pos, success] = m_models.emplace(path, std::move(loadedModel.model));
+  assert(success);
+  unused(success);
 
-    return model;
-  }
-  catch (const GameException& e)
+  auto* model = pos->second.get();
+  if (model != nullptr)
   {
-    m_logger.error() << e.what();
-    m_modelMismatches.insert(path);
-    throw;
+    m_unpreparedModels.push_back(model);
   }
+  ++m_loadedModelCount;
+
+  m_logger.debug() << "Loaded entity model " << path;
+
+  return model;
 }
 
-EntityModel* EntityModelManager::safeGetModel(const std::filesystem::path& path) const
+void EntityModelManager::replaceModel(const std::filesystem::path& path) const
 {
-  try
+  // Entities refer to the frames of the replaced model until they are updated, and the
+  // renderers are destroyed by prepare because they own GL resources, so the model and
+  // its renderers are kept alive until then.
+  for (auto it = m_renderers.begin(); it != m_renderers.end();)
   {
-    return model(path);
+    if (it->first.path == path)
+    {
+      m_unpreparedRenderers =
+        kdl::vec_erase(std::move(m_unpreparedRenderers), it->second.get());
+      m_replacedRenderers.push_back(std::move(it->second));
+      it = m_renderers.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
   }
-  catch (const GameException&)
+
+  const auto rendererMismatches = kdl::vec_filter(
+    m_rendererMismatches.get_data(), [&](const auto& spec) { return spec.path == path; });
+  for (const auto& spec : rendererMismatches)
   {
-    return nullptr;
+    m_rendererMismatches.erase(spec);
   }
+
+  auto it = m_models.find(path);
+  m_unpreparedModels = kdl::vec_erase(std::move(m_unpreparedModels), it->second.get());
+  m_replacedModels.push_back(std::move(it->second));
+  m_models.erase(it);
+  --m_loadedModelCount;
 }
 
-std::unique_ptr<EntityModel> EntityModelManager::loadModel(
-  const std::filesystem::path& path) const
+void EntityModelManager::cancelPendingModels()
 {
-  ensure(m_loader != nullptr, "loader is null");
-  return m_loader->initializeModel(path, m_logger);
+  // the loader must not be used anymore after this function returns, so wait for the
+  // tasks that are already running to finish; the others return immediately
+  m_cancelled = true;
+  for (auto& [path, future] : m_pendingModels)
+  {
+    kdl::default_thread_pool().wait(future);
+  }
+  m_pendingModels.clear();
+  m_cancelled = false;
 }
 
 void EntityModelManager::loadFrame(
-  const Assets::ModelSpecification& spec, Assets::EntityModel& model) const
+  const Assets::ModelSpecification& spec,
+  Assets::EntityModel& model,
+  Logger& logger) const
 {
   try
   {
     ensure(m_loader != nullptr, "loader is null");
-    m_loader->loadFrame(spec.path, spec.frameIndex, model, m_logger);
+    m_loader->loadFrame(spec.path, spec.frameIndex, model, logger);
   }
   catch (const Exception& e)
   {
     // FIXME: be specific about which exceptions to catch here
-    m_logger.error() << "Could not load entity model frame " << spec << ": " << e.what();
+    logger.error() << "Could not load entity model frame " << spec << ": " << e.what();
   }
 }
 
 void EntityModelManager::prepare(Renderer::VboManager& vboManager)
 {
+  m_replacedRenderers.clear();
+  m_replacedModels.clear();
+
   resetTextureMode();
   prepareModels();
   prepareRenderers(vboManager);
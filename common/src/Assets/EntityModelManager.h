@@ -19,16 +19,21 @@
 
 #pragma once
 
+#include "Logger.h"
+
+#include <kdl/thread_pool.h>
 #include <kdl/vector_set.h>
 
+#include <atomic>
 #include <filesystem>
 #include <map>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace TrenchBroom
 {
-class Logger;
 
 namespace IO
 {
@@ -53,17 +58,39 @@ class EntityModelFrame;
 struct ModelSpecification;
 enum class Orientation;
 
+/**
+ * Loads and caches entity models and their renderers.
+ *
+ * Models are loaded on the default thread pool. A model is queued for loading the first
+ * time it is requested, or when it is prefetched. Finished models are installed on the
+ * calling thread by `processLoadedModels`, or when `frame` waits for a model to be
+ * loaded. Pending loads are cancelled when the manager is cleared.
+ *
+ * Models can be reloaded, e.g. when their files have changed. A reloaded model replaces
+ * the current model when it is installed by `processLoadedModels`. The frames and
+ * renderers of the replaced model remain valid until the next call to `prepare`.
+ */
 class EntityModelManager
 {
 private:
+  struct LoadedModel
+  {
+    std::unique_ptr<EntityModel> model;
+    std::optional<std::string> error;
+    RecordingLogger logger;
+  };
+
   using ModelCache = std::map<std::filesystem::path, std::unique_ptr<EntityModel>>;
   using ModelMismatches = kdl::vector_set<std::filesystem::path>;
+  using PendingModels = std::map<std::filesystem::path, kdl::task_future<LoadedModel>>;
   using ModelList = std::vector<EntityModel*>;
+  using ReplacedModels = std::vector<std::unique_ptr<EntityModel>>;
 
   using RendererCache =
     std::map<ModelSpecification, std::unique_ptr<Renderer::TexturedRenderer>>;
   using RendererMismatches = kdl::vector_set<ModelSpecification>;
   using RendererList = std::vector<Renderer::TexturedRenderer*>;
+  using ReplacedRenderers = std::vector<std::unique_ptr<Renderer::TexturedRenderer>>;
 
   Logger& m_logger;
   const IO::EntityModelLoader* m_loader;
@@ -74,12 +101,20 @@ private:
 
   mutable ModelCache m_models;
   mutable ModelMismatches m_modelMismatches;
+  mutable PendingModels m_pendingModels;
+  std::vector<std::filesystem::path> m_suspendedModels;
+  std::atomic<bool> m_cancelled;
+  mutable size_t m_loadedModelCount;
+  mutable size_t m_failedModelCount;
   mutable RendererCache m_renderers;
   mutable RendererMismatches m_rendererMismatches;
 
   mutable ModelList m_unpreparedModels;
   mutable RendererList m_unpreparedRenderers;
 
+  mutable ReplacedModels m_replacedModels;
+  mutable ReplacedRenderers m_replacedRenderers;
+
 public:
   EntityModelManager(int magFilter, int minFilter, Logger& logger);
   ~EntityModelManager();
@@ -88,15 +123,78 @@ public:
 
   void setTextureMode(int minFilter, int magFilter);
   void setLoader(const IO::EntityModelLoader* loader);
+
+  /**
+   * Returns the renderer for the given model specification, or null if the model is not
+   * loaded yet. In that case, the model is queued for loading.
+   */
   Renderer::TexturedRenderer* renderer(const ModelSpecification& spec) const;
 
+  /**
+   * Returns the frame for the given model specification, waiting for its model to be
+   * loaded if necessary.
+   */
   const EntityModelFrame* frame(const ModelSpecification& spec) const;
 
+  /**
+   * Returns the frame for the given model specification, or null if the model is not
+   * loaded yet. In that case, the model is queued for loading, and the caller should
+   * request the frame again once `processLoadedModels` reports the model's path.
+   */
+  const EntityModelFrame* loadedFrame(const ModelSpecification& spec) const;
+
+  /**
+   * Queues the models of the given specifications for loading. The frames requested by
+   * the given specifications are loaded together with their models.
+   */
+  void prefetch(const std::vector<ModelSpecification>& specs) const;
+
+  /**
+   * Installs the models that have finished loading and returns their paths, including the
+   * paths of the models that failed to load.
+   */
+  std::vector<std::filesystem::path> processLoadedModels();
+
+  /**
+   * Returns the paths of the models that were loaded or that failed to load.
+   */
+  std::vector<std::filesystem::path> modelPaths() const;
+
+  /**
+   * Queues the models at the given paths for reloading. Models which failed to load are
+   * loaded again. Paths of models that were never requested are ignored.
+   */
+  void reloadModels(const std::vector<std::filesystem::path>& paths);
+
+  /**
+   * Cancels the pending model loads and waits for those that are already running, e.g.
+   * because the file system used by the loader is about to change. The cancelled models
+   * are queued again by `resumePendingModels`.
+   */
+  void suspendPendingModels();
+  void resumePendingModels();
+
+  size_t queuedModelCount() const;
+  size_t loadedModelCount() const;
+  size_t failedModelCount() const;
+
 private:
-  EntityModel* model(const std::filesystem::path& path) const;
-  EntityModel* safeGetModel(const std::filesystem::path& path) const;
-  std::unique_ptr<EntityModel> loadModel(const std::filesystem::path& path) const;
-  void loadFrame(const ModelSpecification& spec, EntityModel& model) const;
+  EntityModel* model(const ModelSpecification& spec) const;
+  EntityModel* loadedModel(const ModelSpecification& spec) const;
+  const EntityModelFrame* modelFrame(
+    const ModelSpecification& spec, EntityModel* model) const;
+
+  void queueModel(
+    const std::filesystem::path& path, std::vector<size_t> frameIndices) const;
+  LoadedModel loadModel(
+    const std::filesystem::path& path, const std::vector<size_t>& frameIndices) const;
+  EntityModel* installModel(
+    const std::filesystem::path& path, LoadedModel loadedModel) const;
+  void replaceModel(const std::filesystem::path& path) const;
+  void cancelPendingModels();
+
+  void loadFrame(
+    const ModelSpecification& spec, EntityModel& model, Logger& logger) const;
 
 public:
   void prepare(Renderer::VboManager& vboManager);
@@ -20,6 +20,7 @@
 #include "Palette.h"
 
 #include "Assets/TextureBuffer.h"
+#include "Assets/TextureKernels.h"
 #include "Ensure.h"
 #include "Exceptions.h"
 #include "IO/File.h"
@@ -30,7 +31,6 @@
 #include <kdl/result.h>
 #include <kdl/string_format.h>
 
-#include <cstring>
 #include <ostream>
 #include <string>
 
@@ -67,41 +67,22 @@ bool Palette::indexedToRgba(
                                        ? m_data->opaqueData.data()
                                        : m_data->index255TransparentData.data();
 
-  // Write rgba pixels
-  auto* const rgbaData = rgbaImage.data();
-  for (size_t i = 0; i < pixelCount; ++i)
-  {
-    const int index = reader.readInt<unsigned char>();
+  // Expand the indices and compute the color sums and the alpha mask in one pass
+  auto indices = std::vector<unsigned char>(pixelCount);
+  reader.read(indices.data(), pixelCount);
 
-    std::memcpy(rgbaData + (i * 4), &paletteData[index * 4], 4);
-  }
+  const auto result =
+    expandPalette(indices.data(), pixelCount, paletteData, rgbaImage.data());
 
-  // Check average color
-  uint32_t colorSum[3] = {0, 0, 0};
-  for (size_t i = 0; i < pixelCount; ++i)
-  {
-    colorSum[0] += uint32_t(rgbaData[(i * 4) + 0]);
-    colorSum[1] += uint32_t(rgbaData[(i * 4) + 1]);
-    colorSum[2] += uint32_t(rgbaData[(i * 4) + 2]);
-  }
   averageColor = Color{
-    float(colorSum[0]) / (255.0f * float(pixelCount)),
-    float(colorSum[1]) / (255.0f * float(pixelCount)),
-    float(colorSum[2]) / (255.0f * float(pixelCount)),
+    float(result.colorSum[0]) / (255.0f * float(pixelCount)),
+    float(result.colorSum[1]) / (255.0f * float(pixelCount)),
+    float(result.colorSum[2]) / (255.0f * float(pixelCount)),
     1.0f};
 
   // Check for transparency
-  auto hasTransparency = false;
-  if (transparency == PaletteTransparency::Index255Transparent)
-  {
-    // Take the bitwise AND of the alpha channel of all pixels
-    unsigned char andAlpha = 0xFF;
-    for (size_t i = 0; i < pixelCount; ++i)
-    {
-      andAlpha = static_cast<unsigned char>(andAlpha & rgbaData[4 * i + 3]);
-    }
-    hasTransparency = (andAlpha != 0xFF);
-  }
+  const auto hasTransparency =
+    transparency == PaletteTransparency::Index255Transparent && result.alphaAnd != 0xFF;
 
   return hasTransparency;
 }
@@ -153,6 +153,8 @@ private:
     m_blendFunc,
     m_gameData);
 
+  friend class TextureCollection;
+
 public:
   Texture(
     std::string name,
@@ -19,6 +19,7 @@
 
 #include "TextureBuffer.h"
 
+#include "Assets/TextureKernels.h"
 #include "Ensure.h"
 
 #include <vecmath/vec.h>
@@ -129,6 +130,28 @@ void setMipBufferSize(
   }
 }
 
+void generateMips(
+  TextureBufferList& buffers,
+  const size_t width,
+  const size_t height,
+  const size_t firstLevel)
+{
+  ensure(firstLevel > 0, "first level is not the base level");
+
+  for (size_t level = firstLevel; level < buffers.size(); ++level)
+  {
+    const auto previousSize = sizeAtMipLevel(width, height, level - 1);
+    const auto size = sizeAtMipLevel(width, height, level);
+    ensure(buffers[level].size() == 4 * size.x() * size.y(), "buffer has RGBA mip size");
+
+    downsampleBox(
+      buffers[level - 1].data(),
+      previousSize.x(),
+      previousSize.y(),
+      buffers[level].data());
+  }
+}
+
 void resizeMips(
   TextureBufferList& buffers, const vm::vec2s& oldSize, const vm::vec2s& newSize)
 {
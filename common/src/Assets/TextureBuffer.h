@@ -58,6 +58,14 @@ void setMipBufferSize(
   size_t height,
   GLenum format);
 
+/**
+ * Computes the mip levels starting at `firstLevel` by downsampling the respective
+ * previous level with a box filter. The buffers must contain RGBA pixels and must have
+ * the sizes set by `setMipBufferSize`.
+ */
+void generateMips(
+  TextureBufferList& buffers, size_t width, size_t height, size_t firstLevel);
+
 void resizeMips(
   TextureBufferList& buffers, const vm::vec2s& oldSize, const vm::vec2s& newSize);
 } // namespace Assets
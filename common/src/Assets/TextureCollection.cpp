@@ -119,6 +119,16 @@ Texture* TextureCollection::textureByName(const std::string& name)
     const_cast<const TextureCollection*>(this)->textureByName(name));
 }
 
+void TextureCollection::replaceTexture(const size_t index, Texture texture)
+{
+  assert(index < m_textures.size());
+
+  auto& current = m_textures[index];
+  texture.m_usageCount = static_cast<size_t>(current.m_usageCount);
+  texture.m_overridden = current.m_overridden;
+  current = std::move(texture);
+}
+
 bool TextureCollection::prepared() const
 {
   return !m_textureIds.empty();
@@ -142,6 +152,16 @@ void TextureCollection::prepare(const int minFilter, const int magFilter)
   }
 }
 
+void TextureCollection::prepareTexture(
+  const size_t index, const int minFilter, const int magFilter)
+{
+  assert(prepared());
+  assert(index < m_textures.size());
+
+  // the texture reuses the GL texture of the texture it replaced
+  m_textures[index].prepare(m_textureIds[index], minFilter, magFilter);
+}
+
 void TextureCollection::setTextureMode(const int minFilter, const int magFilter)
 {
   for (auto& texture : m_textures)
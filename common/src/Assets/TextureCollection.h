@@ -74,8 +74,17 @@ public:
   const Texture* textureByName(const std::string& name) const;
   Texture* textureByName(const std::string& name);
 
+  /**
+   * Replaces the texture at the given index, e.g. because its file has changed. Pointers
+   * to the replaced texture remain valid, and its usage count and overridden flag are
+   * retained. If this collection is prepared, the new texture must be prepared by calling
+   * `prepareTexture` before it is used.
+   */
+  void replaceTexture(size_t index, Texture texture);
+
   bool prepared() const;
   void prepare(int minFilter, int magFilter);
+  void prepareTexture(size_t index, int minFilter, int magFilter);
   void setTextureMode(int minFilter, int magFilter);
 };
 
@@ -0,0 +1,661 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureKernels.h"
+
+#include "Assets/TextureBuffer.h"
+#include "Ensure.h"
+#include "Macros.h"
+
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TB_TEXTURE_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(TB_TEXTURE_KERNELS_X86) && defined(__GNUC__)
+// allows AVX2 intrinsics in individual functions without compiling everything for AVX2
+#define TB_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TB_TARGET_AVX2
+#endif
+
+namespace TrenchBroom::Assets
+{
+
+std::ostream& operator<<(std::ostream& lhs, const KernelInstructionSet& rhs)
+{
+  switch (rhs)
+  {
+  case KernelInstructionSet::Scalar:
+    lhs << "Scalar";
+    break;
+  case KernelInstructionSet::SSE2:
+    lhs << "SSE2";
+    break;
+  case KernelInstructionSet::AVX2:
+    lhs << "AVX2";
+    break;
+    switchDefault();
+  }
+  return lhs;
+}
+
+namespace
+{
+
+#ifdef TB_TEXTURE_KERNELS_X86
+bool cpuSupportsAVX2()
+{
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+  {
+    return false;
+  }
+
+  // the CPU must support AVX and the OS must save the YMM registers
+  __cpuid(info, 1);
+  const auto osxsave = (info[2] & (1 << 27)) != 0;
+  const auto avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+  {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+void addPixel(const unsigned char* pixel, std::array<uint64_t, 3>& colorSum)
+{
+  colorSum[0] += uint64_t(pixel[0]);
+  colorSum[1] += uint64_t(pixel[1]);
+  colorSum[2] += uint64_t(pixel[2]);
+}
+
+PaletteExpansionResult expandPaletteScalar(
+  const unsigned char* indices,
+  const size_t pixelCount,
+  const unsigned char* palette,
+  unsigned char* rgba)
+{
+  auto result = PaletteExpansionResult{{0, 0, 0}, 0xFF};
+  for (size_t i = 0; i < pixelCount; ++i)
+  {
+    const auto* entry = palette + 4 * size_t(indices[i]);
+    std::memcpy(rgba + 4 * i, entry, 4);
+    addPixel(entry, result.colorSum);
+    result.alphaAnd = static_cast<unsigned char>(result.alphaAnd & entry[3]);
+  }
+  return result;
+}
+
+std::array<uint64_t, 3> sumColorsScalar(
+  const unsigned char* rgba, const size_t pixelCount)
+{
+  auto result = std::array<uint64_t, 3>{0, 0, 0};
+  for (size_t i = 0; i < pixelCount; ++i)
+  {
+    addPixel(rgba + 4 * i, result);
+  }
+  return result;
+}
+
+/**
+ * Downsamples the pixels [first, last) of the destination row computed from the given
+ * source rows.
+ */
+void downsampleRowScalar(
+  const unsigned char* row0,
+  const unsigned char* row1,
+  const size_t width,
+  unsigned char* dst,
+  const size_t first,
+  const size_t last)
+{
+  for (size_t x = first; x < last; ++x)
+  {
+    const auto x0 = 4 * std::min(2 * x, width - 1);
+    const auto x1 = 4 * std::min(2 * x + 1, width - 1);
+    for (size_t c = 0; c < 4; ++c)
+    {
+      const auto sum = unsigned(row0[x0 + c]) + unsigned(row0[x1 + c])
+                       + unsigned(row1[x0 + c]) + unsigned(row1[x1 + c]);
+      dst[4 * x + c] = static_cast<unsigned char>((sum + 2) / 4);
+    }
+  }
+}
+
+void downsampleBoxScalar(
+  const unsigned char* src, const size_t width, const size_t height, unsigned char* dst)
+{
+  const auto dstSize = sizeAtMipLevel(width, height, 1);
+  for (size_t y = 0; y < dstSize.y(); ++y)
+  {
+    const auto* row0 = src + 4 * width * std::min(2 * y, height - 1);
+    const auto* row1 = src + 4 * width * std::min(2 * y + 1, height - 1);
+    downsampleRowScalar(row0, row1, width, dst + 4 * dstSize.x() * y, 0, dstSize.x());
+  }
+}
+
+PaletteExpansionResult combine(
+  const std::array<uint64_t, 3>& colorSum,
+  const unsigned char alphaAnd,
+  const PaletteExpansionResult& remainder)
+{
+  return {
+    {colorSum[0] + remainder.colorSum[0],
+     colorSum[1] + remainder.colorSum[1],
+     colorSum[2] + remainder.colorSum[2]},
+    static_cast<unsigned char>(alphaAnd & remainder.alphaAnd)};
+}
+
+std::array<uint64_t, 3> combine(
+  const std::array<uint64_t, 3>& colorSum, const std::array<uint64_t, 3>& remainder)
+{
+  return {
+    colorSum[0] + remainder[0], colorSum[1] + remainder[1], colorSum[2] + remainder[2]};
+}
+
+#ifdef TB_TEXTURE_KERNELS_X86
+
+/*
+ * The vectorized kernels rely on RGBA pixels being stored as little endian 32 bit
+ * integers, so that the red component is the least significant byte.
+ *
+ * The color components are summed up in 16 bit lanes: masking a pixel with 0x00FF00FF
+ * yields its red and blue components, and shifting it by 8 bits first yields its green
+ * and alpha components. A 16 bit lane can hold the sum of 257 components without
+ * overflowing, so the partial sums are added to the 64 bit totals after every
+ * MaxPartialSums vectors.
+ */
+
+constexpr size_t MaxPartialSums = 256;
+
+struct SSE2Sums
+{
+  std::array<uint64_t, 3> colorSum = {0, 0, 0};
+  __m128i redBlue = _mm_setzero_si128();
+  __m128i greenAlpha = _mm_setzero_si128();
+  __m128i alphaAnd = _mm_set1_epi32(-1);
+  size_t partialSums = 0;
+};
+
+void flushSSE2(SSE2Sums& sums)
+{
+  uint16_t redBlue[8], greenAlpha[8];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(redBlue), sums.redBlue);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(greenAlpha), sums.greenAlpha);
+
+  for (size_t i = 0; i < 8; i += 2)
+  {
+    sums.colorSum[0] += uint64_t(redBlue[i]);
+    sums.colorSum[1] += uint64_t(greenAlpha[i]);
+    sums.colorSum[2] += uint64_t(redBlue[i + 1]);
+  }
+
+  sums.redBlue = _mm_setzero_si128();
+  sums.greenAlpha = _mm_setzero_si128();
+  sums.partialSums = 0;
+}
+
+void addPixelsSSE2(const __m128i pixels, SSE2Sums& sums)
+{
+  const auto mask = _mm_set1_epi32(0x00FF00FF);
+
+  sums.redBlue = _mm_add_epi16(sums.redBlue, _mm_and_si128(pixels, mask));
+  sums.greenAlpha =
+    _mm_add_epi16(sums.greenAlpha, _mm_and_si128(_mm_srli_epi32(pixels, 8), mask));
+  sums.alphaAnd = _mm_and_si128(sums.alphaAnd, pixels);
+
+  if (++sums.partialSums == MaxPartialSums)
+  {
+    flushSSE2(sums);
+  }
+}
+
+std::array<uint64_t, 3> colorSumSSE2(SSE2Sums& sums)
+{
+  flushSSE2(sums);
+  return sums.colorSum;
+}
+
+unsigned char alphaAndSSE2(const SSE2Sums& sums)
+{
+  uint32_t lanes[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sums.alphaAnd);
+  return static_cast<unsigned char>((lanes[0] & lanes[1] & lanes[2] & lanes[3]) >> 24);
+}
+
+uint32_t loadPaletteEntry(const unsigned char* palette, const unsigned char index)
+{
+  auto entry = uint32_t(0);
+  std::memcpy(&entry, palette + 4 * size_t(index), 4);
+  return entry;
+}
+
+PaletteExpansionResult expandPaletteSSE2(
+  const unsigned char* indices,
+  const size_t pixelCount,
+  const unsigned char* palette,
+  unsigned char* rgba)
+{
+  // SSE2 has no gather instruction, so the palette entries are loaded individually
+  auto sums = SSE2Sums{};
+  size_t i = 0;
+  for (; i + 4 <= pixelCount; i += 4)
+  {
+    const auto pixels = _mm_set_epi32(
+      int(loadPaletteEntry(palette, indices[i + 3])),
+      int(loadPaletteEntry(palette, indices[i + 2])),
+      int(loadPaletteEntry(palette, indices[i + 1])),
+      int(loadPaletteEntry(palette, indices[i + 0])));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + 4 * i), pixels);
+    addPixelsSSE2(pixels, sums);
+  }
+
+  return combine(
+    colorSumSSE2(sums),
+    alphaAndSSE2(sums),
+    expandPaletteScalar(indices + i, pixelCount - i, palette, rgba + 4 * i));
+}
+
+std::array<uint64_t, 3> sumColorsSSE2(const unsigned char* rgba, const size_t pixelCount)
+{
+  auto sums = SSE2Sums{};
+  size_t i = 0;
+  for (; i + 4 <= pixelCount; i += 4)
+  {
+    addPixelsSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 4 * i)), sums);
+  }
+
+  return combine(colorSumSSE2(sums), sumColorsScalar(rgba + 4 * i, pixelCount - i));
+}
+
+/**
+ * Computes two destination pixels from four horizontally adjacent pixels in each of the
+ * given rows, returned as eight 16 bit components.
+ */
+__m128i downsampleQuadsSSE2(const __m128i top, const __m128i bottom)
+{
+  const auto zero = _mm_setzero_si128();
+
+  // source pixels 0 and 1 in lo, 2 and 3 in hi
+  const auto lo =
+    _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+  const auto hi =
+    _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+  // add pixels 0 and 1 and pixels 2 and 3
+  const auto sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+  return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+
+void downsampleBoxSSE2(
+  const unsigned char* src, const size_t width, const size_t height, unsigned char* dst)
+{
+  const auto dstSize = sizeAtMipLevel(width, height, 1);
+  for (size_t y = 0; y < dstSize.y(); ++y)
+  {
+    const auto* row0 = src + 4 * width * std::min(2 * y, height - 1);
+    const auto* row1 = src + 4 * width * std::min(2 * y + 1, height - 1);
+    auto* dstRow = dst + 4 * dstSize.x() * y;
+
+    size_t x = 0;
+    for (; x + 4 <= dstSize.x(); x += 4)
+    {
+      const auto* top = reinterpret_cast<const __m128i*>(row0 + 8 * x);
+      const auto* bottom = reinterpret_cast<const __m128i*>(row1 + 8 * x);
+      const auto first =
+        downsampleQuadsSSE2(_mm_loadu_si128(top), _mm_loadu_si128(bottom));
+      const auto second =
+        downsampleQuadsSSE2(_mm_loadu_si128(top + 1), _mm_loadu_si128(bottom + 1));
+      _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dstRow + 4 * x), _mm_packus_epi16(first, second));
+    }
+    downsampleRowScalar(row0, row1, width, dstRow, x, dstSize.x());
+  }
+}
+
+struct AVX2Sums
+{
+  std::array<uint64_t, 3> colorSum;
+  __m256i redBlue;
+  __m256i greenAlpha;
+  __m256i alphaAnd;
+  size_t partialSums;
+};
+
+TB_TARGET_AVX2 AVX2Sums makeAVX2Sums()
+{
+  const auto zero = _mm256_setzero_si256();
+  return {{0, 0, 0}, zero, zero, _mm256_set1_epi32(-1), 0};
+}
+
+TB_TARGET_AVX2 void flushAVX2(AVX2Sums& sums)
+{
+  uint16_t redBlue[16], greenAlpha[16];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(redBlue), sums.redBlue);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(greenAlpha), sums.greenAlpha);
+
+  for (size_t i = 0; i < 16; i += 2)
+  {
+    sums.colorSum[0] += uint64_t(redBlue[i]);
+    sums.colorSum[1] += uint64_t(greenAlpha[i]);
+    sums.colorSum[2] += uint64_t(redBlue[i + 1]);
+  }
+
+  sums.redBlue = _mm256_setzero_si256();
+  sums.greenAlpha = _mm256_setzero_si256();
+  sums.partialSums = 0;
+}
+
+TB_TARGET_AVX2 void addPixelsAVX2(const __m256i pixels, AVX2Sums& sums)
+{
+  const auto mask = _mm256_set1_epi32(0x00FF00FF);
+
+  sums.redBlue = _mm256_add_epi16(sums.redBlue, _mm256_and_si256(pixels, mask));
+  sums.greenAlpha = _mm256_add_epi16(
+    sums.greenAlpha, _mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask));
+  sums.alphaAnd = _mm256_and_si256(sums.alphaAnd, pixels);
+
+  if (++sums.partialSums == MaxPartialSums)
+  {
+    flushAVX2(sums);
+  }
+}
+
+TB_TARGET_AVX2 std::array<uint64_t, 3> colorSumAVX2(AVX2Sums& sums)
+{
+  flushAVX2(sums);
+  return sums.colorSum;
+}
+
+TB_TARGET_AVX2 unsigned char alphaAndAVX2(const AVX2Sums& sums)
+{
+  uint32_t lanes[8];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sums.alphaAnd);
+
+  auto result = uint32_t(0xFFFFFFFF);
+  for (const auto lane : lanes)
+  {
+    result &= lane;
+  }
+  return static_cast<unsigned char>(result >> 24);
+}
+
+TB_TARGET_AVX2 PaletteExpansionResult expandPaletteAVX2(
+  const unsigned char* indices,
+  const size_t pixelCount,
+  const unsigned char* palette,
+  unsigned char* rgba)
+{
+  const auto* entries = reinterpret_cast<const int*>(palette);
+
+  auto sums = makeAVX2Sums();
+  size_t i = 0;
+  for (; i + 8 <= pixelCount; i += 8)
+  {
+    const auto packedIndices =
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i));
+    const auto pixels =
+      _mm256_i32gather_epi32(entries, _mm256_cvtepu8_epi32(packedIndices), 4);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + 4 * i), pixels);
+    addPixelsAVX2(pixels, sums);
+  }
+
+  return combine(
+    colorSumAVX2(sums),
+    alphaAndAVX2(sums),
+    expandPaletteScalar(indices + i, pixelCount - i, palette, rgba + 4 * i));
+}
+
+TB_TARGET_AVX2 std::array<uint64_t, 3> sumColorsAVX2(
+  const unsigned char* rgba, const size_t pixelCount)
+{
+  auto sums = makeAVX2Sums();
+  size_t i = 0;
+  for (; i + 8 <= pixelCount; i += 8)
+  {
+    addPixelsAVX2(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + 4 * i)), sums);
+  }
+
+  return combine(colorSumAVX2(sums), sumColorsScalar(rgba + 4 * i, pixelCount - i));
+}
+
+/**
+ * Like downsampleQuadsSSE2, but the unpack instructions operate on each 128 bit lane
+ * separately, so this computes destination pixels 0 and 1 in the lower lane and 2 and 3
+ * in the upper lane from eight horizontally adjacent pixels in each of the given rows.
+ */
+TB_TARGET_AVX2 __m256i downsampleQuadsAVX2(const __m256i top, const __m256i bottom)
+{
+  const auto zero = _mm256_setzero_si256();
+
+  const auto lo =
+    _mm256_add_epi16(_mm256_unpacklo_epi8(top, zero), _mm256_unpacklo_epi8(bottom, zero));
+  const auto hi =
+    _mm256_add_epi16(_mm256_unpackhi_epi8(top, zero), _mm256_unpackhi_epi8(bottom, zero));
+
+  const auto sum =
+    _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi));
+  return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+}
+
+TB_TARGET_AVX2 void downsampleBoxAVX2(
+  const unsigned char* src, const size_t width, const size_t height, unsigned char* dst)
+{
+  const auto dstSize = sizeAtMipLevel(width, height, 1);
+  for (size_t y = 0; y < dstSize.y(); ++y)
+  {
+    const auto* row0 = src + 4 * width * std::min(2 * y, height - 1);
+    const auto* row1 = src + 4 * width * std::min(2 * y + 1, height - 1);
+    auto* dstRow = dst + 4 * dstSize.x() * y;
+
+    size_t x = 0;
+    for (; x + 8 <= dstSize.x(); x += 8)
+    {
+      const auto* top = reinterpret_cast<const __m256i*>(row0 + 8 * x);
+      const auto* bottom = reinterpret_cast<const __m256i*>(row1 + 8 * x);
+      const auto first =
+        downsampleQuadsAVX2(_mm256_loadu_si256(top), _mm256_loadu_si256(bottom));
+      const auto second = downsampleQuadsAVX2(
+        _mm256_loadu_si256(top + 1), _mm256_loadu_si256(bottom + 1));
+
+      // packing interleaves the lanes, so the 64 bit blocks must be reordered
+      const auto packed = _mm256_packus_epi16(first, second);
+      _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dstRow + 4 * x),
+        _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    downsampleRowScalar(row0, row1, width, dstRow, x, dstSize.x());
+  }
+}
+
+#endif
+
+} // namespace
+
+bool isKernelInstructionSetAvailable(const KernelInstructionSet instructionSet)
+{
+  switch (instructionSet)
+  {
+  case KernelInstructionSet::Scalar:
+    return true;
+#ifdef TB_TEXTURE_KERNELS_X86
+  case KernelInstructionSet::SSE2:
+    // SSE2 is part of the x86-64 baseline
+    return true;
+  case KernelInstructionSet::AVX2: {
+    static const auto avx2 = cpuSupportsAVX2();
+    return avx2;
+  }
+#else
+  case KernelInstructionSet::SSE2:
+  case KernelInstructionSet::AVX2:
+    return false;
+#endif
+    switchDefault();
+  }
+}
+
+std::vector<KernelInstructionSet> availableKernelInstructionSets()
+{
+  auto result = std::vector<KernelInstructionSet>{};
+  for (const auto instructionSet :
+       {KernelInstructionSet::Scalar,
+        KernelInstructionSet::SSE2,
+        KernelInstructionSet::AVX2})
+  {
+    if (isKernelInstructionSetAvailable(instructionSet))
+    {
+      result.push_back(instructionSet);
+    }
+  }
+  return result;
+}
+
+KernelInstructionSet bestKernelInstructionSet()
+{
+  static const auto instructionSet = availableKernelInstructionSets().back();
+  return instructionSet;
+}
+
+PaletteExpansionResult expandPalette(
+  const unsigned char* indices,
+  const size_t pixelCount,
+  const unsigned char* palette,
+  unsigned char* rgba)
+{
+  return expandPalette(indices, pixelCount, palette, rgba, bestKernelInstructionSet());
+}
+
+PaletteExpansionResult expandPalette(
+  const unsigned char* indices,
+  const size_t pixelCount,
+  const unsigned char* palette,
+  unsigned char* rgba,
+  const KernelInstructionSet instructionSet)
+{
+  ensure(
+    isKernelInstructionSetAvailable(instructionSet), "instruction set is available");
+
+  switch (instructionSet)
+  {
+#ifdef TB_TEXTURE_KERNELS_X86
+  case KernelInstructionSet::SSE2:
+    return expandPaletteSSE2(indices, pixelCount, palette, rgba);
+  case KernelInstructionSet::AVX2:
+    return expandPaletteAVX2(indices, pixelCount, palette, rgba);
+#else
+  case KernelInstructionSet::SSE2:
+  case KernelInstructionSet::AVX2:
+#endif
+  case KernelInstructionSet::Scalar:
+    return expandPaletteScalar(indices, pixelCount, palette, rgba);
+    switchDefault();
+  }
+}
+
+std::array<uint64_t, 3> sumColors(const unsigned char* rgba, const size_t pixelCount)
+{
+  return sumColors(rgba, pixelCount, bestKernelInstructionSet());
+}
+
+std::array<uint64_t, 3> sumColors(
+  const unsigned char* rgba,
+  const size_t pixelCount,
+  const KernelInstructionSet instructionSet)
+{
+  ensure(
+    isKernelInstructionSetAvailable(instructionSet), "instruction set is available");
+
+  switch (instructionSet)
+  {
+#ifdef TB_TEXTURE_KERNELS_X86
+  case KernelInstructionSet::SSE2:
+    return sumColorsSSE2(rgba, pixelCount);
+  case KernelInstructionSet::AVX2:
+    return sumColorsAVX2(rgba, pixelCount);
+#else
+  case KernelInstructionSet::SSE2:
+  case KernelInstructionSet::AVX2:
+#endif
+  case KernelInstructionSet::Scalar:
+    return sumColorsScalar(rgba, pixelCount);
+    switchDefault();
+  }
+}
+
+void downsampleBox(
+  const unsigned char* src, const size_t width, const size_t height, unsigned char* dst)
+{
+  downsampleBox(src, width, height, dst, bestKernelInstructionSet());
+}
+
+void downsampleBox(
+  const unsigned char* src,
+  const size_t width,
+  const size_t height,
+  unsigned char* dst,
+  const KernelInstructionSet instructionSet)
+{
+  ensure(
+    isKernelInstructionSetAvailable(instructionSet), "instruction set is available");
+  assert(width > 0);
+  assert(height > 0);
+
+  switch (instructionSet)
+  {
+#ifdef TB_TEXTURE_KERNELS_X86
+  case KernelInstructionSet::SSE2:
+    downsampleBoxSSE2(src, width, height, dst);
+    break;
+  case KernelInstructionSet::AVX2:
+    downsampleBoxAVX2(src, width, height, dst);
+    break;
+#else
+  case KernelInstructionSet::SSE2:
+  case KernelInstructionSet::AVX2:
+#endif
+  case KernelInstructionSet::Scalar:
+    downsampleBoxScalar(src, width, height, dst);
+    break;
+    switchDefault();
+  }
+}
+
+} // namespace TrenchBroom::Assets
@@ -0,0 +1,128 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace TrenchBroom::Assets
+{
+
+/**
+ * The instruction sets that the texture kernels can be run with. The scalar kernels are
+ * always available and serve as the reference for the vectorized kernels, which must
+ * produce bit exact results.
+ */
+enum class KernelInstructionSet
+{
+  Scalar,
+  SSE2,
+  AVX2
+};
+
+std::ostream& operator<<(std::ostream& lhs, const KernelInstructionSet& rhs);
+
+/**
+ * Indicates whether the given instruction set can be used on the current CPU.
+ */
+bool isKernelInstructionSetAvailable(KernelInstructionSet instructionSet);
+
+/**
+ * Returns the instruction sets that can be used on the current CPU, starting with the
+ * scalar instruction set.
+ */
+std::vector<KernelInstructionSet> availableKernelInstructionSets();
+
+/**
+ * Returns the fastest instruction set that can be used on the current CPU. This is the
+ * instruction set used by the kernel functions that do not take an instruction set
+ * parameter.
+ */
+KernelInstructionSet bestKernelInstructionSet();
+
+/**
+ * The result of expanding a paletted image to RGBA.
+ */
+struct PaletteExpansionResult
+{
+  /**
+   * The sums of the red, green and blue components of all expanded pixels.
+   */
+  std::array<uint64_t, 3> colorSum;
+
+  /**
+   * The bitwise AND of the alpha components of all expanded pixels.
+   */
+  unsigned char alphaAnd;
+};
+
+/**
+ * Expands `pixelCount` palette indices to RGBA pixels using the given palette. The
+ * palette must contain 256 RGBA entries, and `rgba` must have room for `pixelCount` * 4
+ * bytes.
+ *
+ * Pixels whose palette entry has an alpha value other than 0xFF (such as index 255 in a
+ * palette with a transparent index) can be detected by checking the alpha component of
+ * the result.
+ */
+PaletteExpansionResult expandPalette(
+  const unsigned char* indices,
+  size_t pixelCount,
+  const unsigned char* palette,
+  unsigned char* rgba);
+
+PaletteExpansionResult expandPalette(
+  const unsigned char* indices,
+  size_t pixelCount,
+  const unsigned char* palette,
+  unsigned char* rgba,
+  KernelInstructionSet instructionSet);
+
+/**
+ * Returns the sums of the red, green and blue components of `pixelCount` RGBA pixels.
+ */
+std::array<uint64_t, 3> sumColors(const unsigned char* rgba, size_t pixelCount);
+
+std::array<uint64_t, 3> sumColors(
+  const unsigned char* rgba, size_t pixelCount, KernelInstructionSet instructionSet);
+
+/**
+ * Downsamples the given RGBA image to half its size using a 2x2 box filter. The size of
+ * the result is given by `sizeAtMipLevel(width, height, 1)`, and `dst` must have room
+ * for the resulting pixels. If a dimension of the source image is 1, the corresponding
+ * source pixels are repeated.
+ *
+ * Each destination component is computed as the rounded average of the corresponding
+ * source components, i.e. (a + b + c + d + 2) / 4.
+ */
+void downsampleBox(
+  const unsigned char* src, size_t width, size_t height, unsigned char* dst);
+
+void downsampleBox(
+  const unsigned char* src,
+  size_t width,
+  size_t height,
+  unsigned char* dst,
+  KernelInstructionSet instructionSet);
+
+} // namespace TrenchBroom::Assets
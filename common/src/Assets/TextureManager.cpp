@@ -23,24 +23,28 @@
 #include "Assets/TextureCollection.h"
 #include "Exceptions.h"
 #include "IO/LoadTextureCollection.h"
+#include "IO/TextureCache.h"
+#include "IO/TextureUtils.h"
 #include "Logger.h"
 
 #include <kdl/map_utils.h>
+#include <kdl/parallel.h>
 #include <kdl/result.h>
 #include <kdl/string_format.h>
+#include <kdl/thread_pool.h>
 #include <kdl/vector_utils.h>
 
 #include <algorithm>
-#include <chrono>
 #include <iterator>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace TrenchBroom
 {
 namespace Assets
 {
-
 TextureManager::TextureManager(int magFilter, int minFilter, Logger& logger)
   : m_logger{logger}
   , m_minFilter{minFilter}
@@ -48,7 +52,15 @@ TextureManager::TextureManager(int magFilter, int minFilter, Logger& logger)
 {
 }
 
-TextureManager::~TextureManager() = default;
+TextureManager::~TextureManager()
+{
+  cancelReloads();
+}
+
+void TextureManager::setTextureCache(std::unique_ptr<IO::TextureCache> textureCache)
+{
+  m_textureCache = std::move(textureCache);
+}
 
 void TextureManager::reload(
   const IO::FileSystem& fs, const Model::TextureConfig& textureConfig)
@@ -56,6 +68,75 @@ void TextureManager::reload(
   setTextureCollections(findTextureCollections(fs, textureConfig), fs, textureConfig);
 }
 
+void TextureManager::reloadTextures(
+  const std::vector<std::filesystem::path>& paths,
+  const IO::FileSystem& fs,
+  const Model::TextureConfig& textureConfig)
+{
+  for (const auto& path : paths)
+  {
+    m_pendingTextures.push_back(
+      kdl::default_thread_pool().submit([this, path, &fs, &textureConfig]() {
+        auto result = ReloadedTexture{path, std::nullopt, {}};
+        if (!m_cancelled)
+        {
+          IO::loadTexture(path, fs, textureConfig)
+            .transform([&](auto texture) { result.texture = std::move(texture); })
+            .transform_error([&](auto e) {
+              result.logger.error()
+                << "Could not reload texture '" << e.textureName << "': " << e.msg;
+            });
+        }
+        return result;
+      }));
+  }
+}
+
+std::vector<Texture*> TextureManager::processReloadedTextures()
+{
+  auto result = std::vector<Texture*>{};
+
+  auto it = m_pendingTextures.begin();
+  while (it != m_pendingTextures.end())
+  {
+    if (it->ready())
+    {
+      auto reloadedTexture = it->get();
+      it = m_pendingTextures.erase(it);
+
+      reloadedTexture.logger.replay(m_logger);
+      if (reloadedTexture.texture)
+      {
+        if (
+          auto* texture =
+            replaceTexture(reloadedTexture.path, std::move(*reloadedTexture.texture)))
+        {
+          result.push_back(texture);
+        }
+      }
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  return result;
+}
+
+void TextureManager::cancelReloads()
+{
+  // the file system must not be used anymore after this function returns, so wait for
+  // the tasks that are already running to finish; the others return immediately
+  m_cancelled = true;
+  for (auto& future : m_pendingTextures)
+  {
+    kdl::default_thread_pool().wait(future);
+  }
+  m_pendingTextures.clear();
+  m_cancelled = false;
+}
+
 void TextureManager::setTextureCollections(std::vector<TextureCollection> collections)
 {
   for (auto& collection : collections)
@@ -73,6 +154,9 @@ void TextureManager::setTextureCollections(
   auto collections = std::move(m_collections);
   clear();
 
+  auto reusedCollections = std::vector<std::optional<TextureCollection>>{};
+  auto collectionsToLoad = std::vector<std::tuple<std::filesystem::path, bool>>{};
+
   for (const auto& path : paths)
   {
     const auto it =
@@ -82,26 +166,12 @@ void TextureManager::setTextureCollections(
 
     if (it == collections.end() || !it->loaded())
     {
-      IO::loadTextureCollection(path, fs, textureConfig, m_logger)
-        .or_else([&](const auto& error) {
-          if (it == collections.end())
-          {
-            m_logger.error() << "Could not load texture collection '" << path
-                             << "': " << error.msg;
-          }
-          return kdl::result<Assets::TextureCollection>{Assets::TextureCollection{path}};
-        })
-        .transform([&](auto collection) {
-          if (!collection.textures().empty())
-          {
-            m_logger.info() << "Loaded texture collection '" << path << "'";
-          }
-          addTextureCollection(std::move(collection));
-        });
+      reusedCollections.emplace_back(std::nullopt);
+      collectionsToLoad.emplace_back(path, it == collections.end());
     }
     else
     {
-      addTextureCollection(std::move(*it));
+      reusedCollections.emplace_back(std::move(*it));
     }
 
     if (it != collections.end())
@@ -110,6 +180,49 @@ void TextureManager::setTextureCollections(
     }
   }
 
+  // Load the missing collections in parallel, but log their messages and add them in
+  // the order of the given paths
+  auto loadedCollections = kdl::vec_parallel_transform(
+    std::move(collectionsToLoad), [&](const auto& pathAndIsNew) {
+      const auto& [path, isNew] = pathAndIsNew;
+
+      auto logger = RecordingLogger{};
+      auto collection =
+        IO::loadTextureCollection(path, fs, textureConfig, logger, m_textureCache.get())
+          .or_else([&](const auto& error) {
+            if (isNew)
+            {
+              logger.error() << "Could not load texture collection '" << path
+                             << "': " << error.msg;
+            }
+            return kdl::result<Assets::TextureCollection>{
+              Assets::TextureCollection{path}};
+          })
+          .value();
+
+      if (!collection.textures().empty())
+      {
+        logger.info() << "Loaded texture collection '" << path << "'";
+      }
+
+      return std::make_tuple(std::move(collection), std::move(logger));
+    });
+
+  auto loadedCollectionIt = loadedCollections.begin();
+  for (auto& reusedCollection : reusedCollections)
+  {
+    if (reusedCollection)
+    {
+      addTextureCollection(std::move(*reusedCollection));
+    }
+    else
+    {
+      auto& [collection, logger] = *loadedCollectionIt++;
+      logger.replay(m_logger);
+      addTextureCollection(std::move(collection));
+    }
+  }
+
   updateTextures();
   m_toRemove = kdl::vec_concat(std::move(m_toRemove), std::move(collections));
 }
@@ -129,11 +242,15 @@ void TextureManager::addTextureCollection(Assets::TextureCollection collection)
 
 void TextureManager::clear()
 {
+  cancelReloads();
+
   m_collections.clear();
 
   m_toPrepare.clear();
+  m_texturesToPrepare.clear();
   m_texturesByName.clear();
   m_textures.clear();
+  m_textureIndicesByPath.clear();
 
   // Remove logging because it might fail when the document is already destroyed.
 }
@@ -193,17 +310,55 @@ void TextureManager::prepare()
     collection.prepare(m_minFilter, m_magFilter);
   }
   m_toPrepare.clear();
+
+  for (const auto& [collectionIndex, textureIndex] : m_texturesToPrepare)
+  {
+    auto& collection = m_collections[collectionIndex];
+    collection.prepareTexture(textureIndex, m_minFilter, m_magFilter);
+  }
+  m_texturesToPrepare.clear();
+}
+
+Texture* TextureManager::replaceTexture(
+  const std::filesystem::path& path, Texture texture)
+{
+  const auto it = m_textureIndicesByPath.find(path);
+  if (it == m_textureIndicesByPath.end())
+  {
+    // the texture's collection was removed in the meantime
+    return nullptr;
+  }
+
+  const auto& indices = it->second;
+  const auto& [collectionIndex, textureIndex] = indices;
+  auto& collection = m_collections[collectionIndex];
+  collection.replaceTexture(textureIndex, std::move(texture));
+
+  if (collection.prepared() && !kdl::vec_contains(m_texturesToPrepare, indices))
+  {
+    m_texturesToPrepare.push_back(indices);
+  }
+
+  m_logger.info() << "Reloaded texture '" << path << "'";
+  return &collection.textures()[textureIndex];
 }
 
 void TextureManager::updateTextures()
 {
   m_texturesByName.clear();
   m_textures.clear();
+  m_textureIndicesByPath.clear();
 
-  for (auto& collection : m_collections)
+  for (size_t collectionIndex = 0; collectionIndex < m_collections.size();
+       ++collectionIndex)
   {
-    for (auto& texture : collection.textures())
+    auto& textures = m_collections[collectionIndex].textures();
+    for (size_t textureIndex = 0; textureIndex < textures.size(); ++textureIndex)
     {
+      auto& texture = textures[textureIndex];
+      m_textureIndicesByPath.emplace(
+        texture.relativePath(), std::make_tuple(collectionIndex, textureIndex));
+
       const auto key = kdl::str_to_lower(texture.name());
       texture.setOverridden(false);
 
@@ -20,19 +20,25 @@
 #pragma once
 
 #include "Assets/TextureCollection.h"
+#include "Logger.h"
 
+#include <kdl/thread_pool.h>
+
+#include <atomic>
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace TrenchBroom
 {
-class Logger;
-
 namespace IO
 {
 class FileSystem;
+class TextureCache;
 } // namespace IO
 
 namespace Model
@@ -48,16 +54,34 @@ class TextureCollection;
 class TextureManager
 {
 private:
+  struct ReloadedTexture
+  {
+    std::filesystem::path path;
+    std::optional<Texture> texture;
+    RecordingLogger logger;
+  };
+
   Logger& m_logger;
+  std::unique_ptr<IO::TextureCache> m_textureCache;
 
   std::vector<TextureCollection> m_collections;
 
   std::vector<size_t> m_toPrepare;
+  std::vector<std::tuple<size_t, size_t>> m_texturesToPrepare;
   std::vector<TextureCollection> m_toRemove;
 
+  std::vector<kdl::task_future<ReloadedTexture>> m_pendingTextures;
+  std::atomic<bool> m_cancelled{false};
+
   std::map<std::string, Texture*> m_texturesByName;
   std::vector<const Texture*> m_textures;
 
+  /**
+   * Maps the relative path of each texture to the index of its collection and its index
+   * within the collection.
+   */
+  std::map<std::filesystem::path, std::tuple<size_t, size_t>> m_textureIndicesByPath;
+
   int m_minFilter;
   int m_magFilter;
   bool m_resetTextureMode{false};
@@ -66,8 +90,39 @@ public:
   TextureManager(int magFilter, int minFilter, Logger& logger);
   ~TextureManager();
 
+  /**
+   * Sets the persistent cache of decoded textures to use when loading texture
+   * collections. Pass nullptr to disable the cache.
+   */
+  void setTextureCache(std::unique_ptr<IO::TextureCache> textureCache);
+
   void reload(const IO::FileSystem& fs, const Model::TextureConfig& textureConfig);
 
+  /**
+   * Reloads the textures at the given paths on the default thread pool, e.g. because
+   * their files have changed. The reloaded textures replace the current textures when
+   * `processReloadedTextures` is called.
+   *
+   * The given file system must not be changed until the textures have been processed or
+   * the reloads have been cancelled.
+   */
+  void reloadTextures(
+    const std::vector<std::filesystem::path>& paths,
+    const IO::FileSystem& fs,
+    const Model::TextureConfig& textureConfig);
+
+  /**
+   * Replaces the textures that have finished reloading and returns them. Pointers to the
+   * replaced textures remain valid, and the reloaded textures are prepared when
+   * `commitChanges` is called.
+   */
+  std::vector<Texture*> processReloadedTextures();
+
+  /**
+   * Cancels the pending texture reloads and waits for those that are already running.
+   */
+  void cancelReloads();
+
   // for testing
   void setTextureCollections(std::vector<TextureCollection> collections);
 
@@ -94,6 +149,7 @@ public:
 private:
   void resetTextureMode();
   void prepare();
+  Texture* replaceTexture(const std::filesystem::path& path, Texture texture);
 
   void updateTextures();
 };
@@ -37,6 +37,30 @@ namespace TrenchBroom
 {
 namespace EL
 {
+namespace
+{
+/**
+ * The context used to evaluate subexpressions when optimizing an expression. Any
+ * variable evaluates to undefined, and it is recorded whether a variable was read. A
+ * subexpression can only be replaced by its value if it doesn't read any variables, since
+ * some operators yield defined values for undefined operands, e.g. `a == 1`.
+ */
+class OptimizationContext : public EvaluationContext
+{
+private:
+  mutable bool m_variableRead = false;
+
+public:
+  Value variableValue(const std::string&) const override
+  {
+    m_variableRead = true;
+    return Value::Undefined;
+  }
+
+  bool variableRead() const { return m_variableRead; }
+};
+} // namespace
+
 ExpressionImpl::~ExpressionImpl() = default;
 
 size_t ExpressionImpl::precedence() const
@@ -196,10 +220,11 @@ std::unique_ptr<ExpressionImpl> ArrayExpression::optimize() const
   auto values = ArrayType{};
   values.reserve(m_elements.size());
 
-  const auto evaluationContext = EvaluationContext{};
+  const auto evaluationContext = OptimizationContext{};
   for (const auto& expression : optimizedExpressions)
   {
-    if (auto value = expression.evaluate(evaluationContext); value != Value::Undefined)
+    if (auto value = expression.evaluate(evaluationContext);
+        value != Value::Undefined && !evaluationContext.variableRead())
     {
       values.push_back(std::move(value));
     }
@@ -264,10 +289,11 @@ std::unique_ptr<ExpressionImpl> MapExpression::optimize() const
 
   auto values = MapType{};
 
-  const auto evaluationContext = EvaluationContext{};
+  const auto evaluationContext = OptimizationContext{};
   for (const auto& [key, expression] : optimizedExpressions)
   {
-    if (auto value = expression.evaluate(evaluationContext); value != Value::Undefined)
+    if (auto value = expression.evaluate(evaluationContext);
+        value != Value::Undefined && !evaluationContext.variableRead())
     {
       values.emplace(key, std::move(value));
     }
@@ -433,9 +459,11 @@ Value UnaryExpression::evaluate(const EvaluationContext& context) const
 std::unique_ptr<ExpressionImpl> UnaryExpression::optimize() const
 {
   auto optimizedOperand = m_operand.optimize();
+
+  const auto evaluationContext = OptimizationContext{};
   if (auto value = evaluateUnaryExpression(
-        m_operator, optimizedOperand.evaluate(EvaluationContext{}));
-      value != Value::Undefined)
+        m_operator, optimizedOperand.evaluate(evaluationContext));
+      value != Value::Undefined && !evaluationContext.variableRead())
   {
     return std::make_unique<LiteralExpression>(std::move(value));
   }
@@ -1122,7 +1150,7 @@ std::unique_ptr<ExpressionImpl> BinaryExpression::optimize() const
   auto optimizedLeftOperand = std::optional<Expression>{};
   auto optimizedRightOperand = std::optional<Expression>{};
 
-  const auto evaluationContext = EvaluationContext{};
+  const auto evaluationContext = OptimizationContext{};
 
   const auto evaluateLeftOperand = [&] {
     optimizedLeftOperand = m_leftOperand.optimize();
@@ -1136,7 +1164,7 @@ std::unique_ptr<ExpressionImpl> BinaryExpression::optimize() const
 
   if (auto value =
         evaluateBinaryExpression(m_operator, evaluateLeftOperand, evaluateRightOperand);
-      value != Value::Undefined)
+      value != Value::Undefined && !evaluationContext.variableRead())
   {
     return std::make_unique<LiteralExpression>(std::move(value));
   }
@@ -1294,7 +1322,7 @@ std::unique_ptr<ExpressionImpl> SubscriptExpression::optimize() const
   auto optimizedLeftOperand = m_leftOperand.optimize();
   auto optimizedRightOperand = m_rightOperand.optimize();
 
-  auto evaluationContext = EvaluationContext{};
+  const auto evaluationContext = OptimizationContext{};
   if (auto leftValue = optimizedLeftOperand.evaluate(evaluationContext);
       leftValue != Value::Undefined)
   {
@@ -1304,7 +1332,8 @@ std::unique_ptr<ExpressionImpl> SubscriptExpression::optimize() const
     if (auto rightValue = optimizedRightOperand.evaluate(stack);
         rightValue != Value::Undefined)
     {
-      if (auto value = leftValue[rightValue]; value != Value::Undefined)
+      if (auto value = leftValue[rightValue];
+          value != Value::Undefined && !evaluationContext.variableRead())
       {
         return std::make_unique<LiteralExpression>(std::move(value));
       }
@@ -1356,8 +1385,9 @@ std::unique_ptr<ExpressionImpl> SwitchExpression::optimize() const
 
   auto optimizedExpressions = kdl::vec_transform(
     m_cases, [](const auto& expression) { return expression.optimize(); });
-  if (auto firstValue = optimizedExpressions.front().evaluate(EvaluationContext{});
-      firstValue != Value::Undefined)
+  const auto evaluationContext = OptimizationContext{};
+  if (auto firstValue = optimizedExpressions.front().evaluate(evaluationContext);
+      firstValue != Value::Undefined && !evaluationContext.variableRead())
   {
     return std::make_unique<LiteralExpression>(std::move(firstValue));
   }
@@ -154,5 +154,51 @@ void NullVariableStore::declare(const std::string& /* name */, const Value& /* v
 {
 }
 void NullVariableStore::assign(const std::string& /* name */, const Value& /* value */) {}
+
+RecordingVariableStore::RecordingVariableStore(
+  const VariableStore& store, std::vector<std::pair<std::string, Value>>& variables)
+  : m_store{store}
+  , m_variables{variables}
+{
+}
+
+VariableStore* RecordingVariableStore::clone() const
+{
+  return new RecordingVariableStore{m_store, m_variables};
+}
+
+size_t RecordingVariableStore::size() const
+{
+  return m_store.size();
+}
+
+Value RecordingVariableStore::value(const std::string& name) const
+{
+  auto result = m_store.value(name);
+  if (std::none_of(m_variables.begin(), m_variables.end(), [&](const auto& variable) {
+        return variable.first == name;
+      }))
+  {
+    m_variables.emplace_back(name, result);
+  }
+  return result;
+}
+
+std::vector<std::string> RecordingVariableStore::names() const
+{
+  return m_store.names();
+}
+
+void RecordingVariableStore::declare(
+  const std::string& /* name */, const Value& /* value */)
+{
+  throw EvaluationError{"Cannot declare variables in a recording variable store"};
+}
+
+void RecordingVariableStore::assign(
+  const std::string& /* name */, const Value& /* value */)
+{
+  throw EvaluationError{"Cannot assign variables in a recording variable store"};
+}
 } // namespace EL
 } // namespace TrenchBroom
@@ -24,6 +24,7 @@
 #include <iosfwd>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom
@@ -84,5 +85,30 @@ public:
   void declare(const std::string& name, const Value& value) override;
   void assign(const std::string& name, const Value& value) override;
 };
+
+/**
+ * Wraps another variable store and records the names and values of all variables that are
+ * read from it, in the order in which they are first read. This can be used to determine
+ * whether the result of evaluating an expression can change if some variables change.
+ *
+ * Copies of this store created by `clone` record into the same vector.
+ */
+class RecordingVariableStore : public VariableStore
+{
+private:
+  const VariableStore& m_store;
+  std::vector<std::pair<std::string, Value>>& m_variables;
+
+public:
+  RecordingVariableStore(
+    const VariableStore& store, std::vector<std::pair<std::string, Value>>& variables);
+
+  VariableStore* clone() const override;
+  size_t size() const override;
+  Value value(const std::string& name) const override;
+  std::vector<std::string> names() const override;
+  void declare(const std::string& name, const Value& value) override;
+  void assign(const std::string& name, const Value& value) override;
+};
 } // namespace EL
 } // namespace TrenchBroom
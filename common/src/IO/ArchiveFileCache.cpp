@@ -0,0 +1,147 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ArchiveFileCache.h"
+
+#include "IO/File.h"
+
+#include <kdl/reflection_impl.h>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+
+kdl_reflect_impl(ArchiveFileCacheStats);
+
+const size_t ArchiveFileCache::DefaultCapacity = 64 * 1024 * 1024;
+
+ArchiveFileCache::ArchiveFileCache(const size_t capacity)
+  : m_capacity{capacity}
+{
+}
+
+ArchiveFileCache& ArchiveFileCache::sharedCache()
+{
+  static auto instance = ArchiveFileCache{};
+  return instance;
+}
+
+size_t ArchiveFileCache::createArchiveId()
+{
+  auto lock = std::lock_guard{m_mutex};
+  return m_nextArchiveId++;
+}
+
+std::shared_ptr<File> ArchiveFileCache::getOrLoad(
+  const size_t archiveId,
+  const size_t entryIndex,
+  const std::function<std::shared_ptr<File>()>& loadFile)
+{
+  const auto key = Key{archiveId, entryIndex};
+
+  {
+    auto lock = std::lock_guard{m_mutex};
+    if (const auto it = m_index.find(key); it != m_index.end())
+    {
+      // move the entry to the front of the list
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      ++m_stats.hits;
+      return it->second->file;
+    }
+    ++m_stats.misses;
+  }
+
+  auto file = loadFile();
+
+  auto lock = std::lock_guard{m_mutex};
+  if (const auto it = m_index.find(key); it != m_index.end())
+  {
+    // another thread has loaded the file in the meantime
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->file;
+  }
+
+  if (file->size() <= m_capacity)
+  {
+    m_entries.push_front(CacheEntry{key, file});
+    m_index.emplace(key, m_entries.begin());
+    ++m_stats.cachedFiles;
+    m_stats.cachedBytes += file->size();
+    evictToCapacity();
+  }
+
+  return file;
+}
+
+void ArchiveFileCache::evictArchive(const size_t archiveId)
+{
+  auto lock = std::lock_guard{m_mutex};
+
+  auto it = m_index.lower_bound(Key{archiveId, 0});
+  while (it != m_index.end() && std::get<0>(it->first) == archiveId)
+  {
+    const auto& file = *it->second->file;
+    --m_stats.cachedFiles;
+    m_stats.cachedBytes -= file.size();
+    m_entries.erase(it->second);
+    it = m_index.erase(it);
+  }
+}
+
+void ArchiveFileCache::clear()
+{
+  auto lock = std::lock_guard{m_mutex};
+  m_entries.clear();
+  m_index.clear();
+  m_stats = {0, 0, 0, 0};
+}
+
+size_t ArchiveFileCache::capacity() const
+{
+  auto lock = std::lock_guard{m_mutex};
+  return m_capacity;
+}
+
+void ArchiveFileCache::setCapacity(const size_t capacity)
+{
+  auto lock = std::lock_guard{m_mutex};
+  m_capacity = capacity;
+  evictToCapacity();
+}
+
+ArchiveFileCacheStats ArchiveFileCache::stats() const
+{
+  auto lock = std::lock_guard{m_mutex};
+  return m_stats;
+}
+
+void ArchiveFileCache::evictToCapacity()
+{
+  while (m_stats.cachedBytes > m_capacity)
+  {
+    const auto& entry = m_entries.back();
+    --m_stats.cachedFiles;
+    m_stats.cachedBytes -= entry.file->size();
+    m_index.erase(entry.key);
+    m_entries.pop_back();
+  }
+}
+} // namespace IO
+} // namespace TrenchBroom
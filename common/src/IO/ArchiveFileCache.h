@@ -0,0 +1,141 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <kdl/reflection_decl.h>
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+class File;
+
+struct ArchiveFileCacheStats
+{
+  size_t hits;
+  size_t misses;
+  size_t cachedFiles;
+  size_t cachedBytes;
+
+  kdl_reflect_decl(ArchiveFileCacheStats, hits, misses, cachedFiles, cachedBytes);
+};
+
+/**
+ * A size bounded cache for the decompressed contents of archive entries. The cache can be
+ * shared by several archives, and each archive is identified by a unique archive ID
+ * obtained from `createArchiveId`. The cached entries are identified by the archive ID
+ * and the index of the entry in its archive.
+ *
+ * If the total size of the cached files exceeds the capacity of the cache, the least
+ * recently used files are evicted. Evicted files stay valid for as long as they are
+ * referenced elsewhere.
+ *
+ * The cache is thread safe.
+ */
+class ArchiveFileCache
+{
+public:
+  static const size_t DefaultCapacity;
+
+private:
+  using Key = std::tuple<size_t, size_t>;
+
+  struct CacheEntry
+  {
+    Key key;
+    std::shared_ptr<File> file;
+  };
+
+  using CacheEntryList = std::list<CacheEntry>;
+
+  mutable std::mutex m_mutex;
+  size_t m_capacity;
+  size_t m_nextArchiveId = 0;
+  CacheEntryList m_entries;
+  std::map<Key, CacheEntryList::iterator> m_index;
+  ArchiveFileCacheStats m_stats = {0, 0, 0, 0};
+
+public:
+  /**
+   * Creates a cache with the given capacity in bytes.
+   */
+  explicit ArchiveFileCache(size_t capacity = DefaultCapacity);
+
+  /**
+   * Returns the cache that is shared by all archives that don't use their own cache.
+   */
+  static ArchiveFileCache& sharedCache();
+
+  /**
+   * Returns a new unique archive ID.
+   */
+  size_t createArchiveId();
+
+  /**
+   * Returns the cached file for the given archive entry. If the file is not cached, it is
+   * loaded by calling the given function and the result is added to the cache.
+   *
+   * The load function is called without holding the cache's lock, so it may be called
+   * concurrently for the same entry by different threads.
+   *
+   * @param archiveId the ID of the archive that contains the entry
+   * @param entryIndex the index of the entry in its archive
+   * @param loadFile loads the file if it is not cached
+   * @return the file
+   *
+   * @throw any exception thrown by loadFile
+   */
+  std::shared_ptr<File> getOrLoad(
+    size_t archiveId,
+    size_t entryIndex,
+    const std::function<std::shared_ptr<File>()>& loadFile);
+
+  /**
+   * Removes all cached files of the given archive.
+   */
+  void evictArchive(size_t archiveId);
+
+  /**
+   * Removes all cached files and resets the statistics.
+   */
+  void clear();
+
+  size_t capacity() const;
+
+  /**
+   * Sets the capacity of this cache in bytes and evicts files if necessary.
+   */
+  void setCapacity(size_t capacity);
+
+  ArchiveFileCacheStats stats() const;
+
+private:
+  void evictToCapacity();
+};
+} // namespace IO
+} // namespace TrenchBroom
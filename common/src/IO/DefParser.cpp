@@ -402,8 +402,7 @@ Assets::ModelDefinition DefParser::parseModelDefinition(ParserStatus& status)
     m_tokenizer.adoptState(parser.tokenizerState());
     expect(status, DefToken::CParenthesis, m_tokenizer.nextToken());
 
-    expression.optimize();
-    return Assets::ModelDefinition(expression);
+    return Assets::ModelDefinition(expression.optimize());
   }
   catch (const ParserException& e)
   {
@@ -418,13 +417,12 @@ Assets::ModelDefinition DefParser::parseModelDefinition(ParserStatus& status)
       m_tokenizer.adoptState(parser.tokenizerState());
       expect(status, DefToken::CParenthesis, m_tokenizer.nextToken());
 
-      expression.optimize();
       status.warn(
         line,
         column,
         "Legacy model expressions are deprecated, replace with '" + expression.asString()
           + "'");
-      return Assets::ModelDefinition(expression);
+      return Assets::ModelDefinition(expression.optimize());
     }
     catch (const ParserException&)
     {
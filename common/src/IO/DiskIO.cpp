@@ -27,6 +27,17 @@
 #include <kdl/string_compare.h>
 #include <kdl/string_format.h>
 
+#include <random>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace TrenchBroom::IO
 {
 namespace Disk
@@ -104,6 +115,70 @@ std::filesystem::path fixCase(const std::filesystem::path& path)
   }
 }
 
+void copyPermissionsAndOwner(
+  const std::filesystem::path& sourcePath, const std::filesystem::path& destPath)
+{
+  auto error = std::error_code{};
+  const auto status = std::filesystem::status(sourcePath, error);
+  if (error || !std::filesystem::exists(status))
+  {
+    return;
+  }
+
+  std::filesystem::permissions(destPath, status.permissions(), error);
+
+#ifndef _WIN32
+  struct stat sourceStat;
+  if (::stat(sourcePath.c_str(), &sourceStat) == 0)
+  {
+    if (::chown(destPath.c_str(), sourceStat.st_uid, sourceStat.st_gid) != 0)
+    {
+      // only privileged users can change the owner, but the group can be retained if
+      // the user is a member of it
+      [[maybe_unused]] const auto result =
+        ::chown(destPath.c_str(), static_cast<uid_t>(-1), sourceStat.st_gid);
+    }
+  }
+#endif
+}
+
+void syncFile(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+  const auto fd = ::_wopen(path.c_str(), _O_RDWR | _O_BINARY);
+  const auto synced = fd >= 0 && ::_commit(fd) == 0;
+  if (fd >= 0)
+  {
+    ::_close(fd);
+  }
+#else
+  const auto fd = ::open(path.c_str(), O_RDONLY);
+  const auto synced = fd >= 0 && ::fsync(fd) == 0;
+  if (fd >= 0)
+  {
+    ::close(fd);
+  }
+#endif
+
+  if (!synced)
+  {
+    throw FileSystemException{"Could not write file '" + path.string() + "'"};
+  }
+}
+
+void syncDirectory([[maybe_unused]] const std::filesystem::path& path)
+{
+#ifndef _WIN32
+  // make the rename durable; this is not supported by every file system, so failures
+  // are ignored
+  const auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd >= 0)
+  {
+    [[maybe_unused]] const auto result = ::fsync(fd);
+    ::close(fd);
+  }
+#endif
+}
 } // namespace
 
 bool isCaseSensitive()
@@ -151,9 +226,23 @@ std::shared_ptr<File> openFile(const std::filesystem::path& path)
     throw FileNotFoundException(fixedPath.string());
   }
 
+  // Loose files are not mapped into memory: they are the files that users edit and
+  // overwrite while the editor is running, and reading a mapped file that was truncated
+  // raises SIGBUS. A stdio file reports an error instead.
   return std::make_shared<CFile>(fixedPath);
 }
 
+std::shared_ptr<File> openMappedFile(const std::filesystem::path& path)
+{
+  const auto fixedPath = fixPath(path);
+  if (pathInfo(fixedPath) != PathInfo::File)
+  {
+    throw FileNotFoundException(fixedPath.string());
+  }
+
+  return openPhysicalFile(fixedPath);
+}
+
 bool createDirectory(const std::filesystem::path& path)
 {
   const auto fixedPath = fixPath(path);
@@ -245,6 +334,59 @@ void moveFile(
   }
 }
 
+std::filesystem::path makeTemporaryPath(const std::filesystem::path& path)
+{
+  static thread_local auto randomEngine = std::mt19937_64{std::random_device{}()};
+
+  auto result = std::filesystem::path{};
+  auto error = std::error_code{};
+  do
+  {
+    auto filename = path.filename();
+    filename += "." + std::to_string(randomEngine()) + ".tmp";
+    result = path.parent_path() / filename;
+  } while (std::filesystem::exists(result, error));
+
+  return result;
+}
+
+std::filesystem::path resolveSymbolicLinks(const std::filesystem::path& path)
+{
+  auto error = std::error_code{};
+  auto result = std::filesystem::weakly_canonical(path, error);
+  return error ? path : result;
+}
+
+void replaceFile(
+  const std::filesystem::path& temporaryPath, const std::filesystem::path& path)
+{
+  auto error = std::error_code{};
+  const auto linkCount = std::filesystem::hard_link_count(path, error);
+  if (!error && linkCount > 1)
+  {
+    // renaming would detach the path from the other links
+    std::filesystem::copy_file(
+      temporaryPath, path, std::filesystem::copy_options::overwrite_existing, error);
+    if (error)
+    {
+      throw FileSystemException(
+        "Could not copy file '" + temporaryPath.string() + "' to '" + path.string()
+        + "'");
+    }
+    syncFile(path);
+    deleteFile(temporaryPath);
+  }
+  else
+  {
+    // the data must be on the disk before the rename, otherwise a crash could leave an
+    // empty file in place of the old one
+    syncFile(temporaryPath);
+    copyPermissionsAndOwner(path, temporaryPath);
+    moveFile(temporaryPath, path);
+    syncDirectory(path.parent_path());
+  }
+}
+
 std::filesystem::path resolvePath(
   const std::vector<std::filesystem::path>& searchPaths,
   const std::filesystem::path& path)
@@ -48,6 +48,18 @@ std::vector<std::filesystem::path> directoryContents(const std::filesystem::path
 
 std::shared_ptr<File> openFile(const std::filesystem::path& path);
 
+/**
+ * Opens the file at the given path and maps it into memory if possible, falling back to
+ * reading it with stdio.
+ *
+ * Only use this for files that are read completely right after they were opened, such as
+ * a map file that is being loaded. The file must not be kept open, because reading a
+ * mapped file that was truncated on the disk crashes the application.
+ *
+ * @throw FileNotFoundException if the file does not exist
+ */
+std::shared_ptr<File> openMappedFile(const std::filesystem::path& path);
+
 template <typename Stream, typename F>
 auto withStream(
   const std::filesystem::path& path, const std::ios::openmode mode, const F& function)
@@ -103,6 +115,64 @@ void copyFile(
 void moveFile(
   const std::filesystem::path& sourcePath, const std::filesystem::path& destPath);
 
+/**
+ * Returns the path of a temporary file next to the given path. The file name is unique,
+ * so concurrent writes to the same path do not use the same temporary file.
+ */
+std::filesystem::path makeTemporaryPath(const std::filesystem::path& path);
+
+/**
+ * Returns the given path with all symbolic links resolved. Missing path components are
+ * kept as they are.
+ */
+std::filesystem::path resolveSymbolicLinks(const std::filesystem::path& path);
+
+/**
+ * Replaces the file at the given path with the given temporary file. The temporary file
+ * is flushed to the disk before it is renamed. The permissions and, if the user may
+ * change it, the owner of the replaced file are retained.
+ *
+ * If the file has other hard links, the temporary file is copied into it instead, so that
+ * the links keep referring to the same file. This is not atomic.
+ */
+void replaceFile(
+  const std::filesystem::path& temporaryPath, const std::filesystem::path& path);
+
+/**
+ * Writes to a temporary file next to the given path and replaces the file at the given
+ * path with it once the given function has returned. If anything fails, the file at the
+ * given path is left untouched, so it never contains partially written data.
+ *
+ * If the given path is a symbolic link, the file it refers to is replaced. If the file
+ * has other hard links, it is overwritten in place, which is not atomic: a failure while
+ * copying can leave it partially written.
+ */
+template <typename F>
+void withAtomicOutputStream(const std::filesystem::path& path, const F& function)
+{
+  const auto targetPath = resolveSymbolicLinks(path);
+  const auto temporaryPath = makeTemporaryPath(targetPath);
+  try
+  {
+    withOutputStream(temporaryPath, [&](auto& stream) {
+      function(stream);
+      stream.flush();
+      if (!stream)
+      {
+        throw FileSystemException{
+          "Could not write file '" + temporaryPath.string() + "'"};
+      }
+    });
+    replaceFile(temporaryPath, targetPath);
+  }
+  catch (...)
+  {
+    auto error = std::error_code{};
+    std::filesystem::remove(temporaryPath, error);
+    throw;
+  }
+}
+
 std::filesystem::path resolvePath(
   const std::vector<std::filesystem::path>& searchPaths,
   const std::filesystem::path& path);
@@ -183,8 +183,7 @@ Assets::ModelDefinition EntParser::parseModel(
   {
     ELParser parser(ELParser::Mode::Lenient, model);
     auto expression = parser.parse();
-    expression.optimize();
-    return Assets::ModelDefinition(expression);
+    return Assets::ModelDefinition(expression.optimize());
   }
   catch (const ParserException&)
   {
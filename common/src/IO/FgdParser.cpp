@@ -463,8 +463,7 @@ Assets::ModelDefinition FgdParser::parseModel(ParserStatus& status)
     m_tokenizer.adoptState(parser.tokenizerState());
     expect(status, FgdToken::CParenthesis, m_tokenizer.nextToken());
 
-    expression.optimize();
-    return Assets::ModelDefinition{expression};
+    return Assets::ModelDefinition{expression.optimize()};
   }
   catch (const ParserException& e)
   {
@@ -479,13 +478,12 @@ Assets::ModelDefinition FgdParser::parseModel(ParserStatus& status)
       m_tokenizer.adoptState(parser.tokenizerState());
       expect(status, FgdToken::CParenthesis, m_tokenizer.nextToken());
 
-      expression.optimize();
       status.warn(
         line,
         column,
         "Legacy model expressions are deprecated, replace with '" + expression.asString()
           + "'");
-      return Assets::ModelDefinition{expression};
+      return Assets::ModelDefinition{expression.optimize()};
     }
     catch (const ParserException&)
     {
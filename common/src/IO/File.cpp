@@ -22,6 +22,9 @@
 #include "Exceptions.h"
 #include "IO/PathQt.h"
 
+#include <QFile>
+
+#include <atomic>
 #include <cstdio> // for FILE
 
 namespace TrenchBroom
@@ -153,6 +156,104 @@ std::FILE* CFile::file() const
   return m_file.get();
 }
 
+MmapFile::MmapFile(std::filesystem::path path)
+  : File{std::move(path)}
+  , m_file{std::make_unique<QFile>(pathAsQString(this->path()))}
+  , m_begin{nullptr}
+  , m_size{0}
+{
+  if (!m_file->open(QIODevice::ReadOnly))
+  {
+    throw FileSystemException{"Cannot open file " + this->path().string()};
+  }
+
+  m_size = static_cast<size_t>(m_file->size());
+  if (m_size > 0)
+  {
+    const auto* data = m_file->map(0, m_file->size());
+    if (!data)
+    {
+      throw FileSystemException{"Cannot map file " + this->path().string()};
+    }
+    m_begin = reinterpret_cast<const char*>(data);
+  }
+}
+
+MmapFile::~MmapFile() = default;
+
+Reader MmapFile::reader() const
+{
+  checkNotTruncated();
+  return Reader::from(begin(), end());
+}
+
+size_t MmapFile::size() const
+{
+  return m_size;
+}
+
+void MmapFile::checkNotTruncated() const
+{
+  if (static_cast<size_t>(m_file->size()) < m_size)
+  {
+    throw FileSystemException{"File was truncated: " + path().string()};
+  }
+}
+
+const char* MmapFile::begin() const
+{
+  return m_begin;
+}
+
+const char* MmapFile::end() const
+{
+  return m_begin + m_size;
+}
+
+namespace
+{
+auto MemoryMappingEnabled = std::atomic<bool>{true};
+} // namespace
+
+bool memoryMappingEnabled()
+{
+  return MemoryMappingEnabled;
+}
+
+void setMemoryMappingEnabled(const bool enabled)
+{
+  MemoryMappingEnabled = enabled;
+}
+
+std::shared_ptr<File> openPhysicalFile(
+  const std::filesystem::path& path, const size_t minMappedSize)
+{
+  auto error = std::error_code{};
+  const auto size = std::filesystem::file_size(path, error);
+  if (!error && size < minMappedSize)
+  {
+    // small files are copied so that they can be changed on the disk while they are read
+    const auto file = CFile{path};
+    auto buffer = std::make_unique<char[]>(file.size());
+    file.reader().read(buffer.get(), file.size());
+    return std::make_shared<OwningBufferFile>(path, std::move(buffer), file.size());
+  }
+
+  if (memoryMappingEnabled() && !error && size > 0)
+  {
+    try
+    {
+      return std::make_shared<MmapFile>(path);
+    }
+    catch (const FileSystemException&)
+    {
+      // fall back to reading the file with stdio
+    }
+  }
+
+  return std::make_shared<CFile>(path);
+}
+
 FileView::FileView(
   std::filesystem::path path,
   std::shared_ptr<File> file,
@@ -165,6 +266,11 @@ FileView::FileView(
 {
 }
 
+const File& FileView::hostFile() const
+{
+  return *m_file;
+}
+
 Reader FileView::reader() const
 {
   return m_file->reader().subReaderFromBegin(m_offset, m_length);
@@ -25,6 +25,8 @@
 #include <filesystem>
 #include <memory>
 
+class QFile;
+
 namespace TrenchBroom
 {
 namespace IO
@@ -147,6 +149,84 @@ public:
   std::FILE* file() const;
 };
 
+/**
+ * A file that is backed by a physical file on the disk which is mapped into memory for
+ * reading. The file is opened and mapped in the constructor and unmapped and closed in
+ * the destructor.
+ *
+ * Readers of this file and of views of this file read directly from the mapped memory.
+ * Accessing mapped memory beyond the end of the file crashes the application, so
+ * creating a reader throws if the file was truncated on the disk since it was mapped.
+ */
+class MmapFile : public File
+{
+private:
+  std::unique_ptr<QFile> m_file;
+  const char* m_begin;
+  size_t m_size;
+
+public:
+  /**
+   * Creates a new file with the given path, opens the file for reading and maps it into
+   * memory.
+   *
+   * @param path the path of the file
+   *
+   * @throw FileSystemException if the file cannot be opened or mapped
+   */
+  explicit MmapFile(std::filesystem::path path);
+  ~MmapFile() override;
+
+  Reader reader() const override;
+  size_t size() const override;
+
+  /**
+   * Checks that the file on the disk is still large enough to back the mapped memory.
+   * This must be called before the mapped memory is accessed without a reader.
+   *
+   * @throw FileSystemException if the file was truncated
+   */
+  void checkNotTruncated() const;
+
+  /**
+   * Returns the beginning of the mapped memory.
+   */
+  const char* begin() const;
+
+  /**
+   * Returns the end of the mapped memory (position after the last byte).
+   */
+  const char* end() const;
+};
+
+/**
+ * Indicates whether openPhysicalFile maps files into memory. Memory mapping is enabled by
+ * default.
+ */
+bool memoryMappingEnabled();
+
+/**
+ * Enables or disables memory mapping in openPhysicalFile.
+ */
+void setMemoryMappingEnabled(bool enabled);
+
+/**
+ * Opens the physical file at the given path for reading.
+ *
+ * If the file is smaller than `minMappedSize` bytes, it is copied into memory and closed
+ * right away. Otherwise, if memory mapping is enabled, the file is mapped into memory.
+ * If memory mapping is disabled, the file is empty, or the file cannot be mapped, the
+ * file is read using a CFile.
+ *
+ * @param path the path of the file
+ * @param minMappedSize the minimum size of a file that is mapped into memory
+ * @return the opened file
+ *
+ * @throw FileSystemException if the file cannot be opened
+ */
+std::shared_ptr<File> openPhysicalFile(
+  const std::filesystem::path& path, size_t minMappedSize = 0);
+
 /**
  * A file that is backed by a portion of a physical file.
  */
@@ -169,6 +249,11 @@ public:
   explicit FileView(
     std::filesystem::path path, std::shared_ptr<File> file, size_t offset, size_t length);
 
+  /**
+   * Returns the host file that contains the data of this file.
+   */
+  const File& hostFile() const;
+
   Reader reader() const override;
   size_t size() const override;
 };
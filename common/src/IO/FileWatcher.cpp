@@ -0,0 +1,329 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FileWatcher.h"
+
+#include "Macros.h"
+
+#include <kdl/map_utils.h>
+#include <kdl/vector_utils.h>
+
+#include <system_error>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace TrenchBroom::IO
+{
+
+bool FileWatcher::FileStamp::operator==(const FileStamp& other) const
+{
+  return modificationTime == other.modificationTime && size == other.size;
+}
+
+bool FileWatcher::FileStamp::operator!=(const FileStamp& other) const
+{
+  return !(*this == other);
+}
+
+FileWatcher::FileWatcher(const Mode mode, const std::chrono::milliseconds pollInterval)
+  : m_pollInterval{pollInterval}
+{
+  if (mode == Mode::Native)
+  {
+    startNativeWatching();
+  }
+
+  m_thread = std::thread{[&]() {
+    if (m_inotifyFd != -1)
+    {
+      watchNatively();
+    }
+    else
+    {
+      pollFiles();
+    }
+  }};
+}
+
+FileWatcher::~FileWatcher()
+{
+  {
+    const auto lock = std::lock_guard{m_mutex};
+    m_stopped = true;
+  }
+  m_condition.notify_all();
+
+#ifdef __linux__
+  if (m_wakeUpFd != -1)
+  {
+    const auto value = uint64_t(1);
+    const auto written = ::write(m_wakeUpFd, &value, sizeof(value));
+    unused(written);
+  }
+#endif
+
+  m_thread.join();
+
+#ifdef __linux__
+  if (m_inotifyFd != -1)
+  {
+    ::close(m_inotifyFd);
+    ::close(m_wakeUpFd);
+  }
+#endif
+}
+
+FileWatcher::Mode FileWatcher::mode() const
+{
+  return m_inotifyFd != -1 ? Mode::Native : Mode::Polling;
+}
+
+void FileWatcher::setWatchedPaths(const std::vector<std::filesystem::path>& paths)
+{
+  const auto lock = std::lock_guard{m_mutex};
+
+  auto watchedFiles = WatchedFiles{};
+  for (const auto& path : paths)
+  {
+    if (watchedFiles.count(path) == 0)
+    {
+      const auto it = m_watchedFiles.find(path);
+      if (it != m_watchedFiles.end())
+      {
+        watchedFiles.emplace(path, it->second);
+      }
+      else
+      {
+        // the stamps of new files are taken immediately so that changes made before the
+        // next poll are not missed
+        watchedFiles.emplace(path, m_inotifyFd == -1 ? fileStamp(path) : std::nullopt);
+      }
+    }
+  }
+  m_watchedFiles = std::move(watchedFiles);
+
+  for (auto it = m_changedPaths.begin(); it != m_changedPaths.end();)
+  {
+    it = m_watchedFiles.count(*it) == 0 ? m_changedPaths.erase(it) : std::next(it);
+  }
+
+  updateDirectoryWatches();
+}
+
+void FileWatcher::addWatchedPaths(const std::vector<std::filesystem::path>& paths)
+{
+  const auto lock = std::lock_guard{m_mutex};
+
+  auto directories = std::set<std::filesystem::path>{};
+  for (const auto& path : paths)
+  {
+    if (m_watchedFiles.count(path) == 0)
+    {
+      m_watchedFiles.emplace(path, m_inotifyFd == -1 ? fileStamp(path) : std::nullopt);
+      directories.insert(path.parent_path());
+    }
+  }
+
+  addDirectoryWatches(directories);
+}
+
+std::vector<std::filesystem::path> FileWatcher::takeChangedPaths()
+{
+  const auto lock = std::lock_guard{m_mutex};
+
+  auto result =
+    std::vector<std::filesystem::path>{m_changedPaths.begin(), m_changedPaths.end()};
+  m_changedPaths.clear();
+  return result;
+}
+
+std::optional<FileWatcher::FileStamp> FileWatcher::fileStamp(
+  const std::filesystem::path& path)
+{
+  auto error = std::error_code{};
+  const auto modificationTime = std::filesystem::last_write_time(path, error);
+  if (error)
+  {
+    return std::nullopt;
+  }
+
+  const auto size = std::filesystem::file_size(path, error);
+  if (error)
+  {
+    return std::nullopt;
+  }
+
+  return FileStamp{modificationTime, size};
+}
+
+void FileWatcher::startNativeWatching()
+{
+#ifdef __linux__
+  m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotifyFd != -1)
+  {
+    m_wakeUpFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeUpFd == -1)
+    {
+      ::close(m_inotifyFd);
+      m_inotifyFd = -1;
+    }
+  }
+#endif
+}
+
+void FileWatcher::updateDirectoryWatches()
+{
+#ifdef __linux__
+  if (m_inotifyFd == -1)
+  {
+    return;
+  }
+
+  auto directories = std::set<std::filesystem::path>{};
+  for (const auto& [path, stamp] : m_watchedFiles)
+  {
+    directories.insert(path.parent_path());
+  }
+
+  for (auto it = m_directoryWatches.begin(); it != m_directoryWatches.end();)
+  {
+    const auto& [directory, watch] = *it;
+    if (directories.count(directory) == 0)
+    {
+      ::inotify_rm_watch(m_inotifyFd, watch);
+      m_watchedDirectories.erase(watch);
+      it = m_directoryWatches.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  addDirectoryWatches(directories);
+#endif
+}
+
+void FileWatcher::addDirectoryWatches(const std::set<std::filesystem::path>& directories)
+{
+#ifdef __linux__
+  if (m_inotifyFd == -1)
+  {
+    return;
+  }
+
+  // files are usually saved by writing them directly or by moving a temporary file over
+  // them, and both must be detected
+  const auto mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+  for (const auto& directory : directories)
+  {
+    if (m_directoryWatches.count(directory) == 0)
+    {
+      const auto watch = ::inotify_add_watch(m_inotifyFd, directory.c_str(), mask);
+      if (watch != -1)
+      {
+        m_directoryWatches.emplace(directory, watch);
+        m_watchedDirectories[watch] = directory;
+      }
+    }
+  }
+#else
+  unused(directories);
+#endif
+}
+
+void FileWatcher::watchNatively()
+{
+#ifdef __linux__
+  pollfd fds[] = {{m_inotifyFd, POLLIN, 0}, {m_wakeUpFd, POLLIN, 0}};
+  alignas(inotify_event) char buffer[4096];
+
+  while (true)
+  {
+    if (::poll(fds, 2, -1) == -1 && errno != EINTR)
+    {
+      return;
+    }
+
+    auto lock = std::unique_lock{m_mutex};
+    if (m_stopped)
+    {
+      return;
+    }
+
+    auto length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+    while (length > 0)
+    {
+      for (auto* cur = buffer; cur < buffer + length;)
+      {
+        const auto* event = reinterpret_cast<const inotify_event*>(cur);
+        if (event->len > 0)
+        {
+          const auto it = m_watchedDirectories.find(event->wd);
+          if (it != m_watchedDirectories.end())
+          {
+            auto path = it->second / event->name;
+            if (m_watchedFiles.count(path) > 0)
+            {
+              m_changedPaths.insert(std::move(path));
+            }
+          }
+        }
+        cur += sizeof(inotify_event) + event->len;
+      }
+      length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+    }
+  }
+#endif
+}
+
+void FileWatcher::pollFiles()
+{
+  auto lock = std::unique_lock{m_mutex};
+  while (!m_condition.wait_for(lock, m_pollInterval, [&]() { return m_stopped; }))
+  {
+    const auto paths = kdl::map_keys(m_watchedFiles);
+
+    // don't block the main thread while the file system is accessed
+    lock.unlock();
+    const auto stamps =
+      kdl::vec_transform(paths, [](const auto& path) { return fileStamp(path); });
+    lock.lock();
+
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+      const auto it = m_watchedFiles.find(paths[i]);
+      if (it != m_watchedFiles.end() && it->second != stamps[i])
+      {
+        it->second = stamps[i];
+        m_changedPaths.insert(paths[i]);
+      }
+    }
+  }
+}
+
+} // namespace TrenchBroom::IO
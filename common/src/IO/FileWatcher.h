@@ -0,0 +1,143 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace TrenchBroom::IO
+{
+
+/**
+ * Watches files on the disk and collects the paths of the files that were modified,
+ * replaced, created or removed.
+ *
+ * The files are watched on a background thread. On Linux, the parent directories of the
+ * watched files are monitored using inotify so that files which are replaced by renaming
+ * another file over them are detected, too. On other platforms, or if inotify is not
+ * available, the modification times and sizes of the watched files are polled.
+ *
+ * The collected changes are taken by calling `takeChangedPaths`, which is meant to be
+ * called periodically on the main thread.
+ */
+class FileWatcher
+{
+public:
+  enum class Mode
+  {
+    /** Use the native change notifications of the platform if available. */
+    Native,
+    /** Poll the watched files. */
+    Polling,
+  };
+
+private:
+  struct FileStamp
+  {
+    std::filesystem::file_time_type modificationTime;
+    std::uintmax_t size;
+
+    bool operator==(const FileStamp& other) const;
+    bool operator!=(const FileStamp& other) const;
+  };
+
+  using WatchedFiles = std::map<std::filesystem::path, std::optional<FileStamp>>;
+
+  std::chrono::milliseconds m_pollInterval;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stopped = false;
+
+  // the stamps are only used when polling
+  WatchedFiles m_watchedFiles;
+  std::set<std::filesystem::path> m_changedPaths;
+
+  // only valid if inotify is used
+  int m_inotifyFd = -1;
+#ifdef __linux__
+  int m_wakeUpFd = -1;
+  std::map<std::filesystem::path, int> m_directoryWatches;
+  std::map<int, std::filesystem::path> m_watchedDirectories;
+#endif
+
+  std::thread m_thread;
+
+public:
+  /**
+   * Creates a file watcher and starts its background thread.
+   *
+   * @param mode whether to use native change notifications or to poll the files
+   * @param pollInterval the interval at which the watched files are polled
+   */
+  explicit FileWatcher(
+    Mode mode = Mode::Native,
+    std::chrono::milliseconds pollInterval = std::chrono::milliseconds{1000});
+  ~FileWatcher();
+
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  /**
+   * Returns the mode that is actually used, which is Mode::Polling if native change
+   * notifications are not available.
+   */
+  Mode mode() const;
+
+  /**
+   * Replaces the set of watched files. The given paths should be absolute. A file that
+   * does not exist yet is reported once it is created, but if its parent directory does
+   * not exist either, it might not be watched at all.
+   *
+   * Collected changes of files that are no longer watched are discarded.
+   */
+  void setWatchedPaths(const std::vector<std::filesystem::path>& paths);
+
+  /**
+   * Adds the given paths to the set of watched files. Paths that are already watched are
+   * ignored.
+   */
+  void addWatchedPaths(const std::vector<std::filesystem::path>& paths);
+
+  /**
+   * Returns the paths of the watched files that changed since the last call and clears
+   * the collected changes. The returned paths are sorted and unique.
+   */
+  std::vector<std::filesystem::path> takeChangedPaths();
+
+private:
+  static std::optional<FileStamp> fileStamp(const std::filesystem::path& path);
+
+  void startNativeWatching();
+  void updateDirectoryWatches();
+  void addDirectoryWatches(const std::set<std::filesystem::path>& directories);
+  void watchNatively();
+  void pollFiles();
+};
+
+} // namespace TrenchBroom::IO
@@ -26,6 +26,7 @@
 
 #include <kdl/overload.h>
 #include <kdl/path_utils.h>
+#include <kdl/string_format.h>
 
 #include <cassert>
 #include <memory>
@@ -37,6 +38,12 @@ namespace IO
 
 namespace
 {
+/**
+ * Smaller archives are copied into memory. This avoids locking them on Windows and
+ * prevents crashes when they are overwritten while they are mapped.
+ */
+constexpr auto MinMappedArchiveSize = size_t(4) * 1024 * 1024;
+
 const std::filesystem::path& getName(const ImageEntry& entry)
 {
   return std::visit(
@@ -52,13 +59,25 @@ bool isDirectory(const ImageEntry& entry)
     entry);
 }
 
-template <typename I>
-auto findEntry(I begin, I end, const std::filesystem::path& name)
+std::string makeEntryKey(const std::filesystem::path& name)
+{
+  return kdl::str_to_lower(name.u8string());
+}
+
+template <typename D>
+auto* findEntry(D& directoryEntry, const std::filesystem::path& name)
+{
+  const auto indexIt = directoryEntry.entryIndices.find(makeEntryKey(name));
+  return indexIt != directoryEntry.entryIndices.end()
+           ? &directoryEntry.entries[indexIt->second]
+           : nullptr;
+}
+
+ImageEntry& addEntry(ImageDirectoryEntry& directoryEntry, ImageEntry entry)
 {
-  const auto nameLc = kdl::path_to_lower(name);
-  return std::find_if(begin, end, [&](const auto& entry) {
-    return kdl::path_to_lower(getName(entry)) == nameLc;
-  });
+  directoryEntry.entryIndices.emplace(
+    makeEntryKey(getName(entry)), directoryEntry.entries.size());
+  return directoryEntry.entries.emplace_back(std::move(entry));
 }
 
 template <typename F>
@@ -80,16 +99,16 @@ auto withEntry(
     kdl::overload(
       [&](const ImageDirectoryEntry& directoryEntry) {
         const auto name = kdl::path_front(searchPath);
-        const auto entryIt =
-          findEntry(directoryEntry.entries.begin(), directoryEntry.entries.end(), name);
-
-        return entryIt != directoryEntry.entries.end() ? withEntry(
-                 kdl::path_pop_front(searchPath),
-                 *entryIt,
-                 currentPath / name,
-                 f,
-                 defaultResult)
-                                                       : defaultResult;
+        if (const auto* entry = findEntry(directoryEntry, name))
+        {
+          return withEntry(
+            kdl::path_pop_front(searchPath),
+            *entry,
+            currentPath / name,
+            f,
+            defaultResult);
+        }
+        return defaultResult;
       },
       [&](const ImageFileEntry&) { return defaultResult; }),
     currentEntry);
@@ -112,12 +131,9 @@ void withEntry(
       kdl::overload(
         [&](const ImageDirectoryEntry& directoryEntry) {
           const auto name = kdl::path_front(searchPath);
-          const auto entryIt =
-            findEntry(directoryEntry.entries.begin(), directoryEntry.entries.end(), name);
-
-          if (entryIt != directoryEntry.entries.end())
+          if (const auto* entry = findEntry(directoryEntry, name))
           {
-            withEntry(kdl::path_pop_front(searchPath), *entryIt, currentPath / name, f);
+            withEntry(kdl::path_pop_front(searchPath), *entry, currentPath / name, f);
           }
         },
         [&](const ImageFileEntry&) {}),
@@ -144,8 +160,7 @@ ImageDirectoryEntry& findOrCreateDirectory(
   }
 
   auto name = kdl::path_front(path);
-  auto entryIt = findEntry(parent.entries.begin(), parent.entries.end(), name);
-  if (entryIt != parent.entries.end())
+  if (auto* entry = findEntry(parent, name))
   {
     return std::visit(
       kdl::overload(
@@ -153,25 +168,25 @@ ImageDirectoryEntry& findOrCreateDirectory(
           return findOrCreateDirectory(kdl::path_pop_front(path), directoryEntry);
         },
         [&](ImageFileEntry&) -> ImageDirectoryEntry& {
-          *entryIt = ImageDirectoryEntry{std::move(name), {}};
+          *entry = ImageDirectoryEntry{std::move(name), {}, {}};
           return findOrCreateDirectory(
-            kdl::path_pop_front(path), std::get<ImageDirectoryEntry>(*entryIt));
+            kdl::path_pop_front(path), std::get<ImageDirectoryEntry>(*entry));
         }),
-      *entryIt);
+      *entry);
   }
   else
   {
     return findOrCreateDirectory(
       kdl::path_pop_front(path),
       std::get<ImageDirectoryEntry>(
-        parent.entries.emplace_back(ImageDirectoryEntry{std::move(name), {}})));
+        addEntry(parent, ImageDirectoryEntry{std::move(name), {}, {}})));
   }
 }
 } // namespace
 
 ImageFileSystemBase::ImageFileSystemBase(std::filesystem::path path)
   : m_path{std::move(path)}
-  , m_root{ImageDirectoryEntry{{}, {}}}
+  , m_root{ImageDirectoryEntry{{}, {}, {}}}
 {
 }
 
@@ -179,7 +194,7 @@ ImageFileSystemBase::~ImageFileSystemBase() = default;
 
 void ImageFileSystemBase::reload()
 {
-  m_root = ImageDirectoryEntry{{}, {}};
+  m_root = ImageDirectoryEntry{{}, {}, {}};
   initialize();
 }
 
@@ -202,16 +217,13 @@ void ImageFileSystemBase::addFile(const std::filesystem::path& path, GetImageFil
     findOrCreateDirectory(path.parent_path(), std::get<ImageDirectoryEntry>(m_root));
 
   auto name = path.filename();
-  if (const auto entryIt =
-        findEntry(directoryEntry.entries.begin(), directoryEntry.entries.end(), name);
-      entryIt != directoryEntry.entries.end())
+  if (auto* entry = findEntry(directoryEntry, name))
   {
-    *entryIt = ImageFileEntry{std::move(name), std::move(getFile)};
+    *entry = ImageFileEntry{std::move(name), std::move(getFile)};
   }
   else
   {
-    directoryEntry.entries.emplace_back(
-      ImageFileEntry{std::move(name), std::move(getFile)});
+    addEntry(directoryEntry, ImageFileEntry{std::move(name), std::move(getFile)});
   }
 }
 
@@ -272,9 +284,20 @@ std::shared_ptr<File> ImageFileSystemBase::doOpenFile(
 
 ImageFileSystem::ImageFileSystem(std::filesystem::path path)
   : ImageFileSystemBase{std::move(path)}
-  , m_file{std::make_shared<CFile>(m_path)}
+  , m_file{openPhysicalFile(m_path, MinMappedArchiveSize)}
 {
   ensure(m_path.is_absolute(), "path must be absolute");
 }
+
+const std::filesystem::path& ImageFileSystem::archivePath() const
+{
+  return m_path;
+}
+
+void ImageFileSystem::reopen()
+{
+  m_file = openPhysicalFile(m_path, MinMappedArchiveSize);
+  reload();
+}
 } // namespace IO
 } // namespace TrenchBroom
@@ -27,13 +27,14 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <variant>
 
 namespace TrenchBroom
 {
 namespace IO
 {
-class CFile;
 class File;
 
 using GetImageFile = std::function<std::shared_ptr<File>()>;
@@ -51,6 +52,10 @@ struct ImageDirectoryEntry
 {
   std::filesystem::path name;
   std::vector<ImageEntry> entries;
+  /**
+   * Maps the lower case names of the entries to their indices in `entries`.
+   */
+  std::unordered_map<std::string, size_t> entryIndices;
 };
 
 class ImageFileSystemBase : public FileSystem
@@ -86,10 +91,24 @@ private:
 class ImageFileSystem : public ImageFileSystemBase
 {
 protected:
-  std::shared_ptr<CFile> m_file;
+  std::shared_ptr<File> m_file;
 
 protected:
   explicit ImageFileSystem(std::filesystem::path path);
+
+public:
+  /**
+   * Returns the path of the archive file on the disk.
+   */
+  const std::filesystem::path& archivePath() const;
+
+  /**
+   * Reopens the archive file and reloads this file system, e.g. because the archive file
+   * was changed on the disk. Files that were opened before remain valid.
+   *
+   * @throw FileSystemException if the archive file cannot be opened or read
+   */
+  void reopen();
 };
 } // namespace IO
 } // namespace TrenchBroom
@@ -23,6 +23,7 @@
 #include "Assets/TextureCollection.h"
 #include "Assets/TextureManager.h"
 #include "Ensure.h"
+#include "Exceptions.h"
 #include "IO/File.h"
 #include "IO/FileSystem.h"
 #include "IO/FileSystemUtils.h"
@@ -35,11 +36,13 @@
 #include "IO/ReadQuake3ShaderTexture.h"
 #include "IO/ReadWalTexture.h"
 #include "IO/ResourceUtils.h"
+#include "IO/TextureCache.h"
 #include "IO/TextureUtils.h"
 #include "Logger.h"
 #include "Model/GameConfig.h"
 
 #include <kdl/overload.h>
+#include <kdl/parallel.h>
 #include <kdl/path_utils.h>
 #include <kdl/reflection_impl.h>
 #include <kdl/result.h>
@@ -47,8 +50,16 @@
 #include <kdl/string_format.h>
 #include <kdl/vector_utils.h>
 
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <ostream>
 #include <string>
+#include <system_error>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom::IO
@@ -165,6 +176,90 @@ kdl::result<ReadTextureFunc, LoadTextureCollectionError> makeReadTextureFunc(
       });
 }
 
+uint64_t makePaletteCacheKey(
+  const FileSystem& gameFS, const Model::TextureConfig& textureConfig)
+{
+  try
+  {
+    if (!textureConfig.palette.empty())
+    {
+      const auto file = gameFS.openFile(textureConfig.palette);
+      return hashTextureCacheKey(
+        InitialTextureCacheKey, file->reader().buffer().stringView());
+    }
+  }
+  catch (const Exception&)
+  {
+    // the palette is missing, so textures that require it cannot be decoded anyway
+  }
+  return InitialTextureCacheKey;
+}
+
+bool needsUpdate(
+  const CachedTextures& cachedTextures,
+  const std::vector<std::tuple<uint64_t, size_t>>& cacheEntries)
+{
+  return cachedTextures.size() != cacheEntries.size()
+         || std::any_of(
+           cacheEntries.begin(), cacheEntries.end(), [&](const auto& cacheEntry) {
+             return !cachedTextures.contains(std::get<0>(cacheEntry));
+           });
+}
+
+std::filesystem::path sourceFilePath(
+  const File& file, const std::filesystem::path& absolutePath)
+{
+  // files in archives such as wads are views of the archive file
+  if (const auto* fileView = dynamic_cast<const FileView*>(&file))
+  {
+    return fileView->hostFile().path();
+  }
+  return absolutePath;
+}
+
+std::optional<std::filesystem::file_time_type> modificationTime(
+  const std::filesystem::path& sourceFilePath)
+{
+  if (!sourceFilePath.empty())
+  {
+    auto error = std::error_code{};
+    const auto result = std::filesystem::last_write_time(sourceFilePath, error);
+    if (!error)
+    {
+      return result;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<uint64_t> makeTextureCacheKey(
+  const File& file,
+  const std::filesystem::path& sourceFilePath,
+  const std::optional<std::filesystem::file_time_type>& modificationTime,
+  const uint64_t paletteKey)
+{
+  // Quake 3 shaders refer to other files, so they cannot be cached
+  if (file.path().extension().empty())
+  {
+    return std::nullopt;
+  }
+
+  const auto key = hashTextureCacheKey(paletteKey, file.path().generic_u8string());
+  if (modificationTime)
+  {
+    // Hashing the contents would read every texture file even if all textures are
+    // cached. Files in archives use the modification time of the archive.
+    return hashTextureCacheKey(
+      hashTextureCacheKey(
+        hashTextureCacheKey(key, sourceFilePath.generic_u8string()),
+        uint64_t(file.size())),
+      uint64_t(modificationTime->time_since_epoch().count()));
+  }
+
+  // the file is not stored on the disk, e.g. it was extracted from a zip archive
+  return hashTextureCacheKey(key, file.reader().buffer().stringView());
+}
+
 } // namespace
 
 kdl_reflect_impl(LoadTextureCollectionError);
@@ -182,7 +277,8 @@ kdl::result<Assets::TextureCollection, LoadTextureCollectionError> loadTextureCo
   const std::filesystem::path& path,
   const FileSystem& gameFS,
   const Model::TextureConfig& textureConfig,
-  Logger& logger)
+  Logger& logger,
+  const TextureCache* textureCache)
 {
   if (gameFS.pathInfo(path) != PathInfo::Directory)
   {
@@ -198,42 +294,176 @@ kdl::result<Assets::TextureCollection, LoadTextureCollectionError> loadTextureCo
                                    ? makeExtensionPathMatcher(textureConfig.extensions)
                                    : matchAnyPath;
         const auto texturePaths = gameFS.find(path, pathMatcher);
-        auto textures = std::vector<Assets::Texture>{};
-        textures.reserve(texturePaths.size());
 
-        for (const auto& texturePath : texturePaths)
+        try
         {
-          try
+          auto files = std::vector<std::shared_ptr<File>>{};
+          auto filePaths = std::vector<std::filesystem::path>{};
+          auto absoluteFilePaths = std::vector<std::filesystem::path>{};
+          files.reserve(texturePaths.size());
+          filePaths.reserve(texturePaths.size());
+          absoluteFilePaths.reserve(texturePaths.size());
+
+          for (const auto& texturePath : texturePaths)
           {
             auto file = gameFS.openFile(texturePath);
-
-            // Store the absolute path to the original file
-            // (may be used by .obj export)
             const auto name = file->path().stem().string();
-            if (shouldExclude(name, textureConfig.excludes))
+            if (!shouldExclude(name, textureConfig.excludes))
+            {
+              files.push_back(std::move(file));
+              filePaths.push_back(texturePath);
+              absoluteFilePaths.push_back(
+                safeMakeAbsolute(texturePath, [&](const auto& p) {
+                  return gameFS.makeAbsolute(p);
+                }).value_or(std::filesystem::path{}));
+            }
+          }
+
+          // all files in an archive share the archive's modification time
+          using ModificationTime = std::optional<std::filesystem::file_time_type>;
+          auto sourceFilePaths = std::vector<std::filesystem::path>{};
+          auto modificationTimes = std::vector<ModificationTime>{};
+          if (textureCache)
+          {
+            auto modificationTimesByPath =
+              std::map<std::filesystem::path, ModificationTime>{};
+            sourceFilePaths.reserve(files.size());
+            modificationTimes.reserve(files.size());
+            for (size_t i = 0; i < files.size(); ++i)
             {
-              continue;
+              auto sourcePath = sourceFilePath(*files[i], absoluteFilePaths[i]);
+              auto it = modificationTimesByPath.find(sourcePath);
+              if (it == modificationTimesByPath.end())
+              {
+                it = modificationTimesByPath
+                       .emplace(sourcePath, modificationTime(sourcePath))
+                       .first;
+              }
+              sourceFilePaths.push_back(std::move(sourcePath));
+              modificationTimes.push_back(it->second);
             }
+          }
+
+          // Archives report their root as their absolute path, so the relative path is
+          // needed to tell their collections apart
+          const auto collectionId = safeMakeAbsolute(path, [&](const auto& p) {
+                                      return gameFS.makeAbsolute(p);
+                                    }).value_or(std::filesystem::path{})
+                                    / path;
+          auto cachedTextures =
+            textureCache ? textureCache->load(collectionId) : CachedTextures{};
+          const auto paletteKey =
+            textureCache ? makePaletteCacheKey(gameFS, textureConfig) : uint64_t(0);
+
+          // Decode the textures in parallel, but handle errors and collect the textures
+          // on this thread so that the log messages and the texture order are stable
+          auto indices = std::vector<size_t>(files.size());
+          std::iota(indices.begin(), indices.end(), size_t(0));
+          auto results = kdl::vec_parallel_transform(
+            std::move(indices), [&](const size_t index) {
+              const auto& file = files[index];
+              const auto cacheKey =
+                textureCache
+                  ? makeTextureCacheKey(
+                    *file, sourceFilePaths[index], modificationTimes[index], paletteKey)
+                  : std::nullopt;
+              if (cacheKey)
+              {
+                if (auto texture = cachedTextures.readTexture(*cacheKey))
+                {
+                  return std::make_tuple(
+                    kdl::result<Assets::Texture, ReadTextureError>{std::move(*texture)},
+                    cacheKey);
+                }
+              }
+              return std::make_tuple(readTexture(*file), cacheKey);
+            });
 
-            readTexture(*file)
-              .or_else(makeReadTextureErrorHandler(gameFS, logger))
+          const auto handleReadTextureError = makeReadTextureErrorHandler(gameFS, logger);
+
+          auto textures = std::vector<Assets::Texture>{};
+          textures.reserve(results.size());
+
+          auto cacheEntries = std::vector<std::tuple<uint64_t, size_t>>{};
+
+          for (size_t i = 0; i < results.size(); ++i)
+          {
+            const auto& texturePath = filePaths[i];
+            auto& [result, cacheKey] = results[i];
+
+            // don't cache the default textures that replace unreadable textures
+            if (cacheKey && result.is_success())
+            {
+              cacheEntries.emplace_back(*cacheKey, textures.size());
+            }
+
+            std::move(result)
+              .or_else(handleReadTextureError)
               .transform([&](auto texture) {
-                texture.setAbsolutePath(safeMakeAbsolute(texturePath, [&](const auto& p) {
-                                          return gameFS.makeAbsolute(p);
-                                        }).value_or(std::filesystem::path{}));
+                // Store the absolute path to the original file
+                // (may be used by .obj export)
+                texture.setAbsolutePath(absoluteFilePaths[i]);
                 texture.setRelativePath(texturePath);
                 textures.push_back(std::move(texture));
               });
           }
-          catch (const std::exception& e)
+
+          if (textureCache && needsUpdate(cachedTextures, cacheEntries))
           {
-            return LoadTextureCollectionError{
-              "Could not load texture collection '" + path.string() + "': " + e.what()};
+            // unmap the cache file before it is replaced
+            cachedTextures = CachedTextures{};
+            try
+            {
+              textureCache->store(
+                collectionId,
+                kdl::vec_transform(cacheEntries, [&](const auto& cacheEntry) {
+                  const auto& [cacheKey, index] = cacheEntry;
+                  return std::make_tuple(cacheKey, &std::as_const(textures[index]));
+                }));
+            }
+            catch (const Exception& e)
+            {
+              logger.warn() << "Could not update texture cache for '" << path
+                            << "': " << e.what();
+            }
           }
+
+          return Assets::TextureCollection{path, std::move(textures)};
         }
+        catch (const std::exception& e)
+        {
+          return LoadTextureCollectionError{
+            "Could not load texture collection '" + path.string() + "': " + e.what()};
+        }
+      });
+}
 
-        return Assets::TextureCollection{path, std::move(textures)};
+kdl::result<Assets::Texture, ReadTextureError> loadTexture(
+  const std::filesystem::path& path,
+  const FileSystem& gameFS,
+  const Model::TextureConfig& textureConfig)
+{
+  try
+  {
+    const auto file = gameFS.openFile(path);
+    return makeReadTextureFunc(gameFS, textureConfig)
+      .or_else([&](auto e) {
+        return kdl::result<ReadTextureFunc, ReadTextureError>{
+          ReadTextureError{path.stem().string(), std::move(e.msg)}};
+      })
+      .and_then([&](const auto& readTexture) { return readTexture(*file); })
+      .transform([&](auto texture) {
+        texture.setAbsolutePath(safeMakeAbsolute(path, [&](const auto& p) {
+                                  return gameFS.makeAbsolute(p);
+                                }).value_or(std::filesystem::path{}));
+        texture.setRelativePath(path);
+        return texture;
       });
+  }
+  catch (const Exception& e)
+  {
+    return ReadTextureError{path.stem().string(), e.what()};
+  }
 }
 
 } // namespace TrenchBroom::IO
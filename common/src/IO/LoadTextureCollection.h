@@ -34,8 +34,9 @@ class Logger;
 
 namespace TrenchBroom::Assets
 {
+class Texture;
 class TextureCollection;
-}
+} // namespace TrenchBroom::Assets
 
 namespace TrenchBroom::Model
 {
@@ -45,6 +46,8 @@ struct TextureConfig;
 namespace TrenchBroom::IO
 {
 class FileSystem;
+class TextureCache;
+struct ReadTextureError;
 
 std::vector<std::filesystem::path> findTextureCollections(
   const FileSystem& gameFS, const Model::TextureConfig& textureConfig);
@@ -56,10 +59,28 @@ struct LoadTextureCollectionError
   kdl_reflect_decl(LoadTextureCollectionError, msg);
 };
 
+/**
+ * Loads the texture collection at the given path.
+ *
+ * If a texture cache is given, textures are read from the cache if possible, and the
+ * cache is updated if any texture was missing from it.
+ */
 kdl::result<Assets::TextureCollection, LoadTextureCollectionError> loadTextureCollection(
   const std::filesystem::path& path,
   const FileSystem& gameFS,
   const Model::TextureConfig& textureConfig,
-  Logger& logger);
+  Logger& logger,
+  const TextureCache* textureCache = nullptr);
+
+/**
+ * Loads the texture at the given path, e.g. to reload a texture whose file has changed.
+ *
+ * Unlike the textures of a collection, a texture that cannot be read is not replaced by a
+ * default texture, but an error is returned.
+ */
+kdl::result<Assets::Texture, ReadTextureError> loadTexture(
+  const std::filesystem::path& path,
+  const FileSystem& gameFS,
+  const Model::TextureConfig& textureConfig);
 
 } // namespace TrenchBroom::IO
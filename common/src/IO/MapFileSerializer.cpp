@@ -39,9 +39,9 @@
 
 #include <fmt/format.h>
 
-#include <iterator> // for std::ostreambuf_iterator
+#include <iterator> // for std::back_inserter, std::ostreambuf_iterator
 #include <memory>
-#include <sstream>
+#include <ostream>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -59,20 +59,20 @@ public:
   }
 
 private:
-  void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override
+  void doWriteBrushFace(std::string& str, const Model::BrushFace& face) const override
   {
-    writeFacePoints(stream, face);
-    writeTextureInfo(stream, face);
-    fmt::format_to(std::ostreambuf_iterator<char>(stream), "\n");
+    writeFacePoints(str, face);
+    writeTextureInfo(str, face);
+    fmt::format_to(std::back_inserter(str), "\n");
   }
 
 protected:
-  void writeFacePoints(std::ostream& stream, const Model::BrushFace& face) const
+  void writeFacePoints(std::string& str, const Model::BrushFace& face) const
   {
     const Model::BrushFace::Points& points = face.points();
 
     fmt::format_to(
-      std::ostreambuf_iterator<char>(stream),
+      std::back_inserter(str),
       "( {} {} {} ) ( {} {} {} ) ( {} {} {} )",
       points[0].x(),
       points[0].y(),
@@ -96,14 +96,14 @@ protected:
     return "\"" + kdl::str_escape(textureName, "\"") + "\"";
   }
 
-  void writeTextureInfo(std::ostream& stream, const Model::BrushFace& face) const
+  void writeTextureInfo(std::string& str, const Model::BrushFace& face) const
   {
     const std::string& textureName = face.attributes().textureName().empty()
                                        ? Model::BrushFaceAttributes::NoTextureName
                                        : face.attributes().textureName();
 
     fmt::format_to(
-      std::ostreambuf_iterator<char>(stream),
+      std::back_inserter(str),
       " {} {} {} {} {} {}",
       shouldQuoteTextureName(textureName) ? quoteTextureName(textureName) : textureName,
       face.attributes().xOffset(),
@@ -113,7 +113,7 @@ protected:
       face.attributes().yScale());
   }
 
-  void writeValveTextureInfo(std::ostream& stream, const Model::BrushFace& face) const
+  void writeValveTextureInfo(std::string& str, const Model::BrushFace& face) const
   {
     const std::string& textureName = face.attributes().textureName().empty()
                                        ? Model::BrushFaceAttributes::NoTextureName
@@ -122,7 +122,7 @@ protected:
     const vm::vec3 yAxis = face.textureYAxis();
 
     fmt::format_to(
-      std::ostreambuf_iterator<char>(stream),
+      std::back_inserter(str),
       " {} [ {} {} {} {} ] [ {} {} {} {} ] {} {} {}",
       shouldQuoteTextureName(textureName) ? quoteTextureName(textureName) : textureName,
 
@@ -151,24 +151,24 @@ public:
   }
 
 private:
-  void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override
+  void doWriteBrushFace(std::string& str, const Model::BrushFace& face) const override
   {
-    writeFacePoints(stream, face);
-    writeTextureInfo(stream, face);
+    writeFacePoints(str, face);
+    writeTextureInfo(str, face);
 
     if (face.attributes().hasSurfaceAttributes())
     {
-      writeSurfaceAttributes(stream, face);
+      writeSurfaceAttributes(str, face);
     }
 
-    fmt::format_to(std::ostreambuf_iterator<char>(stream), "\n");
+    fmt::format_to(std::back_inserter(str), "\n");
   }
 
 protected:
-  void writeSurfaceAttributes(std::ostream& stream, const Model::BrushFace& face) const
+  void writeSurfaceAttributes(std::string& str, const Model::BrushFace& face) const
   {
     fmt::format_to(
-      std::ostreambuf_iterator<char>(stream),
+      std::back_inserter(str),
       " {} {} {}",
       face.resolvedSurfaceContents(),
       face.resolvedSurfaceFlags(),
@@ -185,17 +185,17 @@ public:
   }
 
 private:
-  void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override
+  void doWriteBrushFace(std::string& str, const Model::BrushFace& face) const override
   {
-    writeFacePoints(stream, face);
-    writeValveTextureInfo(stream, face);
+    writeFacePoints(str, face);
+    writeValveTextureInfo(str, face);
 
     if (face.attributes().hasSurfaceAttributes())
     {
-      writeSurfaceAttributes(stream, face);
+      writeSurfaceAttributes(str, face);
     }
 
-    fmt::format_to(std::ostreambuf_iterator<char>(stream), "\n");
+    fmt::format_to(std::back_inserter(str), "\n");
   }
 };
 
@@ -212,28 +212,28 @@ public:
   }
 
 private:
-  void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override
+  void doWriteBrushFace(std::string& str, const Model::BrushFace& face) const override
   {
-    writeFacePoints(stream, face);
-    writeTextureInfo(stream, face);
+    writeFacePoints(str, face);
+    writeTextureInfo(str, face);
 
     if (face.attributes().hasSurfaceAttributes() || face.attributes().hasColor())
     {
-      writeSurfaceAttributes(stream, face);
+      writeSurfaceAttributes(str, face);
     }
     if (face.attributes().hasColor())
     {
-      writeSurfaceColor(stream, face);
+      writeSurfaceColor(str, face);
     }
 
-    fmt::format_to(std::ostreambuf_iterator<char>(stream), "\n");
+    fmt::format_to(std::back_inserter(str), "\n");
   }
 
 protected:
-  void writeSurfaceColor(std::ostream& stream, const Model::BrushFace& face) const
+  void writeSurfaceColor(std::string& str, const Model::BrushFace& face) const
   {
     fmt::format_to(
-      std::ostreambuf_iterator<char>(stream),
+      std::back_inserter(str),
       " {} {} {}",
       static_cast<int>(face.resolvedColor().r()),
       static_cast<int>(face.resolvedColor().g()),
@@ -250,12 +250,12 @@ public:
   }
 
 private:
-  void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override
+  void doWriteBrushFace(std::string& str, const Model::BrushFace& face) const override
   {
-    writeFacePoints(stream, face);
-    writeTextureInfo(stream, face);
+    writeFacePoints(str, face);
+    writeTextureInfo(str, face);
     fmt::format_to(
-      std::ostreambuf_iterator<char>(stream), " 0\n"); // extra value written here
+      std::back_inserter(str), " 0\n"); // extra value written here
   }
 };
 
@@ -268,15 +268,17 @@ public:
   }
 
 private:
-  void doWriteBrushFace(std::ostream& stream, const Model::BrushFace& face) const override
+  void doWriteBrushFace(std::string& str, const Model::BrushFace& face) const override
   {
-    writeFacePoints(stream, face);
-    writeValveTextureInfo(stream, face);
-    fmt::format_to(std::ostreambuf_iterator<char>(stream), "\n");
+    writeFacePoints(str, face);
+    writeValveTextureInfo(str, face);
+    fmt::format_to(std::back_inserter(str), "\n");
   }
 };
 
-std::unique_ptr<NodeSerializer> MapFileSerializer::create(
+namespace
+{
+std::unique_ptr<MapFileSerializer> createMapFileSerializer(
   const Model::MapFormat format, std::ostream& stream)
 {
   switch (format)
@@ -302,22 +304,54 @@ std::unique_ptr<NodeSerializer> MapFileSerializer::create(
     switchDefault();
   }
 }
+} // namespace
+
+std::unique_ptr<NodeSerializer> MapFileSerializer::create(
+  const Model::MapFormat format, std::ostream& stream)
+{
+  return createMapFileSerializer(format, stream);
+}
+
+std::unique_ptr<NodeSerializer> MapFileSerializer::create(
+  const Model::MapFormat format, std::ostream& stream, NodeSerializationCache& cache)
+{
+  auto serializer = createMapFileSerializer(format, stream);
+  serializer->m_format = format;
+  serializer->m_cache = &cache;
+  return serializer;
+}
 
 MapFileSerializer::MapFileSerializer(std::ostream& stream)
   : m_line(1)
   , m_stream(stream)
+  , m_format(Model::MapFormat::Unknown)
+  , m_cache(nullptr)
 {
 }
 
 void MapFileSerializer::doBeginFile(const std::vector<const Model::Node*>& rootNodes)
 {
-  ensure(m_nodeToPrecomputedString.empty(), "MapFileSerializer may not be reused");
+  ensure(m_nodeToSerializedNode.empty(), "MapFileSerializer may not be reused");
 
   // collect nodes
   std::vector<std::variant<const Model::BrushNode*, const Model::PatchNode*>>
     nodesToSerialize;
   nodesToSerialize.reserve(rootNodes.size());
 
+  auto cachedNodes = NodeSerializationCache::SerializedNodes{};
+  const auto collectNode = [&](const auto* node) {
+    if (m_cache)
+    {
+      if (auto serializedNode = m_cache->find(m_format, node->revision()))
+      {
+        m_nodeToSerializedNode.emplace(node, serializedNode);
+        cachedNodes.emplace(node->revision(), std::move(serializedNode));
+        return;
+      }
+    }
+    nodesToSerialize.push_back(node);
+  };
+
   Model::Node::visitAll(
     rootNodes,
     kdl::overload(
@@ -333,11 +367,11 @@ void MapFileSerializer::doBeginFile(const std::vector<const Model::Node*>& rootN
       [](auto&& thisLambda, const Model::EntityNode* entity) {
         entity->visitChildren(thisLambda);
       },
-      [&](const Model::BrushNode* brush) { nodesToSerialize.push_back(brush); },
-      [&](const Model::PatchNode* patchNode) { nodesToSerialize.push_back(patchNode); }));
+      [&](const Model::BrushNode* brush) { collectNode(brush); },
+      [&](const Model::PatchNode* patchNode) { collectNode(patchNode); }));
 
-  // serialize brushes to strings in parallel
-  using Entry = std::pair<const Model::Node*, PrecomputedString>;
+  // serialize the remaining brushes and patches to strings in parallel
+  using Entry = std::pair<const Model::Node*, std::shared_ptr<const SerializedNode>>;
   std::vector<Entry> result =
     kdl::vec_parallel_transform(std::move(nodesToSerialize), [&](const auto& node) {
       return std::visit(
@@ -354,7 +388,18 @@ void MapFileSerializer::doBeginFile(const std::vector<const Model::Node*>& rootN
   // move strings into a map
   for (auto& entry : result)
   {
-    m_nodeToPrecomputedString.insert(std::move(entry));
+    if (m_cache && !exporting())
+    {
+      cachedNodes.emplace(entry.first->revision(), entry.second);
+    }
+    m_nodeToSerializedNode.insert(std::move(entry));
+  }
+
+  // only retain the serializations of the nodes which are written now; an export may
+  // omit some layers, so it must not evict their serializations
+  if (m_cache && !exporting())
+  {
+    m_cache->replace(m_format, std::move(cachedNodes));
   }
 }
 
@@ -395,13 +440,12 @@ void MapFileSerializer::doBrush(const Model::BrushNode* brush)
   ++m_line;
 
   // write pre-serialized brush faces
-  auto it = m_nodeToPrecomputedString.find(brush);
+  auto it = m_nodeToSerializedNode.find(brush);
   ensure(
-    it != std::end(m_nodeToPrecomputedString),
+    it != std::end(m_nodeToSerializedNode),
     "attempted to serialize a brush which was not passed to doBeginFile");
-  const PrecomputedString& precomputedString = it->second;
-  m_stream << precomputedString.string;
-  m_line += precomputedString.lineCount;
+  const SerializedNode& serializedNode = *it->second;
+  writeSerializedNode(serializedNode);
 
   fmt::format_to(std::ostreambuf_iterator<char>(m_stream), "}}\n");
   ++m_line;
@@ -411,7 +455,9 @@ void MapFileSerializer::doBrush(const Model::BrushNode* brush)
 void MapFileSerializer::doBrushFace(const Model::BrushFace& face)
 {
   const size_t lines = 1u;
-  doWriteBrushFace(m_stream, face);
+  auto str = std::string{};
+  doWriteBrushFace(str, face);
+  m_stream << str;
   face.setFilePosition(m_line, lines);
   m_line += lines;
 }
@@ -423,17 +469,25 @@ void MapFileSerializer::doPatch(const Model::PatchNode* patchNode)
   m_startLineStack.push_back(m_line);
 
   // write pre-serialized patch
-  auto it = m_nodeToPrecomputedString.find(patchNode);
+  auto it = m_nodeToSerializedNode.find(patchNode);
   ensure(
-    it != std::end(m_nodeToPrecomputedString),
+    it != std::end(m_nodeToSerializedNode),
     "attempted to serialize a patch which was not passed to doBeginFile");
-  const PrecomputedString& precomputedString = it->second;
-  m_stream << precomputedString.string;
-  m_line += precomputedString.lineCount;
+  const SerializedNode& serializedNode = *it->second;
+  writeSerializedNode(serializedNode);
 
   setFilePosition(patchNode);
 }
 
+void MapFileSerializer::writeSerializedNode(const SerializedNode& serializedNode)
+{
+  // the serialization is shared with the cache, so it is written without copying it
+  m_stream.write(
+    serializedNode.string.data(),
+    static_cast<std::streamsize>(serializedNode.string.size()));
+  m_line += serializedNode.lineCount;
+}
+
 void MapFileSerializer::setFilePosition(const Model::Node* node)
 {
   const size_t start = startLine();
@@ -451,48 +505,49 @@ size_t MapFileSerializer::startLine()
 /**
  * Threadsafe
  */
-MapFileSerializer::PrecomputedString MapFileSerializer::writeBrushFaces(
+std::shared_ptr<const SerializedNode> MapFileSerializer::writeBrushFaces(
   const Model::Brush& brush) const
 {
-  std::stringstream stream;
+  std::string str;
   for (const Model::BrushFace& face : brush.faces())
   {
-    doWriteBrushFace(stream, face);
+    doWriteBrushFace(str, face);
   }
-  return PrecomputedString{stream.str(), brush.faces().size()};
+  return std::make_shared<SerializedNode>(
+    SerializedNode{std::move(str), brush.faces().size()});
 }
 
-MapFileSerializer::PrecomputedString MapFileSerializer::writePatch(
+std::shared_ptr<const SerializedNode> MapFileSerializer::writePatch(
   const Model::BezierPatch& patch) const
 {
   size_t lineCount = 0u;
-  std::stringstream stream;
+  std::string str;
 
-  fmt::format_to(std::ostreambuf_iterator<char>(stream), "{{\n");
+  fmt::format_to(std::back_inserter(str), "{{\n");
   ++lineCount;
-  fmt::format_to(std::ostreambuf_iterator<char>(stream), "patchDef2\n");
+  fmt::format_to(std::back_inserter(str), "patchDef2\n");
   ++lineCount;
-  fmt::format_to(std::ostreambuf_iterator<char>(stream), "{{\n");
+  fmt::format_to(std::back_inserter(str), "{{\n");
   ++lineCount;
-  fmt::format_to(std::ostreambuf_iterator<char>(stream), "{}\n", patch.textureName());
+  fmt::format_to(std::back_inserter(str), "{}\n", patch.textureName());
   ++lineCount;
   fmt::format_to(
-    std::ostreambuf_iterator<char>(stream),
+    std::back_inserter(str),
     "( {} {} 0 0 0 )\n",
     patch.pointRowCount(),
     patch.pointColumnCount());
   ++lineCount;
-  fmt::format_to(std::ostreambuf_iterator<char>(stream), "(\n");
+  fmt::format_to(std::back_inserter(str), "(\n");
   ++lineCount;
 
   for (size_t row = 0u; row < patch.pointRowCount(); ++row)
   {
-    fmt::format_to(std::ostreambuf_iterator<char>(stream), "( ");
+    fmt::format_to(std::back_inserter(str), "( ");
     for (size_t col = 0u; col < patch.pointColumnCount(); ++col)
     {
       const auto& p = patch.controlPoint(row, col);
       fmt::format_to(
-        std::ostreambuf_iterator<char>(stream),
+        std::back_inserter(str),
         "( {} {} {} {} {} ) ",
         p[0],
         p[1],
@@ -500,18 +555,18 @@ MapFileSerializer::PrecomputedString MapFileSerializer::writePatch(
         p[3],
         p[4]);
     }
-    fmt::format_to(std::ostreambuf_iterator<char>(stream), ")\n");
+    fmt::format_to(std::back_inserter(str), ")\n");
     ++lineCount;
   }
 
-  fmt::format_to(std::ostreambuf_iterator<char>(stream), ")\n");
+  fmt::format_to(std::back_inserter(str), ")\n");
   ++lineCount;
-  fmt::format_to(std::ostreambuf_iterator<char>(stream), "}}\n");
+  fmt::format_to(std::back_inserter(str), "}}\n");
   ++lineCount;
-  fmt::format_to(std::ostreambuf_iterator<char>(stream), "}}\n");
+  fmt::format_to(std::back_inserter(str), "}}\n");
   ++lineCount;
 
-  return PrecomputedString{stream.str(), lineCount};
+  return std::make_shared<SerializedNode>(SerializedNode{std::move(str), lineCount});
 }
 } // namespace IO
 } // namespace TrenchBroom
@@ -19,11 +19,14 @@
 
 #pragma once
 
+#include "IO/NodeSerializationCache.h"
 #include "IO/NodeSerializer.h"
 #include "Model/MapFormat.h"
 
 #include <iosfwd>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace TrenchBroom
@@ -49,17 +52,24 @@ private:
   size_t m_line;
   std::ostream& m_stream;
 
-  struct PrecomputedString
-  {
-    std::string string;
-    size_t lineCount;
-  };
-  std::unordered_map<const Model::Node*, PrecomputedString> m_nodeToPrecomputedString;
+  Model::MapFormat m_format;
+  NodeSerializationCache* m_cache;
+
+  std::unordered_map<const Model::Node*, std::shared_ptr<const SerializedNode>>
+    m_nodeToSerializedNode;
 
 public:
   static std::unique_ptr<NodeSerializer> create(
     Model::MapFormat format, std::ostream& stream);
 
+  /**
+   * Creates a serializer that reuses the serializations of unchanged brushes and patches
+   * from the given cache, and replaces the contents of the cache with the serializations
+   * of the brushes and patches passed to beginFile().
+   */
+  static std::unique_ptr<NodeSerializer> create(
+    Model::MapFormat format, std::ostream& stream, NodeSerializationCache& cache);
+
 protected:
   explicit MapFileSerializer(std::ostream& stream);
 
@@ -76,14 +86,14 @@ private:
   void doPatch(const Model::PatchNode* patchNode) override;
 
 private:
+  void writeSerializedNode(const SerializedNode& serializedNode);
   void setFilePosition(const Model::Node* node);
   size_t startLine();
 
 private: // threadsafe
-  virtual void doWriteBrushFace(
-    std::ostream& stream, const Model::BrushFace& face) const = 0;
-  PrecomputedString writeBrushFaces(const Model::Brush& brush) const;
-  PrecomputedString writePatch(const Model::BezierPatch& patch) const;
+  virtual void doWriteBrushFace(std::string& str, const Model::BrushFace& face) const = 0;
+  std::shared_ptr<const SerializedNode> writeBrushFaces(const Model::Brush& brush) const;
+  std::shared_ptr<const SerializedNode> writePatch(const Model::BezierPatch& patch) const;
 };
 } // namespace IO
 } // namespace TrenchBroom
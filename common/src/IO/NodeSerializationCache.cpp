@@ -0,0 +1,56 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NodeSerializationCache.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+std::shared_ptr<const SerializedNode> NodeSerializationCache::find(
+  const Model::MapFormat format, const size_t revision) const
+{
+  if (format != m_format)
+  {
+    return nullptr;
+  }
+
+  const auto it = m_serializedNodes.find(revision);
+  return it != m_serializedNodes.end() ? it->second : nullptr;
+}
+
+void NodeSerializationCache::replace(
+  const Model::MapFormat format, SerializedNodes serializedNodes)
+{
+  m_format = format;
+  m_serializedNodes = std::move(serializedNodes);
+}
+
+size_t NodeSerializationCache::size() const
+{
+  return m_serializedNodes.size();
+}
+
+void NodeSerializationCache::clear()
+{
+  m_format = Model::MapFormat::Unknown;
+  m_serializedNodes.clear();
+}
+} // namespace IO
+} // namespace TrenchBroom
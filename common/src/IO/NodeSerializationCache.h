@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Model/MapFormat.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace TrenchBroom
+{
+namespace IO
+{
+/**
+ * The serialization of a single brush or patch and the number of lines it spans.
+ */
+struct SerializedNode
+{
+  std::string string;
+  size_t lineCount;
+};
+
+/**
+ * Retains the serialized brushes and patches of a map between saves so that only the
+ * nodes that were changed since the last save must be serialized again.
+ *
+ * The serializations are identified by the revisions of their nodes. Since a node
+ * receives a new revision whenever it changes and revisions are never reused, a cached
+ * serialization can never become stale. The cache only retains the serializations which
+ * were used by the last save, so removed and changed nodes are evicted automatically.
+ * Exports read from the cache, but do not change it.
+ *
+ * All serializations in the cache were created for the same map format. Changing the
+ * format clears the cache.
+ */
+class NodeSerializationCache
+{
+public:
+  using SerializedNodes =
+    std::unordered_map<size_t, std::shared_ptr<const SerializedNode>>;
+
+private:
+  Model::MapFormat m_format = Model::MapFormat::Unknown;
+  SerializedNodes m_serializedNodes;
+
+public:
+  /**
+   * Returns the cached serialization of a node with the given revision, or null if there
+   * is no such serialization or if it was created for a different map format.
+   */
+  std::shared_ptr<const SerializedNode> find(
+    Model::MapFormat format, size_t revision) const;
+
+  /**
+   * Replaces the contents of this cache with the given serializations, which were created
+   * for the given map format.
+   */
+  void replace(Model::MapFormat format, SerializedNodes serializedNodes);
+
+  size_t size() const;
+  void clear();
+};
+} // namespace IO
+} // namespace TrenchBroom
@@ -90,6 +90,13 @@ NodeWriter::NodeWriter(const Model::WorldNode& world, std::ostream& stream)
 {
 }
 
+NodeWriter::NodeWriter(
+  const Model::WorldNode& world, std::ostream& stream, NodeSerializationCache& cache)
+  : m_world(world)
+  , m_serializer(MapFileSerializer::create(m_world.mapFormat(), stream, cache))
+{
+}
+
 NodeWriter::NodeWriter(
   const Model::WorldNode& world, std::unique_ptr<NodeSerializer> serializer)
   : m_world(world)
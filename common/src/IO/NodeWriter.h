@@ -38,6 +38,7 @@ class WorldNode;
 
 namespace IO
 {
+class NodeSerializationCache;
 class NodeSerializer;
 
 class NodeWriter
@@ -50,6 +51,8 @@ private:
 
 public:
   NodeWriter(const Model::WorldNode& world, std::ostream& stream);
+  NodeWriter(
+    const Model::WorldNode& world, std::ostream& stream, NodeSerializationCache& cache);
   NodeWriter(const Model::WorldNode& world, std::unique_ptr<NodeSerializer> serializer);
   ~NodeWriter();
 
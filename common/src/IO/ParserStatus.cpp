@@ -123,6 +123,18 @@ void ParserStatus::errorAndThrow(const std::string& str)
   throw ParserException(buildMessage(str));
 }
 
+void ParserStatus::logMessage(const LogLevel level, const std::string& message)
+{
+  if (m_prefix.empty())
+  {
+    doLog(level, message);
+  }
+  else
+  {
+    doLog(level, m_prefix + ": " + message);
+  }
+}
+
 void ParserStatus::log(
   const LogLevel level, const size_t line, const size_t column, const std::string& str)
 {
@@ -61,6 +61,13 @@ public:
   void error(const std::string& str);
   [[noreturn]] void errorAndThrow(const std::string& str);
 
+  /**
+   * Logs a message that was built by another parser status, e.g. one that recorded the
+   * messages of a parser running on a worker thread. Only the prefix of this parser
+   * status is added to the given message.
+   */
+  void logMessage(LogLevel level, const std::string& message);
+
 private:
   void log(LogLevel level, size_t line, size_t column, const std::string& str);
   std::string buildMessage(size_t line, size_t column, const std::string& str) const;
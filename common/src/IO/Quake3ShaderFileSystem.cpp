@@ -23,20 +23,52 @@
 #include "IO/File.h"
 #include "IO/PathInfo.h"
 #include "IO/Quake3ShaderParser.h"
+#include "IO/Reader.h"
 #include "IO/SimpleParserStatus.h"
 #include "Logger.h"
 
+#include <kdl/parallel.h>
 #include <kdl/path_utils.h>
 #include <kdl/vector_utils.h>
 
 #include <memory>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace TrenchBroom
 {
 namespace IO
 {
+namespace
+{
+struct PathHash
+{
+  size_t operator()(const std::filesystem::path& path) const
+  {
+    return std::filesystem::hash_value(path);
+  }
+};
+
+std::tuple<std::vector<Assets::Quake3Shader>, RecordingLogger> parseShaderFile(
+  const std::filesystem::path& path, const BufferedReader& reader)
+{
+  auto logger = RecordingLogger{};
+  try
+  {
+    auto parser = Quake3ShaderParser{reader.stringView()};
+    auto status = SimpleParserStatus{logger, path.string()};
+    return {parser.parse(status), std::move(logger)};
+  }
+  catch (const ParserException& e)
+  {
+    logger.warn() << "Skipping malformed shader file " << path << ": " << e.what();
+    return {std::vector<Assets::Quake3Shader>{}, std::move(logger)};
+  }
+}
+} // namespace
+
 Quake3ShaderFileSystem::Quake3ShaderFileSystem(
   const FileSystem& fs,
   std::filesystem::path shaderSearchPath,
@@ -65,21 +97,34 @@ std::vector<Assets::Quake3Shader> Quake3ShaderFileSystem::loadShaders() const
   {
     const auto paths =
       m_fs.find(m_shaderSearchPath, makeExtensionPathMatcher({".shader"}));
-    for (const auto& path : paths)
-    {
+
+    // Read the files on this thread, but parse them in parallel. The shaders and the log
+    // messages are collected in the order of the files so that if several files define
+    // the same shader, the last one still wins.
+    auto files = kdl::vec_transform(paths, [&](const auto& path) {
       const auto file = m_fs.openFile(path);
-      auto bufferedReader = file->reader().buffer();
+      return std::make_tuple(file->path(), file->reader().buffer());
+    });
 
-      try
-      {
-        auto parser = Quake3ShaderParser{bufferedReader.stringView()};
-        auto status = SimpleParserStatus{m_logger, file->path().string()};
-        result = kdl::vec_concat(std::move(result), parser.parse(status));
-      }
-      catch (const ParserException& e)
-      {
-        m_logger.warn() << "Skipping malformed shader file " << path << ": " << e.what();
-      }
+    auto parsedFiles = kdl::vec_parallel_transform(std::move(files), [](auto file) {
+      const auto& [path, reader] = file;
+      return parseShaderFile(path, reader);
+    });
+
+    auto shaderCount = size_t(0);
+    for (const auto& [shaders, logger] : parsedFiles)
+    {
+      shaderCount += shaders.size();
+    }
+
+    result.reserve(shaderCount);
+    for (auto& [shaders, logger] : parsedFiles)
+    {
+      logger.replay(m_logger);
+      result.insert(
+        result.end(),
+        std::make_move_iterator(shaders.begin()),
+        std::make_move_iterator(shaders.end()));
     }
   }
 
@@ -112,6 +157,14 @@ void Quake3ShaderFileSystem::linkTextures(
   std::vector<Assets::Quake3Shader>& shaders)
 {
   m_logger.debug() << "Linking textures...";
+
+  // If several shaders have the same path, the last one wins.
+  auto shaderIndices = std::unordered_map<std::filesystem::path, size_t, PathHash>{};
+  for (size_t i = 0; i < shaders.size(); ++i)
+  {
+    shaderIndices[shaders[i].shaderPath] = i;
+  }
+
   for (const auto& texture : textures)
   {
     const auto shaderPath = kdl::path_remove_extension(texture);
@@ -119,15 +172,11 @@ void Quake3ShaderFileSystem::linkTextures(
     // Only link a shader if it has not been linked yet.
     if (pathInfo(shaderPath) != PathInfo::File)
     {
-      const auto shaderIt =
-        std::find_if(shaders.begin(), shaders.end(), [&shaderPath](const auto& shader) {
-          return shaderPath == shader.shaderPath;
-        });
-
-      if (shaderIt != std::end(shaders))
+      if (const auto indexIt = shaderIndices.find(shaderPath);
+          indexIt != shaderIndices.end())
       {
         // Found a matching shader.
-        auto& shader = *shaderIt;
+        const auto& shader = shaders[indexIt->second];
 
         auto shaderFile =
           std::make_shared<ObjectFile<Assets::Quake3Shader>>(shaderPath, shader);
@@ -135,7 +184,7 @@ void Quake3ShaderFileSystem::linkTextures(
           shaderPath, [shaderFile = std::move(shaderFile)]() { return shaderFile; });
 
         // Remove the shader so that we don't revisit it when linking standalone shaders.
-        shaders.erase(shaderIt);
+        shaderIndices.erase(indexIt);
       }
       else
       {
@@ -149,6 +198,10 @@ void Quake3ShaderFileSystem::linkTextures(
       }
     }
   }
+
+  shaders = kdl::vec_erase_if(std::move(shaders), [&](const auto& shader) {
+    return shaderIndices.count(shader.shaderPath) == 0;
+  });
 }
 
 void Quake3ShaderFileSystem::linkStandaloneShaders(
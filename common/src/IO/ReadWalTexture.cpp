@@ -20,6 +20,7 @@
 #include "ReadWalTexture.h"
 
 #include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
 #include "Ensure.h"
 #include "IO/Reader.h"
 #include "IO/ReaderException.h"
@@ -69,7 +70,7 @@ std::tuple<Assets::TextureBufferList, bool> readMips(
   Color& averageColor,
   const Assets::PaletteTransparency transparency)
 {
-  static auto tempColor = Color{};
+  auto tempColor = Color{};
 
   auto buffers = Assets::TextureBufferList{};
   Assets::setMipBufferSize(buffers, mipLevels, width, height, GL_RGBA);
@@ -85,7 +86,12 @@ std::tuple<Assets::TextureBufferList, bool> readMips(
 
     if (!reader.canRead(size))
     {
-      // This can happen if the .wal file is corrupt.
+      // This can happen if the .wal file is corrupt. Compute the missing mip levels from
+      // the ones we could read.
+      if (i > 0)
+      {
+        Assets::generateMips(buffers, width, height, i);
+      }
       break;
     }
 
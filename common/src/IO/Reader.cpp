@@ -23,6 +23,7 @@
 
 #include <cassert>
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
 #include <functional>
 #include <string>
@@ -175,10 +176,47 @@ public:
   }
 };
 
+namespace
+{
+/**
+ * Locks a C file for the lifetime of this object so that seeking and reading is not
+ * interleaved with other threads that access the same file.
+ */
+class FileLock
+{
+private:
+  std::FILE* m_file;
+
+public:
+  explicit FileLock(std::FILE* file)
+    : m_file{file}
+  {
+#ifdef _WIN32
+    _lock_file(m_file);
+#else
+    flockfile(m_file);
+#endif
+  }
+
+  ~FileLock()
+  {
+#ifdef _WIN32
+    _unlock_file(m_file);
+#else
+    funlockfile(m_file);
+#endif
+  }
+
+  FileLock(const FileLock&) = delete;
+  FileLock& operator=(const FileLock&) = delete;
+};
+} // namespace
+
 /**
  * A reader source that reads directly from a file. Note that the seek position of the
  * underlying C file is kept in sync with this file source's position automatically,
  * that is, two readers can read from the same underlying file without causing problems.
+ * Every read locks the file, so readers on different threads may share a file, too.
  */
 class FileReaderSource : public ReaderSource
 {
@@ -202,6 +240,7 @@ public:
     , m_length{length}
   {
     assert(m_file != nullptr);
+    const auto lock = FileLock{m_file};
     std::rewind(m_file);
   }
 
@@ -210,6 +249,7 @@ public:
 
   void read(char* val, const size_t position, const size_t size) override
   {
+    const auto lock = FileLock{m_file};
     const auto pos = std::ftell(m_file);
     if (pos < 0)
     {
@@ -236,6 +276,7 @@ public:
 
   std::shared_ptr<BufferReaderSource> buffer() const override
   {
+    const auto lock = FileLock{m_file};
     std::fseek(m_file, long(m_offset), SEEK_SET);
 
 #if defined __APPLE__
@@ -335,6 +376,13 @@ void Reader::seekBackward(const size_t offset)
 Reader Reader::subReaderFromBegin(const size_t position, const size_t length) const
 {
   ensurePosition(position);
+  if (length > size() - position)
+  {
+    throw ReaderException{
+      "Sub region of length " + std::to_string(length) + " at position "
+      + std::to_string(position) + " is out of bounds for reader of size "
+      + std::to_string(size())};
+  }
   return Reader{m_source->subSource(position, length)};
 }
 
@@ -53,7 +53,7 @@ Assets::Texture loadDefaultTexture(
   const FileSystem& fs, const std::string& name, Logger& logger)
 {
   // recursion guard
-  static auto executing = false;
+  static thread_local auto executing = false;
   if (!executing)
   {
     const auto set_executing = kdl::set_temp{executing};
@@ -20,16 +20,24 @@
 #include "StandardMapParser.h"
 
 #include "IO/ParserStatus.h"
+#include "Logger.h"
 #include "Model/BrushFace.h"
+#include "Model/BrushFaceAttributes.h"
 #include "Model/EntityProperties.h"
 
 #include <kdl/invoke.h>
+#include <kdl/overload.h>
+#include <kdl/parallel.h>
+#include <kdl/thread_pool.h>
 #include <kdl/vector_set.h>
 
 #include <vecmath/plane.h>
 #include <vecmath/vec.h>
 
+#include <algorithm>
+#include <optional>
 #include <string>
+#include <variant>
 #include <vector>
 
 namespace TrenchBroom
@@ -42,8 +50,9 @@ const std::string& QuakeMapTokenizer::NumberDelim()
   return numberDelim;
 }
 
-QuakeMapTokenizer::QuakeMapTokenizer(std::string_view str)
-  : Tokenizer(std::move(str), "\"", '\\')
+QuakeMapTokenizer::QuakeMapTokenizer(
+  std::string_view str, const size_t line, const size_t column)
+  : Tokenizer(std::move(str), "\"", '\\', line, column)
   , m_skipEol(true)
 {
 }
@@ -154,6 +163,457 @@ QuakeMapTokenizer::Token QuakeMapTokenizer::emitToken()
   return Token(QuakeMapToken::Eof, nullptr, nullptr, length(), line(), column());
 }
 
+namespace
+{
+/**
+ * A range of the input that contains a sequence of brushes or patches of a single entity,
+ * possibly separated by comments. The chunk begins at the opening brace of its first
+ * brush and ends after the closing brace of its last brush.
+ */
+struct MapChunk
+{
+  const char* begin;
+  const char* end;
+  size_t line;
+  size_t column;
+  size_t endLine;
+  size_t endColumn;
+};
+
+/**
+ * Finds chunks of brushes in the given input by counting braces while skipping comments
+ * and quoted strings in the same way as QuakeMapTokenizer. Line and column numbers are
+ * tracked exactly like the tokenizer does.
+ *
+ * The returned chunks are candidates only: since the tokenizer's behavior depends on the
+ * parser state (e.g. texture names may begin with a brace), a chunk may not contain a
+ * valid sequence of brushes. Such chunks are detected when they are parsed.
+ */
+std::vector<MapChunk> findMapChunks(
+  const char* begin,
+  const char* end,
+  const size_t line,
+  const size_t column,
+  const size_t chunkSize)
+{
+  auto result = std::vector<MapChunk>{};
+
+  auto state = TokenizerState{begin, line, column, false};
+  const auto advance = [&]() {
+    switch (*state.cur)
+    {
+    case '\r':
+      if (state.cur + 1 < end && *(state.cur + 1) == '\n')
+      {
+        ++state.column;
+        break;
+      }
+      switchFallthrough();
+    case '\n':
+      ++state.line;
+      state.column = 1;
+      state.escaped = false;
+      break;
+    default:
+      ++state.column;
+      state.escaped = *state.cur == '\\' ? !state.escaped : false;
+      break;
+    }
+    ++state.cur;
+  };
+
+  const auto discardUntilEol = [&]() {
+    while (state.cur < end && *state.cur != '\n' && *state.cur != '\r')
+    {
+      advance();
+    }
+  };
+
+  const auto isWhitespace = [](const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+  };
+
+  auto depth = size_t(0);
+  auto afterCParenthesis = false;
+  auto chunk = std::optional<MapChunk>{};
+  auto brushStart = TokenizerState{};
+
+  // whether the current chunk can be extended by the next brush of the same entity
+  auto canExtendChunk = false;
+
+  const auto closeChunk = [&]() {
+    if (chunk)
+    {
+      result.push_back(*chunk);
+      chunk = std::nullopt;
+    }
+    canExtendChunk = false;
+  };
+
+  while (state.cur < end)
+  {
+    const auto c = *state.cur;
+    switch (c)
+    {
+    case '/':
+      advance();
+      if (state.cur < end && *state.cur == '/')
+      {
+        advance();
+        if (
+          state.cur < end && *state.cur == '/' && state.cur + 1 < end
+          && *(state.cur + 1) == ' ')
+        {
+          // comment token, the remainder of the line is tokenized normally
+          advance();
+          afterCParenthesis = false;
+          break;
+        }
+        discardUntilEol();
+      }
+      break;
+    case ';':
+      advance();
+      discardUntilEol();
+      break;
+    case '{':
+      if (depth >= 2 && afterCParenthesis)
+      {
+        // this is most likely a texture name such as {fence, read it as a word
+        while (state.cur < end && !isWhitespace(*state.cur))
+        {
+          advance();
+        }
+        afterCParenthesis = false;
+        break;
+      }
+      if (depth == 1)
+      {
+        brushStart = state;
+      }
+      ++depth;
+      advance();
+      afterCParenthesis = false;
+      break;
+    case '}':
+      advance();
+      afterCParenthesis = false;
+      if (depth == 0)
+      {
+        break;
+      }
+      --depth;
+      if (depth == 1)
+      {
+        // a brush or patch ends here
+        if (
+          !canExtendChunk || !chunk
+          || static_cast<size_t>(chunk->end - chunk->begin) >= chunkSize)
+        {
+          closeChunk();
+          chunk = MapChunk{
+            brushStart.cur,
+            state.cur,
+            brushStart.line,
+            brushStart.column,
+            state.line,
+            state.column};
+        }
+        else
+        {
+          chunk->end = state.cur;
+          chunk->endLine = state.line;
+          chunk->endColumn = state.column;
+        }
+        canExtendChunk = true;
+      }
+      else if (depth == 0)
+      {
+        // an entity ends here
+        closeChunk();
+      }
+      break;
+    case '(':
+    case '[':
+    case ']':
+      advance();
+      afterCParenthesis = false;
+      break;
+    case ')':
+      advance();
+      afterCParenthesis = true;
+      break;
+    case '"': {
+      advance();
+      while (state.cur < end
+             && (*state.cur != '"' || (state.escaped && *state.cur == '"')))
+      {
+        if (
+          *state.cur == '"' && state.escaped && state.cur + 1 < end
+          && (*(state.cur + 1) == '\n' || *(state.cur + 1) == '}'))
+        {
+          state.escaped = false;
+          break;
+        }
+        advance();
+      }
+      if (state.cur < end)
+      {
+        advance();
+      }
+      afterCParenthesis = false;
+      if (depth == 1)
+      {
+        // an entity property separates the brushes before and after it
+        canExtendChunk = false;
+      }
+      break;
+    }
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      advance();
+      break;
+    default:
+      while (state.cur < end && !isWhitespace(*state.cur))
+      {
+        advance();
+      }
+      afterCParenthesis = *(state.cur - 1) == ')';
+      if (depth == 1)
+      {
+        canExtendChunk = false;
+      }
+      break;
+    }
+  }
+
+  closeChunk();
+  return result;
+}
+
+struct BeginBrushEvent
+{
+  size_t line;
+};
+
+struct EndBrushEvent
+{
+  size_t startLine;
+  size_t lineCount;
+};
+
+struct StandardBrushFaceEvent
+{
+  size_t line;
+  Model::MapFormat targetMapFormat;
+  vm::vec3 point1;
+  vm::vec3 point2;
+  vm::vec3 point3;
+  Model::BrushFaceAttributes attribs;
+};
+
+struct ValveBrushFaceEvent
+{
+  size_t line;
+  Model::MapFormat targetMapFormat;
+  vm::vec3 point1;
+  vm::vec3 point2;
+  vm::vec3 point3;
+  Model::BrushFaceAttributes attribs;
+  vm::vec3 texAxisX;
+  vm::vec3 texAxisY;
+};
+
+struct PatchEvent
+{
+  size_t startLine;
+  size_t lineCount;
+  Model::MapFormat targetMapFormat;
+  size_t rowCount;
+  size_t columnCount;
+  std::vector<vm::vec<FloatType, 5>> controlPoints;
+  std::string textureName;
+};
+
+struct LogEvent
+{
+  LogLevel level;
+  std::string message;
+};
+
+using ParseEvent = std::variant<
+  BeginBrushEvent,
+  EndBrushEvent,
+  StandardBrushFaceEvent,
+  ValveBrushFaceEvent,
+  PatchEvent,
+  LogEvent>;
+
+/**
+ * Records the messages logged while parsing a chunk so that they can be logged on the
+ * calling thread in the correct order.
+ */
+class RecordingParserStatus : public ParserStatus
+{
+private:
+  static NullLogger s_logger;
+  std::vector<ParseEvent>& m_events;
+
+public:
+  explicit RecordingParserStatus(std::vector<ParseEvent>& events)
+    : ParserStatus{s_logger, ""}
+    , m_events{events}
+  {
+  }
+
+private:
+  void doProgress(double) override {}
+
+  void doLog(const LogLevel level, const std::string& str) override
+  {
+    m_events.push_back(LogEvent{level, str});
+  }
+};
+
+NullLogger RecordingParserStatus::s_logger;
+
+/**
+ * Parses a chunk on a worker thread and records the callbacks.
+ */
+class ChunkParser : public StandardMapParser
+{
+private:
+  std::vector<ParseEvent> m_events;
+
+public:
+  ChunkParser(
+    const MapChunk& chunk,
+    const Model::MapFormat sourceMapFormat,
+    const Model::MapFormat targetMapFormat)
+    : StandardMapParser{
+      std::string_view{chunk.begin, static_cast<size_t>(chunk.end - chunk.begin)},
+      sourceMapFormat,
+      targetMapFormat,
+      chunk.line,
+      chunk.column}
+  {
+  }
+
+  std::vector<ParseEvent> parse()
+  {
+    auto status = RecordingParserStatus{m_events};
+    parseBrushChunk(status);
+    return std::move(m_events);
+  }
+
+private:
+  void onBeginEntity(size_t, std::vector<Model::EntityProperty>, ParserStatus&) override
+  {
+    // chunks don't contain entities
+    assert(false);
+  }
+
+  void onEndEntity(size_t, size_t, ParserStatus&) override
+  {
+    // chunks don't contain entities
+    assert(false);
+  }
+
+  void onBeginBrush(const size_t line, ParserStatus&) override
+  {
+    m_events.push_back(BeginBrushEvent{line});
+  }
+
+  void onEndBrush(const size_t startLine, const size_t lineCount, ParserStatus&) override
+  {
+    m_events.push_back(EndBrushEvent{startLine, lineCount});
+  }
+
+  void onStandardBrushFace(
+    const size_t line,
+    const Model::MapFormat targetMapFormat,
+    const vm::vec3& point1,
+    const vm::vec3& point2,
+    const vm::vec3& point3,
+    const Model::BrushFaceAttributes& attribs,
+    ParserStatus&) override
+  {
+    m_events.push_back(
+      StandardBrushFaceEvent{line, targetMapFormat, point1, point2, point3, attribs});
+  }
+
+  void onValveBrushFace(
+    const size_t line,
+    const Model::MapFormat targetMapFormat,
+    const vm::vec3& point1,
+    const vm::vec3& point2,
+    const vm::vec3& point3,
+    const Model::BrushFaceAttributes& attribs,
+    const vm::vec3& texAxisX,
+    const vm::vec3& texAxisY,
+    ParserStatus&) override
+  {
+    m_events.push_back(ValveBrushFaceEvent{
+      line, targetMapFormat, point1, point2, point3, attribs, texAxisX, texAxisY});
+  }
+
+  void onPatch(
+    const size_t startLine,
+    const size_t lineCount,
+    const Model::MapFormat targetMapFormat,
+    const size_t rowCount,
+    const size_t columnCount,
+    std::vector<vm::vec<FloatType, 5>> controlPoints,
+    std::string textureName,
+    ParserStatus&) override
+  {
+    m_events.push_back(PatchEvent{
+      startLine,
+      lineCount,
+      targetMapFormat,
+      rowCount,
+      columnCount,
+      std::move(controlPoints),
+      std::move(textureName)});
+  }
+};
+
+/**
+ * Parses the given chunk and returns the recorded callbacks, or an empty optional if the
+ * chunk could not be parsed. In that case, the chunk is parsed again on the calling
+ * thread, which reports the error.
+ */
+std::optional<std::vector<ParseEvent>> parseChunk(
+  const MapChunk& chunk,
+  const Model::MapFormat sourceMapFormat,
+  const Model::MapFormat targetMapFormat)
+{
+  try
+  {
+    auto parser = ChunkParser{chunk, sourceMapFormat, targetMapFormat};
+    return parser.parse();
+  }
+  catch (const Exception&)
+  {
+    return std::nullopt;
+  }
+}
+} // namespace
+
+struct StandardMapParser::ChunkedParseState
+{
+  std::vector<MapChunk> chunks;
+  size_t nextChunk = 0;
+
+  // the parsed chunks, starting at windowBegin
+  std::vector<std::optional<std::vector<ParseEvent>>> window;
+  size_t windowBegin = 0;
+};
+
+const size_t StandardMapParser::DefaultParallelChunkSize = 1024 * 1024;
+
 const std::string StandardMapParser::BrushPrimitiveId = "brushDef";
 const std::string StandardMapParser::PatchId = "patchDef2";
 
@@ -161,7 +621,18 @@ StandardMapParser::StandardMapParser(
   std::string_view str,
   const Model::MapFormat sourceMapFormat,
   const Model::MapFormat targetMapFormat)
-  : m_tokenizer(QuakeMapTokenizer(std::move(str)))
+  : StandardMapParser{std::move(str), sourceMapFormat, targetMapFormat, 1, 1}
+{
+}
+
+StandardMapParser::StandardMapParser(
+  std::string_view str,
+  const Model::MapFormat sourceMapFormat,
+  const Model::MapFormat targetMapFormat,
+  const size_t line,
+  const size_t column)
+  : m_tokenizer(QuakeMapTokenizer(std::move(str), line, column))
+  , m_parallelChunkSize(DefaultParallelChunkSize)
   , m_sourceMapFormat(sourceMapFormat)
   , m_targetMapFormat(targetMapFormat)
 {
@@ -171,8 +642,15 @@ StandardMapParser::StandardMapParser(
 
 StandardMapParser::~StandardMapParser() = default;
 
+void StandardMapParser::setParallelChunkSize(const size_t parallelChunkSize)
+{
+  m_parallelChunkSize = parallelChunkSize;
+}
+
 void StandardMapParser::parseEntities(ParserStatus& status)
 {
+  prepareChunkedParse();
+
   auto token = m_tokenizer.peekToken();
   while (token.type() != QuakeMapToken::Eof)
   {
@@ -205,9 +683,149 @@ void StandardMapParser::parseBrushFaces(ParserStatus& status)
   }
 }
 
+void StandardMapParser::parseBrushChunk(ParserStatus& status)
+{
+  auto token = m_tokenizer.peekToken();
+  while (token.type() != QuakeMapToken::Eof)
+  {
+    expect(QuakeMapToken::Comment | QuakeMapToken::OBrace, token);
+    if (token.type() == QuakeMapToken::Comment)
+    {
+      m_tokenizer.nextToken();
+    }
+    else
+    {
+      parseBrushOrBrushPrimitiveOrPatch(status);
+    }
+    token = m_tokenizer.peekToken();
+  }
+}
+
 void StandardMapParser::reset()
 {
   m_tokenizer.reset();
+  m_chunkedParseState.reset();
+}
+
+void StandardMapParser::prepareChunkedParse()
+{
+  m_chunkedParseState.reset();
+
+  const auto source = m_tokenizer.snapshotStateAndSource();
+  const auto length = static_cast<size_t>(source.end - source.state.cur);
+  if (m_parallelChunkSize == 0 || length < 2 * m_parallelChunkSize)
+  {
+    return;
+  }
+
+  auto chunks = findMapChunks(
+    source.state.cur,
+    source.end,
+    source.state.line,
+    source.state.column,
+    m_parallelChunkSize);
+  if (chunks.size() > 1)
+  {
+    m_chunkedParseState = std::make_unique<ChunkedParseState>();
+    m_chunkedParseState->chunks = std::move(chunks);
+  }
+}
+
+bool StandardMapParser::replayParsedChunk(const Token& token, ParserStatus& status)
+{
+  if (!m_chunkedParseState)
+  {
+    return false;
+  }
+
+  auto& state = *m_chunkedParseState;
+  const auto& chunks = state.chunks;
+
+  // skip the chunks that were parsed on this thread
+  while (state.nextChunk < chunks.size() && chunks[state.nextChunk].begin < token.begin())
+  {
+    ++state.nextChunk;
+  }
+
+  if (state.nextChunk == chunks.size() || chunks[state.nextChunk].begin != token.begin())
+  {
+    return false;
+  }
+
+  const auto chunkIndex = state.nextChunk++;
+  const auto& chunk = chunks[chunkIndex];
+  if (chunk.line != token.line() || chunk.column != token.column())
+  {
+    return false;
+  }
+
+  if (
+    chunkIndex < state.windowBegin
+    || chunkIndex >= state.windowBegin + state.window.size())
+  {
+    // parse the next window of chunks in parallel
+    const auto windowSize = (kdl::default_thread_pool().thread_count() + 1) * 2;
+    const auto windowEnd = std::min(chunkIndex + windowSize, chunks.size());
+    auto windowChunks = std::vector<MapChunk>{
+      std::next(chunks.begin(), static_cast<std::ptrdiff_t>(chunkIndex)),
+      std::next(chunks.begin(), static_cast<std::ptrdiff_t>(windowEnd))};
+
+    state.window.clear();
+    state.window = kdl::vec_parallel_transform(
+      std::move(windowChunks), [&](const MapChunk& windowChunk) {
+        return parseChunk(windowChunk, m_sourceMapFormat, m_targetMapFormat);
+      });
+    state.windowBegin = chunkIndex;
+  }
+
+  auto& events = state.window[chunkIndex - state.windowBegin];
+  if (!events)
+  {
+    // the chunk could not be parsed, parse it again on this thread to report the error
+    return false;
+  }
+
+  for (auto& event : *events)
+  {
+    std::visit(
+      kdl::overload(
+        [&](const BeginBrushEvent& e) { onBeginBrush(e.line, status); },
+        [&](const EndBrushEvent& e) { onEndBrush(e.startLine, e.lineCount, status); },
+        [&](const StandardBrushFaceEvent& e) {
+          onStandardBrushFace(
+            e.line, e.targetMapFormat, e.point1, e.point2, e.point3, e.attribs, status);
+        },
+        [&](const ValveBrushFaceEvent& e) {
+          onValveBrushFace(
+            e.line,
+            e.targetMapFormat,
+            e.point1,
+            e.point2,
+            e.point3,
+            e.attribs,
+            e.texAxisX,
+            e.texAxisY,
+            status);
+        },
+        [&](PatchEvent& e) {
+          onPatch(
+            e.startLine,
+            e.lineCount,
+            e.targetMapFormat,
+            e.rowCount,
+            e.columnCount,
+            std::move(e.controlPoints),
+            std::move(e.textureName),
+            status);
+        },
+        [&](const LogEvent& e) { status.logMessage(e.level, e.message); }),
+      event);
+  }
+  events = std::nullopt;
+
+  m_tokenizer.adoptState(
+    TokenizerState{chunk.end, chunk.endLine, chunk.endColumn, false});
+  return true;
 }
 
 void StandardMapParser::parseEntity(ParserStatus& status)
@@ -244,7 +862,10 @@ void StandardMapParser::parseEntity(ParserStatus& status)
         onBeginEntity(startLine, std::move(properties), status);
         beginEntityCalled = true;
       }
-      parseBrushOrBrushPrimitiveOrPatch(status);
+      if (!replayParsedChunk(token, status))
+      {
+        parseBrushOrBrushPrimitiveOrPatch(status);
+      }
       break;
     case QuakeMapToken::CBrace:
       m_tokenizer.nextToken();
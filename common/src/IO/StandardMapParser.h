@@ -29,6 +29,7 @@
 
 #include <vecmath/forward.h>
 
+#include <memory>
 #include <string_view>
 #include <tuple>
 #include <vector>
@@ -64,7 +65,7 @@ private:
   bool m_skipEol;
 
 public:
-  explicit QuakeMapTokenizer(std::string_view str);
+  explicit QuakeMapTokenizer(std::string_view str, size_t line = 1, size_t column = 1);
 
   void setSkipEol(bool skipEol);
 
@@ -74,14 +75,25 @@ private:
 
 class StandardMapParser : public MapParser, public Parser<QuakeMapToken::Type>
 {
+public:
+  /**
+   * The default approximate size in bytes of the chunks of brushes that are parsed in
+   * parallel by parseEntities.
+   */
+  static const size_t DefaultParallelChunkSize;
+
 private:
   using Token = QuakeMapTokenizer::Token;
   using EntityPropertyKeys = kdl::vector_set<std::string>;
 
+  struct ChunkedParseState;
+
   static const std::string BrushPrimitiveId;
   static const std::string PatchId;
 
   QuakeMapTokenizer m_tokenizer;
+  size_t m_parallelChunkSize;
+  std::unique_ptr<ChunkedParseState> m_chunkedParseState;
 
 protected:
   Model::MapFormat m_sourceMapFormat;
@@ -103,14 +115,48 @@ public:
 
   ~StandardMapParser() override;
 
+  /**
+   * Sets the approximate size in bytes of the chunks of brushes that parseEntities parses
+   * in parallel. Inputs that are smaller than twice the chunk size are parsed on the
+   * calling thread only. Passing 0 disables parallel parsing.
+   */
+  void setParallelChunkSize(size_t parallelChunkSize);
+
 protected:
+  /**
+   * Creates a new parser for a part of a larger input. The given line and column are the
+   * position of the first character of the given string within the larger input.
+   */
+  StandardMapParser(
+    std::string_view str,
+    Model::MapFormat sourceMapFormat,
+    Model::MapFormat targetMapFormat,
+    size_t line,
+    size_t column);
+
+  /**
+   * Parses the input as a list of entities.
+   *
+   * If the input is large enough, the brushes and patches of the entities are split into
+   * chunks which are parsed in parallel before the entities are parsed. The callbacks
+   * are called on the calling thread in the same order and with the same arguments as if
+   * the entire input had been parsed on the calling thread.
+   */
   void parseEntities(ParserStatus& status);
   void parseBrushesOrPatches(ParserStatus& status);
   void parseBrushFaces(ParserStatus& status);
 
+  /**
+   * Parses the input as a list of brushes and patches which may be separated by comments.
+   */
+  void parseBrushChunk(ParserStatus& status);
+
   void reset();
 
 private:
+  void prepareChunkedParse();
+  bool replayParsedChunk(const Token& token, ParserStatus& status);
+
   void parseEntity(ParserStatus& status);
   void parseEntityProperty(
     std::vector<Model::EntityProperty>& properties,
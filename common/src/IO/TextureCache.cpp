@@ -0,0 +1,448 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureCache.h"
+
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "Color.h"
+#include "Exceptions.h"
+#include "IO/DiskIO.h"
+#include "IO/File.h"
+#include "IO/PathInfo.h"
+#include "IO/Reader.h"
+
+#include <kdl/reflection_impl.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <variant>
+
+namespace TrenchBroom::IO
+{
+namespace
+{
+constexpr auto Magic = std::string_view{"TBTC"};
+constexpr auto Version = uint32_t(1);
+
+// magic, version and entry count
+constexpr auto HeaderSize = size_t(16);
+// key, offset and size
+constexpr auto IndexEntrySize = size_t(24);
+// name length, width, height, format, type, game data kind, three Q2 data fields, four
+// average color components and the mip count
+constexpr auto RecordFieldsSize = size_t(14 * 4);
+
+// records and mip data are aligned so that they can be uploaded directly from the mapped
+// file
+constexpr auto Alignment = size_t(16);
+
+enum class GameDataKind : uint32_t
+{
+  None = 0,
+  Q2 = 1,
+};
+
+size_t align(const size_t size)
+{
+  return (size + Alignment - 1) / Alignment * Alignment;
+}
+
+size_t recordHeaderSize(const Assets::Texture& texture)
+{
+  return align(
+    RecordFieldsSize + texture.name().size()
+    + texture.buffersIfUnprepared().size() * sizeof(uint64_t));
+}
+
+size_t recordSize(const Assets::Texture& texture)
+{
+  auto size = recordHeaderSize(texture);
+  for (const auto& buffer : texture.buffersIfUnprepared())
+  {
+    size += align(buffer.size());
+  }
+  return size;
+}
+
+template <typename T>
+void writeValue(std::ostream& stream, const T value)
+{
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writePadding(std::ostream& stream, const size_t size)
+{
+  static const char zeros[Alignment] = {};
+  stream.write(zeros, static_cast<std::streamsize>(align(size) - size));
+}
+
+void writeRecord(std::ostream& stream, const Assets::Texture& texture)
+{
+  const auto& name = texture.name();
+  const auto& buffers = texture.buffersIfUnprepared();
+  const auto& averageColor = texture.averageColor();
+  const auto* q2Data = std::get_if<Assets::Q2Data>(&texture.gameData());
+
+  writeValue(stream, uint32_t(name.size()));
+  writeValue(stream, uint32_t(texture.width()));
+  writeValue(stream, uint32_t(texture.height()));
+  writeValue(stream, uint32_t(texture.format()));
+  writeValue(stream, uint32_t(texture.type()));
+  writeValue(stream, q2Data ? GameDataKind::Q2 : GameDataKind::None);
+  writeValue(stream, int32_t(q2Data ? q2Data->flags : 0));
+  writeValue(stream, int32_t(q2Data ? q2Data->contents : 0));
+  writeValue(stream, int32_t(q2Data ? q2Data->value : 0));
+  writeValue(stream, averageColor.r());
+  writeValue(stream, averageColor.g());
+  writeValue(stream, averageColor.b());
+  writeValue(stream, averageColor.a());
+  writeValue(stream, uint32_t(buffers.size()));
+
+  stream.write(name.data(), static_cast<std::streamsize>(name.size()));
+  for (const auto& buffer : buffers)
+  {
+    writeValue(stream, uint64_t(buffer.size()));
+  }
+  writePadding(
+    stream, RecordFieldsSize + name.size() + buffers.size() * sizeof(uint64_t));
+
+  for (const auto& buffer : buffers)
+  {
+    stream.write(
+      reinterpret_cast<const char*>(buffer.data()),
+      static_cast<std::streamsize>(buffer.size()));
+    writePadding(stream, buffer.size());
+  }
+}
+
+std::optional<Assets::Texture> readRecord(Reader& reader)
+{
+  const auto nameLength = reader.readSize<uint32_t>();
+  const auto width = reader.readSize<uint32_t>();
+  const auto height = reader.readSize<uint32_t>();
+  const auto format = reader.read<uint32_t, GLenum>();
+  const auto type = reader.read<uint32_t, Assets::TextureType>();
+  const auto gameDataKind = reader.read<uint32_t, GameDataKind>();
+  const auto q2Flags = reader.readInt<int32_t>();
+  const auto q2Contents = reader.readInt<int32_t>();
+  const auto q2Value = reader.readInt<int32_t>();
+  const auto r = reader.readFloat<float>();
+  const auto g = reader.readFloat<float>();
+  const auto b = reader.readFloat<float>();
+  const auto a = reader.readFloat<float>();
+  const auto mipCount = reader.readSize<uint32_t>();
+
+  if (width == 0 || height == 0)
+  {
+    return std::nullopt;
+  }
+
+  auto name = reader.readString(nameLength);
+
+  auto mipSizes = std::vector<size_t>{};
+  mipSizes.reserve(mipCount);
+  for (size_t i = 0; i < mipCount; ++i)
+  {
+    mipSizes.push_back(reader.readSize<uint64_t>());
+  }
+  reader.seekFromBegin(align(reader.position()));
+
+  auto buffers = Assets::TextureBufferList{};
+  buffers.reserve(mipCount);
+  for (const auto mipSize : mipSizes)
+  {
+    if (!reader.canRead(mipSize))
+    {
+      return std::nullopt;
+    }
+
+    auto& buffer = buffers.emplace_back(mipSize);
+    reader.read(buffer.data(), mipSize);
+    reader.seekFromBegin(align(reader.position()));
+  }
+
+  auto gameData = gameDataKind == GameDataKind::Q2
+                    ? Assets::GameData{Assets::Q2Data{q2Flags, q2Contents, q2Value}}
+                    : Assets::GameData{std::monostate{}};
+
+  return Assets::Texture{
+    std::move(name),
+    width,
+    height,
+    Color{r, g, b, a},
+    std::move(buffers),
+    format,
+    type,
+    std::move(gameData)};
+}
+} // namespace
+
+kdl_reflect_impl(TextureCacheStats);
+
+uint64_t hashTextureCacheKey(uint64_t key, const std::string_view data)
+{
+  // 64 bit FNV-1a
+  for (const auto c : data)
+  {
+    key ^= uint64_t(static_cast<unsigned char>(c));
+    key *= uint64_t(1099511628211u);
+  }
+  return key;
+}
+
+uint64_t hashTextureCacheKey(const uint64_t key, const uint64_t value)
+{
+  return hashTextureCacheKey(
+    key, std::string_view{reinterpret_cast<const char*>(&value), sizeof(value)});
+}
+
+CachedTextures::CachedTextures() = default;
+
+CachedTextures CachedTextures::open(
+  const std::filesystem::path& path, TextureCacheCounters* counters)
+{
+  auto result = CachedTextures{};
+  result.m_counters = counters;
+
+  if (Disk::pathInfo(path) != PathInfo::File)
+  {
+    return result;
+  }
+
+  try
+  {
+    auto file = openPhysicalFile(path);
+    auto reader = file->reader();
+
+    if (
+      reader.readString(Magic.size()) != Magic
+      || reader.readUnsignedInt<uint32_t>() != Version)
+    {
+      return result;
+    }
+
+    const auto entryCount = reader.readSize<uint64_t>();
+    if (!reader.canRead(entryCount * IndexEntrySize))
+    {
+      return result;
+    }
+
+    auto entries = std::unordered_map<uint64_t, Entry>{};
+    for (size_t i = 0; i < entryCount; ++i)
+    {
+      const auto key = reader.read<uint64_t, uint64_t>();
+      const auto offset = reader.readSize<uint64_t>();
+      const auto size = reader.readSize<uint64_t>();
+      if (offset > file->size() || size > file->size() - offset)
+      {
+        return result;
+      }
+      entries.emplace(key, Entry{offset, size});
+    }
+
+    result.m_file = std::move(file);
+    result.m_entries = std::move(entries);
+  }
+  catch (const Exception&)
+  {
+    // treat invalid cache files as empty
+  }
+
+  return result;
+}
+
+size_t CachedTextures::size() const
+{
+  return m_entries.size();
+}
+
+bool CachedTextures::contains(const uint64_t key) const
+{
+  return m_entries.count(key) > 0;
+}
+
+std::optional<Assets::Texture> CachedTextures::readTexture(const uint64_t key) const
+{
+  auto texture = std::optional<Assets::Texture>{};
+
+  const auto it = m_entries.find(key);
+  if (it != m_entries.end())
+  {
+    try
+    {
+      const auto& [offset, size] = it->second;
+      auto reader = m_file->reader().subReaderFromBegin(offset, size);
+      texture = readRecord(reader);
+    }
+    catch (const Exception&)
+    {
+      // treat invalid entries as missing
+    }
+  }
+
+  if (m_counters)
+  {
+    ++(texture ? m_counters->hits : m_counters->misses);
+  }
+
+  return texture;
+}
+
+void writeCachedTextures(
+  const std::filesystem::path& path,
+  const std::vector<std::tuple<uint64_t, const Assets::Texture*>>& textures)
+{
+  const auto temporaryPath = Disk::makeTemporaryPath(path);
+
+  {
+    auto stream = std::ofstream{temporaryPath, std::ios::out | std::ios::binary};
+    if (!stream)
+    {
+      throw FileSystemException{"Could not open '" + temporaryPath.string() + "'"};
+    }
+
+    stream.write(Magic.data(), static_cast<std::streamsize>(Magic.size()));
+    writeValue(stream, Version);
+    writeValue(stream, uint64_t(textures.size()));
+
+    auto offset = align(HeaderSize + textures.size() * IndexEntrySize);
+    for (const auto& [key, texture] : textures)
+    {
+      const auto size = recordSize(*texture);
+      writeValue(stream, key);
+      writeValue(stream, uint64_t(offset));
+      writeValue(stream, uint64_t(size));
+      offset += size;
+    }
+    writePadding(stream, HeaderSize + textures.size() * IndexEntrySize);
+
+    for (const auto& [key, texture] : textures)
+    {
+      writeRecord(stream, *texture);
+    }
+
+    if (!stream.flush())
+    {
+      stream.close();
+
+      auto error = std::error_code{};
+      std::filesystem::remove(temporaryPath, error);
+      throw FileSystemException{"Could not write '" + temporaryPath.string() + "'"};
+    }
+  }
+
+  auto error = std::error_code{};
+  std::filesystem::rename(temporaryPath, path, error);
+  if (error)
+  {
+    std::filesystem::remove(temporaryPath, error);
+    throw FileSystemException{"Could not write '" + path.string() + "'"};
+  }
+}
+
+TextureCache::TextureCache(std::filesystem::path directory)
+  : m_directory{std::move(directory)}
+  , m_counters{std::make_unique<TextureCacheCounters>()}
+{
+}
+
+TextureCache::~TextureCache() = default;
+
+const std::filesystem::path& TextureCache::directory() const
+{
+  return m_directory;
+}
+
+TextureCacheStats TextureCache::stats() const
+{
+  return {m_counters->hits, m_counters->misses};
+}
+
+std::filesystem::path TextureCache::cacheFilePath(
+  const std::filesystem::path& collectionPath) const
+{
+  const auto key =
+    hashTextureCacheKey(InitialTextureCacheKey, collectionPath.generic_u8string());
+
+  auto str = std::stringstream{};
+  str << std::hex << std::setw(16) << std::setfill('0') << key << ".tbtc";
+  return m_directory / str.str();
+}
+
+CachedTextures TextureCache::load(const std::filesystem::path& collectionPath) const
+{
+  const auto path = cacheFilePath(collectionPath);
+  auto cachedTextures = CachedTextures::open(path, m_counters.get());
+  if (cachedTextures.size() > 0)
+  {
+    // mark the file as used so that removeUnusedFiles keeps it
+    auto error = std::error_code{};
+    std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), error);
+  }
+  return cachedTextures;
+}
+
+void TextureCache::store(
+  const std::filesystem::path& collectionPath,
+  const std::vector<std::tuple<uint64_t, const Assets::Texture*>>& textures) const
+{
+  auto error = std::error_code{};
+  std::filesystem::create_directories(m_directory, error);
+  if (error)
+  {
+    throw FileSystemException{
+      "Could not create directory '" + m_directory.string() + "': " + error.message()};
+  }
+
+  writeCachedTextures(cacheFilePath(collectionPath), textures);
+}
+
+void TextureCache::removeUnusedFiles(const std::chrono::hours maxAge) const
+{
+  const auto now = std::filesystem::file_time_type::clock::now();
+
+  auto error = std::error_code{};
+  for (auto it = std::filesystem::directory_iterator{m_directory, error};
+       !error && it != std::filesystem::directory_iterator{};
+       it.increment(error))
+  {
+    const auto& path = it->path();
+    const auto extension = path.extension();
+    if (extension != ".tbtc" && extension != ".tmp")
+    {
+      continue;
+    }
+
+    auto fileError = std::error_code{};
+    const auto modificationTime = std::filesystem::last_write_time(path, fileError);
+    if (!fileError && now - modificationTime > maxAge)
+    {
+      std::filesystem::remove(path, fileError);
+    }
+  }
+}
+
+} // namespace TrenchBroom::IO
@@ -0,0 +1,190 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <kdl/reflection_decl.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace TrenchBroom::Assets
+{
+class Texture;
+}
+
+namespace TrenchBroom::IO
+{
+class File;
+
+struct TextureCacheStats
+{
+  size_t hits;
+  size_t misses;
+
+  kdl_reflect_decl(TextureCacheStats, hits, misses);
+};
+
+struct TextureCacheCounters
+{
+  std::atomic<size_t> hits = 0;
+  std::atomic<size_t> misses = 0;
+};
+
+/**
+ * The initial value of a texture cache key.
+ */
+constexpr auto InitialTextureCacheKey = uint64_t(14695981039346656037u);
+
+/**
+ * Hashes the given data into the given texture cache key and returns the result.
+ *
+ * A texture cache key is built by hashing everything that affects the decoded texture,
+ * that is, the path of the texture file, its size and modification time (or its contents
+ * if it has no modification time) and the contents of the palette, if any.
+ */
+uint64_t hashTextureCacheKey(uint64_t key, std::string_view data);
+
+/**
+ * Hashes the bytes of the given value into the given texture cache key and returns the
+ * result.
+ */
+uint64_t hashTextureCacheKey(uint64_t key, uint64_t value);
+
+/**
+ * Provides read access to the textures stored in a texture cache file.
+ *
+ * The cache file is memory mapped if possible, and only its index is read when the file
+ * is opened. Reading textures is thread safe.
+ */
+class CachedTextures
+{
+private:
+  using Entry = std::tuple<size_t, size_t>;
+
+  std::shared_ptr<File> m_file;
+  std::unordered_map<uint64_t, Entry> m_entries;
+  TextureCacheCounters* m_counters = nullptr;
+
+public:
+  /**
+   * Creates an empty set of cached textures.
+   */
+  CachedTextures();
+
+  /**
+   * Opens the given cache file. If the file does not exist or is invalid, the returned
+   * set of cached textures is empty.
+   *
+   * If counters are given, every call to readTexture increments either the hit or the
+   * miss counter.
+   */
+  static CachedTextures open(
+    const std::filesystem::path& path, TextureCacheCounters* counters = nullptr);
+
+  size_t size() const;
+  bool contains(uint64_t key) const;
+
+  /**
+   * Reads the texture with the given key. Returns an empty optional if this set of cached
+   * textures does not contain the key or if the texture cannot be read.
+   */
+  std::optional<Assets::Texture> readTexture(uint64_t key) const;
+};
+
+/**
+ * Writes the given textures to the given cache file.
+ *
+ * The file is written to a temporary file first and then moved into place so that
+ * readers never observe a partially written cache file.
+ *
+ * @throw FileSystemException if the file cannot be written
+ */
+void writeCachedTextures(
+  const std::filesystem::path& path,
+  const std::vector<std::tuple<uint64_t, const Assets::Texture*>>& textures);
+
+/**
+ * A persistent cache of decoded textures.
+ *
+ * The cache stores one file per texture collection in its directory. Every cached texture
+ * is identified by a key that is computed from the texture file's path, size and
+ * modification time and from the palette, so changed textures are not read from the
+ * cache. When a texture collection is loaded, the cache file is rewritten if any of its
+ * textures was missing from the cache or if the cache file contains textures that are no
+ * longer used.
+ *
+ * Loading a cache file marks it as used. Cache files of collections that were not loaded
+ * for a while can be removed with removeUnusedFiles.
+ */
+class TextureCache
+{
+private:
+  std::filesystem::path m_directory;
+  std::unique_ptr<TextureCacheCounters> m_counters;
+
+public:
+  explicit TextureCache(std::filesystem::path directory);
+  ~TextureCache();
+
+  const std::filesystem::path& directory() const;
+
+  /**
+   * Returns the number of textures that were read from this cache and the number of
+   * textures that were missing from it.
+   */
+  TextureCacheStats stats() const;
+
+  /**
+   * Returns the path of the cache file for the texture collection at the given absolute
+   * path.
+   */
+  std::filesystem::path cacheFilePath(const std::filesystem::path& collectionPath) const;
+
+  CachedTextures load(const std::filesystem::path& collectionPath) const;
+
+  /**
+   * Replaces the cache file of the given collection.
+   *
+   * The cached textures loaded for the collection must have been destroyed, a cache file
+   * that is still mapped into memory cannot be replaced on every platform.
+   *
+   * @throw FileSystemException if the cache file cannot be written
+   */
+  void store(
+    const std::filesystem::path& collectionPath,
+    const std::vector<std::tuple<uint64_t, const Assets::Texture*>>& textures) const;
+
+  /**
+   * Removes the cache files that were not loaded or stored for the given duration and the
+   * temporary files left behind by interrupted writes. Files that cannot be removed are
+   * skipped.
+   */
+  void removeUnusedFiles(std::chrono::hours maxAge) const;
+};
+
+} // namespace TrenchBroom::IO
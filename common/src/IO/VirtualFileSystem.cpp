@@ -20,16 +20,42 @@
 #include "VirtualFileSystem.h"
 
 #include "IO/FileSystemUtils.h"
+#include "IO/ImageFileSystem.h"
 #include "IO/PathInfo.h"
+#include "IO/PathMatcher.h"
 
 #include <kdl/path_utils.h>
+#include <kdl/string_format.h>
 #include <kdl/vector_utils.h>
 
+#include <atomic>
 #include <optional>
+#include <string>
+#include <unordered_map>
 
 namespace TrenchBroom::IO
 {
 
+struct VirtualFileSystemIndex
+{
+  /**
+   * Maps the lower case paths of all entries of the indexed file systems to the positions
+   * of the mount points that contain them, in order of precedence.
+   */
+  std::unordered_map<std::string, std::vector<size_t>> mountPointsByPath;
+
+  /**
+   * Maps the lower case paths of all directories of the indexed file systems and of all
+   * parent directories of the mount points to their merged and sorted contents.
+   */
+  std::unordered_map<std::string, std::vector<std::filesystem::path>> directoryContents;
+
+  /**
+   * The positions of the mount points that are not indexed, in order of precedence.
+   */
+  std::vector<size_t> unindexedMountPoints;
+};
+
 namespace
 {
 
@@ -39,18 +65,131 @@ size_t getMountPointId()
   return ++mountPointId;
 }
 
+std::string makeIndexKey(const std::filesystem::path& path)
+{
+  auto key = std::string{};
+  for (const auto& component : path)
+  {
+    if (!component.empty())
+    {
+      if (!key.empty())
+      {
+        key += '/';
+      }
+      key += kdl::str_to_lower(component.u8string());
+    }
+  }
+  return key;
+}
+
+bool isIndexed(const FileSystem& fs)
+{
+  // The contents of archive file systems only change when they are reloaded
+  return dynamic_cast<const ImageFileSystemBase*>(&fs) != nullptr;
+}
+
+void addDirectoryToIndex(
+  VirtualFileSystemIndex& index,
+  const size_t mountPointPosition,
+  const FileSystem& fs,
+  const std::filesystem::path& mountPath,
+  const std::filesystem::path& path)
+{
+  const auto key = makeIndexKey(mountPath / path);
+  index.mountPointsByPath[key].push_back(mountPointPosition);
+
+  // references to unordered_map elements remain valid when the map grows
+  auto& contents = index.directoryContents[key];
+  for (auto& name : fs.directoryContents(path))
+  {
+    const auto childPath = path / name;
+    if (fs.pathInfo(childPath) == PathInfo::Directory)
+    {
+      addDirectoryToIndex(index, mountPointPosition, fs, mountPath, childPath);
+    }
+    else
+    {
+      index.mountPointsByPath[makeIndexKey(mountPath / childPath)].push_back(
+        mountPointPosition);
+    }
+    contents.push_back(std::move(name));
+  }
+}
+
+void addMountPathToIndex(
+  VirtualFileSystemIndex& index, const std::filesystem::path& mountPath)
+{
+  auto parentPath = std::filesystem::path{};
+  for (const auto& component : mountPath)
+  {
+    index.directoryContents[makeIndexKey(parentPath)].push_back(component);
+    parentPath /= component;
+  }
+  index.directoryContents[makeIndexKey(parentPath)];
+}
+
+std::shared_ptr<const VirtualFileSystemIndex> buildIndex(
+  const std::vector<VirtualMountPoint>& mountPoints)
+{
+  auto index = std::make_shared<VirtualFileSystemIndex>();
+  for (size_t i = 0; i < mountPoints.size(); ++i)
+  {
+    const auto& mountPoint = mountPoints[i];
+    const auto& fs = *mountPoint.mountedFileSystem;
+    if (isIndexed(fs))
+    {
+      addDirectoryToIndex(*index, i, fs, mountPoint.path, std::filesystem::path{});
+    }
+    else
+    {
+      index->unindexedMountPoints.push_back(i);
+    }
+    addMountPathToIndex(*index, mountPoint.path);
+  }
+
+  for (auto& [key, contents] : index->directoryContents)
+  {
+    contents = kdl::vec_sort_and_remove_duplicates(std::move(contents));
+  }
+
+  return index;
+}
+
+/**
+ * Calls the given function for each mount point that may contain the given path, in
+ * order of precedence, until it returns a truthy value. Indexed mount points are only
+ * visited if they contain the path.
+ */
 template <typename F>
 auto forEachMountPoint(
   const std::vector<VirtualMountPoint>& mountPoints,
+  const VirtualFileSystemIndex& index,
   const std::filesystem::path& path,
   const F& f,
   decltype(f(std::declval<FileSystem>(), std::declval<std::filesystem::path>()))
     defaultResult = {})
 {
-  for (const auto& mountPoint : mountPoints)
+  static const auto noMountPoints = std::vector<size_t>{};
+
+  const auto indexIt = index.mountPointsByPath.find(makeIndexKey(path));
+  const auto& indexedMountPoints =
+    indexIt != index.mountPointsByPath.end() ? indexIt->second : noMountPoints;
+  const auto& unindexedMountPoints = index.unindexedMountPoints;
+
+  auto indexedIt = indexedMountPoints.begin();
+  auto unindexedIt = unindexedMountPoints.begin();
+  while (indexedIt != indexedMountPoints.end()
+         || unindexedIt != unindexedMountPoints.end())
   {
-    if (kdl::path_has_prefix(
-          kdl::path_to_lower(path), kdl::path_to_lower(mountPoint.path)))
+    const auto isIndexedNext =
+      unindexedIt == unindexedMountPoints.end()
+      || (indexedIt != indexedMountPoints.end() && *indexedIt < *unindexedIt);
+    const auto& mountPoint = mountPoints[isIndexedNext ? *indexedIt++ : *unindexedIt++];
+
+    if (
+      isIndexedNext
+      || kdl::path_has_prefix(
+        kdl::path_to_lower(path), kdl::path_to_lower(mountPoint.path)))
     {
       const auto pathSuffix = kdl::path_clip(path, kdl::path_length(mountPoint.path));
       if (auto result = f(*mountPoint.mountedFileSystem, pathSuffix))
@@ -85,6 +224,7 @@ VirtualMountPointId VirtualFileSystem::mount(
 {
   const auto id = VirtualMountPointId{};
   m_mountPoints.insert(m_mountPoints.begin(), VirtualMountPoint{id, path, std::move(fs)});
+  invalidateIndex();
   return id;
 }
 
@@ -97,6 +237,7 @@ bool VirtualFileSystem::unmount(const VirtualMountPointId& id)
       it != m_mountPoints.end())
   {
     m_mountPoints.erase(it);
+    invalidateIndex();
     return true;
   }
   return false;
@@ -105,6 +246,61 @@ bool VirtualFileSystem::unmount(const VirtualMountPointId& id)
 void VirtualFileSystem::unmountAll()
 {
   m_mountPoints.clear();
+  invalidateIndex();
+}
+
+void VirtualFileSystem::invalidateIndex()
+{
+  std::atomic_store(&m_index, std::shared_ptr<const VirtualFileSystemIndex>{});
+}
+
+std::vector<std::filesystem::path> VirtualFileSystem::archivePaths() const
+{
+  auto result = std::vector<std::filesystem::path>{};
+  for (const auto& mountPoint : m_mountPoints)
+  {
+    if (
+      const auto* archiveFs =
+        dynamic_cast<const ImageFileSystem*>(mountPoint.mountedFileSystem.get()))
+    {
+      result.push_back(archiveFs->archivePath());
+    }
+  }
+  return result;
+}
+
+std::vector<std::filesystem::path> VirtualFileSystem::reopenArchives(
+  const std::vector<std::filesystem::path>& archivePaths)
+{
+  invalidateIndex();
+
+  auto result = std::vector<std::filesystem::path>{};
+  for (const auto& mountPoint : m_mountPoints)
+  {
+    auto* archiveFs = dynamic_cast<ImageFileSystem*>(mountPoint.mountedFileSystem.get());
+    if (archiveFs && kdl::vec_contains(archivePaths, archiveFs->archivePath()))
+    {
+      archiveFs->reopen();
+      for (const auto& path : archiveFs->findRecursively(
+             std::filesystem::path{}, makePathInfoPathMatcher({PathInfo::File})))
+      {
+        result.push_back(mountPoint.path / path);
+      }
+    }
+  }
+  return result;
+}
+
+std::shared_ptr<const VirtualFileSystemIndex> VirtualFileSystem::index() const
+{
+  // Paths may be looked up by several threads at once, e.g. when loading textures
+  auto index = std::atomic_load(&m_index);
+  if (!index)
+  {
+    index = buildIndex(m_mountPoints);
+    std::atomic_store(&m_index, index);
+  }
+  return index;
 }
 
 std::filesystem::path VirtualFileSystem::doMakeAbsolute(
@@ -112,6 +308,7 @@ std::filesystem::path VirtualFileSystem::doMakeAbsolute(
 {
   auto absolutePath = forEachMountPoint(
     m_mountPoints,
+    *index(),
     path,
     [](const FileSystem& fs, const std::filesystem::path& p)
       -> std::optional<std::filesystem::path> {
@@ -129,9 +326,11 @@ std::filesystem::path VirtualFileSystem::doMakeAbsolute(
 
 PathInfo VirtualFileSystem::doGetPathInfo(const std::filesystem::path& path) const
 {
+  const auto index = this->index();
   if (
     auto result = forEachMountPoint(
       m_mountPoints,
+      *index,
       path,
       [](
         const FileSystem& fs, const std::filesystem::path& p) -> std::optional<PathInfo> {
@@ -142,23 +341,27 @@ PathInfo VirtualFileSystem::doGetPathInfo(const std::filesystem::path& path) con
     return *result;
   }
 
-  return std::any_of(
-           m_mountPoints.begin(),
-           m_mountPoints.end(),
-           [&](const auto& mountPoint) {
-             return kdl::path_has_prefix(
-               kdl::path_to_lower(mountPoint.path), kdl::path_to_lower(path));
-           })
-           ? PathInfo::Directory
-           : PathInfo::Unknown;
+  // the parent directories of the mount points are also listed in the index
+  return index->directoryContents.count(makeIndexKey(path)) > 0 ? PathInfo::Directory
+                                                                : PathInfo::Unknown;
 }
 
 std::vector<std::filesystem::path> VirtualFileSystem::doGetDirectoryContents(
   const std::filesystem::path& path) const
 {
+  const auto index = this->index();
+
   auto result = std::vector<std::filesystem::path>{};
-  for (const auto& mountPoint : m_mountPoints)
+  if (const auto indexIt = index->directoryContents.find(makeIndexKey(path));
+      indexIt != index->directoryContents.end())
   {
+    result = indexIt->second;
+  }
+
+  auto needsSorting = false;
+  for (const auto i : index->unindexedMountPoints)
+  {
+    const auto& mountPoint = m_mountPoints[i];
     if (kdl::path_has_prefix(
           kdl::path_to_lower(path), kdl::path_to_lower(mountPoint.path)))
     {
@@ -167,18 +370,12 @@ std::vector<std::filesystem::path> VirtualFileSystem::doGetDirectoryContents(
       {
         result = kdl::vec_concat(
           std::move(result), mountPoint.mountedFileSystem->directoryContents(pathSuffix));
+        needsSorting = true;
       }
     }
-    else if (
-      kdl::path_length(path) < kdl::path_length(mountPoint.path)
-      && kdl::path_has_prefix(
-        kdl::path_to_lower(mountPoint.path), kdl::path_to_lower(path)))
-    {
-      result.push_back(kdl::path_clip(mountPoint.path, kdl::path_length(path), 1));
-    }
   }
 
-  return kdl::vec_sort_and_remove_duplicates(std::move(result));
+  return needsSorting ? kdl::vec_sort_and_remove_duplicates(std::move(result)) : result;
 }
 
 std::shared_ptr<File> VirtualFileSystem::doOpenFile(
@@ -186,6 +383,7 @@ std::shared_ptr<File> VirtualFileSystem::doOpenFile(
 {
   return forEachMountPoint(
     m_mountPoints,
+    *index(),
     path,
     [](const FileSystem& fs, const std::filesystem::path& p) -> std::shared_ptr<File> {
       return fs.pathInfo(p) != PathInfo::Unknown ? fs.openFile(p) : nullptr;
@@ -28,6 +28,8 @@
 namespace TrenchBroom::IO
 {
 
+struct VirtualFileSystemIndex;
+
 class VirtualMountPointId
 {
 private:
@@ -54,12 +56,46 @@ class VirtualFileSystem : public FileSystem
 private:
   std::vector<VirtualMountPoint> m_mountPoints;
 
+  /**
+   * Merged index of the mounted archive file systems. Built lazily when a path is
+   * looked up and discarded when a file system is mounted or unmounted. Other file
+   * systems are not indexed because their contents can change at any time.
+   */
+  mutable std::shared_ptr<const VirtualFileSystemIndex> m_index;
+
 public:
   VirtualMountPointId mount(
     const std::filesystem::path& path, std::unique_ptr<FileSystem> fs);
   bool unmount(const VirtualMountPointId& id);
   void unmountAll();
 
+  /**
+   * Discards the index of the mounted archive file systems. Must be called when the
+   * contents of a mounted archive file system change, e.g. when it is reloaded.
+   */
+  void invalidateIndex();
+
+  /**
+   * Returns the paths of the archive files on the disk that are mounted in this file
+   * system.
+   */
+  std::vector<std::filesystem::path> archivePaths() const;
+
+  /**
+   * Reopens the mounted archives whose archive files are at the given paths, e.g. because
+   * the archive files were changed on the disk, and discards the index.
+   *
+   * @return the paths of the files in the reopened archives, relative to the root of this
+   * file system
+   *
+   * @throw FileSystemException if an archive cannot be reopened
+   */
+  std::vector<std::filesystem::path> reopenArchives(
+    const std::vector<std::filesystem::path>& archivePaths);
+
+private:
+  std::shared_ptr<const VirtualFileSystemIndex> index() const;
+
 protected:
   std::filesystem::path doMakeAbsolute(const std::filesystem::path& path) const override;
   PathInfo doGetPathInfo(const std::filesystem::path& path) const override;
@@ -19,9 +19,12 @@
 
 #include "ZipFileSystem.h"
 
+#include "IO/ArchiveFileCache.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/File.h"
+#include "IO/Reader.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -29,26 +32,59 @@ namespace TrenchBroom
 {
 namespace IO
 {
+namespace ZipLayout
+{
+static const uint32_t LocalHeaderSignature = 0x04034b50;
+static const size_t LocalHeaderLength = 0x1e;
+static const size_t LocalHeaderFilenameLengthAddress = 0x1a;
+static const mz_uint16 StoredMethod = 0;
+} // namespace ZipLayout
+
 // ZipFileSystem
 
 ZipFileSystem::ZipFileSystem(std::filesystem::path path)
+  : ZipFileSystem{std::move(path), ArchiveFileCache::sharedCache()}
+{
+}
+
+ZipFileSystem::ZipFileSystem(std::filesystem::path path, ArchiveFileCache& cache)
   : ImageFileSystem{std::move(path)}
+  , m_archive{}
+  , m_cache{cache}
+  , m_archiveId{m_cache.createArchiveId()}
 {
   initialize();
 }
 
 ZipFileSystem::~ZipFileSystem()
 {
+  m_cache.evictArchive(m_archiveId);
   mz_zip_reader_end(&m_archive);
 }
 
 void ZipFileSystem::doReadDirectory()
 {
+  // entry indices change if the archive is reloaded
+  m_cache.evictArchive(m_archiveId);
+
+  mz_zip_reader_end(&m_archive);
   mz_zip_zero_struct(&m_archive);
 
-  if (mz_zip_reader_init_cfile(&m_archive, m_file->file(), m_file->size(), 0) != MZ_TRUE)
+  if (const auto* cFile = dynamic_cast<const CFile*>(m_file.get()))
   {
-    throw FileSystemException{"Error calling mz_zip_reader_init_cfile"};
+    if (mz_zip_reader_init_cfile(&m_archive, cFile->file(), cFile->size(), 0) != MZ_TRUE)
+    {
+      throw FileSystemException{"Error calling mz_zip_reader_init_cfile"};
+    }
+  }
+  else
+  {
+    // the archive is mapped or copied into memory, so buffering its reader doesn't copy
+    const auto reader = m_file->reader().buffer();
+    if (mz_zip_reader_init_mem(&m_archive, reader.begin(), reader.size(), 0) != MZ_TRUE)
+    {
+      throw FileSystemException{"Error calling mz_zip_reader_init_mem"};
+    }
   }
 
   const auto numFiles = mz_zip_reader_get_num_files(&m_archive);
@@ -57,27 +93,7 @@ void ZipFileSystem::doReadDirectory()
     if (!mz_zip_reader_is_file_a_directory(&m_archive, i))
     {
       const auto path = std::filesystem::path{filename(i)};
-      addFile(path, [=]() -> std::shared_ptr<File> {
-        auto stat = mz_zip_archive_file_stat{};
-        if (!mz_zip_reader_file_stat(&m_archive, i, &stat))
-        {
-          throw FileSystemException{
-            "mz_zip_reader_file_stat failed for " + path.string()};
-        }
-
-        const auto uncompressedSize = static_cast<size_t>(stat.m_uncomp_size);
-        auto data = std::make_unique<char[]>(uncompressedSize);
-        auto* begin = data.get();
-
-        if (!mz_zip_reader_extract_to_mem(&m_archive, i, begin, uncompressedSize, 0))
-        {
-          throw FileSystemException{
-            "mz_zip_reader_extract_to_mem failed for " + path.string()};
-        }
-
-        return std::make_shared<OwningBufferFile>(
-          path, std::move(data), uncompressedSize);
-      });
+      addFile(path, [=]() { return openEntry(path, i); });
     }
   }
 
@@ -111,5 +127,80 @@ std::string ZipFileSystem::filename(const mz_uint fileIndex)
 
   return result;
 }
+
+std::shared_ptr<File> ZipFileSystem::openEntry(
+  const std::filesystem::path& path, const mz_uint fileIndex)
+{
+  auto lock = std::unique_lock{m_archiveMutex};
+
+  auto stat = mz_zip_archive_file_stat{};
+  if (!mz_zip_reader_file_stat(&m_archive, fileIndex, &stat))
+  {
+    throw FileSystemException{"mz_zip_reader_file_stat failed for " + path.string()};
+  }
+
+  if (stat.m_method == ZipLayout::StoredMethod && !stat.m_is_encrypted)
+  {
+    if (stat.m_comp_size != stat.m_uncomp_size)
+    {
+      throw FileSystemException{"Invalid size of stored file " + path.string()};
+    }
+
+    // the entry is not compressed, so we can return a view of the archive file
+    auto reader = m_file->reader();
+    reader.seekFromBegin(static_cast<size_t>(stat.m_local_header_ofs));
+    if (reader.readUnsignedInt<uint32_t>() != ZipLayout::LocalHeaderSignature)
+    {
+      throw FileSystemException{"Invalid local file header for " + path.string()};
+    }
+
+    reader.seekFromBegin(
+      static_cast<size_t>(stat.m_local_header_ofs)
+      + ZipLayout::LocalHeaderFilenameLengthAddress);
+    const auto filenameLength = reader.readSize<uint16_t>();
+    const auto extraFieldLength = reader.readSize<uint16_t>();
+    const auto dataOffset = static_cast<size_t>(stat.m_local_header_ofs)
+                            + ZipLayout::LocalHeaderLength + filenameLength
+                            + extraFieldLength;
+    const auto size = static_cast<size_t>(stat.m_uncomp_size);
+    if (dataOffset > m_file->size() || size > m_file->size() - dataOffset)
+    {
+      throw FileSystemException{"Stored file " + path.string() + " is truncated"};
+    }
+
+    return std::make_shared<FileView>(path, m_file, dataOffset, size);
+  }
+
+  lock.unlock();
+
+  return m_cache.getOrLoad(
+    m_archiveId, fileIndex, [&]() { return extractEntry(path, stat); });
+}
+
+std::shared_ptr<File> ZipFileSystem::extractEntry(
+  const std::filesystem::path& path, const mz_zip_archive_file_stat& stat)
+{
+  const auto uncompressedSize = static_cast<size_t>(stat.m_uncomp_size);
+  auto data = std::make_unique<char[]>(uncompressedSize);
+  auto* begin = data.get();
+
+  {
+    auto lock = std::unique_lock{m_archiveMutex};
+    if (const auto* mmapFile = dynamic_cast<const MmapFile*>(m_file.get()))
+    {
+      // miniz reads the mapped memory directly
+      mmapFile->checkNotTruncated();
+    }
+
+    if (!mz_zip_reader_extract_to_mem(
+          &m_archive, stat.m_file_index, begin, uncompressedSize, 0))
+    {
+      throw FileSystemException{
+        "mz_zip_reader_extract_to_mem failed for " + path.string()};
+    }
+  }
+
+  return std::make_shared<OwningBufferFile>(path, std::move(data), uncompressedSize);
+}
 } // namespace IO
 } // namespace TrenchBroom
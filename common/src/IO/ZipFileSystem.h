@@ -25,19 +25,32 @@
 
 #include <filesystem>
 #include <memory>
+#include <mutex>
 
 namespace TrenchBroom
 {
 namespace IO
 {
+class ArchiveFileCache;
 
+/**
+ * A file system backed by a ZIP archive.
+ *
+ * Entries that are stored without compression are returned as views of the archive file.
+ * Compressed entries are decompressed when they are opened, and the decompressed files
+ * are kept in an archive file cache. By default, all ZIP file systems share one cache.
+ */
 class ZipFileSystem : public ImageFileSystem
 {
 private:
   mz_zip_archive m_archive;
+  std::mutex m_archiveMutex;
+  ArchiveFileCache& m_cache;
+  size_t m_archiveId;
 
 public:
   explicit ZipFileSystem(std::filesystem::path path);
+  ZipFileSystem(std::filesystem::path path, ArchiveFileCache& cache);
   ~ZipFileSystem() override;
 
 private:
@@ -45,6 +58,9 @@ private:
 
 private:
   std::string filename(mz_uint fileIndex);
+  std::shared_ptr<File> openEntry(const std::filesystem::path& path, mz_uint fileIndex);
+  std::shared_ptr<File> extractEntry(
+    const std::filesystem::path& path, const mz_zip_archive_file_stat& stat);
 };
 } // namespace IO
 } // namespace TrenchBroom
@@ -142,4 +142,22 @@ void Logger::log(const LogLevel level, const QString& message)
 
 void NullLogger::doLog(const LogLevel /* level */, const std::string& /* message */) {}
 void NullLogger::doLog(const LogLevel /* level */, const QString& /* message */) {}
+
+void RecordingLogger::replay(Logger& logger) const
+{
+  for (const auto& [level, message] : m_messages)
+  {
+    logger.log(level, message);
+  }
+}
+
+void RecordingLogger::doLog(const LogLevel level, const std::string& message)
+{
+  m_messages.emplace_back(level, message);
+}
+
+void RecordingLogger::doLog(const LogLevel level, const QString& message)
+{
+  doLog(level, message.toStdString());
+}
 } // namespace TrenchBroom
@@ -21,6 +21,8 @@
 
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <vector>
 
 class QString;
 
@@ -94,4 +96,22 @@ private:
   void doLog(LogLevel level, const std::string& message) override;
   void doLog(LogLevel level, const QString& message) override;
 };
+
+/**
+ * Records the logged messages so that they can be replayed to another logger later. This
+ * is useful when loading assets on worker threads, as the other loggers must only be used
+ * on the main thread.
+ */
+class RecordingLogger : public Logger
+{
+private:
+  std::vector<std::tuple<LogLevel, std::string>> m_messages;
+
+public:
+  void replay(Logger& logger) const;
+
+private:
+  void doLog(LogLevel level, const std::string& message) override;
+  void doLog(LogLevel level, const QString& message) override;
+};
 } // namespace TrenchBroom
@@ -67,22 +67,9 @@ Brush::Brush() {}
 
 Brush::Brush(const Brush& other)
   : m_faces(other.m_faces)
-  , m_geometry(
-      other.m_geometry
-        ? std::make_unique<BrushGeometry>(*other.m_geometry, CopyCallback())
-        : nullptr)
+  , m_geometry(other.m_geometry)
 {
-  if (m_geometry)
-  {
-    for (BrushFaceGeometry* faceGeometry : m_geometry->faces())
-    {
-      if (const auto faceIndex = faceGeometry->payload())
-      {
-        BrushFace& face = m_faces[*faceIndex];
-        face.setGeometry(faceGeometry);
-      }
-    }
-  }
+  updateFaceGeometries();
 }
 
 Brush::Brush(Brush&& other) noexcept
@@ -176,6 +163,21 @@ kdl::result<void, BrushError> Brush::updateGeometryFromFaces(const vm::bbox3& wo
   return kdl::void_success;
 }
 
+void Brush::updateFaceGeometries()
+{
+  if (m_geometry)
+  {
+    for (BrushFaceGeometry* faceGeometry : m_geometry->faces())
+    {
+      if (const auto faceIndex = faceGeometry->payload())
+      {
+        BrushFace& face = m_faces[*faceIndex];
+        face.setGeometry(faceGeometry);
+      }
+    }
+  }
+}
+
 const vm::bbox3& Brush::bounds() const
 {
   ensure(m_geometry != nullptr, "geometry is null");
@@ -1197,6 +1199,26 @@ kdl::result<void, BrushError> Brush::transform(
     }
   }
 
+  if (m_geometry && vm::strip_translation(transformation) == vm::mat4x4::identity())
+  {
+    // Translating the geometry is much cheaper than rebuilding it from the transformed
+    // faces. The translated vertices can differ from the rebuilt ones by rounding errors,
+    // but the topology is the same. If the brush gets too close to the world bounds, we
+    // rebuild it so that it is clipped in the same way as before.
+    const auto delta = transformation * vm::vec3::zero();
+    if (worldBounds.encloses(m_geometry->bounds().translate(delta)))
+    {
+      if (delta != vm::vec3::zero())
+      {
+        auto geometry = std::make_shared<BrushGeometry>(*m_geometry, CopyCallback());
+        geometry->translate(delta);
+        m_geometry = std::move(geometry);
+        updateFaceGeometries();
+      }
+      return kdl::void_success;
+    }
+  }
+
   return updateGeometryFromFaces(worldBounds);
 }
 
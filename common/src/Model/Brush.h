@@ -58,7 +58,16 @@ public:
 
 private:
   std::vector<BrushFace> m_faces;
-  std::unique_ptr<BrushGeometry> m_geometry;
+
+  /**
+   * The geometry is shared between copies of a brush. Operations that change a brush
+   * replace its geometry instead of modifying it, so copying a brush is cheap and the
+   * geometry is only copied when one of the copies is edited.
+   *
+   * Only identical copies share their geometry. Translating a brush, e.g. when a linked
+   * group is updated, gives it a geometry of its own.
+   */
+  std::shared_ptr<BrushGeometry> m_geometry;
 
 public:
   Brush();
@@ -78,6 +87,7 @@ private:
   Brush(std::vector<BrushFace> faces);
 
   kdl::result<void, BrushError> updateGeometryFromFaces(const vm::bbox3& worldBounds);
+  void updateFaceGeometries();
 
 public:
   const vm::bbox3& bounds() const;
@@ -644,28 +644,39 @@ void BrushFace::flipTexture(
   }
 }
 
-kdl::result<void, BrushError> BrushFace::transform(
-  const vm::mat4x4& transform, const bool lockTexture)
+BrushFace::Points BrushFace::transformedPoints(const vm::mat4x4& transform) const
 {
   using std::swap;
 
-  const vm::vec3 invariant = m_geometry != nullptr ? center() : m_boundary.anchor();
-  const vm::plane3 oldBoundary = m_boundary;
-
-  m_boundary = m_boundary.transform(transform);
+  const auto boundary = m_boundary.transform(transform);
+  auto points = m_points;
   for (size_t i = 0; i < 3; ++i)
   {
-    m_points[i] = transform * m_points[i];
+    points[i] = transform * points[i];
   }
 
-  if (
-    dot(cross(m_points[2] - m_points[0], m_points[1] - m_points[0]), m_boundary.normal)
-    < 0.0)
+  if (dot(cross(points[2] - points[0], points[1] - points[0]), boundary.normal) < 0.0)
+  {
+    swap(points[1], points[2]);
+  }
+
+  for (size_t i = 0; i < 3; ++i)
   {
-    swap(m_points[1], m_points[2]);
+    points[i] = correct(points[i]);
   }
+  return points;
+}
+
+kdl::result<void, BrushError> BrushFace::transform(
+  const vm::mat4x4& transform, const bool lockTexture)
+{
+  const vm::vec3 invariant = m_geometry != nullptr ? center() : m_boundary.anchor();
+  const vm::plane3 oldBoundary = m_boundary;
+
+  const auto points = transformedPoints(transform);
+  m_boundary = m_boundary.transform(transform);
 
-  return setPoints(m_points[0], m_points[1], m_points[2]).transform([&]() {
+  return setPoints(points[0], points[1], points[2]).transform([&]() {
     m_texCoordSystem->transform(
       oldBoundary,
       m_boundary,
@@ -233,6 +233,10 @@ public:
     const vm::vec3& cameraRight,
     vm::direction cameraRelativeFlipDirection);
 
+  /**
+   * Returns the points that this face has after it is transformed with the given matrix.
+   */
+  BrushFace::Points transformedPoints(const vm::mat4x4& transform) const;
   kdl::result<void, BrushError> transform(const vm::mat4x4& transform, bool lockTexture);
   void invert();
 
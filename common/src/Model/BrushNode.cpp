@@ -71,6 +71,7 @@ const HitType::Type BrushNode::BrushHitType = HitType::freeType();
 BrushNode::BrushNode(Brush brush)
   : m_brushRendererBrushCache(std::make_unique<Renderer::BrushRendererBrushCache>())
   , m_brush(std::move(brush))
+  , m_packedPlanes(m_brush)
 {
   clearSelectedFaces();
 }
@@ -115,14 +116,15 @@ const Brush& BrushNode::brush() const
 
 Brush BrushNode::setBrush(Brush brush)
 {
-  const auto nodeChange = NotifyNodeChange{*this};
+  const auto nodeChange = NotifyNodeChange{*this, ValidatorDependency::Geometry};
   const auto boundsChange = NotifyPhysicalBoundsChange{*this};
 
   using std::swap;
   swap(m_brush, brush);
+  m_packedPlanes = PackedBrushPlanes{m_brush};
 
   updateSelectedFaceCount();
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Geometry);
   invalidateVertexCache();
 
   return brush;
@@ -154,7 +156,9 @@ void BrushNode::setFaceTexture(const size_t faceIndex, Assets::Texture* texture)
 {
   m_brush.face(faceIndex).setTexture(texture);
 
-  invalidateIssues();
+  // the texture provides default surface attributes that are written to the map file
+  updateRevision();
+  invalidateIssues(ValidatorDependency::Geometry);
   invalidateVertexCache();
 }
 
@@ -261,6 +265,18 @@ bool BrushNode::intersects(const Node* node) const
     [&](const PatchNode* patch) { return intersectsPatch(m_brush, patch->grid()); }));
 }
 
+std::optional<Hit> BrushNode::findHit(const vm::ray3& ray)
+{
+  if (const auto faceHit = findFaceHit(ray))
+  {
+    const auto [distance, faceIndex] = *faceHit;
+    ensure(!vm::is_nan(distance), "nan hit distance");
+    const auto hitPoint = vm::point_at_distance(ray, distance);
+    return Hit(BrushHitType, distance, hitPoint, BrushFaceHandle(this, faceIndex));
+  }
+  return std::nullopt;
+}
+
 void BrushNode::clearSelectedFaces()
 {
   for (BrushFace& face : m_brush.faces())
@@ -365,13 +381,9 @@ void BrushNode::doPick(
 {
   if (editorContext.visible(this))
   {
-    if (const auto hit = findFaceHit(ray))
+    if (const auto hit = findHit(ray))
     {
-      const auto [distance, faceIndex] = *hit;
-      ensure(!vm::is_nan(distance), "nan hit distance");
-      const auto hitPoint = vm::point_at_distance(ray, distance);
-      pickResult.addHit(
-        Hit(BrushHitType, distance, hitPoint, BrushFaceHandle(this, faceIndex)));
+      pickResult.addHit(*hit);
     }
   }
 }
@@ -387,16 +399,34 @@ void BrushNode::doFindNodesContaining(const vm::vec3& point, std::vector<Node*>&
 std::optional<std::tuple<FloatType, size_t>> BrushNode::findFaceHit(
   const vm::ray3& ray) const
 {
-  if (!vm::is_nan(vm::intersect_ray_bbox(ray, logicalBounds())))
+  if (vm::is_nan(vm::intersect_ray_bbox(ray, logicalBounds())))
+  {
+    return std::nullopt;
+  }
+
+  // The slab test rejects most rays without visiting the face polygons. A hit is
+  // confirmed by intersecting the ray with the polygon of the face it enters through.
+  const auto slabHit = m_packedPlanes.intersectWithRay(ray);
+  if (!slabHit)
   {
-    for (size_t i = 0u; i < m_brush.faceCount(); ++i)
+    return std::nullopt;
+  }
+
+  const auto slabFaceIndex = std::get<1>(*slabHit);
+  const auto distance = m_brush.face(slabFaceIndex).intersectWithRay(ray);
+  if (!vm::is_nan(distance))
+  {
+    return std::make_tuple(distance, slabFaceIndex);
+  }
+
+  // the ray grazes an edge or a vertex, so test all faces
+  for (size_t i = 0u; i < m_brush.faceCount(); ++i)
+  {
+    const auto& face = m_brush.face(i);
+    const auto faceDistance = face.intersectWithRay(ray);
+    if (!vm::is_nan(faceDistance))
     {
-      const auto& face = m_brush.face(i);
-      const auto distance = face.intersectWithRay(ray);
-      if (!vm::is_nan(distance))
-      {
-        return std::make_tuple(distance, i);
-      }
+      return std::make_tuple(faceDistance, i);
     }
   }
   return std::nullopt;
@@ -26,6 +26,7 @@
 #include "Model/HitType.h"
 #include "Model/Node.h"
 #include "Model/Object.h"
+#include "Model/PackedBrushPlanes.h"
 #include "Model/TagType.h"
 
 #include <kdl/result_forward.h>
@@ -53,6 +54,7 @@ namespace Model
 {
 class BrushFace;
 class GroupNode;
+class Hit;
 class LayerNode;
 
 class ModelFactory;
@@ -70,6 +72,7 @@ private:
   mutable std::unique_ptr<Renderer::BrushRendererBrushCache>
     m_brushRendererBrushCache; // unique_ptr for breaking header dependencies
   Brush m_brush;               // must be destroyed before the brush renderer cache
+  PackedBrushPlanes m_packedPlanes;
   size_t m_selectedFaceCount = 0u;
 
 public:
@@ -96,6 +99,15 @@ public:
   bool contains(const Node* node) const;
   bool intersects(const Node* node) const;
 
+  /**
+   * Returns the hit of the given ray with this brush, regardless of whether this brush is
+   * visible.
+   *
+   * This function does not modify this node, so it can be called for several nodes in
+   * parallel.
+   */
+  std::optional<Hit> findHit(const vm::ray3& ray);
+
 private:
   void clearSelectedFaces();
   void updateSelectedFaceCount();
@@ -40,7 +40,10 @@ static const auto Type = freeIssueType();
 } // namespace
 
 EmptyBrushEntityValidator::EmptyBrushEntityValidator()
-  : Validator{Type, "Empty brush entity"}
+  : Validator{
+    Type,
+    "Empty brush entity",
+    ValidatorDependency::Properties | ValidatorDependency::Hierarchy}
 {
   addQuickFix(makeDeleteNodesQuickFix());
 }
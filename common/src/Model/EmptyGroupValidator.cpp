@@ -38,7 +38,7 @@ static const auto Type = freeIssueType();
 } // namespace
 
 EmptyGroupValidator::EmptyGroupValidator()
-  : Validator{Type, "Empty group"}
+  : Validator{Type, "Empty group", ValidatorDependency::Hierarchy}
 {
   addQuickFix(makeDeleteNodesQuickFix());
 }
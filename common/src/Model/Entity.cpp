@@ -23,6 +23,8 @@
 #include "Assets/EntityModel.h"
 #include "Assets/ModelDefinition.h"
 #include "Assets/PropertyDefinition.h"
+#include "EL/ELExceptions.h"
+#include "EL/VariableStore.h"
 #include "Model/EntityProperties.h"
 #include "Model/EntityPropertiesVariableStore.h"
 #include "Model/EntityRotation.h"
@@ -74,7 +76,10 @@ Entity::Entity()
   : m_pointEntity{true}
   , m_model{nullptr}
   , m_cachedProperties{
-      EntityPropertyValues::NoClassname, vm::vec3{}, vm::mat4x4{}, vm::mat4x4{}}
+      InternedString{EntityPropertyValues::NoClassname},
+      vm::vec3{},
+      vm::mat4x4{},
+      vm::mat4x4{}}
 {
 }
 
@@ -170,6 +175,7 @@ void Entity::setDefinition(
   }
 
   m_definition = Assets::AssetReference{definition};
+  m_cachedProperties.modelSpecificationValid = false;
   updateCachedProperties(propertyConfig);
 }
 
@@ -192,17 +198,11 @@ void Entity::setModel(
 
 Assets::ModelSpecification Entity::modelSpecification() const
 {
-  if (
-    const auto* pointDefinition =
-      dynamic_cast<const Assets::PointEntityDefinition*>(m_definition.get()))
-  {
-    const auto variableStore = EntityPropertiesVariableStore{*this};
-    return pointDefinition->modelDefinition().modelSpecification(variableStore);
-  }
-  else
+  if (m_cachedProperties.modelSpecificationError)
   {
-    return Assets::ModelSpecification{};
+    std::rethrow_exception(m_cachedProperties.modelSpecificationError);
   }
+  return m_cachedProperties.modelSpecification;
 }
 
 const vm::mat4x4& Entity::modelTransformation() const
@@ -221,6 +221,8 @@ void Entity::unsetEntityDefinitionAndModel()
   m_model = nullptr;
   m_cachedProperties.rotation = entityRotation(*this);
   m_cachedProperties.modelTransformation = vm::mat4x4::identity();
+  m_cachedProperties.modelSpecificationValid = false;
+  updateCachedModelSpecification();
 }
 
 void Entity::addOrUpdateProperty(
@@ -350,7 +352,7 @@ std::vector<std::string> Entity::propertyKeys() const
 
 const std::string& Entity::classname() const
 {
-  return m_cachedProperties.classname;
+  return m_cachedProperties.classname.str();
 }
 
 void Entity::setClassname(
@@ -430,16 +432,19 @@ void Entity::applyRotation(
 
 void Entity::updateCachedProperties(const EntityPropertyConfig& propertyConfig)
 {
-  const auto* classnameValue = property(EntityPropertyKeys::Classname);
+  const auto classnameIt =
+    findEntityProperty(m_properties, EntityPropertyKeys::Classname);
   const auto* originValue = property(EntityPropertyKeys::Origin);
 
   // order is important here because EntityRotation::getRotation accesses classname
-  m_cachedProperties.classname =
-    classnameValue ? *classnameValue : EntityPropertyValues::NoClassname;
+  m_cachedProperties.classname = classnameIt != m_properties.end()
+                                   ? classnameIt->internedValue()
+                                   : InternedString{EntityPropertyValues::NoClassname};
   m_cachedProperties.origin =
     originValue ? vm::parse<FloatType, 3>(*originValue).value_or(vm::vec3::zero())
                 : vm::vec3::zero();
   m_cachedProperties.rotation = entityRotation(*this);
+  updateCachedModelSpecification();
 
   if (
     const auto* pointDefinition =
@@ -459,6 +464,50 @@ void Entity::updateCachedProperties(const EntityPropertyConfig& propertyConfig)
   }
 }
 
+void Entity::updateCachedModelSpecification()
+{
+  const auto* pointDefinition =
+    dynamic_cast<const Assets::PointEntityDefinition*>(m_definition.get());
+  if (!pointDefinition)
+  {
+    m_cachedProperties.modelSpecificationValid = true;
+    m_cachedProperties.modelSpecification = Assets::ModelSpecification{};
+    m_cachedProperties.modelSpecificationError = nullptr;
+    m_cachedProperties.modelSpecificationVariables.clear();
+    return;
+  }
+
+  const auto variableStore = EntityPropertiesVariableStore{*this};
+  if (
+    m_cachedProperties.modelSpecificationValid
+    && std::all_of(
+      m_cachedProperties.modelSpecificationVariables.begin(),
+      m_cachedProperties.modelSpecificationVariables.end(),
+      [&](const auto& variable) {
+        return variableStore.value(variable.first) == variable.second;
+      }))
+  {
+    return;
+  }
+
+  m_cachedProperties.modelSpecificationVariables.clear();
+  const auto recordingStore = EL::RecordingVariableStore{
+    variableStore, m_cachedProperties.modelSpecificationVariables};
+
+  try
+  {
+    m_cachedProperties.modelSpecification =
+      pointDefinition->modelDefinition().modelSpecification(recordingStore);
+    m_cachedProperties.modelSpecificationError = nullptr;
+  }
+  catch (const EL::Exception&)
+  {
+    m_cachedProperties.modelSpecification = Assets::ModelSpecification{};
+    m_cachedProperties.modelSpecificationError = std::current_exception();
+  }
+  m_cachedProperties.modelSpecificationValid = true;
+}
+
 bool operator==(const Entity& lhs, const Entity& rhs)
 {
   return lhs.properties() == rhs.properties();
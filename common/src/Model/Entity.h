@@ -20,6 +20,8 @@
 #pragma once
 
 #include "Assets/AssetReference.h"
+#include "Assets/ModelDefinition.h"
+#include "EL/Value.h"
 #include "FloatType.h"
 #include "Model/EntityProperties.h"
 
@@ -27,8 +29,10 @@
 #include <vecmath/mat.h>
 #include <vecmath/vec.h>
 
+#include <exception>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom
@@ -37,7 +41,6 @@ namespace Assets
 {
 class EntityDefinition;
 class EntityModelFrame;
-struct ModelSpecification;
 } // namespace Assets
 
 namespace Model
@@ -107,10 +110,20 @@ private:
    */
   struct CachedProperties
   {
-    std::string classname;
+    InternedString classname;
     vm::vec3 origin;
     vm::mat4x4 rotation;
     vm::mat4x4 modelTransformation;
+
+    /**
+     * The result of evaluating the model expression of the point entity definition, and
+     * the values of the variables that the expression read. The expression is only
+     * evaluated again if one of these values changes.
+     */
+    bool modelSpecificationValid = false;
+    Assets::ModelSpecification modelSpecification = {};
+    std::exception_ptr modelSpecificationError = nullptr;
+    std::vector<std::pair<std::string, EL::Value>> modelSpecificationVariables = {};
   };
 
   CachedProperties m_cachedProperties;
@@ -206,6 +219,7 @@ private:
     const EntityPropertyConfig& propertyConfig, const vm::mat4x4& rotation);
 
   void updateCachedProperties(const EntityPropertyConfig& propertyConfig);
+  void updateCachedModelSpecification();
 };
 
 bool operator==(const Entity& lhs, const Entity& rhs);
@@ -148,7 +148,7 @@ void EntityNodeBase::setDefinition(Assets::EntityDefinition* definition)
 }
 
 EntityNodeBase::NotifyPropertyChange::NotifyPropertyChange(EntityNodeBase& node)
-  : m_nodeChange{node}
+  : m_nodeChange{node, ValidatorDependency::Properties}
   , m_node{node}
   , m_oldPhysicalBounds{node.physicalBounds()}
 {
@@ -192,17 +192,21 @@ void EntityNodeBase::updatePropertyIndex(
 
     if (oldProp < newProp)
     {
-      removePropertyFromIndex(oldProp.key(), oldProp.value());
+      removePropertyFromIndex(oldProp.internedKey(), oldProp.internedValue());
       ++oldIt;
     }
     else if (oldProp > newProp)
     {
-      addPropertyToIndex(newProp.key(), newProp.value());
+      addPropertyToIndex(newProp.internedKey(), newProp.internedValue());
       ++newIt;
     }
     else
     {
-      updatePropertyIndex(oldProp.key(), oldProp.value(), newProp.key(), newProp.value());
+      updatePropertyIndex(
+        oldProp.internedKey(),
+        oldProp.internedValue(),
+        newProp.internedKey(),
+        newProp.internedValue());
       ++oldIt;
       ++newIt;
     }
@@ -211,14 +215,14 @@ void EntityNodeBase::updatePropertyIndex(
   while (oldIt != oldEnd)
   {
     const EntityProperty& oldProp = *oldIt;
-    removePropertyFromIndex(oldProp.key(), oldProp.value());
+    removePropertyFromIndex(oldProp.internedKey(), oldProp.internedValue());
     ++oldIt;
   }
 
   while (newIt != newEnd)
   {
     const EntityProperty& newProp = *newIt;
-    addPropertyToIndex(newProp.key(), newProp.value());
+    addPropertyToIndex(newProp.internedKey(), newProp.internedValue());
     ++newIt;
   }
 }
@@ -273,31 +277,32 @@ void EntityNodeBase::updateLinks(
 void EntityNodeBase::addPropertiesToIndex()
 {
   for (const EntityProperty& property : m_entity.properties())
-    addPropertyToIndex(property.key(), property.value());
+    addPropertyToIndex(property.internedKey(), property.internedValue());
 }
 
 void EntityNodeBase::removePropertiesFromIndex()
 {
   for (const EntityProperty& property : m_entity.properties())
-    removePropertyFromIndex(property.key(), property.value());
+    removePropertyFromIndex(property.internedKey(), property.internedValue());
 }
 
-void EntityNodeBase::addPropertyToIndex(const std::string& key, const std::string& value)
+void EntityNodeBase::addPropertyToIndex(
+  const InternedString& key, const InternedString& value)
 {
   addToIndex(this, key, value);
 }
 
 void EntityNodeBase::removePropertyFromIndex(
-  const std::string& key, const std::string& value)
+  const InternedString& key, const InternedString& value)
 {
   removeFromIndex(this, key, value);
 }
 
 void EntityNodeBase::updatePropertyIndex(
-  const std::string& oldKey,
-  const std::string& oldValue,
-  const std::string& newKey,
-  const std::string& newValue)
+  const InternedString& oldKey,
+  const InternedString& oldValue,
+  const InternedString& newKey,
+  const InternedString& newValue)
 {
   if (oldKey == newKey && oldValue == newValue)
   {
@@ -561,7 +566,7 @@ void EntityNodeBase::addLinkTargets(const std::vector<EntityNodeBase*>& targets)
     target->addLinkSource(this);
     m_linkTargets.push_back(target);
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::addKillTargets(const std::vector<EntityNodeBase*>& targets)
@@ -572,7 +577,7 @@ void EntityNodeBase::addKillTargets(const std::vector<EntityNodeBase*>& targets)
     target->addKillSource(this);
     m_killTargets.push_back(target);
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::addLinkSources(const std::vector<EntityNodeBase*>& sources)
@@ -583,7 +588,7 @@ void EntityNodeBase::addLinkSources(const std::vector<EntityNodeBase*>& sources)
     linkSource->addLinkTarget(this);
     m_linkSources.push_back(linkSource);
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::addKillSources(const std::vector<EntityNodeBase*>& sources)
@@ -594,7 +599,7 @@ void EntityNodeBase::addKillSources(const std::vector<EntityNodeBase*>& sources)
     killSource->addKillTarget(this);
     m_killSources.push_back(killSource);
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::removeAllLinkSources()
@@ -602,7 +607,7 @@ void EntityNodeBase::removeAllLinkSources()
   for (EntityNodeBase* linkSource : m_linkSources)
     linkSource->removeLinkTarget(this);
   m_linkSources.clear();
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::removeAllLinkTargets()
@@ -610,7 +615,7 @@ void EntityNodeBase::removeAllLinkTargets()
   for (EntityNodeBase* linkTarget : m_linkTargets)
     linkTarget->removeLinkSource(this);
   m_linkTargets.clear();
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::removeAllKillSources()
@@ -618,7 +623,7 @@ void EntityNodeBase::removeAllKillSources()
   for (EntityNodeBase* killSource : m_killSources)
     killSource->removeKillTarget(this);
   m_killSources.clear();
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::removeAllKillTargets()
@@ -626,7 +631,7 @@ void EntityNodeBase::removeAllKillTargets()
   for (EntityNodeBase* killTarget : m_killTargets)
     killTarget->removeKillSource(this);
   m_killTargets.clear();
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::removeAllLinks()
@@ -666,49 +671,49 @@ void EntityNodeBase::addLinkSource(EntityNodeBase* node)
 {
   ensure(node != nullptr, "node is null");
   m_linkSources.push_back(node);
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::addLinkTarget(EntityNodeBase* node)
 {
   ensure(node != nullptr, "node is null");
   m_linkTargets.push_back(node);
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::addKillSource(EntityNodeBase* node)
 {
   ensure(node != nullptr, "node is null");
   m_killSources.push_back(node);
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::addKillTarget(EntityNodeBase* node)
 {
   ensure(node != nullptr, "node is null");
   m_killTargets.push_back(node);
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::removeLinkSource(EntityNodeBase* node)
 {
   ensure(node != nullptr, "node is null");
   m_linkSources = kdl::vec_erase(std::move(m_linkSources), node);
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::removeLinkTarget(EntityNodeBase* node)
 {
   ensure(node != nullptr, "node is null");
   m_linkTargets = kdl::vec_erase(std::move(m_linkTargets), node);
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 void EntityNodeBase::removeKillSource(EntityNodeBase* node)
 {
   ensure(node != nullptr, "node is null");
   m_killSources = kdl::vec_erase(std::move(m_killSources), node);
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Links);
 }
 
 EntityNodeBase::EntityNodeBase()
@@ -98,13 +98,13 @@ private: // search index management
   void addPropertiesToIndex();
   void removePropertiesFromIndex();
 
-  void addPropertyToIndex(const std::string& key, const std::string& value);
-  void removePropertyFromIndex(const std::string& key, const std::string& value);
+  void addPropertyToIndex(const InternedString& key, const InternedString& value);
+  void removePropertyFromIndex(const InternedString& key, const InternedString& value);
   void updatePropertyIndex(
-    const std::string& oldKey,
-    const std::string& oldValue,
-    const std::string& newKey,
-    const std::string& newValue);
+    const InternedString& oldKey,
+    const InternedString& oldValue,
+    const InternedString& newKey,
+    const InternedString& newValue);
 
 public: // link management
   const std::vector<EntityNodeBase*>& linkSources() const;
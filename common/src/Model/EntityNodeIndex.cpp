@@ -27,15 +27,190 @@
 #include <kdl/compact_trie.h>
 #include <kdl/vector_utils.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <iterator>
-#include <list>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom
 {
 namespace Model
 {
+/**
+ * A multiset of entity nodes. Small sets are stored as an unsorted list, larger sets are
+ * stored as an open addressing hash table with linear probing, so that inserting and
+ * removing a node takes constant time on average while each node only takes up a few
+ * pointers worth of memory.
+ */
+class EntityNodeIndex::EntityNodeSet
+{
+private:
+  static constexpr auto MaxListSize = size_t(16);
+
+  std::vector<EntityNodeBase*> m_slots;
+  size_t m_size = 0;
+  bool m_hashed = false;
+
+public:
+  bool empty() const { return m_size == 0u; }
+
+  void insert(EntityNodeBase* node)
+  {
+    if (!m_hashed)
+    {
+      if (m_slots.size() < MaxListSize)
+      {
+        m_slots.push_back(node);
+        ++m_size;
+        return;
+      }
+      rehash(4u * MaxListSize);
+    }
+    else if (4u * (m_size + 1u) > 3u * m_slots.size())
+    {
+      rehash(2u * m_slots.size());
+    }
+
+    insertIntoTable(node);
+    ++m_size;
+  }
+
+  bool remove(EntityNodeBase* node)
+  {
+    if (!m_hashed)
+    {
+      const auto it = std::find(std::begin(m_slots), std::end(m_slots), node);
+      if (it == std::end(m_slots))
+      {
+        return false;
+      }
+      *it = m_slots.back();
+      m_slots.pop_back();
+      --m_size;
+      return true;
+    }
+
+    const auto mask = m_slots.size() - 1u;
+    auto hole = homeSlot(node);
+    while (m_slots[hole] != node)
+    {
+      if (m_slots[hole] == nullptr)
+      {
+        return false;
+      }
+      hole = (hole + 1u) & mask;
+    }
+
+    // shift the following nodes back into the hole unless that would move them before
+    // their home slot
+    for (auto i = (hole + 1u) & mask; m_slots[i] != nullptr; i = (i + 1u) & mask)
+    {
+      const auto home = homeSlot(m_slots[i]);
+      if (((i - home) & mask) >= ((i - hole) & mask))
+      {
+        m_slots[hole] = m_slots[i];
+        hole = i;
+      }
+    }
+    m_slots[hole] = nullptr;
+    --m_size;
+
+    if (m_size <= MaxListSize / 2u)
+    {
+      m_slots.erase(
+        std::remove(std::begin(m_slots), std::end(m_slots), nullptr), std::end(m_slots));
+      m_slots.shrink_to_fit();
+      m_hashed = false;
+    }
+    else if (8u * m_size < m_slots.size())
+    {
+      rehash(m_slots.size() / 2u);
+    }
+    return true;
+  }
+
+  template <typename O>
+  void copyTo(O out) const
+  {
+    for (auto* node : m_slots)
+    {
+      if (node != nullptr)
+      {
+        *out++ = node;
+      }
+    }
+  }
+
+private:
+  size_t homeSlot(const EntityNodeBase* node) const
+  {
+    // Fibonacci hashing spreads the aligned node addresses over the table
+    const auto hash = uint64_t(reinterpret_cast<uintptr_t>(node)) * 0x9e3779b97f4a7c15ull;
+    return size_t(hash >> 32u) & (m_slots.size() - 1u);
+  }
+
+  void rehash(const size_t capacity)
+  {
+    auto nodes = std::exchange(m_slots, std::vector<EntityNodeBase*>(capacity, nullptr));
+    m_hashed = true;
+    for (auto* node : nodes)
+    {
+      if (node != nullptr)
+      {
+        insertIntoTable(node);
+      }
+    }
+  }
+
+  void insertIntoTable(EntityNodeBase* node)
+  {
+    const auto mask = m_slots.size() - 1u;
+    auto i = homeSlot(node);
+    while (m_slots[i] != nullptr)
+    {
+      i = (i + 1u) & mask;
+    }
+    m_slots[i] = node;
+  }
+};
+
+namespace
+{
+template <typename NodesByString>
+void addToIndex(
+  EntityNodeStringIndex& index,
+  NodesByString& nodesByString,
+  const InternedString& str,
+  EntityNodeBase* node)
+{
+  auto& nodes = nodesByString[str];
+  if (nodes.empty())
+  {
+    index.insert(str.str(), str);
+  }
+  nodes.insert(node);
+}
+
+template <typename NodesByString>
+void removeFromIndex(
+  EntityNodeStringIndex& index,
+  NodesByString& nodesByString,
+  const InternedString& str,
+  EntityNodeBase* node)
+{
+  const auto it = nodesByString.find(str);
+  if (it != std::end(nodesByString) && it->second.remove(node) && it->second.empty())
+  {
+    index.remove(str.str(), str);
+    nodesByString.erase(it);
+  }
+}
+} // namespace
+
 EntityNodeIndexQuery EntityNodeIndexQuery::exact(const std::string& pattern)
 {
   return EntityNodeIndexQuery(Type_Exact, pattern);
@@ -56,20 +231,20 @@ EntityNodeIndexQuery EntityNodeIndexQuery::any()
   return EntityNodeIndexQuery(Type_Any);
 }
 
-std::set<EntityNodeBase*> EntityNodeIndexQuery::execute(
+std::vector<InternedString> EntityNodeIndexQuery::execute(
   const EntityNodeStringIndex& index) const
 {
-  std::set<EntityNodeBase*> result;
+  std::vector<InternedString> result;
   switch (m_type)
   {
   case Type_Exact:
-    index.find_matches(m_pattern, std::inserter(result, std::end(result)));
+    index.find_matches(m_pattern, std::back_inserter(result));
     break;
   case Type_Prefix:
-    index.find_matches(m_pattern + "*", std::inserter(result, std::end(result)));
+    index.find_matches(m_pattern + "*", std::back_inserter(result));
     break;
   case Type_Numbered:
-    index.find_matches(m_pattern + "%*", std::inserter(result, std::end(result)));
+    index.find_matches(m_pattern + "%*", std::back_inserter(result));
     break;
   case Type_Any:
     break;
@@ -122,6 +297,8 @@ EntityNodeIndexQuery::EntityNodeIndexQuery(const Type type, const std::string& p
 EntityNodeIndex::EntityNodeIndex()
   : m_keyIndex(std::make_unique<EntityNodeStringIndex>())
   , m_valueIndex(std::make_unique<EntityNodeStringIndex>())
+  , m_nodesByKey(std::make_unique<NodesByString>())
+  , m_nodesByValue(std::make_unique<NodesByString>())
 {
 }
 
@@ -130,35 +307,41 @@ EntityNodeIndex::~EntityNodeIndex() = default;
 void EntityNodeIndex::addEntityNode(EntityNodeBase* node)
 {
   for (const EntityProperty& property : node->entity().properties())
-    addProperty(node, property.key(), property.value());
+    addProperty(node, property.internedKey(), property.internedValue());
 }
 
 void EntityNodeIndex::removeEntityNode(EntityNodeBase* node)
 {
   for (const EntityProperty& property : node->entity().properties())
-    removeProperty(node, property.key(), property.value());
+    removeProperty(node, property.internedKey(), property.internedValue());
 }
 
 void EntityNodeIndex::addProperty(
-  EntityNodeBase* node, const std::string& key, const std::string& value)
+  EntityNodeBase* node, const InternedString& key, const InternedString& value)
 {
-  m_keyIndex->insert(key, node);
-  m_valueIndex->insert(value, node);
+  addToIndex(*m_keyIndex, *m_nodesByKey, key, node);
+  addToIndex(*m_valueIndex, *m_nodesByValue, value, node);
 }
 
 void EntityNodeIndex::removeProperty(
-  EntityNodeBase* node, const std::string& key, const std::string& value)
+  EntityNodeBase* node, const InternedString& key, const InternedString& value)
 {
-  m_keyIndex->remove(key, node);
-  m_valueIndex->remove(value, node);
+  removeFromIndex(*m_keyIndex, *m_nodesByKey, key, node);
+  removeFromIndex(*m_valueIndex, *m_nodesByValue, value, node);
 }
 
 std::vector<EntityNodeBase*> EntityNodeIndex::findEntityNodes(
   const EntityNodeIndexQuery& keyQuery, const std::string& value) const
 {
   // first, find Nodes which have `value` as the value for any key
+  std::vector<InternedString> values;
+  m_valueIndex->find_matches(value, std::back_inserter(values));
+
   std::vector<EntityNodeBase*> result;
-  m_valueIndex->find_matches(value, std::back_inserter(result));
+  for (const auto& matchingValue : values)
+  {
+    m_nodesByValue->at(matchingValue).copyTo(std::back_inserter(result));
+  }
   if (result.empty())
   {
     return {};
@@ -192,7 +375,12 @@ std::vector<std::string> EntityNodeIndex::allValuesForKeys(
 {
   std::vector<std::string> result;
 
-  const std::set<EntityNodeBase*> nameResult = keyQuery.execute(*m_keyIndex);
+  std::set<EntityNodeBase*> nameResult;
+  for (const auto& key : keyQuery.execute(*m_keyIndex))
+  {
+    m_nodesByKey->at(key).copyTo(std::inserter(nameResult, std::end(nameResult)));
+  }
+
   for (const auto node : nameResult)
   {
     const auto matchingProperties = keyQuery.execute(node);
@@ -19,11 +19,13 @@
 
 #pragma once
 
+#include "Model/InternedString.h"
+
 #include <kdl/compact_trie_forward.h>
 
 #include <memory>
-#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace TrenchBroom
@@ -33,7 +35,7 @@ namespace Model
 class EntityNodeBase;
 class EntityProperty;
 
-using EntityNodeStringIndex = kdl::compact_trie<EntityNodeBase*>;
+using EntityNodeStringIndex = kdl::compact_trie<InternedString>;
 
 class EntityNodeIndexQuery
 {
@@ -56,7 +58,7 @@ public:
   static EntityNodeIndexQuery numbered(const std::string& pattern);
   static EntityNodeIndexQuery any();
 
-  std::set<EntityNodeBase*> execute(const EntityNodeStringIndex& index) const;
+  std::vector<InternedString> execute(const EntityNodeStringIndex& index) const;
   bool execute(const EntityNodeBase* node, const std::string& value) const;
   std::vector<Model::EntityProperty> execute(const EntityNodeBase* node) const;
 
@@ -64,11 +66,24 @@ private:
   explicit EntityNodeIndexQuery(Type type, const std::string& pattern = "");
 };
 
+/**
+ * Indexes entity nodes by their property keys and values.
+ *
+ * Each distinct key and value is stored once in a trie, which maps it to its interned
+ * string. The nodes that use a key or value are stored in a compact hash set for each
+ * interned string. A node is stored more than once in such a set if it uses the string
+ * in more than one property.
+ */
 class EntityNodeIndex
 {
 private:
+  class EntityNodeSet;
+  using NodesByString = std::unordered_map<InternedString, EntityNodeSet>;
+
   std::unique_ptr<EntityNodeStringIndex> m_keyIndex;
   std::unique_ptr<EntityNodeStringIndex> m_valueIndex;
+  std::unique_ptr<NodesByString> m_nodesByKey;
+  std::unique_ptr<NodesByString> m_nodesByValue;
 
 public:
   EntityNodeIndex();
@@ -78,9 +93,9 @@ public:
   void removeEntityNode(EntityNodeBase* node);
 
   void addProperty(
-    EntityNodeBase* node, const std::string& key, const std::string& value);
+    EntityNodeBase* node, const InternedString& key, const InternedString& value);
   void removeProperty(
-    EntityNodeBase* node, const std::string& key, const std::string& value);
+    EntityNodeBase* node, const InternedString& key, const InternedString& value);
 
   std::vector<EntityNodeBase*> findEntityNodes(
     const EntityNodeIndexQuery& keyQuery, const std::string& value) const;
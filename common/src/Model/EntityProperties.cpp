@@ -103,22 +103,32 @@ kdl_reflect_impl(EntityProperty);
 
 const std::string& EntityProperty::key() const
 {
-  return m_key;
+  return m_key.str();
 }
 
 const std::string& EntityProperty::value() const
+{
+  return m_value.str();
+}
+
+const InternedString& EntityProperty::internedKey() const
+{
+  return m_key;
+}
+
+const InternedString& EntityProperty::internedValue() const
 {
   return m_value;
 }
 
 bool EntityProperty::hasKey(std::string_view key) const
 {
-  return kdl::cs::str_is_equal(m_key, key);
+  return kdl::cs::str_is_equal(m_key.str(), key);
 }
 
 bool EntityProperty::hasValue(const std::string_view value) const
 {
-  return kdl::cs::str_is_equal(m_value, value);
+  return kdl::cs::str_is_equal(m_value.str(), value);
 }
 
 bool EntityProperty::hasKeyAndValue(std::string_view key, std::string_view value) const
@@ -128,7 +138,7 @@ bool EntityProperty::hasKeyAndValue(std::string_view key, std::string_view value
 
 bool EntityProperty::hasPrefix(const std::string_view prefix) const
 {
-  return kdl::cs::str_is_prefix(m_key, prefix);
+  return kdl::cs::str_is_prefix(m_key.str(), prefix);
 }
 
 bool EntityProperty::hasPrefixAndValue(
@@ -139,7 +149,7 @@ bool EntityProperty::hasPrefixAndValue(
 
 bool EntityProperty::hasNumberedPrefix(const std::string_view prefix) const
 {
-  return isNumberedProperty(prefix, m_key);
+  return isNumberedProperty(prefix, m_key.str());
 }
 
 bool EntityProperty::hasNumberedPrefixAndValue(
@@ -150,12 +160,19 @@ bool EntityProperty::hasNumberedPrefixAndValue(
 
 void EntityProperty::setKey(std::string key)
 {
-  m_key = std::move(key);
+  // avoid looking up the pool if the key does not change
+  if (key != m_key.str())
+  {
+    m_key = InternedString{std::move(key)};
+  }
 }
 
 void EntityProperty::setValue(std::string value)
 {
-  m_value = std::move(value);
+  if (value != m_value.str())
+  {
+    m_value = InternedString{std::move(value)};
+  }
 }
 
 bool isLayer(const std::string& classname, const std::vector<EntityProperty>& properties)
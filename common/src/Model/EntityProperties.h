@@ -20,6 +20,7 @@
 #pragma once
 
 #include "EL/Expression.h"
+#include "Model/InternedString.h"
 
 #include <kdl/reflection_decl.h>
 
@@ -99,8 +100,8 @@ bool isNumberedProperty(std::string_view prefix, std::string_view key);
 class EntityProperty
 {
 private:
-  std::string m_key;
-  std::string m_value;
+  InternedString m_key;
+  InternedString m_value;
 
 public:
   EntityProperty();
@@ -111,6 +112,9 @@ public:
   const std::string& key() const;
   const std::string& value() const;
 
+  const InternedString& internedKey() const;
+  const InternedString& internedValue() const;
+
   bool hasKey(std::string_view key) const;
   bool hasValue(std::string_view value) const;
   bool hasKeyAndValue(std::string_view key, std::string_view value) const;
@@ -59,6 +59,11 @@ void Game::setAdditionalSearchPaths(
   doSetAdditionalSearchPaths(searchPaths, logger);
 }
 
+std::filesystem::path Game::makeAbsolute(const std::filesystem::path& path) const
+{
+  return doMakeAbsolute(path);
+}
+
 Game::PathErrors Game::checkAdditionalSearchPaths(
   const std::vector<std::filesystem::path>& searchPaths) const
 {
@@ -151,6 +156,13 @@ void Game::loadTextureCollections(Assets::TextureManager& textureManager) const
   doLoadTextureCollections(textureManager);
 }
 
+void Game::reloadTextures(
+  Assets::TextureManager& textureManager,
+  const std::vector<std::filesystem::path>& texturePaths) const
+{
+  doReloadTextures(textureManager, texturePaths);
+}
+
 void Game::reloadWads(
   const std::filesystem::path& documentPath,
   const std::vector<std::filesystem::path>& wadPaths,
@@ -164,6 +176,17 @@ void Game::reloadShaders()
   doReloadShaders();
 }
 
+std::vector<std::filesystem::path> Game::archivePaths() const
+{
+  return doArchivePaths();
+}
+
+std::vector<std::filesystem::path> Game::reopenArchives(
+  const std::vector<std::filesystem::path>& archivePaths)
+{
+  return doReopenArchives(archivePaths);
+}
+
 bool Game::isEntityDefinitionFile(const std::filesystem::path& path) const
 {
   return doIsEntityDefinitionFile(path);
@@ -70,6 +70,13 @@ public:
   void setAdditionalSearchPaths(
     const std::vector<std::filesystem::path>& searchPaths, Logger& logger);
 
+  /**
+   * Returns the absolute path of the given path in the game file system, or an empty path
+   * if the given path cannot be made absolute. Files that are contained in an archive
+   * have an absolute path that does not exist on the disk.
+   */
+  std::filesystem::path makeAbsolute(const std::filesystem::path& path) const;
+
   using PathErrors = std::map<std::filesystem::path, std::string>;
   PathErrors checkAdditionalSearchPaths(
     const std::vector<std::filesystem::path>& searchPaths) const;
@@ -135,12 +142,32 @@ public: // parsing and serializing objects
 public: // texture collection handling
   void loadTextureCollections(Assets::TextureManager& textureManagerr) const;
 
+  /**
+   * Reloads the textures at the given paths in the game file system, see
+   * TextureManager::reloadTextures.
+   */
+  void reloadTextures(
+    Assets::TextureManager& textureManager,
+    const std::vector<std::filesystem::path>& texturePaths) const;
+
   void reloadWads(
     const std::filesystem::path& documentPath,
     const std::vector<std::filesystem::path>& wadPaths,
     Logger& logger);
   void reloadShaders();
 
+  /**
+   * Returns the paths of the archive files that are mounted in the game file system.
+   */
+  std::vector<std::filesystem::path> archivePaths() const;
+
+  /**
+   * Reopens the archives at the given paths in the game file system, see
+   * VirtualFileSystem::reopenArchives.
+   */
+  std::vector<std::filesystem::path> reopenArchives(
+    const std::vector<std::filesystem::path>& archivePaths);
+
 public: // entity definition handling
   bool isEntityDefinitionFile(const std::filesystem::path& path) const;
   std::vector<Assets::EntityDefinitionFileSpec> allEntityDefinitionFiles() const;
@@ -171,6 +198,8 @@ private: // subclassing interface
     const std::vector<std::filesystem::path>& searchPaths, Logger& logger) = 0;
   virtual PathErrors doCheckAdditionalSearchPaths(
     const std::vector<std::filesystem::path>& searchPaths) const = 0;
+  virtual std::filesystem::path doMakeAbsolute(
+    const std::filesystem::path& path) const = 0;
 
   virtual const CompilationConfig& doCompilationConfig() = 0;
   virtual size_t doMaxPropertyLength() const = 0;
@@ -208,11 +237,17 @@ private: // subclassing interface
     std::ostream& stream) const = 0;
 
   virtual void doLoadTextureCollections(Assets::TextureManager& textureManager) const = 0;
+  virtual void doReloadTextures(
+    Assets::TextureManager& textureManager,
+    const std::vector<std::filesystem::path>& texturePaths) const = 0;
   virtual void doReloadWads(
     const std::filesystem::path& documentPath,
     const std::vector<std::filesystem::path>& wadPaths,
     Logger& logger) = 0;
   virtual void doReloadShaders() = 0;
+  virtual std::vector<std::filesystem::path> doArchivePaths() const = 0;
+  virtual std::vector<std::filesystem::path> doReopenArchives(
+    const std::vector<std::filesystem::path>& archivePaths) = 0;
 
   virtual bool doIsEntityDefinitionFile(const std::filesystem::path& path) const = 0;
   virtual std::vector<Assets::EntityDefinitionFileSpec> doAllEntityDefinitionFiles()
@@ -65,6 +65,7 @@ void GameFileSystem::reloadShaders()
   if (m_shaderFS)
   {
     m_shaderFS->reload();
+    invalidateIndex();
   }
 }
 
@@ -37,6 +37,7 @@
 #include "IO/ExportOptions.h"
 #include "IO/FgdParser.h"
 #include "IO/File.h"
+#include "IO/FileSystemUtils.h"
 #include "IO/GameConfigParser.h"
 #include "IO/ImageSpriteParser.h"
 #include "IO/LoadTextureCollection.h"
@@ -137,6 +138,12 @@ Game::PathErrors GameImpl::doCheckAdditionalSearchPaths(
   return result;
 }
 
+std::filesystem::path GameImpl::doMakeAbsolute(const std::filesystem::path& path) const
+{
+  return IO::safeMakeAbsolute(path, [&](const auto& p) { return m_fs.makeAbsolute(p); })
+    .value_or(std::filesystem::path{});
+}
+
 const CompilationConfig& GameImpl::doCompilationConfig()
 {
   return m_config.compilationConfig;
@@ -215,7 +222,7 @@ std::unique_ptr<WorldNode> GameImpl::doLoadMap(
   Logger& logger) const
 {
   auto parserStatus = IO::SimpleParserStatus{logger};
-  auto file = IO::Disk::openFile(path);
+  auto file = IO::Disk::openMappedFile(path);
   auto fileReader = file->reader().buffer();
   if (format == MapFormat::Unknown)
   {
@@ -242,12 +249,12 @@ std::unique_ptr<WorldNode> GameImpl::doLoadMap(
 void GameImpl::doWriteMap(
   WorldNode& world, const std::filesystem::path& path, const bool exporting) const
 {
-  IO::Disk::withOutputStream(path, [&](auto& stream) {
+  IO::Disk::withAtomicOutputStream(path, [&](auto& stream) {
     const auto mapFormatName = formatName(world.mapFormat());
     stream << "// Game: " << gameName() << "\n"
            << "// Format: " << mapFormatName << "\n";
 
-    auto writer = IO::NodeWriter{world, stream};
+    auto writer = IO::NodeWriter{world, stream, m_nodeSerializationCache};
     writer.setExporting(exporting);
     writer.writeMap();
   });
@@ -328,6 +335,13 @@ void GameImpl::doLoadTextureCollections(Assets::TextureManager& textureManager)
   textureManager.reload(m_fs, m_config.textureConfig);
 }
 
+void GameImpl::doReloadTextures(
+  Assets::TextureManager& textureManager,
+  const std::vector<std::filesystem::path>& texturePaths) const
+{
+  textureManager.reloadTextures(texturePaths, m_fs, m_config.textureConfig);
+}
+
 void GameImpl::doReloadWads(
   const std::filesystem::path& documentPath,
   const std::vector<std::filesystem::path>& wadPaths,
@@ -346,6 +360,17 @@ void GameImpl::doReloadShaders()
   m_fs.reloadShaders();
 }
 
+std::vector<std::filesystem::path> GameImpl::doArchivePaths() const
+{
+  return m_fs.archivePaths();
+}
+
+std::vector<std::filesystem::path> GameImpl::doReopenArchives(
+  const std::vector<std::filesystem::path>& archivePaths)
+{
+  return m_fs.reopenArchives(archivePaths);
+}
+
 bool GameImpl::doIsEntityDefinitionFile(const std::filesystem::path& path) const
 {
   static const auto extensions = {".fgd", ".def", ".ent"};
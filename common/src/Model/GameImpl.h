@@ -20,6 +20,7 @@
 #pragma once
 
 #include "FloatType.h"
+#include "IO/NodeSerializationCache.h"
 #include "Model/Game.h"
 #include "Model/GameFileSystem.h"
 
@@ -50,6 +51,9 @@ private:
   std::filesystem::path m_gamePath;
   std::vector<std::filesystem::path> m_additionalSearchPaths;
 
+  // the serialized brushes and patches of the last written map
+  mutable IO::NodeSerializationCache m_nodeSerializationCache;
+
 public:
   GameImpl(GameConfig& config, std::filesystem::path gamePath, Logger& logger);
 
@@ -64,6 +68,7 @@ private:
     const std::vector<std::filesystem::path>& searchPaths, Logger& logger) override;
   PathErrors doCheckAdditionalSearchPaths(
     const std::vector<std::filesystem::path>& searchPaths) const override;
+  std::filesystem::path doMakeAbsolute(const std::filesystem::path& path) const override;
 
   const CompilationConfig& doCompilationConfig() override;
 
@@ -108,12 +113,18 @@ private:
     std::ostream& stream) const override;
 
   void doLoadTextureCollections(Assets::TextureManager& textureManager) const override;
+  void doReloadTextures(
+    Assets::TextureManager& textureManager,
+    const std::vector<std::filesystem::path>& texturePaths) const override;
 
   void doReloadWads(
     const std::filesystem::path& documentPath,
     const std::vector<std::filesystem::path>& wadPaths,
     Logger& logger) override;
   void doReloadShaders() override;
+  std::vector<std::filesystem::path> doArchivePaths() const override;
+  std::vector<std::filesystem::path> doReopenArchives(
+    const std::vector<std::filesystem::path>& archivePaths) override;
 
   bool doIsEntityDefinitionFile(const std::filesystem::path& path) const override;
   std::vector<Assets::EntityDefinition*> doLoadEntityDefinitions(
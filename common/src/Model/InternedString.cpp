@@ -0,0 +1,205 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "InternedString.h"
+
+#include <array>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+class StringPool
+{
+private:
+  using Entry = std::pair<const std::string, std::atomic<size_t>>;
+
+  struct Shard
+  {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::atomic<size_t>> entries;
+  };
+
+  static constexpr auto ShardCount = size_t(64);
+  std::array<Shard, ShardCount> m_shards;
+
+public:
+  Entry* acquire(std::string str)
+  {
+    auto& shard = shardFor(str);
+    const auto lock = std::lock_guard<std::mutex>{shard.mutex};
+    auto [it, inserted] = shard.entries.try_emplace(std::move(str), 0);
+    it->second.fetch_add(1, std::memory_order_relaxed);
+    return &*it;
+  }
+
+  void release(Entry* entry)
+  {
+    // as long as other handles remain, the reference count can be decremented without
+    // locking; the count only drops to zero while the lock is held, and a new handle
+    // for the string can only be created while the lock is held, too
+    auto refs = entry->second.load(std::memory_order_relaxed);
+    while (refs > 1)
+    {
+      if (entry->second.compare_exchange_weak(
+            refs, refs - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+      {
+        return;
+      }
+    }
+
+    auto& shard = shardFor(entry->first);
+    const auto lock = std::lock_guard<std::mutex>{shard.mutex};
+    if (entry->second.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      shard.entries.erase(entry->first);
+    }
+  }
+
+  size_t size()
+  {
+    auto result = size_t(0);
+    for (auto& shard : m_shards)
+    {
+      const auto lock = std::lock_guard<std::mutex>{shard.mutex};
+      result += shard.entries.size();
+    }
+    return result;
+  }
+
+private:
+  Shard& shardFor(const std::string& str)
+  {
+    return m_shards[std::hash<std::string>{}(str) % ShardCount];
+  }
+};
+
+StringPool& pool()
+{
+  // never destroyed so that handles with static storage duration can be released
+  static auto* pool = new StringPool{};
+  return *pool;
+}
+
+const std::string& emptyString()
+{
+  static const auto emptyString = std::string{};
+  return emptyString;
+}
+} // namespace
+
+InternedString::InternedString()
+  : m_entry{nullptr}
+{
+}
+
+InternedString::InternedString(std::string str)
+  : m_entry{str.empty() ? nullptr : pool().acquire(std::move(str))}
+{
+}
+
+InternedString::InternedString(const std::string_view str)
+  : InternedString{std::string{str}}
+{
+}
+
+InternedString::InternedString(const char* str)
+  : InternedString{std::string{str}}
+{
+}
+
+InternedString::InternedString(const InternedString& other)
+  : m_entry{other.m_entry}
+{
+  if (m_entry)
+  {
+    m_entry->second.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+InternedString::InternedString(InternedString&& other) noexcept
+  : m_entry{std::exchange(other.m_entry, nullptr)}
+{
+}
+
+InternedString& InternedString::operator=(const InternedString& other)
+{
+  if (m_entry != other.m_entry)
+  {
+    if (other.m_entry)
+    {
+      other.m_entry->second.fetch_add(1, std::memory_order_relaxed);
+    }
+    release();
+    m_entry = other.m_entry;
+  }
+  return *this;
+}
+
+InternedString& InternedString::operator=(InternedString&& other) noexcept
+{
+  if (this != &other)
+  {
+    release();
+    m_entry = std::exchange(other.m_entry, nullptr);
+  }
+  return *this;
+}
+
+InternedString::~InternedString()
+{
+  release();
+}
+
+const std::string& InternedString::str() const
+{
+  return m_entry ? m_entry->first : emptyString();
+}
+
+bool InternedString::empty() const
+{
+  return m_entry == nullptr;
+}
+
+size_t InternedString::poolSize()
+{
+  return pool().size();
+}
+
+std::ostream& operator<<(std::ostream& lhs, const InternedString& rhs)
+{
+  return lhs << rhs.str();
+}
+
+void InternedString::release()
+{
+  if (m_entry)
+  {
+    pool().release(m_entry);
+  }
+}
+
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,126 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+
+/**
+ * A handle to a string that is stored in a global, thread safe pool. Equal strings share
+ * the same storage, so copying, hashing and comparing handles for equality only touches a
+ * pointer. The pool counts the handles that refer to each string and releases a string
+ * when its last handle is destroyed.
+ *
+ * The pool is split into shards that are locked independently, so threads that intern
+ * different strings, e.g. while loading a map, rarely wait for each other.
+ *
+ * The string that a handle refers to never changes, and its address remains stable for as
+ * long as the handle (or a copy of it) exists.
+ */
+class InternedString
+{
+private:
+  using Entry = std::pair<const std::string, std::atomic<size_t>>;
+
+  Entry* m_entry;
+
+public:
+  InternedString();
+  explicit InternedString(std::string str);
+  explicit InternedString(std::string_view str);
+  explicit InternedString(const char* str);
+
+  InternedString(const InternedString& other);
+  InternedString(InternedString&& other) noexcept;
+
+  InternedString& operator=(const InternedString& other);
+  InternedString& operator=(InternedString&& other) noexcept;
+
+  ~InternedString();
+
+  const std::string& str() const;
+  bool empty() const;
+
+  /**
+   * Returns the number of distinct strings that are currently stored in the pool.
+   */
+  static size_t poolSize();
+
+  friend bool operator==(const InternedString& lhs, const InternedString& rhs)
+  {
+    return lhs.m_entry == rhs.m_entry;
+  }
+
+  friend bool operator!=(const InternedString& lhs, const InternedString& rhs)
+  {
+    return lhs.m_entry != rhs.m_entry;
+  }
+
+  // the relational operators compare the strings, not their addresses
+  friend bool operator<(const InternedString& lhs, const InternedString& rhs)
+  {
+    return lhs != rhs && lhs.str() < rhs.str();
+  }
+
+  friend bool operator<=(const InternedString& lhs, const InternedString& rhs)
+  {
+    return !(rhs < lhs);
+  }
+
+  friend bool operator>(const InternedString& lhs, const InternedString& rhs)
+  {
+    return rhs < lhs;
+  }
+
+  friend bool operator>=(const InternedString& lhs, const InternedString& rhs)
+  {
+    return !(lhs < rhs);
+  }
+
+  friend std::ostream& operator<<(std::ostream& lhs, const InternedString& rhs);
+
+private:
+  friend struct std::hash<InternedString>;
+
+  void release();
+};
+
+} // namespace Model
+} // namespace TrenchBroom
+
+namespace std
+{
+template <>
+struct hash<TrenchBroom::Model::InternedString>
+{
+  size_t operator()(const TrenchBroom::Model::InternedString& str) const noexcept
+  {
+    return hash<const void*>{}(str.m_entry);
+  }
+};
+} // namespace std
@@ -69,7 +69,7 @@ IssueQuickFix makeResetTextureScaleQuickFix()
 } // namespace
 
 InvalidTextureScaleValidator::InvalidTextureScaleValidator()
-  : Validator{Type, "Invalid texture scale"}
+  : Validator{Type, "Invalid texture scale", ValidatorDependency::Geometry}
 {
   addQuickFix(makeResetTextureScaleQuickFix());
 }
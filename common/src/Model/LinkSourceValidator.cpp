@@ -39,7 +39,10 @@ static const auto Type = freeIssueType();
 } // namespace
 
 LinkSourceValidator::LinkSourceValidator()
-  : Validator{Type, "Missing entity link source"}
+  : Validator{
+    Type,
+    "Missing entity link source",
+    ValidatorDependency::Properties | ValidatorDependency::Links}
 {
   addQuickFix(makeRemoveEntityPropertiesQuickFix(Type));
 }
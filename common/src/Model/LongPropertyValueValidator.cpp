@@ -59,7 +59,7 @@ IssueQuickFix makeTruncatePropertyValueQuickFix(const size_t maxLength)
 } // namespace
 
 LongPropertyValueValidator::LongPropertyValueValidator(const size_t maxLength)
-  : Validator{Type, "Long entity property value"}
+  : Validator{Type, "Long entity property value", ValidatorDependency::Properties}
   , m_maxLength{maxLength}
 {
   addQuickFix(makeRemoveEntityPropertiesQuickFix(Type));
@@ -39,7 +39,7 @@ static const auto Type = freeIssueType();
 } // namespace
 
 MissingDefinitionValidator::MissingDefinitionValidator()
-  : Validator{Type, "Missing entity definition"}
+  : Validator{Type, "Missing entity definition", ValidatorDependency::Properties}
 {
   addQuickFix(makeDeleteNodesQuickFix());
 }
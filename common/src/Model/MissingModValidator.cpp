@@ -91,7 +91,7 @@ IssueQuickFix makeRemoveModsQuickFix()
 } // namespace
 
 MissingModValidator::MissingModValidator(std::weak_ptr<Game> game)
-  : Validator{Type, "Missing mod directory"}
+  : Validator{Type, "Missing mod directory", ValidatorDependency::Properties}
   , m_game{std::move(game)}
 {
   addQuickFix(makeRemoveModsQuickFix());
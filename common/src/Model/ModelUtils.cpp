@@ -33,8 +33,11 @@
 #include "Polyhedron.h"
 
 #include <kdl/overload.h>
+#include <kdl/parallel.h>
 #include <kdl/vector_utils.h>
 
+#include <algorithm>
+#include <unordered_set>
 #include <vector>
 
 namespace TrenchBroom
@@ -367,6 +370,14 @@ std::vector<Node*> collectNodes(const std::vector<Node*>& nodes)
  * pair of node and brush.
  *
  * The given predicate must be a function that maps a node and a brush to true or false.
+ * It must only return true if the logical bounds of the node intersect the bounds of the
+ * brush. This allows to discard most nodes using their bounds only: For a world, only the
+ * nodes found in its spatial index are considered, and the rest of the world is not
+ * visited. All other nodes are tested against the brush bounds. The predicate is then
+ * evaluated in parallel for the remaining candidates.
+ *
+ * The nodes of a world are returned in no particular order, all other nodes are returned
+ * in the order in which they were visited.
  */
 template <typename P>
 static std::vector<Node*> collectMatchingNodes(
@@ -374,15 +385,62 @@ static std::vector<Node*> collectMatchingNodes(
   const std::vector<BrushNode*>& brushes,
   const P& predicate)
 {
-  auto result = std::vector<Model::Node*>{};
+  const auto brushBounds =
+    kdl::vec_transform(brushes, [](const auto* brush) { return brush->logicalBounds(); });
+  const auto queryBrushes =
+    std::unordered_set<const Node*>{brushes.begin(), brushes.end()};
+
+  const auto intersectsAnyBrush = [&](const vm::bbox3& bounds) {
+    return std::any_of(brushBounds.begin(), brushBounds.end(), [&](const auto& b) {
+      return b.intersects(bounds);
+    });
+  };
+
+  auto candidates = std::vector<Node*>{};
+
+  // This also computes the logical bounds of every candidate, which are cached lazily by
+  // some nodes, so the predicate can safely be evaluated in parallel afterwards.
+  const auto addIfCandidate = [&](auto* node) {
+    if (intersectsAnyBrush(node->logicalBounds()))
+    {
+      candidates.push_back(node);
+    }
+  };
+
+  const auto addCandidatesFromIndex = [&](WorldNode* world) {
+    auto intersectingNodes = std::vector<Node*>{};
+    for (const auto& bounds : brushBounds)
+    {
+      world->findNodesIntersecting(bounds, intersectingNodes);
+    }
 
-  const auto collectIfMatching = [&](auto* node) {
-    for (const auto* brush : brushes)
+    // a node can intersect several brushes, and the nodes in a closed group are only
+    // considered as part of the group
+    auto visitedNodes = std::unordered_set<const Node*>{};
+    for (auto* node : intersectingNodes)
     {
-      if (predicate(node, brush))
+      auto* closedGroup = findOutermostClosedGroup(node);
+      auto* candidate = closedGroup ? closedGroup : node;
+      if (visitedNodes.insert(candidate).second)
       {
-        result.push_back(node);
-        return;
+        candidate->accept(kdl::overload(
+          [](WorldNode*) {},
+          [](LayerNode*) {},
+          [&](GroupNode* group) { addIfCandidate(group); },
+          [&](EntityNode* entity) {
+            if (!entity->hasChildren())
+            {
+              addIfCandidate(entity);
+            }
+          },
+          [&](BrushNode* brush) {
+            // if `brush` is one of the search query nodes, don't count it as touching
+            if (queryBrushes.count(brush) == 0)
+            {
+              addIfCandidate(brush);
+            }
+          },
+          [&](PatchNode* patch) { addIfCandidate(patch); }));
       }
     }
   };
@@ -390,8 +448,7 @@ static std::vector<Node*> collectMatchingNodes(
   for (auto* node : nodes)
   {
     node->accept(kdl::overload(
-      [](
-        auto&& thisLambda, Model::WorldNode* world) { world->visitChildren(thisLambda); },
+      [&](Model::WorldNode* world) { addCandidatesFromIndex(world); },
       [](
         auto&& thisLambda, Model::LayerNode* layer) { layer->visitChildren(thisLambda); },
       [&](auto&& thisLambda, Model::GroupNode* group) {
@@ -401,7 +458,7 @@ static std::vector<Node*> collectMatchingNodes(
         }
         else
         {
-          collectIfMatching(group);
+          addIfCandidate(group);
         }
       },
       [&](auto&& thisLambda, Model::EntityNode* entity) {
@@ -411,22 +468,37 @@ static std::vector<Node*> collectMatchingNodes(
         }
         else
         {
-          collectIfMatching(entity);
+          addIfCandidate(entity);
         }
       },
       [&](Model::BrushNode* brush) {
         // if `brush` is one of the search query nodes, don't count it as touching
-        if (!kdl::vec_contains(brushes, brush))
+        if (queryBrushes.count(brush) == 0)
         {
-          collectIfMatching(brush);
+          addIfCandidate(brush);
         }
       },
       [&](Model::PatchNode* patch) {
         // if `patch` is one of the search query nodes, don't count it as touching
-        collectIfMatching(patch);
+        addIfCandidate(patch);
       }));
   }
 
+  const auto matches = kdl::vec_parallel_transform(candidates, [&](const auto* node) {
+    return std::any_of(brushes.begin(), brushes.end(), [&](const auto* brush) {
+      return predicate(node, brush);
+    });
+  });
+
+  auto result = std::vector<Model::Node*>{};
+  for (size_t i = 0; i < candidates.size(); ++i)
+  {
+    if (matches[i])
+    {
+      result.push_back(candidates[i]);
+    }
+  }
+
   return result;
 }
 
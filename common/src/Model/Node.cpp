@@ -24,14 +24,18 @@
 #include "Model/EntityProperties.h"
 #include "Model/Issue.h"
 #include "Model/LockState.h"
+#include "Model/PickResult.h"
 #include "Model/Validator.h"
 #include "Model/VisibilityState.h"
+#include "octree.h"
 
 #include <kdl/reflection_impl.h>
 #include <kdl/vector_utils.h>
 
 #include <vecmath/bbox.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iterator>
 #include <ostream>
@@ -45,6 +49,16 @@ namespace Model
 
 kdl_reflect_impl(NodePath);
 
+namespace
+{
+size_t nextRevision()
+{
+  // nodes are created by multiple threads when a map is loaded
+  static auto revision = std::atomic<size_t>{0};
+  return ++revision;
+}
+} // namespace
+
 Node::Node()
   : m_parent{nullptr}
   , m_descendantCount{0}
@@ -56,7 +70,9 @@ Node::Node()
   , m_lockedByOtherSelection{false}
   , m_lineNumber{0}
   , m_lineCount{0}
-  , m_issuesValid{false}
+  , m_revision{nextRevision()}
+  , m_validIssueTypes{0}
+  , m_invalidDependencies{ValidatorDependency::None}
   , m_hiddenIssues{0}
 {
 }
@@ -397,7 +413,7 @@ void Node::descendantWasAdded(Node* node, const size_t depth)
   {
     m_parent->descendantWasAdded(node, depth + 1);
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Hierarchy);
 }
 
 void Node::descendantWillBeRemoved(Node* node, const size_t depth)
@@ -416,7 +432,7 @@ void Node::descendantWasRemoved(Node* oldParent, Node* node, const size_t depth)
   {
     m_parent->descendantWasRemoved(oldParent, node, depth + 1);
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Hierarchy);
 }
 
 void Node::incDescendantCount(const size_t delta)
@@ -479,7 +495,7 @@ void Node::ancestorWillChange()
   {
     child->ancestorWillChange();
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Hierarchy);
 }
 
 void Node::ancestorDidChange()
@@ -489,36 +505,39 @@ void Node::ancestorDidChange()
   {
     child->ancestorDidChange();
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Hierarchy);
 }
 
-void Node::nodeWillChange()
+void Node::nodeWillChange(const ValidatorDependency::Type dependencies)
 {
   if (m_parent != nullptr)
   {
     m_parent->childWillChange(this);
   }
-  invalidateIssues();
+  invalidateIssues(dependencies);
 }
 
-void Node::nodeDidChange()
+void Node::nodeDidChange(const ValidatorDependency::Type dependencies)
 {
+  updateRevision();
   if (m_parent != nullptr)
   {
     m_parent->childDidChange(this);
   }
-  invalidateIssues();
+  invalidateIssues(dependencies);
 }
 
-Node::NotifyNodeChange::NotifyNodeChange(Node& node)
+Node::NotifyNodeChange::NotifyNodeChange(
+  Node& node, const ValidatorDependency::Type dependencies)
   : m_node{node}
+  , m_dependencies{dependencies}
 {
-  m_node.nodeWillChange();
+  m_node.nodeWillChange(m_dependencies);
 }
 
 Node::NotifyNodeChange::~NotifyNodeChange()
 {
-  m_node.nodeDidChange();
+  m_node.nodeDidChange(m_dependencies);
 }
 
 Node::NotifyPhysicalBoundsChange::NotifyPhysicalBoundsChange(Node& node)
@@ -559,7 +578,7 @@ void Node::descendantWillChange(Node* node)
   {
     m_parent->descendantWillChange(node);
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Hierarchy);
 }
 
 void Node::descendantDidChange(Node* node)
@@ -569,7 +588,7 @@ void Node::descendantDidChange(Node* node)
   {
     m_parent->descendantDidChange(node);
   }
-  invalidateIssues();
+  invalidateIssues(ValidatorDependency::Hierarchy);
 }
 
 void Node::childPhysicalBoundsDidChange(Node* node)
@@ -829,11 +848,31 @@ void Node::pick(
   doPick(editorContext, ray, pickResult);
 }
 
+void Node::pick(
+  const EditorContext& editorContext,
+  const std::vector<vm::ray3>& rays,
+  std::vector<PickResult>& pickResults)
+{
+  ensure(pickResults.size() == rays.size(), "one pick result per ray");
+  doPickRays(editorContext, rays, pickResults);
+}
+
 void Node::findNodesContaining(const vm::vec3& point, std::vector<Node*>& result)
 {
   doFindNodesContaining(point, result);
 }
 
+void Node::findNodesIntersecting(const vm::bbox3& bounds, std::vector<Node*>& result)
+{
+  doFindNodesIntersecting(bounds, result);
+}
+
+void Node::findNodesIntersecting(
+  const std::vector<vm::plane3>& planes, std::vector<Node*>& result)
+{
+  doFindNodesIntersecting(planes, result);
+}
+
 size_t Node::lineNumber() const
 {
   return m_lineNumber;
@@ -850,6 +889,16 @@ bool Node::containsLine(const size_t lineNumber) const
   return lineNumber >= m_lineNumber && lineNumber < m_lineNumber + m_lineCount;
 }
 
+size_t Node::revision() const
+{
+  return m_revision;
+}
+
+void Node::updateRevision()
+{
+  m_revision = nextRevision();
+}
+
 std::vector<const Issue*> Node::issues(const std::vector<const Validator*>& validators)
 {
   validateIssues(validators);
@@ -857,6 +906,11 @@ std::vector<const Issue*> Node::issues(const std::vector<const Validator*>& vali
     m_issues, [](const auto& issue) { return const_cast<const Issue*>(issue.get()); });
 }
 
+bool Node::issuesValid(const std::vector<const Validator*>& validators) const
+{
+  return invalidIssueTypes(validators) == 0;
+}
+
 bool Node::issueHidden(const IssueType type) const
 {
   return (type & m_hiddenIssues) != 0;
@@ -874,22 +928,54 @@ void Node::setIssueHidden(const IssueType type, const bool hidden)
   }
 }
 
+IssueType Node::invalidIssueTypes(const std::vector<const Validator*>& validators) const
+{
+  auto validatorTypes = IssueType{0};
+  auto invalidTypes = IssueType{0};
+  for (const auto* validator : validators)
+  {
+    validatorTypes |= validator->type();
+    if (
+      (m_validIssueTypes & validator->type()) == 0
+      || (m_invalidDependencies & validator->dependencies()) != 0)
+    {
+      invalidTypes |= validator->type();
+    }
+  }
+
+  // the issues of validators that are no longer given must be dropped
+  return invalidTypes | (m_validIssueTypes & ~validatorTypes);
+}
+
 void Node::validateIssues(const std::vector<const Validator*>& validators)
 {
-  if (!m_issuesValid)
+  const auto invalidTypes = invalidIssueTypes(validators);
+  if (invalidTypes != 0)
   {
+    m_issues = kdl::vec_erase_if(std::move(m_issues), [&](const auto& issue) {
+      return (issue->type() & invalidTypes) != 0;
+    });
+
     for (const auto* validator : validators)
     {
-      validator->validate(*this, m_issues);
+      if ((validator->type() & invalidTypes) != 0)
+      {
+        validator->validate(*this, m_issues);
+      }
     }
-    m_issuesValid = true;
   }
+
+  m_validIssueTypes = 0;
+  for (const auto* validator : validators)
+  {
+    m_validIssueTypes |= validator->type();
+  }
+  m_invalidDependencies = ValidatorDependency::None;
 }
 
-void Node::invalidateIssues() const
+void Node::invalidateIssues(const ValidatorDependency::Type dependencies) const
 {
-  m_issues.clear();
-  m_issuesValid = false;
+  m_invalidDependencies |= dependencies;
 }
 
 const EntityPropertyConfig& Node::entityPropertyConfig() const
@@ -914,13 +1000,13 @@ void Node::findEntityNodesWithNumberedProperty(
 }
 
 void Node::addToIndex(
-  EntityNodeBase* node, const std::string& key, const std::string& value)
+  EntityNodeBase* node, const InternedString& key, const InternedString& value)
 {
   doAddToIndex(node, key, value);
 }
 
 void Node::removeFromIndex(
-  EntityNodeBase* node, const std::string& key, const std::string& value)
+  EntityNodeBase* node, const InternedString& key, const InternedString& value)
 {
   doRemoveFromIndex(node, key, value);
 }
@@ -962,6 +1048,45 @@ void Node::doChildDidChange(Node* /* node */) {}
 void Node::doDescendantWillChange(Node* /* node */) {}
 void Node::doDescendantDidChange(Node* /* node */) {}
 
+void Node::doPickRays(
+  const EditorContext& editorContext,
+  const std::vector<vm::ray3>& rays,
+  std::vector<PickResult>& pickResults)
+{
+  for (size_t i = 0; i < rays.size(); ++i)
+  {
+    doPick(editorContext, rays[i], pickResults[i]);
+  }
+}
+
+void Node::doFindNodesIntersecting(const vm::bbox3& bounds, std::vector<Node*>& result)
+{
+  if (shouldAddToSpacialIndex() && physicalBounds().intersects(bounds))
+  {
+    result.push_back(this);
+  }
+  for (auto* child : m_children)
+  {
+    child->findNodesIntersecting(bounds, result);
+  }
+}
+
+void Node::doFindNodesIntersecting(
+  const std::vector<vm::plane3>& planes, std::vector<Node*>& result)
+{
+  const auto isAbove = [&](const auto& plane) {
+    return detail::is_above(physicalBounds(), plane);
+  };
+  if (shouldAddToSpacialIndex() && std::none_of(planes.begin(), planes.end(), isAbove))
+  {
+    result.push_back(this);
+  }
+  for (auto* child : m_children)
+  {
+    child->findNodesIntersecting(planes, result);
+  }
+}
+
 const EntityPropertyConfig& Node::doGetEntityPropertyConfig() const
 {
   if (m_parent != nullptr)
@@ -996,7 +1121,7 @@ void Node::doFindEntityNodesWithNumberedProperty(
 }
 
 void Node::doAddToIndex(
-  EntityNodeBase* node, const std::string& key, const std::string& value)
+  EntityNodeBase* node, const InternedString& key, const InternedString& value)
 {
   if (m_parent != nullptr)
   {
@@ -1005,7 +1130,7 @@ void Node::doAddToIndex(
 }
 
 void Node::doRemoveFromIndex(
-  EntityNodeBase* node, const std::string& key, const std::string& value)
+  EntityNodeBase* node, const InternedString& key, const InternedString& value)
 {
   if (m_parent != nullptr)
   {
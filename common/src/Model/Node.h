@@ -23,6 +23,7 @@
 #include "Model/IssueType.h"
 #include "Model/NodeVisitor.h"
 #include "Model/Tag.h"
+#include "Model/ValidatorDependency.h"
 
 #include <kdl/reflection_decl.h>
 
@@ -41,6 +42,7 @@ namespace Model
 class EditorContext;
 class EntityNodeBase;
 struct EntityPropertyConfig;
+class InternedString;
 class ConstNodeVisitor;
 class Issue;
 enum class LockState;
@@ -74,8 +76,11 @@ private:
   mutable size_t m_lineNumber;
   mutable size_t m_lineCount;
 
+  size_t m_revision;
+
   mutable std::vector<std::unique_ptr<Issue>> m_issues;
-  mutable bool m_issuesValid;
+  mutable IssueType m_validIssueTypes;
+  mutable ValidatorDependency::Type m_invalidDependencies;
   IssueType m_hiddenIssues;
 
 protected:
@@ -274,15 +279,21 @@ protected: // notification for parents
   {
   private:
     Node& m_node;
+    ValidatorDependency::Type m_dependencies;
 
   public:
-    explicit NotifyNodeChange(Node& node);
+    /**
+     * The given dependencies specify which aspects of the node will change so that only
+     * the affected issues of the node are invalidated.
+     */
+    explicit NotifyNodeChange(
+      Node& node, ValidatorDependency::Type dependencies = ValidatorDependency::All);
     ~NotifyNodeChange();
   };
 
   // call these methods via the NotifyNodeChange class, it's much safer
-  void nodeWillChange();
-  void nodeDidChange();
+  void nodeWillChange(ValidatorDependency::Type dependencies);
+  void nodeDidChange(ValidatorDependency::Type dependencies);
 
   friend class NotifyPhysicalBoundsChange;
   class NotifyPhysicalBoundsChange
@@ -365,23 +376,75 @@ public: // visibility, locking
 
 public: // picking
   void pick(const EditorContext& editorContext, const vm::ray3& ray, PickResult& result);
+
+  /**
+   * Picks all of the given rays at once. The given pick results must contain one pick
+   * result for each ray, and the hits of each ray are added to its pick result.
+   */
+  void pick(
+    const EditorContext& editorContext,
+    const std::vector<vm::ray3>& rays,
+    std::vector<PickResult>& pickResults);
+
   void findNodesContaining(const vm::vec3& point, std::vector<Node*>& result);
 
+  /**
+   * Finds the nodes in this subtree that are stored in the spatial index and whose
+   * physical bounds intersect with the given bounds.
+   */
+  void findNodesIntersecting(const vm::bbox3& bounds, std::vector<Node*>& result);
+
+  /**
+   * Finds the nodes in this subtree that are stored in the spatial index and whose
+   * physical bounds intersect with the convex volume bounded by the given planes, such as
+   * a view frustum. The plane normals must point out of the volume.
+   *
+   * The test is conservative: a node is only rejected if its physical bounds lie entirely
+   * above one of the planes.
+   */
+  void findNodesIntersecting(
+    const std::vector<vm::plane3>& planes, std::vector<Node*>& result);
+
 public: // file position
   size_t lineNumber() const;
   void setFilePosition(size_t lineNumber, size_t lineCount) const;
   bool containsLine(size_t lineNumber) const;
 
+public: // revision
+  /**
+   * Returns the revision of this node. A node receives a new revision when it is created
+   * and whenever it changes. Revisions are never reused, not even by other nodes, so a
+   * revision identifies the contents of a node. This is used to cache data derived from a
+   * node, such as its serialization.
+   */
+  size_t revision() const;
+
+protected:
+  void updateRevision();
+
 public: // issue management
   std::vector<const Issue*> issues(const std::vector<const Validator*>& validators);
 
+  /**
+   * Indicates whether the issues of this node are up to date with respect to the given
+   * validators, i.e., whether requesting the issues would not run any validator.
+   */
+  bool issuesValid(const std::vector<const Validator*>& validators) const;
+
   bool issueHidden(IssueType type) const;
   void setIssueHidden(IssueType type, bool hidden);
 
 public: // should only be called from this and from the world
-  void invalidateIssues() const;
+  /**
+   * Invalidates the issues of this node that were found by validators which depend on
+   * any of the given aspects of this node. These validators are run again when the issues
+   * of this node are requested for the next time.
+   */
+  void invalidateIssues(
+    ValidatorDependency::Type dependencies = ValidatorDependency::All) const;
 
 private:
+  IssueType invalidIssueTypes(const std::vector<const Validator*>& validators) const;
   void validateIssues(const std::vector<const Validator*>& validators);
 
 public: // visitors
@@ -522,9 +585,10 @@ protected: // index management
     const std::string& value,
     std::vector<EntityNodeBase*>& result) const;
 
-  void addToIndex(EntityNodeBase* node, const std::string& key, const std::string& value);
+  void addToIndex(
+    EntityNodeBase* node, const InternedString& key, const InternedString& value);
   void removeFromIndex(
-    EntityNodeBase* node, const std::string& key, const std::string& value);
+    EntityNodeBase* node, const InternedString& key, const InternedString& value);
 
 private: // subclassing interface
   virtual const std::string& doGetName() const = 0;
@@ -572,6 +636,14 @@ private: // subclassing interface
     const EditorContext& editorContext, const vm::ray3& ray, PickResult& pickResult) = 0;
   virtual void doFindNodesContaining(
     const vm::vec3& point, std::vector<Node*>& result) = 0;
+  virtual void doPickRays(
+    const EditorContext& editorContext,
+    const std::vector<vm::ray3>& rays,
+    std::vector<PickResult>& pickResults);
+  virtual void doFindNodesIntersecting(
+    const vm::bbox3& bounds, std::vector<Node*>& result);
+  virtual void doFindNodesIntersecting(
+    const std::vector<vm::plane3>& planes, std::vector<Node*>& result);
 
   virtual void doAccept(NodeVisitor& visitor) = 0;
   virtual void doAccept(ConstNodeVisitor& visitor) const = 0;
@@ -588,9 +660,9 @@ private: // subclassing interface
     std::vector<EntityNodeBase*>& result) const;
 
   virtual void doAddToIndex(
-    EntityNodeBase* node, const std::string& key, const std::string& value);
+    EntityNodeBase* node, const InternedString& key, const InternedString& value);
   virtual void doRemoveFromIndex(
-    EntityNodeBase* node, const std::string& key, const std::string& value);
+    EntityNodeBase* node, const InternedString& key, const InternedString& value);
 };
 } // namespace Model
 } // namespace TrenchBroom
@@ -0,0 +1,472 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NodeContentsDelta.h"
+
+#include "Model/BezierPatch.h"
+#include "Model/Brush.h"
+#include "Model/BrushError.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushGeometry.h"
+#include "Model/BrushNode.h"
+#include "Model/Entity.h"
+#include "Model/EntityNode.h"
+#include "Model/Group.h"
+#include "Model/GroupNode.h"
+#include "Model/Layer.h"
+#include "Model/LayerNode.h"
+#include "Model/NodeContents.h"
+#include "Model/ParallelTexCoordSystem.h"
+#include "Model/PatchNode.h"
+#include "Model/TexCoordSystem.h"
+#include "Model/WorldNode.h"
+#include "Polyhedron.h"
+
+#include <kdl/overload.h>
+#include <kdl/result.h>
+
+#include <vecmath/mat_ext.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+size_t estimateMemoryUsage(const std::string& str)
+{
+  // short strings are stored inline
+  return sizeof(std::string) + (str.capacity() > 15u ? str.capacity() : 0u);
+}
+
+size_t estimateMemoryUsage(const EntityProperty&)
+{
+  // the key and value are interned and usually shared with the map
+  return sizeof(EntityProperty);
+}
+
+size_t estimateMemoryUsage(const std::vector<EntityProperty>& properties)
+{
+  auto result = size_t(0);
+  for (const auto& property : properties)
+  {
+    result += estimateMemoryUsage(property);
+  }
+  return result;
+}
+
+size_t estimateMemoryUsage(const std::vector<std::string>& strings)
+{
+  auto result = size_t(0);
+  for (const auto& str : strings)
+  {
+    result += estimateMemoryUsage(str);
+  }
+  return result;
+}
+
+size_t estimateMemoryUsage(const BrushFaceAttributes& attributes)
+{
+  return sizeof(BrushFaceAttributes) - sizeof(std::string)
+         + estimateMemoryUsage(attributes.textureName());
+}
+
+size_t estimateMemoryUsage(const Brush& brush)
+{
+  auto result = sizeof(Brush) + sizeof(BrushGeometry);
+  for (const auto& face : brush.faces())
+  {
+    result += sizeof(BrushFace) - sizeof(BrushFaceAttributes)
+              + estimateMemoryUsage(face.attributes()) + sizeof(ParallelTexCoordSystem)
+              + sizeof(BrushFaceGeometry);
+  }
+  result += brush.vertexCount() * sizeof(BrushVertex);
+  result += brush.edgeCount() * (sizeof(BrushEdge) + 2u * sizeof(BrushHalfEdge));
+  return result;
+}
+
+size_t estimateMemoryUsage(const Layer& layer)
+{
+  return sizeof(Layer) + estimateMemoryUsage(layer.name());
+}
+
+size_t estimateMemoryUsage(const Group& group)
+{
+  return sizeof(Group) + estimateMemoryUsage(group.name());
+}
+
+size_t estimateMemoryUsage(const Entity& entity)
+{
+  return sizeof(Entity) + estimateMemoryUsage(entity.properties())
+         + estimateMemoryUsage(entity.protectedProperties());
+}
+
+size_t estimateMemoryUsage(const BezierPatch& patch)
+{
+  return sizeof(BezierPatch) + patch.controlPoints().size() * sizeof(BezierPatch::Point)
+         + estimateMemoryUsage(patch.textureName());
+}
+
+bool identicalFaces(const BrushFace& lhs, const BrushFace& rhs)
+{
+  return lhs.points() == rhs.points() && lhs.boundary() == rhs.boundary()
+         && lhs.attributes() == rhs.attributes()
+         && lhs.texCoordSystem() == rhs.texCoordSystem();
+}
+
+bool identicalBrushes(const Brush& lhs, const Brush& rhs)
+{
+  return lhs.faceCount() == rhs.faceCount()
+         && std::equal(
+           lhs.faces().begin(), lhs.faces().end(), rhs.faces().begin(), identicalFaces);
+}
+
+bool identicalEntities(const Entity& lhs, const Entity& rhs)
+{
+  return lhs.properties() == rhs.properties()
+         && lhs.protectedProperties() == rhs.protectedProperties()
+         && lhs.pointEntity() == rhs.pointEntity();
+}
+
+bool identicalContents(const NodeContents& lhs, const NodeContents& rhs)
+{
+  return std::visit(
+    kdl::overload(
+      [](const Entity& lhsEntity, const Entity& rhsEntity) {
+        return identicalEntities(lhsEntity, rhsEntity);
+      },
+      [](const Brush& lhsBrush, const Brush& rhsBrush) {
+        return identicalBrushes(lhsBrush, rhsBrush);
+      },
+      [](const auto&, const auto&) { return false; }),
+    lhs.get(),
+    rhs.get());
+}
+
+std::optional<BrushTransformation> invert(const BrushTransformation& brushTransformation)
+{
+  const auto [invertible, inverse] = vm::invert(brushTransformation.transformation);
+  if (invertible)
+  {
+    return BrushTransformation{
+      brushTransformation.worldBounds, inverse, brushTransformation.lockTextures};
+  }
+  return std::nullopt;
+}
+
+bool recreatesFacePoints(
+  const Brush& brush, const vm::mat4x4& transformation, const Brush& expected)
+{
+  return brush.faceCount() == expected.faceCount()
+         && std::equal(
+           brush.faces().begin(),
+           brush.faces().end(),
+           expected.faces().begin(),
+           [&](const auto& face, const auto& expectedFace) {
+             return face.transformedPoints(transformation) == expectedFace.points();
+           });
+}
+} // namespace
+
+std::optional<BrushTransformation> composeBrushTransformations(
+  const BrushTransformation& first, const BrushTransformation& second)
+{
+  if (
+    first.worldBounds == second.worldBounds && first.lockTextures == second.lockTextures)
+  {
+    return BrushTransformation{
+      first.worldBounds,
+      second.transformation * first.transformation,
+      first.lockTextures};
+  }
+  return std::nullopt;
+}
+
+template <typename T>
+NodeContentsDelta::NodeContentsDelta(T delta)
+  : m_delta{std::move(delta)}
+{
+}
+
+std::optional<NodeContentsDelta> NodeContentsDelta::create(
+  const NodeContents& currentContents,
+  const NodeContents& snapshot,
+  const EntityPropertyConfig& propertyConfig,
+  const std::optional<BrushTransformation>& brushTransformation)
+{
+  auto delta = std::visit(
+    kdl::overload(
+      [](const Entity& currentEntity, const Entity& snapshotEntity)
+        -> std::optional<NodeContentsDelta> {
+        if (currentEntity.pointEntity() != snapshotEntity.pointEntity())
+        {
+          return std::nullopt;
+        }
+
+        const auto& currentProperties = currentEntity.properties();
+        const auto& snapshotProperties = snapshotEntity.properties();
+
+        // store the range of properties that differ from the current properties
+        const auto maxLength =
+          std::min(currentProperties.size(), snapshotProperties.size());
+        auto prefixLength = size_t(0);
+        while (prefixLength < maxLength
+               && currentProperties[prefixLength] == snapshotProperties[prefixLength])
+        {
+          ++prefixLength;
+        }
+
+        auto suffixLength = size_t(0);
+        while (prefixLength + suffixLength < maxLength
+               && currentProperties[currentProperties.size() - suffixLength - 1u]
+                    == snapshotProperties[snapshotProperties.size() - suffixLength - 1u])
+        {
+          ++suffixLength;
+        }
+
+        auto properties = std::vector<EntityProperty>(
+          std::next(snapshotProperties.begin(), long(prefixLength)),
+          std::prev(snapshotProperties.end(), long(suffixLength)));
+        auto protectedProperties =
+          currentEntity.protectedProperties() != snapshotEntity.protectedProperties()
+            ? std::optional{snapshotEntity.protectedProperties()}
+            : std::nullopt;
+
+        return NodeContentsDelta{PropertiesDelta{
+          prefixLength,
+          suffixLength,
+          std::move(properties),
+          std::move(protectedProperties)}};
+      },
+      [&](const Brush& currentBrush, const Brush& snapshotBrush)
+        -> std::optional<NodeContentsDelta> {
+        if (brushTransformation)
+        {
+          // The current brush was created by transforming the snapshot. Transforming the
+          // face points is much cheaper than transforming the brushes, and the geometry
+          // is determined by the face points, so we only check that the transformations
+          // recreate the face points exactly. The texture attributes are trusted to
+          // follow the transformation.
+          if (const auto inverseTransformation = invert(*brushTransformation))
+          {
+            if (
+              recreatesFacePoints(
+                currentBrush, inverseTransformation->transformation, snapshotBrush)
+              && recreatesFacePoints(
+                snapshotBrush, brushTransformation->transformation, currentBrush))
+            {
+              return NodeContentsDelta{
+                TransformationDelta{*inverseTransformation, *brushTransformation}};
+            }
+          }
+          return std::nullopt;
+        }
+
+        if (currentBrush.faceCount() != snapshotBrush.faceCount())
+        {
+          return std::nullopt;
+        }
+
+        auto faces = std::vector<FaceDelta>{};
+        for (size_t i = 0; i < currentBrush.faceCount(); ++i)
+        {
+          const auto& currentFace = currentBrush.face(i);
+          const auto& snapshotFace = snapshotBrush.face(i);
+          if (
+            currentFace.points() != snapshotFace.points()
+            || currentFace.boundary() != snapshotFace.boundary())
+          {
+            // the geometry was changed
+            return std::nullopt;
+          }
+
+          if (
+            currentFace.attributes() != snapshotFace.attributes()
+            || currentFace.texCoordSystem() != snapshotFace.texCoordSystem())
+          {
+            faces.push_back(FaceDelta{
+              i, snapshotFace.attributes(), snapshotFace.takeTexCoordSystemSnapshot()});
+          }
+        }
+
+        return NodeContentsDelta{FaceAttributesDelta{std::move(faces)}};
+      },
+      [](const auto&, const auto&) -> std::optional<NodeContentsDelta> {
+        return std::nullopt;
+      }),
+    currentContents.get(),
+    snapshot.get());
+
+  if (!delta || std::holds_alternative<TransformationDelta>(delta->m_delta))
+  {
+    return delta;
+  }
+
+  // only use the delta if it recreates the snapshot exactly
+  const auto recreatesSnapshot =
+    delta->apply(currentContents, propertyConfig)
+      .transform([&](const auto& restoredContents) {
+        return identicalContents(restoredContents, snapshot);
+      })
+      .value_or(false);
+  if (!recreatesSnapshot)
+  {
+    return std::nullopt;
+  }
+
+  return delta;
+}
+
+NodeContentsDelta::~NodeContentsDelta() = default;
+
+NodeContentsDelta::NodeContentsDelta(NodeContentsDelta&& other) noexcept = default;
+NodeContentsDelta& NodeContentsDelta::operator=(
+  NodeContentsDelta&& other) noexcept = default;
+
+kdl::result<NodeContents, BrushError> NodeContentsDelta::apply(
+  NodeContents currentContents, const EntityPropertyConfig& propertyConfig) const
+{
+  return std::visit(
+    kdl::overload(
+      [&](const PropertiesDelta& delta) -> kdl::result<NodeContents, BrushError> {
+        auto& entity = std::get<Entity>(currentContents.get());
+        const auto& currentProperties = entity.properties();
+
+        auto properties = std::vector<EntityProperty>{};
+        properties.reserve(
+          delta.prefixLength + delta.properties.size() + delta.suffixLength);
+
+        const auto prefixEnd =
+          std::next(currentProperties.begin(), long(delta.prefixLength));
+        const auto suffixBegin =
+          std::prev(currentProperties.end(), long(delta.suffixLength));
+
+        properties.insert(properties.end(), currentProperties.begin(), prefixEnd);
+        properties.insert(
+          properties.end(), delta.properties.begin(), delta.properties.end());
+        properties.insert(properties.end(), suffixBegin, currentProperties.end());
+
+        entity.setProperties(propertyConfig, std::move(properties));
+        if (delta.protectedProperties)
+        {
+          entity.setProtectedProperties(*delta.protectedProperties);
+        }
+        return std::move(currentContents);
+      },
+      [&](const FaceAttributesDelta& delta) -> kdl::result<NodeContents, BrushError> {
+        auto& brush = std::get<Brush>(currentContents.get());
+        for (const auto& faceDelta : delta.faces)
+        {
+          auto& face = brush.face(faceDelta.faceIndex);
+          face.setAttributes(faceDelta.attributes);
+          if (faceDelta.texCoordSystemSnapshot)
+          {
+            face.restoreTexCoordSystemSnapshot(*faceDelta.texCoordSystemSnapshot);
+          }
+        }
+        return std::move(currentContents);
+      },
+      [&](const TransformationDelta& delta) -> kdl::result<NodeContents, BrushError> {
+        auto& brush = std::get<Brush>(currentContents.get());
+        return brush
+          .transform(
+            delta.transformation.worldBounds,
+            delta.transformation.transformation,
+            delta.transformation.lockTextures)
+          .transform([&]() { return std::move(currentContents); });
+      }),
+    m_delta);
+}
+
+std::optional<NodeContentsDelta> NodeContentsDelta::inverse() const
+{
+  if (const auto* delta = std::get_if<TransformationDelta>(&m_delta))
+  {
+    return NodeContentsDelta{
+      TransformationDelta{delta->inverseTransformation, delta->transformation}};
+  }
+  return std::nullopt;
+}
+
+size_t NodeContentsDelta::memoryUsage() const
+{
+  return sizeof(NodeContentsDelta)
+         + std::visit(
+           kdl::overload(
+             [](const PropertiesDelta& delta) {
+               return estimateMemoryUsage(delta.properties)
+                      + (delta.protectedProperties
+                           ? estimateMemoryUsage(*delta.protectedProperties)
+                           : size_t(0));
+             },
+             [](const FaceAttributesDelta& delta) {
+               auto result = size_t(0);
+               for (const auto& faceDelta : delta.faces)
+               {
+                 result += sizeof(FaceDelta) - sizeof(BrushFaceAttributes)
+                           + estimateMemoryUsage(faceDelta.attributes)
+                           + (faceDelta.texCoordSystemSnapshot
+                                ? sizeof(ParallelTexCoordSystemSnapshot)
+                                : size_t(0));
+               }
+               return result;
+             },
+             [](const TransformationDelta&) { return size_t(0); }),
+           m_delta);
+}
+
+size_t memoryUsage(const NodeContents& contents)
+{
+  return std::visit(
+    [](const auto& value) { return estimateMemoryUsage(value); }, contents.get());
+}
+
+size_t memoryUsage(const Node& node)
+{
+  auto result = size_t(0);
+  node.accept(kdl::overload(
+    [&](auto&& thisLambda, const WorldNode* worldNode) {
+      result += sizeof(WorldNode) + estimateMemoryUsage(worldNode->entity());
+      worldNode->visitChildren(thisLambda);
+    },
+    [&](auto&& thisLambda, const LayerNode* layerNode) {
+      result += sizeof(LayerNode) + estimateMemoryUsage(layerNode->layer());
+      layerNode->visitChildren(thisLambda);
+    },
+    [&](auto&& thisLambda, const GroupNode* groupNode) {
+      result += sizeof(GroupNode) + estimateMemoryUsage(groupNode->group());
+      groupNode->visitChildren(thisLambda);
+    },
+    [&](auto&& thisLambda, const EntityNode* entityNode) {
+      result += sizeof(EntityNode) + estimateMemoryUsage(entityNode->entity());
+      entityNode->visitChildren(thisLambda);
+    },
+    [&](const BrushNode* brushNode) {
+      result += sizeof(BrushNode) + estimateMemoryUsage(brushNode->brush());
+    },
+    [&](const PatchNode* patchNode) {
+      result += sizeof(PatchNode) + estimateMemoryUsage(patchNode->patch());
+    }));
+  return result;
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,169 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FloatType.h"
+#include "Model/BrushFaceAttributes.h"
+#include "Model/EntityProperties.h"
+
+#include <kdl/result_forward.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+enum class BrushError;
+class Node;
+class NodeContents;
+class TexCoordSystemSnapshot;
+
+/**
+ * Describes a transformation that was applied to brushes using Brush::transform.
+ */
+struct BrushTransformation
+{
+  vm::bbox3 worldBounds;
+  vm::mat4x4 transformation;
+  bool lockTextures;
+};
+
+/**
+ * Returns a brush transformation that has the same effect as applying the given first
+ * and then the given second transformation, or an empty optional if the transformations
+ * differ in their world bounds or in whether they lock textures.
+ */
+std::optional<BrushTransformation> composeBrushTransformations(
+  const BrushTransformation& first, const BrushTransformation& second);
+
+/**
+ * A compact replacement for a node contents snapshot.
+ *
+ * A delta is created from the current contents of a node and a snapshot of the contents
+ * that the node should receive later, e.g. when a command is undone. Applying the delta
+ * to the current contents recreates the snapshot. Deltas exist for the most common
+ * changes:
+ *
+ * - changes to some of the properties of an entity,
+ * - changes to the attributes of some faces of a brush whose geometry is unchanged,
+ * - a rigid transformation of a brush.
+ *
+ * A delta is only created if applying it recreates the snapshot exactly. For a
+ * transformation, only the face points are checked, and the texture attributes are
+ * assumed to follow the transformation.
+ */
+class NodeContentsDelta
+{
+private:
+  struct PropertiesDelta
+  {
+    size_t prefixLength;
+    size_t suffixLength;
+    std::vector<EntityProperty> properties;
+    std::optional<std::vector<std::string>> protectedProperties;
+  };
+
+  struct FaceDelta
+  {
+    size_t faceIndex;
+    BrushFaceAttributes attributes;
+    std::unique_ptr<TexCoordSystemSnapshot> texCoordSystemSnapshot;
+  };
+
+  struct FaceAttributesDelta
+  {
+    std::vector<FaceDelta> faces;
+  };
+
+  struct TransformationDelta
+  {
+    BrushTransformation transformation;
+    BrushTransformation inverseTransformation;
+  };
+
+  std::variant<PropertiesDelta, FaceAttributesDelta, TransformationDelta> m_delta;
+
+public:
+  /**
+   * Creates a delta that recreates the given snapshot from the given current contents.
+   *
+   * If the given brush transformation is not empty, then it is assumed that the current
+   * contents were created by applying it to the snapshot, and a transformation delta is
+   * attempted for brushes.
+   *
+   * Returns an empty optional if no delta can recreate the snapshot exactly.
+   */
+  static std::optional<NodeContentsDelta> create(
+    const NodeContents& currentContents,
+    const NodeContents& snapshot,
+    const EntityPropertyConfig& propertyConfig,
+    const std::optional<BrushTransformation>& brushTransformation = std::nullopt);
+
+  ~NodeContentsDelta();
+
+  NodeContentsDelta(NodeContentsDelta&& other) noexcept;
+  NodeContentsDelta& operator=(NodeContentsDelta&& other) noexcept;
+
+  /**
+   * Recreates the snapshot from the given current contents. The given contents must be
+   * the contents that this delta was created from.
+   *
+   * Returns an error if a transformed brush cannot be recreated.
+   */
+  kdl::result<NodeContents, BrushError> apply(
+    NodeContents currentContents, const EntityPropertyConfig& propertyConfig) const;
+
+  /**
+   * Returns a delta that recreates the current contents from the snapshot, if such a
+   * delta is known without comparing the contents again.
+   */
+  std::optional<NodeContentsDelta> inverse() const;
+
+  /**
+   * Returns an estimate of the memory used by this delta in bytes.
+   */
+  size_t memoryUsage() const;
+
+private:
+  template <typename T>
+  explicit NodeContentsDelta(T delta);
+};
+
+/**
+ * Returns an estimate of the memory used by the given node contents in bytes.
+ */
+size_t memoryUsage(const NodeContents& contents);
+
+/**
+ * Returns an estimate of the memory used by the given node and its descendants in bytes.
+ */
+size_t memoryUsage(const Node& node);
+
+} // namespace Model
+} // namespace TrenchBroom
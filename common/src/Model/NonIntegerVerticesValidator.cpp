@@ -45,7 +45,7 @@ IssueQuickFix makeSnapVerticesQuickFix()
 } // namespace
 
 NonIntegerVerticesValidator::NonIntegerVerticesValidator()
-  : Validator(Type, "Non-integer vertices")
+  : Validator(Type, "Non-integer vertices", ValidatorDependency::Geometry)
 {
   addQuickFix(makeSnapVerticesQuickFix());
 }
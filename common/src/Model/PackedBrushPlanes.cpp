@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PackedBrushPlanes.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushFace.h"
+
+#include <vecmath/plane.h>
+#include <vecmath/ray.h>
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+PackedBrushPlanes::PackedBrushPlanes()
+  : m_planeCount{0}
+{
+}
+
+PackedBrushPlanes::PackedBrushPlanes(const Brush& brush)
+  : m_planeCount{brush.faceCount()}
+  , m_components(4 * m_planeCount)
+{
+  for (size_t i = 0; i < m_planeCount; ++i)
+  {
+    const auto& plane = brush.face(i).boundary();
+    m_components[i] = plane.normal.x();
+    m_components[i + m_planeCount] = plane.normal.y();
+    m_components[i + 2 * m_planeCount] = plane.normal.z();
+    m_components[i + 3 * m_planeCount] = plane.distance;
+  }
+}
+
+size_t PackedBrushPlanes::planeCount() const
+{
+  return m_planeCount;
+}
+
+std::optional<std::tuple<FloatType, size_t>> PackedBrushPlanes::intersectWithRay(
+  const vm::ray3& ray) const
+{
+  const auto* normalX = m_components.data();
+  const auto* normalY = normalX + m_planeCount;
+  const auto* normalZ = normalY + m_planeCount;
+  const auto* distance = normalZ + m_planeCount;
+
+  const auto dirX = ray.direction.x();
+  const auto dirY = ray.direction.y();
+  const auto dirZ = ray.direction.z();
+  const auto originX = ray.origin.x();
+  const auto originY = ray.origin.y();
+  const auto originZ = ray.origin.z();
+
+  // rays that are almost parallel to a plane are not considered to intersect it, see
+  // vm::intersect_ray_plane
+  constexpr auto epsilon = vm::constants<FloatType>::almost_zero();
+  constexpr auto infinity = std::numeric_limits<FloatType>::infinity();
+
+  const auto cosAt = [&](const size_t i) {
+    return normalX[i] * dirX + normalY[i] * dirY + normalZ[i] * dirZ;
+  };
+  const auto depthAt = [&](const size_t i) {
+    return distance[i]
+           - (normalX[i] * originX + normalY[i] * originY + normalZ[i] * originZ);
+  };
+
+  // This loop has no early exits and no data dependent branches so that it can be
+  // vectorized. The division yields infinity or nan if the ray is parallel to a plane,
+  // but the result is discarded in that case.
+  auto enter = -infinity;
+  auto exit = infinity;
+  auto outside = false;
+  for (size_t i = 0; i < m_planeCount; ++i)
+  {
+    const auto cos = cosAt(i);
+    const auto depth = depthAt(i);
+    const auto t = depth / cos;
+    enter = cos < -epsilon ? std::max(enter, t) : enter;
+    exit = cos > epsilon ? std::min(exit, t) : exit;
+    outside = outside | (cos >= -epsilon && cos <= epsilon && depth < -epsilon);
+  }
+
+  if (outside || enter < -epsilon || enter > exit + epsilon)
+  {
+    return std::nullopt;
+  }
+
+  // find the plane through which the ray enters; if it enters through an edge or a
+  // vertex, the plane with the lowest index wins
+  auto enterIndex = m_planeCount;
+  auto enterDistance = -infinity;
+  for (size_t i = 0; i < m_planeCount; ++i)
+  {
+    const auto cos = cosAt(i);
+    if (cos < -epsilon)
+    {
+      const auto t = depthAt(i) / cos;
+      if (t > enterDistance)
+      {
+        enterDistance = t;
+        enterIndex = i;
+      }
+    }
+  }
+
+  return std::make_tuple(enterDistance, enterIndex);
+}
+
+} // namespace Model
+} // namespace TrenchBroom
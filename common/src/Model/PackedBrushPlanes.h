@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FloatType.h"
+
+#include <vecmath/forward.h>
+
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+class Brush;
+
+/**
+ * Stores the face planes of a brush as a structure of arrays so that a ray can be tested
+ * against all planes at once.
+ *
+ * The plane components are stored consecutively, i.e., first the X components of all
+ * plane normals, then the Y components, the Z components, and finally the plane
+ * distances. This lets the compiler vectorize the loop over the planes.
+ */
+class PackedBrushPlanes
+{
+private:
+  size_t m_planeCount;
+  std::vector<FloatType> m_components;
+
+public:
+  PackedBrushPlanes();
+  explicit PackedBrushPlanes(const Brush& brush);
+
+  size_t planeCount() const;
+
+  /**
+   * Intersects the given ray with the convex volume bounded by the planes.
+   *
+   * The ray is clipped against every plane: planes facing the ray limit the distance at
+   * which it enters the volume from below, and planes facing away from the ray limit the
+   * distance at which it exits the volume from above. The ray hits the volume if it
+   * enters before it exits.
+   *
+   * Returns the distance at which the ray enters the volume and the index of the plane
+   * through which it enters, or nullopt if the ray misses the volume or starts inside of
+   * it. Hits that graze an edge or a vertex are reported, so callers that need exact
+   * results must check the returned face.
+   */
+  std::optional<std::tuple<FloatType, size_t>> intersectWithRay(
+    const vm::ray3& ray) const;
+};
+
+} // namespace Model
+} // namespace TrenchBroom
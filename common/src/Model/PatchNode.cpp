@@ -334,7 +334,7 @@ const BezierPatch& PatchNode::patch() const
 
 BezierPatch PatchNode::setPatch(BezierPatch patch)
 {
-  const auto nodeChange = NotifyNodeChange{*this};
+  const auto nodeChange = NotifyNodeChange{*this, ValidatorDependency::Geometry};
   const auto boundsChange = NotifyPhysicalBoundsChange{*this};
 
   auto previousPatch = std::exchange(m_patch, std::move(patch));
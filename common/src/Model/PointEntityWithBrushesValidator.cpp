@@ -66,7 +66,10 @@ IssueQuickFix makeMoveBrushesToWorldQuickFix()
 } // namespace
 
 PointEntityWithBrushesValidator::PointEntityWithBrushesValidator()
-  : Validator{Type, "Point entity with brushes"}
+  : Validator{
+    Type,
+    "Point entity with brushes",
+    ValidatorDependency::Properties | ValidatorDependency::Hierarchy}
 {
   addQuickFix(makeMoveBrushesToWorldQuickFix());
 }
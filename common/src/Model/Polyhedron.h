@@ -1561,6 +1561,18 @@ private:
    */
   void updateBounds();
 
+public: // Translation
+  /**
+   * Translates every vertex of this polyhedron by the given delta. This does not change
+   * the topology of this polyhedron, so all vertices, edges and faces and their payloads
+   * are retained.
+   *
+   * Updates the bounds of this polyhedron afterwards.
+   *
+   * @param delta the delta by which to translate
+   */
+  void translate(const vm::vec<T, 3>& delta);
+
 public: // Vertex correction and edge healing
   /**
    * Rounds each component of position of every vertex to the nearest integer if the
@@ -822,6 +822,16 @@ void Polyhedron<T, FP, VP>::updateBounds()
   }
 }
 
+template <typename T, typename FP, typename VP>
+void Polyhedron<T, FP, VP>::translate(const vm::vec<T, 3>& delta)
+{
+  for (auto* vertex : m_vertices)
+  {
+    vertex->setPosition(vertex->position() + delta);
+  }
+  updateBounds();
+}
+
 template <typename T, typename FP, typename VP>
 void Polyhedron<T, FP, VP>::correctVertexPositions(const size_t decimals, const T epsilon)
 {
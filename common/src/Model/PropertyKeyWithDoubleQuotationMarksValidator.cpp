@@ -41,7 +41,7 @@ static const auto Type = freeIssueType();
 
 PropertyKeyWithDoubleQuotationMarksValidator::
   PropertyKeyWithDoubleQuotationMarksValidator()
-  : Validator{Type, "Invalid entity property keys"}
+  : Validator{Type, "Invalid entity property keys", ValidatorDependency::Properties}
 {
   addQuickFix(makeRemoveEntityPropertiesQuickFix(Type));
   addQuickFix(makeTransformEntityPropertiesQuickFix(
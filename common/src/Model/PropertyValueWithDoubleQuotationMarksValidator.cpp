@@ -41,7 +41,7 @@ static const auto Type = freeIssueType();
 
 PropertyValueWithDoubleQuotationMarksValidator::
   PropertyValueWithDoubleQuotationMarksValidator()
-  : Validator{Type, "Invalid entity property values"}
+  : Validator{Type, "Invalid entity property values", ValidatorDependency::Properties}
 {
   addQuickFix(makeRemoveEntityPropertiesQuickFix(Type));
   addQuickFix(makeTransformEntityPropertiesQuickFix(
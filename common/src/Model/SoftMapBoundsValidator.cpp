@@ -59,7 +59,11 @@ void validateInternal(
 
 SoftMapBoundsValidator::SoftMapBoundsValidator(
   std::weak_ptr<Game> game, const WorldNode& world)
-  : Validator(Type, "Objects out of soft map bounds")
+  : Validator(
+    Type,
+    "Objects out of soft map bounds",
+    ValidatorDependency::Properties | ValidatorDependency::Geometry
+    | ValidatorDependency::Hierarchy)
   , m_game{game}
   , m_world{world}
 {
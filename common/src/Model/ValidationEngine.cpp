@@ -0,0 +1,182 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ValidationEngine.h"
+
+#include "Model/BrushNode.h"
+#include "Model/EntityNode.h"
+#include "Model/GroupNode.h"
+#include "Model/LayerNode.h"
+#include "Model/PatchNode.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/parallel.h>
+#include <kdl/vector_utils.h>
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+ValidationEngine::ValidationEngine(const size_t batchSize)
+  : m_batchSize{std::max(batchSize, size_t(1))}
+  , m_nextNode{0}
+{
+}
+
+void ValidationEngine::reset(WorldNode& worldNode)
+{
+  reset();
+  schedule({&worldNode});
+}
+
+void ValidationEngine::reset()
+{
+  m_pendingNodes.clear();
+  m_nextNode = 0;
+  m_scheduledNodes.clear();
+}
+
+namespace
+{
+template <typename F>
+void visitNodesAndDescendants(const std::vector<Node*>& nodes, const F& f)
+{
+  for (auto* node : nodes)
+  {
+    node->accept([&](auto&& thisLambda, Node* descendant) {
+      f(descendant);
+      descendant->visitChildren(thisLambda);
+    });
+  }
+}
+} // namespace
+
+void ValidationEngine::schedule(const std::vector<Node*>& nodes)
+{
+  visitNodesAndDescendants(nodes, [&](Node* node) {
+    if (m_scheduledNodes.insert(node).second)
+    {
+      m_pendingNodes.push_back(node);
+    }
+  });
+}
+
+void ValidationEngine::scheduleInvalidNodes(
+  const std::vector<Node*>& nodes, const std::vector<const Validator*>& validators)
+{
+  for (auto* node : nodes)
+  {
+    // changing a node can invalidate the issues of its ancestors, too
+    for (auto* ancestor = node; ancestor != nullptr; ancestor = ancestor->parent())
+    {
+      if (!ancestor->issuesValid(validators) && m_scheduledNodes.insert(ancestor).second)
+      {
+        m_pendingNodes.push_back(ancestor);
+      }
+    }
+  }
+}
+
+void ValidationEngine::unschedule(const std::vector<Node*>& nodes)
+{
+  auto removedNodes = std::unordered_set<Node*>{};
+  visitNodesAndDescendants(nodes, [&](Node* node) {
+    if (m_scheduledNodes.erase(node) > 0)
+    {
+      removedNodes.insert(node);
+    }
+  });
+
+  if (!removedNodes.empty())
+  {
+    m_pendingNodes.erase(
+      m_pendingNodes.begin(),
+      std::next(m_pendingNodes.begin(), static_cast<std::ptrdiff_t>(m_nextNode)));
+    m_nextNode = 0;
+    m_pendingNodes = kdl::vec_erase_if(std::move(m_pendingNodes), [&](auto* node) {
+      return removedNodes.count(node) > 0;
+    });
+  }
+}
+
+bool ValidationEngine::done() const
+{
+  return m_nextNode == m_pendingNodes.size();
+}
+
+size_t ValidationEngine::pendingNodeCount() const
+{
+  return m_pendingNodes.size() - m_nextNode;
+}
+
+std::vector<Node*> ValidationEngine::nextBatch() const
+{
+  return kdl::vec_slice(
+    m_pendingNodes, m_nextNode, std::min(m_batchSize, pendingNodeCount()));
+}
+
+std::vector<const Issue*> ValidationEngine::validateNextBatch(
+  const std::vector<const Validator*>& validators)
+{
+  const auto batchSize = std::min(m_batchSize, pendingNodeCount());
+  auto batch = kdl::vec_slice(m_pendingNodes, m_nextNode, batchSize);
+  m_nextNode += batchSize;
+
+  for (auto* node : batch)
+  {
+    m_scheduledNodes.erase(node);
+  }
+
+  // Some nodes compute and cache their bounds lazily, and computing the bounds of a node
+  // may compute the bounds of its descendants, so we must do this before validating
+  // concurrently.
+  for (const auto* node : batch)
+  {
+    node->logicalBounds();
+  }
+
+  const auto issuesPerNode = kdl::vec_parallel_transform(
+    std::move(batch), [&](Node* node) { return node->issues(validators); });
+
+  auto result = std::vector<const Issue*>{};
+  for (const auto& issues : issuesPerNode)
+  {
+    result.insert(result.end(), issues.begin(), issues.end());
+  }
+  return result;
+}
+
+std::vector<const Issue*> ValidationEngine::validateAll(
+  const std::vector<const Validator*>& validators)
+{
+  auto result = std::vector<const Issue*>{};
+  while (!done())
+  {
+    auto issues = validateNextBatch(validators);
+    result.insert(result.end(), issues.begin(), issues.end());
+  }
+  return result;
+}
+} // namespace Model
+} // namespace TrenchBroom
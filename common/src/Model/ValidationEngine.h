@@ -0,0 +1,113 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace Model
+{
+class Issue;
+class Node;
+class Validator;
+class WorldNode;
+
+/**
+ * Validates the nodes of a world in batches.
+ *
+ * The nodes of each batch are validated in parallel using the default thread pool. A node
+ * only runs those validators again whose dependencies were invalidated since the node was
+ * last validated, and callers pass the changed nodes to the engine instead of letting it
+ * search the world for them, so validating a world after a small change is cheap. Since
+ * the issues are returned per batch, callers can publish them incrementally while the
+ * remaining batches are validated, e.g. between the events of the UI thread.
+ *
+ * The nodes must not be modified while a batch is being validated, and nodes that are
+ * removed from the world must be unscheduled before they are destroyed.
+ */
+class ValidationEngine
+{
+public:
+  static constexpr auto DefaultBatchSize = size_t(4096);
+
+private:
+  size_t m_batchSize;
+  std::vector<Node*> m_pendingNodes;
+  size_t m_nextNode;
+  std::unordered_set<Node*> m_scheduledNodes;
+
+public:
+  explicit ValidationEngine(size_t batchSize = DefaultBatchSize);
+
+  /**
+   * Schedules all nodes of the given world for validation and discards all previously
+   * pending nodes.
+   */
+  void reset(WorldNode& worldNode);
+
+  /**
+   * Discards all pending nodes.
+   */
+  void reset();
+
+  /**
+   * Schedules the given nodes and their descendants for validation unless they are
+   * already pending.
+   */
+  void schedule(const std::vector<Node*>& nodes);
+
+  /**
+   * Schedules those of the given nodes and their ancestors for validation whose issues are
+   * not up to date with respect to the given validators unless they are already pending.
+   * Only these nodes are visited, so this is cheap if few nodes have changed.
+   */
+  void scheduleInvalidNodes(
+    const std::vector<Node*>& nodes, const std::vector<const Validator*>& validators);
+
+  /**
+   * Removes the given nodes and their descendants from the pending nodes.
+   */
+  void unschedule(const std::vector<Node*>& nodes);
+
+  bool done() const;
+  size_t pendingNodeCount() const;
+
+  /**
+   * Returns the nodes that are validated by the next call to validateNextBatch.
+   */
+  std::vector<Node*> nextBatch() const;
+
+  /**
+   * Validates the next batch of pending nodes using the given validators and returns the
+   * issues of the validated nodes in the order in which the nodes were scheduled.
+   */
+  std::vector<const Issue*> validateNextBatch(
+    const std::vector<const Validator*>& validators);
+
+  /**
+   * Validates all pending nodes using the given validators and returns their issues.
+   */
+  std::vector<const Issue*> validateAll(const std::vector<const Validator*>& validators);
+};
+} // namespace Model
+} // namespace TrenchBroom
@@ -21,6 +21,7 @@
 
 #include "Model/IssueQuickFix.h"
 #include "Model/IssueType.h"
+#include "Model/ValidatorDependency.h"
 
 #include <memory>
 #include <string>
@@ -45,6 +46,7 @@ class Validator
 private:
   IssueType m_type;
   std::string m_description;
+  ValidatorDependency::Type m_dependencies;
   std::vector<IssueQuickFix> m_quickFixes;
 
 public:
@@ -52,12 +54,16 @@ public:
 
   IssueType type() const;
   const std::string& description() const;
+  ValidatorDependency::Type dependencies() const;
   std::vector<const IssueQuickFix*> quickFixes() const;
 
   void validate(Node& node, std::vector<std::unique_ptr<Issue>>& issues) const;
 
 protected:
-  Validator(IssueType type, const std::string& description);
+  Validator(
+    IssueType type,
+    const std::string& description,
+    ValidatorDependency::Type dependencies = ValidatorDependency::All);
   void addQuickFix(IssueQuickFix quickFix);
 
 private:
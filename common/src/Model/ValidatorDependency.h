@@ -0,0 +1,51 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace TrenchBroom
+{
+namespace Model
+{
+/**
+ * The aspects of a node that a validator inspects. When a node changes, only those of
+ * its issues are invalidated which were found by a validator that depends on the changed
+ * aspects.
+ */
+namespace ValidatorDependency
+{
+using Type = unsigned int;
+constexpr Type None = 0u;
+
+/** The entity properties and the entity definition of an entity node. */
+constexpr Type Properties = 1u << 0;
+
+/** The geometry and the face attributes of a brush node or a patch node. */
+constexpr Type Geometry = 1u << 1;
+
+/** The parent and the children of a node. */
+constexpr Type Hierarchy = 1u << 2;
+
+/** The link sources and link targets of an entity node. */
+constexpr Type Links = 1u << 3;
+
+constexpr Type All = ~None;
+} // namespace ValidatorDependency
+} // namespace Model
+} // namespace TrenchBroom
@@ -48,7 +48,11 @@ void validateInternal(
 } // namespace
 
 WorldBoundsValidator::WorldBoundsValidator(const vm::bbox3& bounds)
-  : Validator{Type, "Objects out of world bounds"}
+  : Validator{
+    Type,
+    "Objects out of world bounds",
+    ValidatorDependency::Properties | ValidatorDependency::Geometry
+    | ValidatorDependency::Hierarchy}
   , m_bounds{bounds}
 {
   addQuickFix(makeDeleteNodesQuickFix());
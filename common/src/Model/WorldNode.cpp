@@ -22,30 +22,42 @@
 #include "Ensure.h"
 #include "Model/BrushFace.h"
 #include "Model/BrushNode.h"
+#include "Model/EditorContext.h"
 #include "Model/EntityNode.h"
 #include "Model/EntityNodeIndex.h"
 #include "Model/GroupNode.h"
 #include "Model/LayerNode.h"
 #include "Model/PatchNode.h"
+#include "Model/PickResult.h"
 #include "Model/TagVisitor.h"
 #include "Model/Validator.h"
 #include "Model/ValidatorRegistry.h"
-#include "octree.h"
+#include "flat_octree.h"
 
 #include <kdl/overload.h>
+#include <kdl/parallel.h>
 #include <kdl/result.h>
 #include <kdl/vector_utils.h>
 
 #include <vecmath/bbox_io.h>
 
+#include <algorithm>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom
 {
 namespace Model
 {
+namespace
+{
+// picking the candidates of a single ray in parallel only pays off for long lists
+constexpr auto ParallelPickThreshold = size_t(512);
+} // namespace
+
 WorldNode::WorldNode(
   EntityPropertyConfig entityPropertyConfig, Entity entity, const MapFormat mapFormat)
   : m_entityPropertyConfig{std::move(entityPropertyConfig)}
@@ -248,11 +260,8 @@ void WorldNode::rebuildNodeTree()
     [&](BrushNode* brush) { addNode(brush); },
     [&](PatchNode* patch) { addNode(patch); }));
 
-  m_nodeTree->clear();
-  for (auto* node : nodes)
-  {
-    m_nodeTree->insert(node->physicalBounds(), node);
-  }
+  m_nodeTree->build(kdl::vec_transform(
+    nodes, [](auto* node) { return std::make_pair(node->physicalBounds(), node); }));
 }
 
 void WorldNode::invalidateAllIssues()
@@ -446,9 +455,53 @@ bool WorldNode::doSelectable() const
 void WorldNode::doPick(
   const EditorContext& editorContext, const vm::ray3& ray, PickResult& pickResult)
 {
-  for (auto* node : m_nodeTree->find_intersectors(ray))
+  const auto candidates = m_nodeTree->find_intersectors(ray);
+
+  // with a single worker thread, the pool would just compete with the calling thread
+  auto& pool = kdl::default_thread_pool();
+  if (candidates.size() < ParallelPickThreshold || pool.thread_count() < 2)
+  {
+    for (auto* node : candidates)
+    {
+      node->pick(editorContext, ray, pickResult);
+    }
+    return;
+  }
+
+  // The editor context is not thread safe, so the visibility of the brushes is checked
+  // here. Only the ray intersections with the visible brushes are computed in parallel,
+  // all other nodes are picked right away.
+  const auto pickNode = [&](Node* node) { node->pick(editorContext, ray, pickResult); };
+
+  auto brushNodes = std::vector<BrushNode*>{};
+  brushNodes.reserve(candidates.size());
+  for (auto* node : candidates)
+  {
+    node->accept(kdl::overload(
+      [&](WorldNode* worldNode) { pickNode(worldNode); },
+      [&](LayerNode* layerNode) { pickNode(layerNode); },
+      [&](GroupNode* groupNode) { pickNode(groupNode); },
+      [&](EntityNode* entityNode) { pickNode(entityNode); },
+      [&](BrushNode* brushNode) {
+        if (editorContext.visible(brushNode))
+        {
+          brushNodes.push_back(brushNode);
+        }
+      },
+      [&](PatchNode* patchNode) { pickNode(patchNode); }));
+  }
+
+  auto hits = std::vector<std::optional<Hit>>(brushNodes.size());
+  kdl::parallel_for(pool, brushNodes.size(), [&](const size_t i) {
+    hits[i] = brushNodes[i]->findHit(ray);
+  });
+
+  for (const auto& hit : hits)
   {
-    node->pick(editorContext, ray, pickResult);
+    if (hit)
+    {
+      pickResult.addHit(*hit);
+    }
   }
 }
 
@@ -460,6 +513,43 @@ void WorldNode::doFindNodesContaining(const vm::vec3& point, std::vector<Node*>&
   }
 }
 
+void WorldNode::doPickRays(
+  const EditorContext& editorContext,
+  const std::vector<vm::ray3>& rays,
+  std::vector<PickResult>& pickResults)
+{
+  m_nodeTree->visit_intersectors(rays, [&](const size_t i, Node* node) {
+    node->pick(editorContext, rays[i], pickResults[i]);
+  });
+}
+
+void WorldNode::doFindNodesIntersecting(
+  const vm::bbox3& bounds, std::vector<Node*>& result)
+{
+  for (auto* node : m_nodeTree->find_overlapping(bounds))
+  {
+    if (node->physicalBounds().intersects(bounds))
+    {
+      result.push_back(node);
+    }
+  }
+}
+
+void WorldNode::doFindNodesIntersecting(
+  const std::vector<vm::plane3>& planes, std::vector<Node*>& result)
+{
+  for (auto* node : m_nodeTree->find_overlapping(planes))
+  {
+    const auto isAbove = [&](const auto& plane) {
+      return detail::is_above(node->physicalBounds(), plane);
+    };
+    if (std::none_of(planes.begin(), planes.end(), isAbove))
+    {
+      result.push_back(node);
+    }
+  }
+}
+
 void WorldNode::doAccept(NodeVisitor& visitor)
 {
   visitor.visit(this);
@@ -496,13 +586,13 @@ void WorldNode::doFindEntityNodesWithNumberedProperty(
 }
 
 void WorldNode::doAddToIndex(
-  EntityNodeBase* node, const std::string& key, const std::string& value)
+  EntityNodeBase* node, const InternedString& key, const InternedString& value)
 {
   m_entityNodeIndex->addProperty(node, key, value);
 }
 
 void WorldNode::doRemoveFromIndex(
-  EntityNodeBase* node, const std::string& key, const std::string& value)
+  EntityNodeBase* node, const InternedString& key, const InternedString& value)
 {
   m_entityNodeIndex->removeProperty(node, key, value);
 }
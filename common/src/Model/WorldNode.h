@@ -36,7 +36,7 @@
 namespace TrenchBroom
 {
 template <typename T, typename U>
-class octree;
+class flat_octree;
 
 namespace Model
 {
@@ -56,7 +56,7 @@ private:
   std::unique_ptr<EntityNodeIndex> m_entityNodeIndex;
   std::unique_ptr<ValidatorRegistry> m_validatorRegistry;
 
-  using NodeTree = octree<FloatType, Node*>;
+  using NodeTree = flat_octree<FloatType, Node*>;
   std::unique_ptr<NodeTree> m_nodeTree;
   bool m_updateNodeTree;
 
@@ -166,6 +166,14 @@ private: // implement Node interface
     const vm::ray3& ray,
     PickResult& pickResult) override;
   void doFindNodesContaining(const vm::vec3& point, std::vector<Node*>& result) override;
+  void doPickRays(
+    const EditorContext& editorContext,
+    const std::vector<vm::ray3>& rays,
+    std::vector<PickResult>& pickResults) override;
+  void doFindNodesIntersecting(
+    const vm::bbox3& bounds, std::vector<Node*>& result) override;
+  void doFindNodesIntersecting(
+    const std::vector<vm::plane3>& planes, std::vector<Node*>& result) override;
   void doAccept(NodeVisitor& visitor) override;
   void doAccept(ConstNodeVisitor& visitor) const override;
   const EntityPropertyConfig& doGetEntityPropertyConfig() const override;
@@ -178,9 +186,13 @@ private: // implement Node interface
     const std::string& value,
     std::vector<EntityNodeBase*>& result) const override;
   void doAddToIndex(
-    EntityNodeBase* node, const std::string& key, const std::string& value) override;
+    EntityNodeBase* node,
+    const InternedString& key,
+    const InternedString& value) override;
   void doRemoveFromIndex(
-    EntityNodeBase* node, const std::string& key, const std::string& value) override;
+    EntityNodeBase* node,
+    const InternedString& key,
+    const InternedString& value) override;
 
 private: // implement EntityNodeBase interface
   void doPropertiesDidChange(const vm::bbox3& oldBounds) override;
@@ -187,6 +187,7 @@ Preference<Color> GridColor2D("Rendere/Grid/Color2D", Color(0.8f, 0.8f, 0.8f, 0.
 Preference<int> TextureMinFilter("Renderer/Texture mode min filter", 0x2700);
 Preference<int> TextureMagFilter("Renderer/Texture mode mag filter", 0x2600);
 Preference<bool> EnableMSAA("Renderer/Enable multisampling", true);
+Preference<bool> EnableTextureCache("Renderer/Enable texture cache", true);
 
 Preference<bool> TextureLock("Editor/Texture lock", true);
 Preference<bool> UVLock("Editor/UV lock", false);
@@ -382,6 +383,7 @@ const std::vector<PreferenceBase*>& staticPreferences()
     &GridColor2D,
     &TextureMinFilter,
     &TextureMagFilter,
+    &EnableTextureCache,
     &TextureLock,
     &UVLock,
     &RendererFontPath(),
@@ -641,6 +641,8 @@ void MapRenderer::connectObservers()
     this, &MapRenderer::nodeVisibilityDidChange);
   m_notifierConnection += document->nodeLockingDidChangeNotifier.connect(
     this, &MapRenderer::nodeLockingDidChange);
+  m_notifierConnection += document->entityModelsDidChangeNotifier.connect(
+    this, &MapRenderer::entityModelsDidChange);
   m_notifierConnection +=
     document->groupWasOpenedNotifier.connect(this, &MapRenderer::groupWasOpened);
   m_notifierConnection +=
@@ -730,6 +732,14 @@ void MapRenderer::nodeLockingDidChange(const std::vector<Model::Node*>& nodes)
   invalidateEntityLinkRenderer();
 }
 
+void MapRenderer::entityModelsDidChange(const std::vector<Model::Node*>& nodes)
+{
+  for (auto* node : nodes)
+  {
+    updateAndInvalidateNode(node);
+  }
+}
+
 void MapRenderer::groupWasOpened(Model::GroupNode*)
 {
   invalidateGroupLinkRenderer();
@@ -141,6 +141,7 @@ private: // notification
 
   void nodeVisibilityDidChange(const std::vector<Model::Node*>& nodes);
   void nodeLockingDidChange(const std::vector<Model::Node*>& nodes);
+  void entityModelsDidChange(const std::vector<Model::Node*>& nodes);
 
   void groupWasOpened(Model::GroupNode* group);
   void groupWasClosed(Model::GroupNode* group);
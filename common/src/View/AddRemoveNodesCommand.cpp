@@ -22,6 +22,7 @@
 #include "Ensure.h"
 #include "Macros.h"
 #include "Model/Node.h"
+#include "Model/NodeContentsDelta.h"
 #include "Model/UpdateLinkedGroupsError.h"
 #include "View/MapDocumentCommandFacade.h"
 
@@ -65,6 +66,7 @@ AddRemoveNodesCommand::AddRemoveNodesCommand(
   const Action action, const std::map<Model::Node*, std::vector<Model::Node*>>& nodes)
   : UpdateLinkedGroupsCommandBase{makeName(action), true}
   , m_action{action}
+  , m_memoryUsage{0}
 {
   switch (m_action)
   {
@@ -104,6 +106,11 @@ std::unique_ptr<CommandResult> AddRemoveNodesCommand::doPerformUndo(
   return std::make_unique<CommandResult>(true);
 }
 
+size_t AddRemoveNodesCommand::doGetMemoryUsage() const
+{
+  return UpdateLinkedGroupsCommandBase::doGetMemoryUsage() + m_memoryUsage;
+}
+
 void AddRemoveNodesCommand::doAction(MapDocumentCommandFacade* document)
 {
   switch (m_action)
@@ -118,6 +125,7 @@ void AddRemoveNodesCommand::doAction(MapDocumentCommandFacade* document)
 
   using std::swap;
   swap(m_nodesToAdd, m_nodesToRemove);
+  updateMemoryUsage();
 }
 
 void AddRemoveNodesCommand::undoAction(MapDocumentCommandFacade* document)
@@ -134,6 +142,19 @@ void AddRemoveNodesCommand::undoAction(MapDocumentCommandFacade* document)
 
   using std::swap;
   swap(m_nodesToAdd, m_nodesToRemove);
+  updateMemoryUsage();
+}
+void AddRemoveNodesCommand::updateMemoryUsage()
+{
+  // the nodes to add are owned by this command
+  m_memoryUsage = 0;
+  for (const auto& [parent, children] : m_nodesToAdd)
+  {
+    for (const auto* child : children)
+    {
+      m_memoryUsage += Model::memoryUsage(*child);
+    }
+  }
 }
 } // namespace View
 } // namespace TrenchBroom
@@ -47,6 +47,7 @@ private:
   Action m_action;
   std::map<Model::Node*, std::vector<Model::Node*>> m_nodesToAdd;
   std::map<Model::Node*, std::vector<Model::Node*>> m_nodesToRemove;
+  size_t m_memoryUsage;
 
 public:
   static std::unique_ptr<AddRemoveNodesCommand> add(
@@ -67,8 +68,11 @@ private:
   std::unique_ptr<CommandResult> doPerformUndo(
     MapDocumentCommandFacade* document) override;
 
+  size_t doGetMemoryUsage() const override;
+
   void doAction(MapDocumentCommandFacade* document);
   void undoAction(MapDocumentCommandFacade* document);
+  void updateMemoryUsage();
 
   deleteCopyAndMove(AddRemoveNodesCommand);
 };
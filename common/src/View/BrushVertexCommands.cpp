@@ -48,7 +48,8 @@ std::unique_ptr<CommandResult> BrushVertexCommandBase::createCommandResult(
 }
 
 static auto collectBrushNodes(
-  const std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes)
+  const std::vector<std::pair<Model::Node*, SwapNodeContentsCommand::ContentsOrDelta>>&
+    nodes)
 {
   auto result = std::vector<Model::BrushNode*>{};
   for (const auto& [node, contents] : nodes)
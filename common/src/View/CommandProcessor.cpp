@@ -157,12 +157,25 @@ private:
 
     return false;
   }
+
+  size_t doGetMemoryUsage() const override
+  {
+    auto result = size_t(0);
+    for (const auto& command : m_commands)
+    {
+      result += command->memoryUsage();
+    }
+    return result;
+  }
 };
 
 CommandProcessor::CommandProcessor(
-  MapDocumentCommandFacade* document, const std::chrono::milliseconds collationInterval)
+  MapDocumentCommandFacade* document,
+  const std::chrono::milliseconds collationInterval,
+  const size_t memoryLimit)
   : m_document{document}
   , m_collationInterval{collationInterval}
+  , m_memoryLimit{memoryLimit}
   , m_lastCommandTimestamp{std::chrono::time_point<std::chrono::system_clock>{}}
 {
 }
@@ -179,6 +192,16 @@ bool CommandProcessor::canRedo() const
   return m_transactionStack.empty() && !m_redoStack.empty();
 }
 
+size_t CommandProcessor::memoryUsage() const
+{
+  auto result = size_t(0);
+  for (const auto& command : m_undoStack)
+  {
+    result += command->memoryUsage();
+  }
+  return result;
+}
+
 const std::string& CommandProcessor::undoCommandName() const
 {
   if (!canUndo())
@@ -445,14 +468,31 @@ bool CommandProcessor::pushToUndoStack(
     auto& lastCommand = m_undoStack.back();
     if (lastCommand->collateWith(*command))
     {
+      trimUndoStack();
       return false;
     }
   }
 
   m_undoStack.push_back(std::move(command));
+  trimUndoStack();
   return true;
 }
 
+void CommandProcessor::trimUndoStack()
+{
+  auto memoryUsage = size_t(0);
+  for (auto it = m_undoStack.rbegin(); it != m_undoStack.rend(); ++it)
+  {
+    memoryUsage += (*it)->memoryUsage();
+    if (memoryUsage > m_memoryLimit && it != m_undoStack.rbegin())
+    {
+      // remove this command and all older commands
+      m_undoStack.erase(m_undoStack.begin(), it.base());
+      return;
+    }
+  }
+}
+
 std::unique_ptr<UndoableCommand> CommandProcessor::popFromUndoStack()
 {
   assert(m_transactionStack.empty());
@@ -22,6 +22,7 @@
 #include "Notifier.h"
 
 #include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -53,6 +54,11 @@ enum class TransactionScope;
  * The command processor supports nested transactions. Each transaction can be committed
  * or rolled back individually. Committing a nested transaction adds it as a command to
  * the containing transaction.
+ *
+ * The memory used by the commands on the undo stack is limited. If storing a command
+ * exceeds the limit, then the oldest commands are removed from the undo stack until the
+ * memory used by the remaining commands no longer exceeds the limit. The most recently
+ * executed command is never removed.
  */
 class CommandProcessor
 {
@@ -67,6 +73,11 @@ private:
    */
   std::chrono::milliseconds m_collationInterval;
 
+  /**
+   * Limits the memory used by the commands on the undo stack, in bytes.
+   */
+  size_t m_memoryLimit;
+
   /**
    * Holds the commands that were executed so far, with the most recently executed command
    * at the end of the vector.
@@ -100,10 +111,13 @@ public:
    * they are executed or undone.
    *
    * @param document the document to pass to commands, may be null
+   * @param collationInterval the maximum time between two commands that can be collated
+   * @param memoryLimit the maximum memory used by the commands on the undo stack
    */
   explicit CommandProcessor(
     MapDocumentCommandFacade* document,
-    std::chrono::milliseconds collationInterval = std::chrono::milliseconds{1000});
+    std::chrono::milliseconds collationInterval = std::chrono::milliseconds{1000},
+    size_t memoryLimit = size_t(512) * 1024u * 1024u);
 
   ~CommandProcessor();
 
@@ -156,6 +170,11 @@ public:
    */
   bool canRedo() const;
 
+  /**
+   * Returns the estimated memory used by the commands on the undo stack, in bytes.
+   */
+  size_t memoryUsage() const;
+
   /**
    * Returns the name of the command that will be undone when calling `undo`.
    *
@@ -365,6 +384,13 @@ private:
    */
   bool pushToUndoStack(std::unique_ptr<UndoableCommand> command, bool collate);
 
+  /**
+   * Removes the oldest commands from the undo stack until the memory used by the
+   * remaining commands does not exceed the memory limit. The topmost command is always
+   * kept.
+   */
+  void trimUndoStack();
+
   /**
    * Pops the topmost command from the undo stack and returns it.
    *
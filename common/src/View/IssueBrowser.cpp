@@ -24,6 +24,8 @@
 #include <QStringList>
 #include <QVBoxLayout>
 
+#include "Model/BrushFaceHandle.h"
+#include "Model/BrushNode.h"
 #include "Model/Issue.h"
 #include "Model/Validator.h"
 #include "Model/WorldNode.h"
@@ -32,6 +34,7 @@
 #include "View/MapDocument.h"
 
 #include <kdl/memory_utils.h>
+#include <kdl/vector_utils.h>
 
 namespace TrenchBroom
 {
@@ -85,6 +88,8 @@ void IssueBrowser::connectObservers()
     this, &IssueBrowser::documentWasNewedOrLoaded);
   m_notifierConnection += document->documentWasLoadedNotifier.connect(
     this, &IssueBrowser::documentWasNewedOrLoaded);
+  m_notifierConnection += document->documentWillBeClearedNotifier.connect(
+    this, &IssueBrowser::documentWillBeCleared);
   m_notifierConnection +=
     document->nodesWereAddedNotifier.connect(this, &IssueBrowser::nodesWereAdded);
   m_notifierConnection +=
@@ -101,29 +106,34 @@ void IssueBrowser::documentWasNewedOrLoaded(MapDocument*)
   m_view->reload();
 }
 
+void IssueBrowser::documentWillBeCleared(MapDocument*)
+{
+  m_view->clear();
+}
+
 void IssueBrowser::documentWasSaved(MapDocument*)
 {
   m_view->update();
 }
 
-void IssueBrowser::nodesWereAdded(const std::vector<Model::Node*>&)
+void IssueBrowser::nodesWereAdded(const std::vector<Model::Node*>& nodes)
 {
-  m_view->reload();
+  m_view->nodesWereAdded(nodes);
 }
 
-void IssueBrowser::nodesWereRemoved(const std::vector<Model::Node*>&)
+void IssueBrowser::nodesWereRemoved(const std::vector<Model::Node*>& nodes)
 {
-  m_view->reload();
+  m_view->nodesWereRemoved(nodes);
 }
 
-void IssueBrowser::nodesDidChange(const std::vector<Model::Node*>&)
+void IssueBrowser::nodesDidChange(const std::vector<Model::Node*>& nodes)
 {
-  m_view->reload();
+  m_view->nodesDidChange(nodes);
 }
 
-void IssueBrowser::brushFacesDidChange(const std::vector<Model::BrushFaceHandle>&)
+void IssueBrowser::brushFacesDidChange(const std::vector<Model::BrushFaceHandle>& faces)
 {
-  m_view->reload();
+  m_view->nodesDidChange(kdl::vec_element_cast<Model::Node*>(Model::toNodes(faces)));
 }
 
 void IssueBrowser::issueIgnoreChanged(Model::Issue*)
@@ -68,6 +68,7 @@ public:
 private:
   void connectObservers();
   void documentWasNewedOrLoaded(MapDocument* document);
+  void documentWillBeCleared(MapDocument* document);
   void documentWasSaved(MapDocument* document);
   void nodesWereAdded(const std::vector<Model::Node*>& nodes);
   void nodesWereRemoved(const std::vector<Model::Node*>& nodes);
@@ -26,34 +26,42 @@
 #include <QTableView>
 
 #include "Ensure.h"
-#include "Model/BrushNode.h"
-#include "Model/EntityNode.h"
-#include "Model/GroupNode.h"
 #include "Model/Issue.h"
 #include "Model/IssueQuickFix.h"
-#include "Model/LayerNode.h"
-#include "Model/PatchNode.h"
+#include "Model/ModelUtils.h"
+#include "Model/Node.h"
 #include "Model/WorldNode.h"
 #include "View/MapDocument.h"
 #include "View/QtUtils.h"
 
 #include <kdl/memory_utils.h>
-#include <kdl/overload.h>
 #include <kdl/vector_set.h>
 #include <kdl/vector_utils.h>
 
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
 #include <vector>
 
 namespace TrenchBroom
 {
 namespace View
 {
+namespace
+{
+// newer issues are shown first
+bool compareIssues(const Model::Issue* lhs, const Model::Issue* rhs)
+{
+  return lhs->seqId() > rhs->seqId();
+}
+} // namespace
+
 IssueBrowserView::IssueBrowserView(std::weak_ptr<MapDocument> document, QWidget* parent)
   : QWidget{parent}
   , m_document{std::move(document)}
   , m_hiddenIssueTypes{0}
   , m_showHiddenIssues{false}
-  , m_valid{false}
+  , m_valid{true}
 {
   createGui();
   bindEvents();
@@ -89,18 +97,72 @@ void IssueBrowserView::setHiddenIssueTypes(const int hiddenIssueTypes)
   if (hiddenIssueTypes != m_hiddenIssueTypes)
   {
     m_hiddenIssueTypes = hiddenIssueTypes;
-    invalidate();
+    updateTable();
   }
 }
 
 void IssueBrowserView::setShowHiddenIssues(const bool show)
 {
   m_showHiddenIssues = show;
-  invalidate();
+  updateTable();
 }
 
 void IssueBrowserView::reload()
 {
+  m_issues.clear();
+  m_tableModel->setIssues({});
+
+  auto document = kdl::mem_lock(m_document);
+  if (auto* world = document->world())
+  {
+    m_validationEngine.reset(*world);
+  }
+  else
+  {
+    m_validationEngine.reset();
+  }
+
+  invalidate();
+}
+
+void IssueBrowserView::clear()
+{
+  m_valid = true;
+  m_validationEngine.reset();
+  m_issues.clear();
+  m_tableModel->setIssues({});
+}
+
+void IssueBrowserView::nodesWereAdded(const std::vector<Model::Node*>& nodes)
+{
+  // the issues of nodes that are added again are valid, but they aren't shown yet
+  m_validationEngine.schedule(nodes);
+  invalidate();
+}
+
+void IssueBrowserView::nodesWereRemoved(const std::vector<Model::Node*>& nodes)
+{
+  m_validationEngine.unschedule(nodes);
+
+  auto removedIssues = std::unordered_set<const Model::Issue*>{};
+  for (const auto* node : Model::collectNodes(nodes))
+  {
+    if (const auto it = m_issues.find(node); it != m_issues.end())
+    {
+      removedIssues.insert(it->second.begin(), it->second.end());
+      m_issues.erase(it);
+    }
+  }
+  m_tableModel->removeIssues(removedIssues);
+}
+
+void IssueBrowserView::nodesDidChange(const std::vector<Model::Node*>& nodes)
+{
+  auto document = kdl::mem_lock(m_document);
+  if (auto* world = document->world())
+  {
+    m_validationEngine.scheduleInvalidNodes(nodes, world->registeredValidators());
+  }
   invalidate();
 }
 
@@ -130,6 +192,9 @@ void IssueBrowserView::updateSelection()
   document->selectNodes(nodes);
 }
 
+/**
+ * Validates the next batch of nodes and replaces their issues in the table view.
+ */
 void IssueBrowserView::updateIssues()
 {
   auto document = kdl::mem_lock(m_document);
@@ -137,44 +202,57 @@ void IssueBrowserView::updateIssues()
   {
     const auto validators = document->world()->registeredValidators();
 
-    auto issues = std::vector<const Model::Issue*>{};
-    const auto collectIssues = [&](auto* node) {
-      for (auto* issue : node->issues(validators))
+    // the old issues of the nodes are destroyed when the nodes are validated, so they
+    // must be removed from the table before
+    auto oldIssues = std::unordered_set<const Model::Issue*>{};
+    for (const auto* node : m_validationEngine.nextBatch())
+    {
+      if (const auto it = m_issues.find(node); it != m_issues.end())
+      {
+        oldIssues.insert(it->second.begin(), it->second.end());
+        m_issues.erase(it);
+      }
+    }
+    m_tableModel->removeIssues(oldIssues);
+
+    auto newIssues = std::vector<const Model::Issue*>{};
+    for (const auto* issue : m_validationEngine.validateNextBatch(validators))
+    {
+      m_issues[&issue->node()].push_back(issue);
+      if (isIssueVisible(*issue))
+      {
+        newIssues.push_back(issue);
+      }
+    }
+    m_tableModel->addIssues(std::move(newIssues));
+  }
+}
+
+/**
+ * Shows the issues that pass the current filter in the table view.
+ */
+void IssueBrowserView::updateTable()
+{
+  auto issues = std::vector<const Model::Issue*>{};
+  for (const auto& [node, nodeIssues] : m_issues)
+  {
+    for (const auto* issue : nodeIssues)
+    {
+      if (isIssueVisible(*issue))
       {
-        if (
-          m_showHiddenIssues
-          || (!issue->hidden() && (issue->type() & m_hiddenIssueTypes) == 0))
-        {
-          issues.push_back(issue);
-        }
+        issues.push_back(issue);
       }
-    };
-
-    document->world()->accept(kdl::overload(
-      [&](auto&& thisLambda, Model::WorldNode* world) {
-        collectIssues(world);
-        world->visitChildren(thisLambda);
-      },
-      [&](auto&& thisLambda, Model::LayerNode* layer) {
-        collectIssues(layer);
-        layer->visitChildren(thisLambda);
-      },
-      [&](auto&& thisLambda, Model::GroupNode* group) {
-        collectIssues(group);
-        group->visitChildren(thisLambda);
-      },
-      [&](auto&& thisLambda, Model::EntityNode* entity) {
-        collectIssues(entity);
-        entity->visitChildren(thisLambda);
-      },
-      [&](Model::BrushNode* brush) { collectIssues(brush); },
-      [&](Model::PatchNode* patch) { collectIssues(patch); }));
-
-    issues = kdl::vec_sort(std::move(issues), [](const auto* lhs, const auto* rhs) {
-      return lhs->seqId() > rhs->seqId();
-    });
-    m_tableModel->setIssues(std::move(issues));
+    }
   }
+
+  issues = kdl::vec_sort(std::move(issues), compareIssues);
+  m_tableModel->setIssues(std::move(issues));
+}
+
+bool IssueBrowserView::isIssueVisible(const Model::Issue& issue) const
+{
+  return m_showHiddenIssues
+         || (!issue.hidden() && (issue.type() & m_hiddenIssueTypes) == 0);
 }
 
 void IssueBrowserView::applyQuickFix(const Model::IssueQuickFix& quickFix)
@@ -250,7 +328,7 @@ void IssueBrowserView::setIssueVisibility(const bool show)
     document->setIssueHidden(*issue, !show);
   }
 
-  invalidate();
+  updateTable();
 }
 
 QList<QModelIndex> IssueBrowserView::getSelection() const
@@ -326,10 +404,11 @@ void IssueBrowserView::hideIssues()
 
 void IssueBrowserView::invalidate()
 {
-  m_valid = false;
-  m_tableModel->setIssues({});
-
-  QMetaObject::invokeMethod(this, "validate", Qt::QueuedConnection);
+  if (m_valid && !m_validationEngine.done())
+  {
+    m_valid = false;
+    QMetaObject::invokeMethod(this, "validate", Qt::QueuedConnection);
+  }
 }
 
 void IssueBrowserView::validate()
@@ -337,7 +416,15 @@ void IssueBrowserView::validate()
   if (!m_valid)
   {
     updateIssues();
-    m_valid = true;
+    if (m_validationEngine.done())
+    {
+      m_valid = true;
+    }
+    else
+    {
+      // validate the remaining nodes after pending events were processed
+      QMetaObject::invokeMethod(this, "validate", Qt::QueuedConnection);
+    }
   }
 }
 
@@ -355,6 +442,68 @@ void IssueBrowserModel::setIssues(std::vector<const Model::Issue*> issues)
   endResetModel();
 }
 
+void IssueBrowserModel::addIssues(std::vector<const Model::Issue*> issues)
+{
+  if (issues.empty())
+  {
+    return;
+  }
+
+  issues = kdl::vec_sort(std::move(issues), compareIssues);
+  if (m_issues.empty() || compareIssues(issues.back(), m_issues.front()))
+  {
+    // new issues are shown first, so this is the common case
+    const auto count = static_cast<int>(issues.size());
+    beginInsertRows(QModelIndex{}, 0, count - 1);
+    m_issues.insert(m_issues.begin(), issues.begin(), issues.end());
+    endInsertRows();
+  }
+  else
+  {
+    for (const auto* issue : issues)
+    {
+      const auto it =
+        std::lower_bound(m_issues.begin(), m_issues.end(), issue, compareIssues);
+      const auto row = static_cast<int>(std::distance(m_issues.begin(), it));
+      beginInsertRows(QModelIndex{}, row, row);
+      m_issues.insert(it, issue);
+      endInsertRows();
+    }
+  }
+}
+
+void IssueBrowserModel::removeIssues(
+  const std::unordered_set<const Model::Issue*>& issues)
+{
+  auto rows = std::vector<size_t>{};
+  for (size_t i = 0; i < m_issues.size(); ++i)
+  {
+    if (issues.count(m_issues[i]) > 0)
+    {
+      rows.push_back(i);
+    }
+  }
+
+  // remove contiguous ranges of rows starting at the end
+  while (!rows.empty())
+  {
+    const auto last = rows.back();
+    auto first = last;
+    rows.pop_back();
+    while (!rows.empty() && rows.back() == first - 1)
+    {
+      first = rows.back();
+      rows.pop_back();
+    }
+
+    beginRemoveRows(QModelIndex{}, static_cast<int>(first), static_cast<int>(last));
+    m_issues.erase(
+      std::next(m_issues.begin(), static_cast<std::ptrdiff_t>(first)),
+      std::next(m_issues.begin(), static_cast<std::ptrdiff_t>(last + 1)));
+    endRemoveRows();
+  }
+}
+
 const std::vector<const Model::Issue*>& IssueBrowserModel::issues()
 {
   return m_issues;
@@ -23,8 +23,11 @@
 #include <QWidget>
 
 #include "Model/IssueType.h"
+#include "Model/ValidationEngine.h"
 
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class QWidget;
@@ -36,6 +39,7 @@ namespace Model
 {
 class Issue;
 class IssueQuickFix;
+class Node;
 } // namespace Model
 
 namespace View
@@ -53,6 +57,8 @@ private:
   bool m_showHiddenIssues;
 
   bool m_valid;
+  Model::ValidationEngine m_validationEngine;
+  std::unordered_map<const Model::Node*, std::vector<const Model::Issue*>> m_issues;
 
   QTableView* m_tableView;
   IssueBrowserModel* m_tableModel;
@@ -69,10 +75,16 @@ public:
   void setHiddenIssueTypes(int hiddenIssueTypes);
   void setShowHiddenIssues(bool show);
   void reload();
+  void clear();
+  void nodesWereAdded(const std::vector<Model::Node*>& nodes);
+  void nodesWereRemoved(const std::vector<Model::Node*>& nodes);
+  void nodesDidChange(const std::vector<Model::Node*>& nodes);
   void deselectAll();
 
 private:
   void updateIssues();
+  void updateTable();
+  bool isIssueVisible(const Model::Issue& issue) const;
 
   std::vector<const Model::Issue*> collectIssues(const QList<QModelIndex>& indices) const;
   std::vector<const Model::IssueQuickFix*> collectQuickFixes(
@@ -98,8 +110,9 @@ public slots:
 };
 
 /**
- * Trivial QAbstractTableModel subclass, when the issues list changes,
- * it just refreshes the entire list with beginResetModel()/endResetModel().
+ * QAbstractTableModel subclass that shows the issues ordered from newest to oldest.
+ * Issues can be added and removed incrementally, or the entire list can be replaced
+ * with beginResetModel()/endResetModel().
  */
 class IssueBrowserModel : public QAbstractTableModel
 {
@@ -111,6 +124,8 @@ public:
   explicit IssueBrowserModel(QObject* parent);
 
   void setIssues(std::vector<const Model::Issue*> issues);
+  void addIssues(std::vector<const Model::Issue*> issues);
+  void removeIssues(const std::unordered_set<const Model::Issue*>& issues);
   const std::vector<const Model::Issue*>& issues();
 
 public: // QAbstractTableModel overrides
@@ -29,6 +29,8 @@
 #include <vecmath/polygon.h>
 #include <vecmath/segment.h>
 
+#include <array>
+
 namespace TrenchBroom
 {
 namespace View
@@ -47,6 +49,43 @@ void Lasso::update(const vm::vec3& point)
   m_cur = point;
 }
 
+std::vector<vm::plane3> Lasso::boundingPlanes() const
+{
+  const auto transform = getTransform();
+  const auto [invertible, inverseTransform] = vm::invert(transform);
+  assert(invertible);
+  unused(invertible);
+
+  // expand the box a little so that rounding errors don't exclude points on its boundary
+  const auto box = getBox(transform).expand(0.01);
+  const auto corners = std::array<vm::vec3, 4>{
+    inverseTransform * vm::vec3{box.min.x(), box.min.y(), 0.0},
+    inverseTransform * vm::vec3{box.min.x(), box.max.y(), 0.0},
+    inverseTransform * vm::vec3{box.max.x(), box.max.y(), 0.0},
+    inverseTransform * vm::vec3{box.max.x(), box.min.y(), 0.0},
+  };
+  const auto boxCenter = box.center();
+  const auto center = inverseTransform * vm::vec3{boxCenter.x(), boxCenter.y(), 0.0};
+
+  // every side plane contains the pick rays through two adjacent corners of the box
+  auto result = std::vector<vm::plane3>{};
+  for (size_t i = 0; i < corners.size(); ++i)
+  {
+    const auto& p1 = corners[i];
+    const auto& p2 = corners[(i + 1) % corners.size()];
+    const auto direction = vm::vec3{m_camera.pickRay(vm::vec3f{p1}).direction};
+
+    const auto [valid, plane] = vm::from_points(p1, p2, p1 + direction);
+    if (!valid)
+    {
+      return {};
+    }
+    result.push_back(plane.point_distance(center) > 0.0 ? plane.flip() : plane);
+  }
+
+  return result;
+}
+
 bool Lasso::selects(
   const vm::vec3& point, const vm::plane3& plane, const vm::bbox2& box) const
 {
@@ -24,6 +24,8 @@
 #include <vecmath/bbox.h>
 #include <vecmath/plane.h>
 
+#include <vector>
+
 namespace TrenchBroom
 {
 namespace Renderer
@@ -48,6 +50,13 @@ public:
 
   void update(const vm::vec3& point);
 
+  /**
+   * Returns the planes bounding the volume in which this lasso selects points. The plane
+   * normals point out of the volume. If the planes cannot be computed, an empty list is
+   * returned.
+   */
+  std::vector<vm::plane3> boundingPlanes() const;
+
   template <typename I, typename O>
   void selected(I cur, I end, O out) const
   {
@@ -32,10 +32,12 @@
 #include "IO/DiskFileSystem.h"
 #include "IO/DiskIO.h"
 #include "IO/ExportOptions.h"
+#include "IO/FileWatcher.h"
 #include "IO/GameConfigParser.h"
 #include "IO/PathInfo.h"
 #include "IO/SimpleParserStatus.h"
 #include "IO/SystemPaths.h"
+#include "IO/TextureCache.h"
 #include "Model/BezierPatch.h"
 #include "Model/Brush.h"
 #include "Model/BrushBuilder.h"
@@ -105,6 +107,7 @@
 #include "View/ViewEffectsService.h"
 
 #include <kdl/collection_utils.h>
+#include <kdl/invoke.h>
 #include <kdl/map_utils.h>
 #include <kdl/memory_utils.h>
 #include <kdl/overload.h>
@@ -122,6 +125,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdlib> // for std::abs
 #include <map>
 #include <mutex>
@@ -129,6 +133,7 @@
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace TrenchBroom
@@ -367,6 +372,7 @@ MapDocument::MapDocument()
   , m_textureManager(std::make_unique<Assets::TextureManager>(
       pref(Preferences::TextureMagFilter), pref(Preferences::TextureMinFilter), logger()))
   , m_tagManager(std::make_unique<Model::TagManager>())
+  , m_assetFileWatcher(std::make_unique<IO::FileWatcher>())
   , m_editorContext(std::make_unique<Model::EditorContext>())
   , m_grid(std::make_unique<Grid>(4))
   , m_path(DefaultDocumentName)
@@ -2834,7 +2840,8 @@ void MapDocument::downgradeUnlockedToInherit(const std::vector<Model::Node*>& no
 bool MapDocument::swapNodeContents(
   const std::string& commandName,
   std::vector<std::pair<Model::Node*, Model::NodeContents>> nodesToSwap,
-  std::vector<Model::GroupNode*> changedLinkedGroups)
+  std::vector<Model::GroupNode*> changedLinkedGroups,
+  std::optional<Model::BrushTransformation> brushTransformation)
 {
 
   if (!checkLinkedGroupsToUpdate(changedLinkedGroups))
@@ -2843,8 +2850,8 @@ bool MapDocument::swapNodeContents(
   }
 
   auto transaction = Transaction{*this};
-  const auto result = executeAndStore(
-    std::make_unique<SwapNodeContentsCommand>(commandName, std::move(nodesToSwap)));
+  const auto result = executeAndStore(std::make_unique<SwapNodeContentsCommand>(
+    commandName, std::move(nodesToSwap), std::move(brushTransformation)));
 
   if (!result->success())
   {
@@ -2959,10 +2966,13 @@ bool MapDocument::transformObjects(
 
   return kdl::fold_results(std::move(transformResults))
     .and_then([&](auto nodesToUpdate) -> kdl::result<bool> {
+      // linked brushes are always transformed with texture lock, so the command may
+      // have to store snapshots for them if the preference is off
       const auto success = swapNodeContents(
         commandName,
         std::move(nodesToUpdate),
-        findContainingLinkedGroups(*m_world, m_selectedNodes.nodes()));
+        findContainingLinkedGroups(*m_world, m_selectedNodes.nodes()),
+        Model::BrushTransformation{m_worldBounds, transformation, lockTexturesPref});
 
       if (success)
       {
@@ -4449,12 +4459,54 @@ void MapDocument::unloadAssets()
   unloadTextures();
 }
 
+void MapDocument::updateWatchedAssetFiles()
+{
+  auto paths = std::vector<std::filesystem::path>{};
+
+  if (!m_entityDefinitionFilePath.empty())
+  {
+    paths.push_back(m_entityDefinitionFilePath);
+  }
+
+  if (m_game)
+  {
+    for (const auto& modelPath : m_entityModelManager->modelPaths())
+    {
+      if (auto absoluteModelPath = m_game->makeAbsolute(modelPath);
+          !absoluteModelPath.empty())
+      {
+        paths.push_back(std::move(absoluteModelPath));
+      }
+    }
+
+    // the assets contained in archives are reloaded when their archive changes
+    paths = kdl::vec_concat(std::move(paths), m_game->archivePaths());
+  }
+
+  // textures contained in archives have paths that don't exist on the disk, they are
+  // ignored by the watcher
+  for (const auto& collection : m_textureManager->collections())
+  {
+    for (const auto& texture : collection.textures())
+    {
+      if (!texture.absolutePath().empty())
+      {
+        paths.push_back(texture.absolutePath());
+      }
+    }
+  }
+
+  m_assetFileWatcher->setWatchedPaths(paths);
+}
+
 void MapDocument::loadEntityDefinitions()
 {
   const Assets::EntityDefinitionFileSpec spec = entityDefinitionFile();
   try
   {
     const auto path = m_game->findEntityDefinitionFile(spec, externalSearchPaths());
+    m_entityDefinitionFilePath = path;
+
     IO::SimpleParserStatus status(logger());
     m_entityDefinitionManager->loadDefinitions(path, *m_game, status);
     info("Loaded entity definition file " + path.filename().string());
@@ -4474,6 +4526,8 @@ void MapDocument::loadEntityDefinitions()
               << "': " << e.what();
     }
   }
+
+  updateWatchedAssetFiles();
 }
 
 void MapDocument::unloadEntityDefinitions()
@@ -4481,11 +4535,14 @@ void MapDocument::unloadEntityDefinitions()
   unsetEntityDefinitions();
   m_entityDefinitionManager->clear();
   m_entityDefinitionActions.clear();
+  m_entityDefinitionFilePath.clear();
+  updateWatchedAssetFiles();
 }
 
 void MapDocument::loadEntityModels()
 {
   m_entityModelManager->setLoader(m_game.get());
+  prefetchEntityModels();
   setEntityModels();
 }
 
@@ -4495,10 +4552,27 @@ void MapDocument::unloadEntityModels()
   m_entityModelManager->setLoader(nullptr);
 }
 
+template <typename F>
+static void changeGameFileSystem(
+  Assets::TextureManager& textureManager,
+  Assets::EntityModelManager& entityModelManager,
+  const F& change)
+{
+  // pending texture reloads and model loads must not access the file system while it is
+  // being changed
+  textureManager.cancelReloads();
+  entityModelManager.suspendPendingModels();
+  auto resumeModels =
+    kdl::invoke_later{[&]() { entityModelManager.resumePendingModels(); }};
+
+  change();
+}
+
 void MapDocument::reloadTextures()
 {
   unloadTextures();
-  m_game->reloadShaders();
+  changeGameFileSystem(
+    *m_textureManager, *m_entityModelManager, [&]() { m_game->reloadShaders(); });
   loadTextures();
 }
 
@@ -4511,7 +4585,21 @@ void MapDocument::loadTextures()
       const auto wadPaths = kdl::vec_transform(
         kdl::str_split(*wadStr, ";"),
         [](const auto& str) { return std::filesystem::path{str}; });
-      m_game->reloadWads(path(), wadPaths, logger());
+      changeGameFileSystem(*m_textureManager, *m_entityModelManager, [&]() {
+        m_game->reloadWads(path(), wadPaths, logger());
+      });
+    }
+    if (pref(Preferences::EnableTextureCache))
+    {
+      auto textureCache = std::make_unique<IO::TextureCache>(
+        IO::SystemPaths::userDataDirectory() / "TextureCache");
+      // cache files of collections that were not loaded for a month are likely unused
+      textureCache->removeUnusedFiles(std::chrono::hours{24 * 30});
+      m_textureManager->setTextureCache(std::move(textureCache));
+    }
+    else
+    {
+      m_textureManager->setTextureCache(nullptr);
     }
     m_game->loadTextureCollections(*m_textureManager);
   }
@@ -4519,12 +4607,15 @@ void MapDocument::loadTextures()
   {
     error(e.what());
   }
+
+  updateWatchedAssetFiles();
 }
 
 void MapDocument::unloadTextures()
 {
   unsetTextures();
   m_textureManager->clear();
+  updateWatchedAssetFiles();
 }
 
 static auto makeSetTexturesVisitor(Assets::TextureManager& manager)
@@ -4674,56 +4765,250 @@ void MapDocument::clearEntityModels()
 {
   unsetEntityModels();
   m_entityModelManager->clear();
+  updateWatchedAssetFiles();
 }
 
-static auto makeSetEntityModelsVisitor(
-  Logger& logger, Assets::EntityModelManager& manager)
+static Assets::ModelSpecification modelSpecification(
+  Logger& logger, const Model::EntityNode& entityNode)
+{
+  return Assets::safeGetModelSpecification(
+    logger, entityNode.entity().classname(), [&]() {
+      return entityNode.entity().modelSpecification();
+    });
+}
+
+template <typename F>
+static auto makeEntityNodesVisitor(const F& f)
 {
   return kdl::overload(
     [](auto&& thisLambda, Model::WorldNode* world) { world->visitChildren(thisLambda); },
     [](auto&& thisLambda, Model::LayerNode* layer) { layer->visitChildren(thisLambda); },
     [](auto&& thisLambda, Model::GroupNode* group) { group->visitChildren(thisLambda); },
-    [&](Model::EntityNode* entityNode) {
-      const auto modelSpec = Assets::safeGetModelSpecification(
-        logger, entityNode->entity().classname(), [&]() {
-          return entityNode->entity().modelSpecification();
-        });
-      const auto* frame = manager.frame(modelSpec);
-      entityNode->setModelFrame(frame);
-    },
+    [f](Model::EntityNode* entityNode) { f(entityNode); },
     [](Model::BrushNode*) {},
     [](Model::PatchNode*) {});
 }
 
-static auto makeUnsetEntityModelsVisitor()
+void MapDocument::prefetchEntityModels()
 {
-  return kdl::overload(
-    [](auto&& thisLambda, Model::WorldNode* world) { world->visitChildren(thisLambda); },
+  // queue all models at once so that every frame used by the map is loaded together
+  // with its model
+  auto modelSpecs = std::vector<Assets::ModelSpecification>{};
+  m_world->accept(makeEntityNodesVisitor([&](const Model::EntityNode* entityNode) {
+    modelSpecs.push_back(modelSpecification(*this, *entityNode));
+  }));
+  m_entityModelManager->prefetch(modelSpecs);
+}
+
+void MapDocument::processLoadedEntityModels()
+{
+  const auto loadedPaths = m_entityModelManager->processLoadedModels();
+  if (m_game)
+  {
+    // watch the files of the models that were loaded or failed to load
+    auto absolutePaths = std::vector<std::filesystem::path>{};
+    for (const auto& path : loadedPaths)
+    {
+      if (auto absolutePath = m_game->makeAbsolute(path); !absolutePath.empty())
+      {
+        absolutePaths.push_back(std::move(absolutePath));
+      }
+    }
+    m_assetFileWatcher->addWatchedPaths(absolutePaths);
+  }
+
+  auto nodes = std::vector<Model::Node*>{};
+  for (const auto& path : loadedPaths)
+  {
+    if (const auto it = m_entityNodesByModelPath.find(path);
+        it != m_entityNodesByModelPath.end())
+    {
+      nodes.insert(nodes.end(), it->second.begin(), it->second.end());
+    }
+  }
+
+  if (!nodes.empty())
+  {
+    // setting a model doesn't change the entity itself, only its bounds and how it is
+    // rendered
+    setEntityModels(nodes);
+    invalidateSelectionBounds();
+    entityModelsDidChangeNotifier(nodes);
+  }
+}
+
+static std::vector<Model::Node*> findNodesWithTextures(
+  Model::WorldNode& world, const kdl::vector_set<const Assets::Texture*>& textures)
+{
+  auto result = std::vector<Model::Node*>{};
+  world.accept(kdl::overload(
+    [](auto&& thisLambda, Model::WorldNode* worldNode) {
+      worldNode->visitChildren(thisLambda);
+    },
     [](auto&& thisLambda, Model::LayerNode* layer) { layer->visitChildren(thisLambda); },
     [](auto&& thisLambda, Model::GroupNode* group) { group->visitChildren(thisLambda); },
-    [](Model::EntityNode* entity) { entity->setModelFrame(nullptr); },
-    [](Model::BrushNode*) {},
-    [](Model::PatchNode*) {});
+    [](auto&& thisLambda, Model::EntityNode* entity) {
+      entity->visitChildren(thisLambda);
+    },
+    [&](Model::BrushNode* brushNode) {
+      const auto& faces = brushNode->brush().faces();
+      if (std::any_of(faces.begin(), faces.end(), [&](const auto& face) {
+            return textures.count(face.texture()) > 0;
+          }))
+      {
+        result.push_back(brushNode);
+      }
+    },
+    [&](Model::PatchNode* patchNode) {
+      if (textures.count(patchNode->patch().texture()) > 0)
+      {
+        result.push_back(patchNode);
+      }
+    }));
+  return result;
+}
+
+void MapDocument::processChangedAssets()
+{
+  if (!m_world)
+  {
+    return;
+  }
+
+  const auto changedPaths =
+    kdl::vector_set<std::filesystem::path>(m_assetFileWatcher->takeChangedPaths());
+  if (!changedPaths.empty())
+  {
+    // changed archives must be reopened before the assets they contain can be reloaded
+    auto changedArchiveFilePaths = kdl::vector_set<std::filesystem::path>{};
+    if (const auto changedArchivePaths = kdl::vec_filter(
+          m_game->archivePaths(),
+          [&](const auto& archivePath) { return changedPaths.count(archivePath) > 0; });
+        !changedArchivePaths.empty())
+    {
+      changeGameFileSystem(*m_textureManager, *m_entityModelManager, [&]() {
+        try
+        {
+          changedArchiveFilePaths = kdl::vector_set<std::filesystem::path>(
+            m_game->reopenArchives(changedArchivePaths));
+        }
+        catch (const Exception& e)
+        {
+          error() << "Could not reload archive: " << e.what();
+        }
+      });
+    }
+
+    if (changedPaths.count(m_entityDefinitionFilePath) > 0)
+    {
+      // the definitions depend on each other, so the entire file must be reloaded, which
+      // reloads the entity models, too
+      reloadEntityDefinitions();
+    }
+    else
+    {
+      m_entityModelManager->reloadModels(
+        kdl::vec_filter(m_entityModelManager->modelPaths(), [&](const auto& modelPath) {
+          return changedArchiveFilePaths.count(modelPath) > 0
+                 || changedPaths.count(m_game->makeAbsolute(modelPath)) > 0;
+        }));
+    }
+
+    auto texturePaths = std::vector<std::filesystem::path>{};
+    for (const auto& collection : m_textureManager->collections())
+    {
+      for (const auto& texture : collection.textures())
+      {
+        if (
+          changedArchiveFilePaths.count(texture.relativePath()) > 0
+          || changedPaths.count(texture.absolutePath()) > 0)
+        {
+          texturePaths.push_back(texture.relativePath());
+        }
+      }
+    }
+    m_game->reloadTextures(*m_textureManager, texturePaths);
+  }
+
+  const auto reloadedTextures =
+    kdl::vector_set<const Assets::Texture*>(m_textureManager->processReloadedTextures());
+  if (!reloadedTextures.empty())
+  {
+    // the textures were replaced in place, but their sizes may have changed
+    const auto nodes = findNodesWithTextures(*m_world, reloadedTextures);
+    NotifyBeforeAndAfter notifyNodes(
+      nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
+    NotifyBeforeAndAfter notifyTextureCollections(
+      textureCollectionsWillChangeNotifier, textureCollectionsDidChangeNotifier);
+  }
 }
 
 void MapDocument::setEntityModels()
 {
-  m_world->accept(makeSetEntityModelsVisitor(*this, *m_entityModelManager));
+  m_world->accept(makeEntityNodesVisitor(
+    [&](Model::EntityNode* entityNode) { setEntityModel(*entityNode); }));
 }
 
 void MapDocument::setEntityModels(const std::vector<Model::Node*>& nodes)
 {
-  Model::Node::visitAll(nodes, makeSetEntityModelsVisitor(*this, *m_entityModelManager));
+  Model::Node::visitAll(
+    nodes, makeEntityNodesVisitor([&](Model::EntityNode* entityNode) {
+      setEntityModel(*entityNode);
+    }));
 }
 
 void MapDocument::unsetEntityModels()
 {
-  m_world->accept(makeUnsetEntityModelsVisitor());
+  m_world->accept(makeEntityNodesVisitor(
+    [&](Model::EntityNode* entityNode) { unsetEntityModel(*entityNode); }));
 }
 
 void MapDocument::unsetEntityModels(const std::vector<Model::Node*>& nodes)
 {
-  Model::Node::visitAll(nodes, makeUnsetEntityModelsVisitor());
+  Model::Node::visitAll(
+    nodes, makeEntityNodesVisitor([&](Model::EntityNode* entityNode) {
+      unsetEntityModel(*entityNode);
+    }));
+}
+
+void MapDocument::setEntityModel(Model::EntityNode& entityNode)
+{
+  const auto spec = modelSpecification(*this, entityNode);
+
+  const auto it = m_entityModelPaths.find(&entityNode);
+  if (it == m_entityModelPaths.end() || it->second != spec.path)
+  {
+    if (it != m_entityModelPaths.end())
+    {
+      unsetEntityModel(entityNode);
+    }
+    if (!spec.path.empty())
+    {
+      m_entityNodesByModelPath[spec.path].insert(&entityNode);
+      m_entityModelPaths.emplace(&entityNode, spec.path);
+    }
+  }
+
+  // if the model is still loading, the entity is rendered as a bounding box until
+  // processLoadedEntityModels sets the model
+  entityNode.setModelFrame(m_entityModelManager->loadedFrame(spec));
+}
+
+void MapDocument::unsetEntityModel(Model::EntityNode& entityNode)
+{
+  const auto it = m_entityModelPaths.find(&entityNode);
+  if (it != m_entityModelPaths.end())
+  {
+    const auto nodesIt = m_entityNodesByModelPath.find(it->second);
+    nodesIt->second.erase(&entityNode);
+    if (nodesIt->second.empty())
+    {
+      m_entityNodesByModelPath.erase(nodesIt);
+    }
+    m_entityModelPaths.erase(it);
+  }
+
+  entityNode.setModelFrame(nullptr);
 }
 
 std::vector<std::filesystem::path> MapDocument::externalSearchPaths() const
@@ -4746,10 +5031,12 @@ std::vector<std::filesystem::path> MapDocument::externalSearchPaths() const
 
 void MapDocument::updateGameSearchPaths()
 {
-  m_game->setAdditionalSearchPaths(
-    kdl::vec_transform(
-      mods(), [](const auto& mod) { return std::filesystem::path{mod}; }),
-    logger());
+  changeGameFileSystem(*m_textureManager, *m_entityModelManager, [&]() {
+    m_game->setAdditionalSearchPaths(
+      kdl::vec_transform(
+        mods(), [](const auto& mod) { return std::filesystem::path{mod}; }),
+      logger());
+  });
 }
 
 std::vector<std::string> MapDocument::mods() const
@@ -5128,9 +5415,11 @@ void MapDocument::preferenceDidChange(const std::filesystem::path& path)
   {
     const Model::GameFactory& gameFactory = Model::GameFactory::instance();
     const std::filesystem::path newGamePath = gameFactory.gamePath(m_game->gameName());
-    m_game->setGamePath(newGamePath, logger());
 
+    // cancel loading models from the old game path
     clearEntityModels();
+    m_textureManager->cancelReloads();
+    m_game->setGamePath(newGamePath, logger());
     setEntityModels();
 
     reloadTextures();
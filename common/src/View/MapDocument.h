@@ -24,6 +24,7 @@
 #include "Model/MapFacade.h"
 #include "Model/NodeCollection.h"
 #include "Model/NodeContents.h"
+#include "Model/NodeContentsDelta.h"
 #include "Model/PointTrace.h"
 #include "Notifier.h"
 #include "NotifierConnection.h"
@@ -38,6 +39,8 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
@@ -55,6 +58,11 @@ class Texture;
 class TextureManager;
 } // namespace Assets
 
+namespace IO
+{
+class FileWatcher;
+} // namespace IO
+
 namespace Model
 {
 class Brush;
@@ -63,6 +71,7 @@ class BrushFaceHandle;
 class BrushFaceAttributes;
 class EditorContext;
 class Entity;
+class EntityNode;
 class Game;
 class Issue;
 enum class MapFormat;
@@ -114,8 +123,17 @@ protected:
   std::unique_ptr<Assets::EntityDefinitionManager> m_entityDefinitionManager;
   std::unique_ptr<Assets::EntityModelManager> m_entityModelManager;
   std::unique_ptr<Assets::TextureManager> m_textureManager;
+
+  // the entities by the paths of their models, so that they can be updated when their
+  // models have been loaded or reloaded
+  std::map<std::filesystem::path, std::unordered_set<Model::EntityNode*>>
+    m_entityNodesByModelPath;
+  std::unordered_map<Model::EntityNode*, std::filesystem::path> m_entityModelPaths;
   std::unique_ptr<Model::TagManager> m_tagManager;
 
+  std::filesystem::path m_entityDefinitionFilePath;
+  std::unique_ptr<IO::FileWatcher> m_assetFileWatcher;
+
   std::unique_ptr<Model::EditorContext> m_editorContext;
   std::unique_ptr<Grid> m_grid;
 
@@ -179,6 +197,7 @@ public: // notification
 
   Notifier<const std::vector<Model::Node*>&> nodeVisibilityDidChangeNotifier;
   Notifier<const std::vector<Model::Node*>&> nodeLockingDidChangeNotifier;
+  Notifier<const std::vector<Model::Node*>&> entityModelsDidChangeNotifier;
 
   Notifier<Model::GroupNode*> groupWasOpenedNotifier;
   Notifier<Model::GroupNode*> groupWasClosedNotifier;
@@ -544,7 +563,8 @@ public: // modifying objects, declared in MapFacade interface
   bool swapNodeContents(
     const std::string& commandName,
     std::vector<std::pair<Model::Node*, Model::NodeContents>> nodesToSwap,
-    std::vector<Model::GroupNode*> changedLinkedGroups);
+    std::vector<Model::GroupNode*> changedLinkedGroups,
+    std::optional<Model::BrushTransformation> brushTransformation = std::nullopt);
   bool swapNodeContents(
     const std::string& commandName,
     std::vector<std::pair<Model::Node*, Model::NodeContents>> nodesToSwap);
@@ -699,15 +719,30 @@ public: // asset management
   void reloadTextureCollections();
   void reloadEntityDefinitions();
 
+  /**
+   * Sets the models of the entities whose models have finished loading in the background
+   * since the last call. Until then, these entities are rendered as bounding boxes.
+   */
+  void processLoadedEntityModels();
+
+  /**
+   * Reloads the textures, entity models and entity definitions whose files have changed
+   * on the disk since the last call. Textures and entity models are reloaded in the
+   * background and replace the current ones in a later call.
+   */
+  void processChangedAssets();
+
 private:
   void loadAssets();
   void unloadAssets();
+  void updateWatchedAssetFiles();
 
   void loadEntityDefinitions();
   void unloadEntityDefinitions();
 
   void loadEntityModels();
   void unloadEntityModels();
+  void prefetchEntityModels();
 
 protected:
   void reloadTextures();
@@ -732,6 +767,8 @@ protected:
   void setEntityModels(const std::vector<Model::Node*>& nodes);
   void unsetEntityModels();
   void unsetEntityModels(const std::vector<Model::Node*>& nodes);
+  void setEntityModel(Model::EntityNode& entityNode);
+  void unsetEntityModel(Model::EntityNode& entityNode);
 
 protected: // search paths and mods
   std::vector<std::filesystem::path> externalSearchPaths() const;
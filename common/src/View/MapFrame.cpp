@@ -117,6 +117,7 @@ MapFrame::MapFrame(FrameManager* frameManager, std::shared_ptr<MapDocument> docu
   , m_lastInputTime(std::chrono::system_clock::now())
   , m_autosaver(std::make_unique<Autosaver>(m_document))
   , m_autosaveTimer(nullptr)
+  , m_entityModelTimer(nullptr)
   , m_toolBar(nullptr)
   , m_hSplitter(nullptr)
   , m_vSplitter(nullptr)
@@ -160,6 +161,11 @@ MapFrame::MapFrame(FrameManager* frameManager, std::shared_ptr<MapDocument> docu
   m_autosaveTimer = new QTimer(this);
   m_autosaveTimer->start(1000);
 
+  // entity models are loaded in the background, check for finished models and for
+  // changed asset files regularly
+  m_entityModelTimer = new QTimer(this);
+  m_entityModelTimer->start(100);
+
   connectObservers();
   bindEvents();
 
@@ -944,6 +950,10 @@ void MapFrame::portalFileDidChange()
 void MapFrame::bindEvents()
 {
   connect(m_autosaveTimer, &QTimer::timeout, this, &MapFrame::triggerAutosave);
+  connect(m_entityModelTimer, &QTimer::timeout, this, [this]() {
+    m_document->processLoadedEntityModels();
+    m_document->processChangedAssets();
+  });
   connect(qApp, &QApplication::focusChanged, this, &MapFrame::focusChange);
   connect(
     m_gridChoice,
@@ -88,6 +88,7 @@ private:
   std::chrono::time_point<std::chrono::system_clock> m_lastInputTime;
   std::unique_ptr<Autosaver> m_autosaver;
   QTimer* m_autosaveTimer;
+  QTimer* m_entityModelTimer;
 
   QToolBar* m_toolBar;
 
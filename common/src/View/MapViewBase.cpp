@@ -158,6 +158,8 @@ void MapViewBase::connectObservers()
     document->nodeVisibilityDidChangeNotifier.connect(this, &MapViewBase::nodesDidChange);
   m_notifierConnection +=
     document->nodeLockingDidChangeNotifier.connect(this, &MapViewBase::nodesDidChange);
+  m_notifierConnection +=
+    document->entityModelsDidChangeNotifier.connect(this, &MapViewBase::nodesDidChange);
   m_notifierConnection +=
     document->commandDoneNotifier.connect(this, &MapViewBase::commandDone);
   m_notifierConnection +=
@@ -19,23 +19,145 @@
 
 #include "SwapNodeContentsCommand.h"
 
-#include "Model/Brush.h"
-#include "Model/Entity.h"
+#include "Model/BrushError.h"
+#include "Model/BrushNode.h"
+#include "Model/EntityNode.h"
+#include "Model/GroupNode.h"
+#include "Model/LayerNode.h"
 #include "Model/Node.h"
+#include "Model/PatchNode.h"
+#include "Model/WorldNode.h"
 #include "View/MapDocumentCommandFacade.h"
 
+#include <kdl/overload.h>
+#include <kdl/parallel.h>
 #include <kdl/result.h>
+#include <kdl/result_fold.h>
 #include <kdl/vector_utils.h>
 
+#include <tuple>
+#include <unordered_map>
+
 namespace TrenchBroom
 {
 namespace View
 {
+namespace
+{
+std::optional<Model::NodeContents> copyNodeContents(const Model::Node* node)
+{
+  // only entities and brushes can be stored as deltas
+  return node->accept(kdl::overload(
+    [](const Model::WorldNode*) -> std::optional<Model::NodeContents> {
+      return std::nullopt;
+    },
+    [](const Model::LayerNode*) -> std::optional<Model::NodeContents> {
+      return std::nullopt;
+    },
+    [](const Model::GroupNode*) -> std::optional<Model::NodeContents> {
+      return std::nullopt;
+    },
+    [](const Model::EntityNode* entityNode) -> std::optional<Model::NodeContents> {
+      return Model::NodeContents{entityNode->entity()};
+    },
+    [](const Model::BrushNode* brushNode) -> std::optional<Model::NodeContents> {
+      return Model::NodeContents{brushNode->brush()};
+    },
+    [](const Model::PatchNode*) -> std::optional<Model::NodeContents> {
+      return std::nullopt;
+    }));
+}
+
+/**
+ * Recreates the snapshots that are stored as deltas from the current node contents. The
+ * returned vector contains an empty optional for each node whose snapshot is not stored
+ * as a delta. Returns an error if a delta cannot be applied, in which case nothing was
+ * changed.
+ */
+kdl::result<std::vector<std::optional<Model::NodeContents>>, Model::BrushError>
+applyNodeContentsDeltas(
+  const std::vector<std::pair<Model::Node*, SwapNodeContentsCommand::ContentsOrDelta>>&
+    nodes)
+{
+  return kdl::fold_results(
+    nodes,
+    [](const auto& pair)
+      -> kdl::result<std::optional<Model::NodeContents>, Model::BrushError> {
+      const auto& [node, contentsOrDelta] = pair;
+      if (const auto* delta = std::get_if<Model::NodeContentsDelta>(&contentsOrDelta))
+      {
+        auto currentContents = copyNodeContents(node);
+        assert(currentContents);
+        return delta->apply(std::move(*currentContents), node->entityPropertyConfig())
+          .transform([](auto contents) { return std::optional{std::move(contents)}; });
+      }
+      return std::optional<Model::NodeContents>{};
+    });
+}
+
+using SwappedNode =
+  std::tuple<Model::Node*, Model::NodeContents, std::optional<Model::NodeContentsDelta>>;
+
+/**
+ * Replaces the given swapped contents with a delta against the current node contents
+ * where possible. If a swapped node already has a delta, it is used without comparing
+ * the contents again.
+ */
+std::vector<std::pair<Model::Node*, SwapNodeContentsCommand::ContentsOrDelta>>
+compactNodeContents(
+  std::vector<SwappedNode> swappedNodes,
+  const std::optional<Model::BrushTransformation>& brushTransformation)
+{
+  return kdl::vec_parallel_transform(
+    std::move(swappedNodes),
+    [&](auto&& swappedNode)
+      -> std::pair<Model::Node*, SwapNodeContentsCommand::ContentsOrDelta> {
+      auto& [node, contents, delta] = swappedNode;
+      if (delta)
+      {
+        return {node, std::move(*delta)};
+      }
+
+      if (const auto currentContents = copyNodeContents(node))
+      {
+        if (
+          auto newDelta = Model::NodeContentsDelta::create(
+            *currentContents,
+            contents,
+            node->entityPropertyConfig(),
+            brushTransformation))
+        {
+          return {node, std::move(*newDelta)};
+        }
+      }
+      return {node, std::move(contents)};
+    });
+}
+
+size_t estimateMemoryUsage(
+  const SwapNodeContentsCommand::ContentsOrDelta& contentsOrDelta)
+{
+  return std::visit(
+    kdl::overload(
+      [](const Model::NodeContents& contents) { return Model::memoryUsage(contents); },
+      [](const Model::NodeContentsDelta& delta) { return delta.memoryUsage(); }),
+    contentsOrDelta);
+}
+} // namespace
+
 SwapNodeContentsCommand::SwapNodeContentsCommand(
   const std::string& name,
-  std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes)
+  std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes,
+  std::optional<Model::BrushTransformation> brushTransformation)
   : UpdateLinkedGroupsCommandBase(name, true)
-  , m_nodes(std::move(nodes))
+  , m_nodes(kdl::vec_transform(
+      std::move(nodes),
+      [](auto&& pair) {
+        return std::pair<Model::Node*, ContentsOrDelta>{
+          pair.first, std::move(pair.second)};
+      }))
+  , m_brushTransformation(std::move(brushTransformation))
+  , m_memoryUsage(0)
 {
 }
 
@@ -44,15 +166,14 @@ SwapNodeContentsCommand::~SwapNodeContentsCommand() = default;
 std::unique_ptr<CommandResult> SwapNodeContentsCommand::doPerformDo(
   MapDocumentCommandFacade* document)
 {
-  document->performSwapNodeContents(m_nodes);
-  return std::make_unique<CommandResult>(true);
+  return swapNodeContents(document, m_brushTransformation);
 }
 
 std::unique_ptr<CommandResult> SwapNodeContentsCommand::doPerformUndo(
   MapDocumentCommandFacade* document)
 {
-  document->performSwapNodeContents(m_nodes);
-  return std::make_unique<CommandResult>(true);
+  // the current contents were not obtained by applying the brush transformation
+  return swapNodeContents(document, std::nullopt);
 }
 
 bool SwapNodeContentsCommand::doCollateWith(UndoableCommand& command)
@@ -67,10 +188,138 @@ bool SwapNodeContentsCommand::doCollateWith(UndoableCommand& command)
     kdl::vec_sort(myNodes);
     kdl::vec_sort(theirNodes);
 
-    return myNodes == theirNodes;
+    if (myNodes != theirNodes)
+    {
+      return false;
+    }
+
+    // our deltas recreate our snapshots from the contents that the other command
+    // replaced, so they must be expanded before the other command is discarded; nothing
+    // is moved until all deltas were applied so that both commands remain intact if a
+    // delta cannot be applied
+    auto theirDeltaContentsResult = applyNodeContentsDeltas(other->m_nodes);
+    if (theirDeltaContentsResult.is_error())
+    {
+      return false;
+    }
+    const auto theirDeltaContents = std::move(theirDeltaContentsResult).value();
+
+    auto theirContents = std::unordered_map<Model::Node*, const Model::NodeContents*>{};
+    for (size_t i = 0; i < other->m_nodes.size(); ++i)
+    {
+      const auto& [node, contentsOrDelta] = other->m_nodes[i];
+      theirContents.emplace(
+        node,
+        theirDeltaContents[i] ? &*theirDeltaContents[i]
+                              : &std::get<Model::NodeContents>(contentsOrDelta));
+    }
+
+    auto myDeltaContents = std::vector<std::optional<Model::NodeContents>>{};
+    myDeltaContents.reserve(m_nodes.size());
+    for (const auto& [node, contentsOrDelta] : m_nodes)
+    {
+      if (const auto* delta = std::get_if<Model::NodeContentsDelta>(&contentsOrDelta))
+      {
+        auto contents =
+          delta->apply(*theirContents.at(node), node->entityPropertyConfig());
+        if (contents.is_error())
+        {
+          return false;
+        }
+        myDeltaContents.push_back(std::move(contents).value());
+      }
+      else
+      {
+        myDeltaContents.push_back(std::nullopt);
+      }
+    }
+
+    auto swappedNodes = std::vector<SwappedNode>{};
+    swappedNodes.reserve(m_nodes.size());
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+      auto& [node, contentsOrDelta] = m_nodes[i];
+      swappedNodes.emplace_back(
+        node,
+        myDeltaContents[i] ? std::move(*myDeltaContents[i])
+                           : std::get<Model::NodeContents>(std::move(contentsOrDelta)),
+        std::nullopt);
+    }
+
+    // the collated command replaces our snapshots with the contents that the other
+    // command created, i.e. it applies our brush transformation followed by theirs
+    m_brushTransformation =
+      m_brushTransformation && other->m_brushTransformation
+        ? Model::composeBrushTransformations(
+            *m_brushTransformation, *other->m_brushTransformation)
+        : std::nullopt;
+    m_nodes = compactNodeContents(std::move(swappedNodes), m_brushTransformation);
+    updateMemoryUsage();
+    return true;
   }
 
   return false;
 }
+
+size_t SwapNodeContentsCommand::doGetMemoryUsage() const
+{
+  return UpdateLinkedGroupsCommandBase::doGetMemoryUsage() + m_memoryUsage;
+}
+
+std::unique_ptr<CommandResult> SwapNodeContentsCommand::swapNodeContents(
+  MapDocumentCommandFacade* document,
+  const std::optional<Model::BrushTransformation>& brushTransformation)
+{
+  return applyNodeContentsDeltas(m_nodes)
+    .transform([&](auto deltaContents) {
+      auto inverseDeltas = std::vector<std::optional<Model::NodeContentsDelta>>{};
+      inverseDeltas.reserve(m_nodes.size());
+
+      auto nodes = std::vector<std::pair<Model::Node*, Model::NodeContents>>{};
+      nodes.reserve(m_nodes.size());
+      for (size_t i = 0; i < m_nodes.size(); ++i)
+      {
+        auto& [node, contentsOrDelta] = m_nodes[i];
+        const auto* delta = std::get_if<Model::NodeContentsDelta>(&contentsOrDelta);
+        inverseDeltas.push_back(delta ? delta->inverse() : std::nullopt);
+        nodes.emplace_back(
+          node,
+          deltaContents[i] ? std::move(*deltaContents[i])
+                           : std::get<Model::NodeContents>(std::move(contentsOrDelta)));
+      }
+      m_nodes.clear();
+
+      document->performSwapNodeContents(nodes);
+
+      auto swappedNodes = std::vector<SwappedNode>{};
+      swappedNodes.reserve(nodes.size());
+      for (size_t i = 0; i < nodes.size(); ++i)
+      {
+        swappedNodes.emplace_back(
+          nodes[i].first, std::move(nodes[i].second), std::move(inverseDeltas[i]));
+      }
+
+      m_nodes = compactNodeContents(std::move(swappedNodes), brushTransformation);
+      updateMemoryUsage();
+      return std::make_unique<CommandResult>(true);
+    })
+    .transform_error([&](const Model::BrushError e) {
+      if (document)
+      {
+        document->error() << "Could not swap node contents: " << e;
+      }
+      return std::make_unique<CommandResult>(false);
+    })
+    .value();
+}
+
+void SwapNodeContentsCommand::updateMemoryUsage()
+{
+  m_memoryUsage = 0;
+  for (const auto& [node, contentsOrDelta] : m_nodes)
+  {
+    m_memoryUsage += estimateMemoryUsage(contentsOrDelta);
+  }
+}
 } // namespace View
 } // namespace TrenchBroom
@@ -21,10 +21,13 @@
 
 #include "Macros.h"
 #include "Model/NodeContents.h"
+#include "Model/NodeContentsDelta.h"
 #include "View/UpdateLinkedGroupsCommandBase.h"
 
 #include <memory>
+#include <optional>
 #include <string>
+#include <variant>
 #include <vector>
 
 namespace TrenchBroom
@@ -39,15 +42,33 @@ class Node;
 
 namespace View
 {
+/**
+ * Replaces the contents of the given nodes with the given contents, and restores the
+ * replaced contents when undone.
+ *
+ * To reduce the memory used by the undo history, the replaced contents are stored as a
+ * delta against the current node contents where possible. The optional brush
+ * transformation allows storing transformed brushes as a transformation only; it must be
+ * the transformation that was applied to the current brushes to obtain the given
+ * contents.
+ */
 class SwapNodeContentsCommand : public UpdateLinkedGroupsCommandBase
 {
+public:
+  using ContentsOrDelta = std::variant<Model::NodeContents, Model::NodeContentsDelta>;
+
 protected:
-  std::vector<std::pair<Model::Node*, Model::NodeContents>> m_nodes;
+  std::vector<std::pair<Model::Node*, ContentsOrDelta>> m_nodes;
+
+private:
+  std::optional<Model::BrushTransformation> m_brushTransformation;
+  size_t m_memoryUsage;
 
 public:
   SwapNodeContentsCommand(
     const std::string& name,
-    std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes);
+    std::vector<std::pair<Model::Node*, Model::NodeContents>> nodes,
+    std::optional<Model::BrushTransformation> brushTransformation = std::nullopt);
   ~SwapNodeContentsCommand();
 
   std::unique_ptr<CommandResult> doPerformDo(MapDocumentCommandFacade* document) override;
@@ -56,6 +77,14 @@ public:
 
   bool doCollateWith(UndoableCommand& command) override;
 
+private:
+  size_t doGetMemoryUsage() const override;
+
+  std::unique_ptr<CommandResult> swapNodeContents(
+    MapDocumentCommandFacade* document,
+    const std::optional<Model::BrushTransformation>& brushTransformation);
+  void updateMemoryUsage();
+
   deleteCopyAndMove(SwapNodeContentsCommand);
 };
 } // namespace View
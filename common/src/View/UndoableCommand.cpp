@@ -75,11 +75,21 @@ bool UndoableCommand::collateWith(UndoableCommand& command)
   return false;
 }
 
+size_t UndoableCommand::memoryUsage() const
+{
+  return doGetMemoryUsage();
+}
+
 bool UndoableCommand::doCollateWith(UndoableCommand&)
 {
   return false;
 }
 
+size_t UndoableCommand::doGetMemoryUsage() const
+{
+  return 0u;
+}
+
 void UndoableCommand::setModificationCount(MapDocumentCommandFacade* document)
 {
   if (document && m_modificationCount)
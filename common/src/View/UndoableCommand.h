@@ -22,6 +22,7 @@
 #include "Macros.h"
 #include "View/Command.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -47,11 +48,18 @@ public:
 
   virtual bool collateWith(UndoableCommand& command);
 
+  /**
+   * Returns an estimate of the memory in bytes that this command uses to store the state
+   * required to undo or redo it.
+   */
+  size_t memoryUsage() const;
+
 protected:
   virtual std::unique_ptr<CommandResult> doPerformUndo(
     MapDocumentCommandFacade* document) = 0;
 
   virtual bool doCollateWith(UndoableCommand& command);
+  virtual size_t doGetMemoryUsage() const;
 
   void setModificationCount(MapDocumentCommandFacade* document);
   void resetModificationCount(MapDocumentCommandFacade* document);
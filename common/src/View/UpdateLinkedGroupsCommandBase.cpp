@@ -107,5 +107,10 @@ bool UpdateLinkedGroupsCommandBase::collateWith(UndoableCommand& command)
   return false;
 }
 
+size_t UpdateLinkedGroupsCommandBase::doGetMemoryUsage() const
+{
+  return m_updateLinkedGroupsHelper.memoryUsage();
+}
+
 } // namespace View
 } // namespace TrenchBroom
@@ -23,6 +23,7 @@
 #include "Model/GroupNode.h"
 #include "Model/ModelUtils.h"
 #include "Model/Node.h"
+#include "Model/NodeContentsDelta.h"
 #include "Model/UpdateLinkedGroupsError.h"
 #include "View/MapDocumentCommandFacade.h"
 
@@ -59,6 +60,7 @@ const auto compareByAncestry = [](const auto* lhs, const auto* rhs) {
 UpdateLinkedGroupsHelper::UpdateLinkedGroupsHelper(
   ChangedLinkedGroups changedLinkedGroups)
   : m_state{kdl::vec_sort(std::move(changedLinkedGroups), compareByAncestry)}
+  , m_memoryUsage{0}
 {
 }
 
@@ -108,6 +110,13 @@ void UpdateLinkedGroupsHelper::collateWith(UpdateLinkedGroupsHelper& other)
         theirGroupNodeToUpdate, std::move(theirOldChildren));
     }
   }
+
+  updateMemoryUsage();
+}
+
+size_t UpdateLinkedGroupsHelper::memoryUsage() const
+{
+  return m_memoryUsage;
 }
 
 kdl::result<void, Model::UpdateLinkedGroupsError> UpdateLinkedGroupsHelper::
@@ -165,6 +174,22 @@ void UpdateLinkedGroupsHelper::doApplyOrUndoLinkedGroupUpdates(
         m_state = document.performReplaceChildren(std::move(linkedGroupUpdates));
       }),
     std::move(m_state));
+  updateMemoryUsage();
+}
+
+void UpdateLinkedGroupsHelper::updateMemoryUsage()
+{
+  m_memoryUsage = 0;
+  if (const auto* linkedGroupUpdates = std::get_if<LinkedGroupUpdates>(&m_state))
+  {
+    for (const auto& [groupNode, children] : *linkedGroupUpdates)
+    {
+      for (const auto& child : children)
+      {
+        m_memoryUsage += Model::memoryUsage(*child);
+      }
+    }
+  }
 }
 } // namespace View
 } // namespace TrenchBroom
@@ -23,6 +23,7 @@
 
 #include <kdl/result_forward.h>
 
+#include <cstddef>
 #include <memory>
 #include <utility>
 #include <variant>
@@ -66,6 +67,7 @@ private:
   using LinkedGroupUpdates =
     std::vector<std::pair<Model::Node*, std::vector<std::unique_ptr<Model::Node>>>>;
   std::variant<ChangedLinkedGroups, LinkedGroupUpdates> m_state;
+  size_t m_memoryUsage;
 
 public:
   explicit UpdateLinkedGroupsHelper(ChangedLinkedGroups changedLinkedGroups);
@@ -76,6 +78,11 @@ public:
   void undoLinkedGroupUpdates(MapDocumentCommandFacade& document);
   void collateWith(UpdateLinkedGroupsHelper& other);
 
+  /**
+   * Returns an estimate of the memory used by the replaced nodes that this helper owns.
+   */
+  size_t memoryUsage() const;
+
 private:
   kdl::result<void, Model::UpdateLinkedGroupsError> computeLinkedGroupUpdates(
     MapDocumentCommandFacade& document);
@@ -84,6 +91,7 @@ private:
     const ChangedLinkedGroups& changedLinkedGroups, MapDocumentCommandFacade& document);
 
   void doApplyOrUndoLinkedGroupUpdates(MapDocumentCommandFacade& document);
+  void updateMemoryUsage();
 };
 } // namespace View
 } // namespace TrenchBroom
@@ -31,10 +31,57 @@
 #include <vecmath/ray.h>
 #include <vecmath/vec.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace TrenchBroom
 {
 namespace View
 {
+vm::bbox3 handleBounds(const vm::vec3& handle)
+{
+  return vm::bbox3{handle, handle};
+}
+
+vm::bbox3 handleBounds(const vm::segment3& handle)
+{
+  return vm::bbox3{
+    vm::min(handle.start(), handle.end()), vm::max(handle.start(), handle.end())};
+}
+
+vm::bbox3 handleBounds(const vm::polygon3& handle)
+{
+  return vm::bbox3::merge_all(std::begin(handle), std::end(handle));
+}
+
+bool intersectsBounds(const vm::ray3& ray, const vm::bbox3& bounds)
+{
+  auto tMin = FloatType(0);
+  auto tMax = std::numeric_limits<FloatType>::max();
+  for (size_t i = 0; i < 3; ++i)
+  {
+    if (ray.direction[i] == FloatType(0))
+    {
+      if (ray.origin[i] < bounds.min[i] || ray.origin[i] > bounds.max[i])
+      {
+        return false;
+      }
+    }
+    else
+    {
+      const auto t1 = (bounds.min[i] - ray.origin[i]) / ray.direction[i];
+      const auto t2 = (bounds.max[i] - ray.origin[i]) / ray.direction[i];
+      tMin = std::max(tMin, std::min(t1, t2));
+      tMax = std::min(tMax, std::max(t1, t2));
+      if (tMin > tMax)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 VertexHandleManagerBase::~VertexHandleManagerBase() {}
 
 const Model::HitType::Type VertexHandleManager::HandleHitType =
@@ -45,10 +92,11 @@ void VertexHandleManager::pick(
   const Renderer::Camera& camera,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  for (const auto* entry : findPickCandidates(pickRay, camera, handleRadius))
   {
-    const auto distance = camera.pickPointHandle(
-      pickRay, position, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+    const auto& position = entry->first;
+    const auto distance = camera.pickPointHandle(pickRay, position, handleRadius);
     if (!vm::is_nan(distance))
     {
       const auto hitPoint = vm::point_at_distance(pickRay, distance);
@@ -63,7 +111,7 @@ void VertexHandleManager::addHandles(const Model::BrushNode* brushNode)
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushVertex* vertex : brush.vertices())
   {
-    add(vertex->position());
+    add(vertex->position(), brushNode);
   }
 }
 
@@ -72,7 +120,7 @@ void VertexHandleManager::removeHandles(const Model::BrushNode* brushNode)
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushVertex* vertex : brush.vertices())
   {
-    assertResult(remove(vertex->position()));
+    assertResult(remove(vertex->position(), brushNode));
   }
 }
 
@@ -96,16 +144,18 @@ void EdgeHandleManager::pickGridHandle(
   const Grid& grid,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  for (const auto* entry : findPickCandidates(pickRay, camera, handleRadius))
   {
-    const FloatType edgeDist = camera.pickLineSegmentHandle(
-      pickRay, position, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+    const auto& position = entry->first;
+    const FloatType edgeDist =
+      camera.pickLineSegmentHandle(pickRay, position, handleRadius);
     if (!vm::is_nan(edgeDist))
     {
       const vm::vec3 pointHandle =
         grid.snap(vm::point_at_distance(pickRay, edgeDist), position);
-      const FloatType pointDist = camera.pickPointHandle(
-        pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+      const FloatType pointDist =
+        camera.pickPointHandle(pickRay, pointHandle, handleRadius);
       if (!vm::is_nan(pointDist))
       {
         const vm::vec3 hitPoint = vm::point_at_distance(pickRay, pointDist);
@@ -121,12 +171,14 @@ void EdgeHandleManager::pickCenterHandle(
   const Renderer::Camera& camera,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  for (const auto* entry : findPickCandidates(pickRay, camera, handleRadius))
   {
+    const auto& position = entry->first;
     const vm::vec3 pointHandle = position.center();
 
-    const FloatType pointDist = camera.pickPointHandle(
-      pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+    const FloatType pointDist =
+      camera.pickPointHandle(pickRay, pointHandle, handleRadius);
     if (!vm::is_nan(pointDist))
     {
       const vm::vec3 hitPoint = vm::point_at_distance(pickRay, pointDist);
@@ -140,7 +192,9 @@ void EdgeHandleManager::addHandles(const Model::BrushNode* brushNode)
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushEdge* edge : brush.edges())
   {
-    add(vm::segment3(edge->firstVertex()->position(), edge->secondVertex()->position()));
+    add(
+      vm::segment3(edge->firstVertex()->position(), edge->secondVertex()->position()),
+      brushNode);
   }
 }
 
@@ -150,7 +204,8 @@ void EdgeHandleManager::removeHandles(const Model::BrushNode* brushNode)
   for (const Model::BrushEdge* edge : brush.edges())
   {
     assertResult(remove(
-      vm::segment3(edge->firstVertex()->position(), edge->secondVertex()->position())));
+      vm::segment3(edge->firstVertex()->position(), edge->secondVertex()->position()),
+      brushNode));
   }
 }
 
@@ -174,8 +229,10 @@ void FaceHandleManager::pickGridHandle(
   const Grid& grid,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  for (const auto* entry : findPickCandidates(pickRay, camera, handleRadius))
   {
+    const auto& position = entry->first;
     const auto [valid, plane] = vm::from_points(std::begin(position), std::end(position));
     if (!valid)
     {
@@ -188,8 +245,7 @@ void FaceHandleManager::pickGridHandle(
     {
       const auto pointHandle = grid.snap(vm::point_at_distance(pickRay, distance), plane);
 
-      const auto pointDist = camera.pickPointHandle(
-        pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+      const auto pointDist = camera.pickPointHandle(pickRay, pointHandle, handleRadius);
       if (!vm::is_nan(pointDist))
       {
         const auto hitPoint = vm::point_at_distance(pickRay, pointDist);
@@ -205,12 +261,13 @@ void FaceHandleManager::pickCenterHandle(
   const Renderer::Camera& camera,
   Model::PickResult& pickResult) const
 {
-  for (const auto& [position, info] : m_handles)
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+  for (const auto* entry : findPickCandidates(pickRay, camera, handleRadius))
   {
+    const auto& position = entry->first;
     const auto pointHandle = position.center();
 
-    const auto pointDist = camera.pickPointHandle(
-      pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+    const auto pointDist = camera.pickPointHandle(pickRay, pointHandle, handleRadius);
     if (!vm::is_nan(pointDist))
     {
       const auto hitPoint = vm::point_at_distance(pickRay, pointDist);
@@ -224,7 +281,7 @@ void FaceHandleManager::addHandles(const Model::BrushNode* brushNode)
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushFace& face : brush.faces())
   {
-    add(face.polygon());
+    add(face.polygon(), brushNode);
   }
 }
 
@@ -233,7 +290,7 @@ void FaceHandleManager::removeHandles(const Model::BrushNode* brushNode)
   const Model::Brush& brush = brushNode->brush();
   for (const Model::BrushFace& face : brush.faces())
   {
-    assertResult(remove(face.polygon()));
+    assertResult(remove(face.polygon(), brushNode));
   }
 }
 
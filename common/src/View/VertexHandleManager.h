@@ -25,11 +25,17 @@
 #include "Model/HitType.h"
 #include "Model/PickResult.h"
 #include "Renderer/Camera.h"
+#include "flat_octree.h"
 
 #include <kdl/vector_set.h>
 
+#include <vecmath/bbox.h>
+#include <vecmath/plane.h>
+#include <vecmath/polygon.h>
+#include <vecmath/ray.h>
 #include <vecmath/segment.h>
 
+#include <algorithm>
 #include <iterator>
 #include <map>
 #include <vector>
@@ -45,6 +51,20 @@ namespace View
 {
 class Grid;
 
+/**
+ * Returns the bounding box of the given handle.
+ */
+vm::bbox3 handleBounds(const vm::vec3& handle);
+vm::bbox3 handleBounds(const vm::segment3& handle);
+vm::bbox3 handleBounds(const vm::polygon3& handle);
+
+/**
+ * Checks whether the given ray's origin is contained in the given bounds or whether the
+ * ray hits the bounds. Unlike vm::intersect_ray_bbox, this doesn't miss the bounds if the
+ * ray enters them exactly through an edge or a corner.
+ */
+bool intersectsBounds(const vm::ray3& ray, const vm::bbox3& bounds);
+
 class VertexHandleManagerBase
 {
 public:
@@ -118,6 +138,12 @@ protected:
     size_t count;
     bool selected;
 
+    /**
+     * The brushes which added this handle. Handles that are added without a brush are
+     * only counted.
+     */
+    std::vector<const Model::BrushNode*> incidentBrushes;
+
     HandleInfo()
       : count(0)
       , selected(false)
@@ -172,12 +198,19 @@ protected:
 
   using HandleMap = std::map<H, HandleInfo>;
   using HandleEntry = typename HandleMap::value_type;
+  using HandleTree = flat_octree<FloatType, HandleEntry*>;
 
   /**
    * Maps a handle position to its info.
    */
   HandleMap m_handles;
 
+  /**
+   * Spatial index of the entries of m_handles. The entries of a std::map are never
+   * moved, so the tree can refer to them directly.
+   */
+  HandleTree m_handleTree;
+
   /**
    * The total number of selected handles, not counting duplicates.
    */
@@ -185,7 +218,8 @@ protected:
 
 public:
   VertexHandleManagerBaseT()
-    : m_selectedHandleCount(0)
+    : m_handleTree(16.0)
+    , m_selectedHandleCount(0)
   {
   }
 
@@ -322,10 +356,20 @@ public:
    *
    * @param handle the handle to add
    */
-  void add(const Handle& handle)
+  void add(const Handle& handle) { insert(handle).inc(); }
+
+  /**
+   * Adds the given handle to this manager and records that the given brush is incident
+   * to it.
+   *
+   * @param handle the handle to add
+   * @param brushNode the brush which the handle belongs to
+   */
+  void add(const Handle& handle, const Model::BrushNode* brushNode)
   {
-    m_handles[handle].inc(); // unknown value gets value constructed, which for HandleInfo
-                             // means its default constructor is called
+    auto& info = insert(handle);
+    info.inc();
+    info.incidentBrushes.push_back(brushNode);
   }
 
   /**
@@ -335,7 +379,17 @@ public:
    * @return true if the given handle was contained in this manager (and therefore
    * removed) and false otherwise
    */
-  bool remove(const Handle& handle)
+  bool remove(const Handle& handle) { return remove(handle, nullptr); }
+
+  /**
+   * Removes the given handle of the given brush from this manager.
+   *
+   * @param handle the handle to remove
+   * @param brushNode the brush which the handle belongs to
+   * @return true if the given handle was contained in this manager (and therefore
+   * removed) and false otherwise
+   */
+  bool remove(const Handle& handle, const Model::BrushNode* brushNode)
   {
     const auto it = m_handles.find(handle);
     if (it != std::end(m_handles))
@@ -343,9 +397,18 @@ public:
       HandleInfo& info = it->second;
       info.dec();
 
+      if (brushNode)
+      {
+        auto& incidentBrushes = info.incidentBrushes;
+        incidentBrushes.erase(
+          std::remove(std::begin(incidentBrushes), std::end(incidentBrushes), brushNode),
+          std::end(incidentBrushes));
+      }
+
       if (info.count == 0)
       {
         deselect(info);
+        m_handleTree.remove(&*it);
         m_handles.erase(it);
       }
       return true;
@@ -359,10 +422,25 @@ public:
    */
   void clear()
   {
+    m_handleTree.clear();
     m_handles.clear();
     m_selectedHandleCount = 0;
   }
 
+private:
+  HandleInfo& insert(const Handle& handle)
+  {
+    // unknown value gets value constructed, which for HandleInfo means its default
+    // constructor is called
+    const auto [it, inserted] = m_handles.try_emplace(handle);
+    if (inserted)
+    {
+      m_handleTree.insert(handleBounds(it->first), &*it);
+    }
+    return it->second;
+  }
+
+public:
   /**
    * Selects the given range of handles.
    *
@@ -466,8 +544,13 @@ private:
   void forEachCloseHandle(const H& otherHandle, F fun)
   {
     static const auto epsilon = 0.001 * 0.001;
-    for (auto& [handle, info] : m_handles)
+
+    // a handle can only be close if its bounds overlap the expanded bounds
+    const auto bounds = handleBounds(otherHandle).expand(epsilon);
+    for (auto* entry : findEntries(
+           [&](const vm::bbox3& nodeBounds) { return nodeBounds.intersects(bounds); }))
     {
+      auto& [handle, info] = *entry;
       if (compare(otherHandle, handle, epsilon) == 0)
       {
         fun(info);
@@ -507,6 +590,79 @@ private:
     }
   }
 
+public:
+  /**
+   * Returns the handles that may lie in the convex volume bounded by the given planes,
+   * such as the volume selected by a lasso. The plane normals must point out of the
+   * volume. The result contains every handle whose bounds intersect the volume, but it
+   * may also contain handles that lie outside of it. The handles are returned in the same
+   * order as by allHandles().
+   *
+   * @param planes the planes bounding the volume
+   * @return a list of candidate handles
+   */
+  HandleList findCandidateHandles(const std::vector<vm::plane3>& planes) const
+  {
+    const auto entries = findEntries([&](const vm::bbox3& nodeBounds) {
+      return std::none_of(std::begin(planes), std::end(planes), [&](const auto& plane) {
+        return detail::is_above(nodeBounds, plane);
+      });
+    });
+
+    HandleList result;
+    result.reserve(entries.size());
+    for (const auto* entry : entries)
+    {
+      result.push_back(entry->first);
+    }
+    return result;
+  }
+
+protected:
+  /**
+   * Returns the entries of the handles that may be hit by the given pick ray. A handle is
+   * hit if the ray intersects a sphere around a point of the handle whose radius is
+   * scaled by the camera's perspective scaling factor at that point, see
+   * Renderer::Camera::pickPointHandle. The scaling factor is an affine function of the
+   * point for all cameras, so its largest absolute value within the bounds of a tree node
+   * is attained at one of their corners, and the bounds can be expanded by the largest
+   * radius before testing them against the ray.
+   *
+   * @param pickRay the picking ray
+   * @param camera the camera
+   * @param handleRadius the unscaled handle radius
+   * @return the entries of the candidate handles, in the order of the handle map
+   */
+  std::vector<HandleEntry*> findPickCandidates(
+    const vm::ray3& pickRay,
+    const Renderer::Camera& camera,
+    const FloatType handleRadius) const
+  {
+    return findEntries([&](const vm::bbox3& nodeBounds) {
+      auto maxScaling = FloatType(0);
+      nodeBounds.for_each_vertex([&](const vm::vec3& vertex) {
+        const auto scaling =
+          static_cast<FloatType>(camera.perspectiveScalingFactor(vm::vec3f{vertex}));
+        maxScaling = std::max(maxScaling, vm::abs(scaling));
+      });
+
+      const auto bounds = nodeBounds.expand(FloatType(2) * handleRadius * maxScaling);
+      return intersectsBounds(pickRay, bounds);
+    });
+  }
+
+private:
+  template <typename P>
+  std::vector<HandleEntry*> findEntries(const P& predicate) const
+  {
+    auto result = m_handleTree.find_matching(predicate);
+    std::sort(
+      std::begin(result), std::end(result), [&](const auto* lhs, const auto* rhs) {
+        return m_handles.key_comp()(lhs->first, rhs->first);
+      });
+    return result;
+  }
+
 public:
   /**
    * Applies the given picking test to all handles in this manager and adds all hits to
@@ -568,9 +724,25 @@ public:
   {
     kdl::vector_set<Model::BrushNode*> result;
     auto out = std::inserter(result, std::end(result));
+
+    kdl::vector_set<const Model::BrushNode*> incidentBrushes;
     for (auto hCur = hBegin; hCur != hEnd; ++hCur)
     {
-      findIncidentBrushes(*hCur, bBegin, bEnd, out);
+      if (!collectIncidentBrushes(*hCur, incidentBrushes))
+      {
+        findIncidentBrushesByTesting(*hCur, bBegin, bEnd, out);
+      }
+    }
+
+    if (!incidentBrushes.empty())
+    {
+      for (auto bCur = bBegin; bCur != bEnd; ++bCur)
+      {
+        if (incidentBrushes.count(*bCur) > 0)
+        {
+          out++ = *bCur;
+        }
+      }
     }
     return result.release_data();
   }
@@ -587,6 +759,51 @@ public:
    */
   template <typename I, typename O>
   void findIncidentBrushes(const Handle& handle, I begin, I end, O out) const
+  {
+    kdl::vector_set<const Model::BrushNode*> incidentBrushes;
+    if (!collectIncidentBrushes(handle, incidentBrushes))
+    {
+      findIncidentBrushesByTesting(handle, begin, end, out);
+      return;
+    }
+
+    for (auto cur = begin; cur != end; ++cur)
+    {
+      if (incidentBrushes.count(*cur) > 0)
+      {
+        out++ = *cur;
+      }
+    }
+  }
+
+private:
+  /**
+   * Adds the brushes that added the given handle to the given set. This fails if the
+   * handle is unknown or if it was also added without a brush.
+   *
+   * @param handle the handle
+   * @param incidentBrushes the set to add the brushes to
+   * @return true if the incident brushes of the given handle are known and false
+   * otherwise
+   */
+  bool collectIncidentBrushes(
+    const Handle& handle, kdl::vector_set<const Model::BrushNode*>& incidentBrushes) const
+  {
+    const auto it = m_handles.find(handle);
+    if (
+      it == std::end(m_handles)
+      || it->second.incidentBrushes.size() != it->second.count)
+    {
+      return false;
+    }
+
+    incidentBrushes.insert(
+      std::begin(it->second.incidentBrushes), std::end(it->second.incidentBrushes));
+    return true;
+  }
+
+  template <typename I, typename O>
+  void findIncidentBrushesByTesting(const Handle& handle, I begin, I end, O out) const
   {
     for (auto cur = begin; cur != end; ++cur)
     {
@@ -597,7 +814,6 @@ public:
     }
   }
 
-private:
   /**
    * Checks whether the given brush is incident to the given handle.
    *
@@ -152,17 +152,7 @@ public:
   std::vector<Model::BrushNode*> findIncidentBrushes(const M& manager, I cur, I end) const
   {
     const std::vector<Model::BrushNode*>& brushes = selectedBrushes();
-    kdl::vector_set<Model::BrushNode*> result;
-    auto out = std::inserter(result, std::end(result));
-
-    while (cur != end)
-    {
-      const auto& handle = *cur;
-      manager.findIncidentBrushes(handle, std::begin(brushes), std::end(brushes), out);
-      ++cur;
-    }
-
-    return result.release_data();
+    return manager.findIncidentBrushes(cur, end, std::begin(brushes), std::end(brushes));
   }
 
   virtual void pick(
@@ -215,11 +205,14 @@ public: // Handle selection
   {
     using HandleList = std::vector<H>;
 
-    const HandleList allHandles = handleManager().allHandles();
+    const HandleList candidateHandles =
+      handleManager().findCandidateHandles(lasso.boundingPlanes());
     HandleList selectedHandles;
 
     lasso.selected(
-      std::begin(allHandles), std::end(allHandles), std::back_inserter(selectedHandles));
+      std::begin(candidateHandles),
+      std::end(candidateHandles),
+      std::back_inserter(selectedHandles));
     if (!modifySelection)
     {
       handleManager().deselectAll();
@@ -0,0 +1,1157 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Ensure.h"
+#include "Exceptions.h"
+#include "octree.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/plane.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace TrenchBroom
+{
+namespace detail
+{
+
+/**
+ * Scrambles the bits of the given hash value. Standard library hashes of pointers and
+ * integers are often the identity function, which clusters badly in an open addressing
+ * table with a power of two capacity.
+ */
+inline uint64_t mix_hash(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+} // namespace detail
+
+/**
+ * An octree with the same node structure and queries as `octree`, but with a linear
+ * memory layout.
+ *
+ * The nodes are stored in contiguous arrays and referenced by index. Their bounds are
+ * stored as a structure of arrays, which is all that a query needs to touch. The data
+ * items are stored in fixed size blocks, and the blocks of each node form a linked list.
+ * Only the first block of a node may be partially filled. When the tree is built in bulk,
+ * the nodes and blocks are laid out in depth first order, which is the Morton order of
+ * their node addresses, and the blocks of each node occupy a contiguous range. Blocks and
+ * nodes that are created later are appended, and the slots of removed blocks and nodes
+ * are reused.
+ *
+ * The location of an item is found using an open addressing hash table that maps the
+ * item to its block and its position within the block.
+ *
+ * @tparam T the floating point type
+ * @tparam U the node data to store in the nodes, must be hashable with std::hash
+ */
+template <typename T, typename U>
+class flat_octree
+{
+private:
+  using index_type = uint32_t;
+  static constexpr auto invalid_index = std::numeric_limits<index_type>::max();
+  static constexpr auto deleted_index = invalid_index - 1;
+  static constexpr auto block_size = index_type(8);
+
+  struct node_bounds
+  {
+    std::vector<T> min_x;
+    std::vector<T> min_y;
+    std::vector<T> min_z;
+    std::vector<T> max_x;
+    std::vector<T> max_y;
+    std::vector<T> max_z;
+  };
+
+  struct build_scratch
+  {
+    std::vector<size_t> order;
+    std::vector<uint8_t> quadrants;
+  };
+
+  T m_min_size;
+  index_type m_root = invalid_index;
+
+  std::vector<detail::node_address> m_node_address;
+  node_bounds m_node_bounds;
+  std::vector<std::array<index_type, 8>> m_node_children;
+  std::vector<index_type> m_node_parent;
+  std::vector<index_type> m_node_first_block;
+  std::vector<index_type> m_free_nodes;
+
+  std::vector<U> m_item_data;
+  std::vector<detail::node_address> m_item_address;
+  std::vector<index_type> m_block_count;
+  std::vector<index_type> m_block_node;
+  std::vector<index_type> m_block_next;
+  std::vector<index_type> m_free_blocks;
+
+  std::vector<index_type> m_index;
+  size_t m_index_used = 0;
+  size_t m_size = 0;
+
+public:
+  explicit flat_octree(const T min_size)
+    : m_min_size{min_size}
+  {
+  }
+
+  /**
+   * Returns the number of data items in this tree.
+   */
+  size_t size() const { return m_size; }
+
+  /**
+   * Indicates whether a node with the given data exists in this tree.
+   *
+   * @param data the data to find
+   * @return true if a node with the given data exists and false otherwise
+   */
+  bool contains(const U& data) const { return find_location(data) != invalid_index; }
+
+  /**
+   * Replaces the contents of this tree with the given data items. This is much faster
+   * than inserting the items one by one, and it yields the memory layout that is best for
+   * queries.
+   *
+   * @param items pairs of bounds and data to add to this tree
+   *
+   * @throws NodeTreeException if any of the bounds is invalid or if the given items
+   * contain duplicate data; the tree is empty afterwards
+   */
+  void build(const std::vector<std::pair<vm::bbox<T, 3>, U>>& items)
+  {
+    clear();
+
+    auto addresses = std::vector<std::pair<detail::node_address, U>>{};
+    addresses.reserve(items.size());
+    for (const auto& [bounds, data] : items)
+    {
+      check(bounds);
+      addresses.emplace_back(detail::get_container(bounds, m_min_size), data);
+    }
+
+    build_from_addresses(std::nullopt, std::move(addresses));
+  }
+
+  void insert(const vm::bbox<T, 3>& bounds, U data)
+  {
+    check(bounds);
+
+    if (contains(data))
+    {
+      throw NodeTreeException("Data already in tree");
+    }
+
+    insert(detail::get_container(bounds, m_min_size), std::move(data));
+  }
+
+  /**
+   * Removes the node with the given data from this tree.
+   *
+   * @param data the data to remove
+   * @return true if a node with the given data was removed, and false otherwise
+   */
+  bool remove(const U& data)
+  {
+    const auto location = find_location(data);
+    if (location == invalid_index)
+    {
+      return false;
+    }
+
+    remove_from_index(data);
+    const auto node = m_block_node[location / block_size];
+    remove_item(location);
+
+    if (--m_size == 0)
+    {
+      clear();
+    }
+    else
+    {
+      prune_node(node);
+    }
+
+    return true;
+  }
+
+  /**
+   * Updates the node with the given data with the given new bounds.
+   *
+   * @param newBounds the new bounds of the node
+   * @param data the node data of the node to update
+   *
+   * @throws NodeTreeException if no node with the given data can be found in this tree
+   */
+  void update(const vm::bbox<T, 3>& newBounds, const U& data)
+  {
+    check(newBounds);
+
+    const auto location = find_location(data);
+    if (location == invalid_index)
+    {
+      throw NodeTreeException("node not found");
+    }
+
+    // most edits don't move an item out of its node
+    if (get_address(location) != detail::get_container(newBounds, m_min_size))
+    {
+      remove(data);
+      insert(newBounds, data);
+    }
+  }
+
+  /**
+   * Clears this node tree.
+   */
+  void clear()
+  {
+    m_root = invalid_index;
+
+    m_node_address.clear();
+    m_node_bounds = node_bounds{};
+    m_node_children.clear();
+    m_node_parent.clear();
+    m_node_first_block.clear();
+    m_free_nodes.clear();
+
+    m_item_data.clear();
+    m_item_address.clear();
+    m_block_count.clear();
+    m_block_node.clear();
+    m_block_next.clear();
+    m_free_blocks.clear();
+
+    m_index.clear();
+    m_index_used = 0;
+    m_size = 0;
+  }
+
+  /**
+   * Indicates whether this tree is empty.
+   *
+   * @return true if this tree is empty and false otherwise
+   */
+  bool empty() const { return m_root == invalid_index; }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the given ray
+   * and retuns a list of those items.
+   *
+   * @param ray the ray to test
+   * @return a list containing all found data items
+   */
+  std::vector<U> find_intersectors(const vm::ray<T, 3>& ray) const
+  {
+    auto result = std::vector<U>{};
+    find_intersectors(ray, std::back_inserter(result));
+    return result;
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the given ray
+   * and appends it to the given output iterator.
+   *
+   * @tparam O the output iterator type
+   * @param ray the ray to test
+   * @param out the output iterator to append to
+   */
+  template <typename O>
+  void find_intersectors(const vm::ray<T, 3>& ray, O out) const
+  {
+    if (m_root != invalid_index)
+    {
+      const auto inv_direction = get_inverse_direction(ray);
+      visit_node_if(
+        m_root,
+        [&](const auto node) { copy_data(node, out); },
+        [&](const auto node) { return intersects(ray, inv_direction, node); });
+    }
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with any of the
+   * given rays. The result is the same as calling find_intersectors for each ray, but the
+   * tree is only traversed once.
+   *
+   * @param rays the rays to test
+   * @return a list containing a list of the found data items for each of the given rays
+   */
+  std::vector<std::vector<U>> find_intersectors(
+    const std::vector<vm::ray<T, 3>>& rays) const
+  {
+    auto result = std::vector<std::vector<U>>(rays.size());
+    visit_intersectors(rays, [&](const size_t ray_index, const U& data) {
+      result[ray_index].push_back(data);
+    });
+    return result;
+  }
+
+  /**
+   * Calls the given function for every pair of a ray and a data item whose bounding box
+   * intersects with that ray. The function is called with the index of the ray and the
+   * data item. All rays that intersect a tree node are passed to the function for each of
+   * the node's data items before the traversal moves on to the next node.
+   *
+   * @tparam F the type of the function to call
+   * @param rays the rays to test
+   * @param f the function to call
+   */
+  template <typename F>
+  void visit_intersectors(const std::vector<vm::ray<T, 3>>& rays, const F& f) const
+  {
+    if (m_root != invalid_index && !rays.empty())
+    {
+      auto inv_directions = std::vector<vm::vec<T, 3>>{};
+      inv_directions.reserve(rays.size());
+
+      auto ray_indices = std::vector<size_t>{};
+      ray_indices.reserve(2 * rays.size());
+
+      for (size_t i = 0; i < rays.size(); ++i)
+      {
+        inv_directions.push_back(get_inverse_direction(rays[i]));
+        ray_indices.push_back(i);
+      }
+
+      visit_intersectors(m_root, rays, inv_directions, ray_indices, 0, f);
+    }
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the given
+   * bounding box and returns a list of those items.
+   *
+   * @param bounds the bounding box to test
+   * @return a list containing all found data items
+   */
+  std::vector<U> find_overlapping(const vm::bbox<T, 3>& bounds) const
+  {
+    auto result = std::vector<U>{};
+    find_overlapping(bounds, std::back_inserter(result));
+    return result;
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the given
+   * bounding box and appends it to the given output iterator.
+   *
+   * @tparam O the output iterator type
+   * @param bounds the bounding box to test
+   * @param out the output iterator to append to
+   */
+  template <typename O>
+  void find_overlapping(const vm::bbox<T, 3>& bounds, O out) const
+  {
+    if (m_root != invalid_index)
+    {
+      visit_node_if(
+        m_root,
+        [&](const auto node) { copy_data(node, out); },
+        [&](const auto node) { return get_bounds(node).intersects(bounds); });
+    }
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the convex
+   * volume bounded by the given planes, such as a view frustum, and returns a list of
+   * those items. The plane normals must point out of the volume.
+   *
+   * @param planes the planes bounding the volume to test
+   * @return a list containing all found data items
+   */
+  std::vector<U> find_overlapping(const std::vector<vm::plane<T, 3>>& planes) const
+  {
+    auto result = std::vector<U>{};
+    find_overlapping(planes, std::back_inserter(result));
+    return result;
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the convex
+   * volume bounded by the given planes and appends it to the given output iterator. The
+   * plane normals must point out of the volume.
+   *
+   * The test is conservative: a bounding box is only rejected if it lies entirely above
+   * one of the planes.
+   *
+   * @tparam O the output iterator type
+   * @param planes the planes bounding the volume to test
+   * @param out the output iterator to append to
+   */
+  template <typename O>
+  void find_overlapping(const std::vector<vm::plane<T, 3>>& planes, O out) const
+  {
+    if (m_root != invalid_index)
+    {
+      visit_node_if(
+        m_root,
+        [&](const auto node) { copy_data(node, out); },
+        [&](const auto node) {
+          const auto bounds = get_bounds(node);
+          return std::none_of(planes.begin(), planes.end(), [&](const auto& plane) {
+            return detail::is_above(bounds, plane);
+          });
+        });
+    }
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box contains the given point and
+   * returns a list of those items.
+   *
+   * @param point the point to test
+   * @return a list containing all found data items
+   */
+  std::vector<U> find_containers(const vm::vec<T, 3>& point) const
+  {
+    auto result = std::vector<U>{};
+    find_containers(point, std::back_inserter(result));
+    return result;
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box contains the given point and
+   * appends it to the given output iterator.
+   *
+   * @tparam O the output iterator type
+   * @param point the point to test
+   * @param out the output iterator to append to
+   */
+  template <typename O>
+  void find_containers(const vm::vec<T, 3>& point, O out) const
+  {
+    if (m_root != invalid_index)
+    {
+      visit_node_if(
+        m_root,
+        [&](const auto node) { copy_data(node, out); },
+        [&](const auto node) { return get_bounds(node).contains(point); });
+    }
+  }
+
+  /**
+   * Finds every data item in this tree that is stored in a node whose bounds satisfy the
+   * given predicate and returns a list of those items.
+   *
+   * @tparam P the type of the predicate
+   * @param predicate the predicate to apply to the node bounds
+   * @return a list containing all found data items
+   */
+  template <typename P>
+  std::vector<U> find_matching(const P& predicate) const
+  {
+    auto result = std::vector<U>{};
+    find_matching(predicate, std::back_inserter(result));
+    return result;
+  }
+
+  /**
+   * Finds every data item in this tree that is stored in a node whose bounds satisfy the
+   * given predicate and appends it to the given output iterator.
+   *
+   * The children of a node are only visited if its bounds satisfy the predicate, so the
+   * predicate must hold for a node if it holds for any of the node's children. Since the
+   * bounds of a node contain the bounding boxes of its data items, the result contains
+   * every data item whose bounding box satisfies such a predicate, but it may also
+   * contain items whose bounding boxes don't satisfy it.
+   *
+   * @tparam P the type of the predicate
+   * @tparam O the output iterator type
+   * @param predicate the predicate to apply to the node bounds
+   * @param out the output iterator to append to
+   */
+  template <typename P, typename O>
+  void find_matching(const P& predicate, O out) const
+  {
+    if (m_root != invalid_index)
+    {
+      visit_node_if(
+        m_root,
+        [&](const auto node) { copy_data(node, out); },
+        [&](const auto node) { return predicate(get_bounds(node)); });
+    }
+  }
+
+private:
+  void check(const vm::bbox<T, 3>& bounds) const
+  {
+    if (vm::is_nan(bounds.min) || vm::is_nan(bounds.max))
+    {
+      throw NodeTreeException("Cannot add node to octree with invalid bounds");
+    }
+  }
+
+  vm::bbox<T, 3> get_bounds(const index_type node) const
+  {
+    return {
+      {m_node_bounds.min_x[node], m_node_bounds.min_y[node], m_node_bounds.min_z[node]},
+      {m_node_bounds.max_x[node], m_node_bounds.max_y[node], m_node_bounds.max_z[node]}};
+  }
+
+  template <typename O>
+  void copy_data(const index_type node, O& out) const
+  {
+    for (auto block = m_node_first_block[node]; block != invalid_index;
+         block = m_block_next[block])
+    {
+      const auto first = block * block_size;
+      for (auto i = first; i < first + m_block_count[block]; ++i)
+      {
+        *out = m_item_data[i];
+        ++out;
+      }
+    }
+  }
+
+  template <typename Predicate, typename Visitor>
+  void visit_node_if(
+    const index_type node, const Visitor& visitor, const Predicate& predicate) const
+  {
+    if (predicate(node))
+    {
+      visitor(node);
+      for (const auto child : m_node_children[node])
+      {
+        if (child != invalid_index)
+        {
+          visit_node_if(child, visitor, predicate);
+        }
+      }
+    }
+  }
+
+  static vm::vec<T, 3> get_inverse_direction(const vm::ray<T, 3>& ray)
+  {
+    return {
+      T(1) / ray.direction.x(), T(1) / ray.direction.y(), T(1) / ray.direction.z()};
+  }
+
+  /**
+   * Slab test of the given ray against the bounds of the given node. Returns true if the
+   * ray's origin is contained in the bounds or if the ray hits the bounds.
+   */
+  bool intersects(
+    const vm::ray<T, 3>& ray,
+    const vm::vec<T, 3>& inv_direction,
+    const index_type node) const
+  {
+    auto t_min = T(0);
+    auto t_max = std::numeric_limits<T>::max();
+
+    const auto clip = [&](const size_t axis, const T min, const T max) {
+      const auto origin = ray.origin[axis];
+      if (ray.direction[axis] == T(0))
+      {
+        return origin >= min && origin <= max;
+      }
+
+      auto t1 = (min - origin) * inv_direction[axis];
+      auto t2 = (max - origin) * inv_direction[axis];
+      if (t1 > t2)
+      {
+        std::swap(t1, t2);
+      }
+      t_min = std::max(t_min, t1);
+      t_max = std::min(t_max, t2);
+      return t_min <= t_max;
+    };
+
+    return clip(0, m_node_bounds.min_x[node], m_node_bounds.max_x[node])
+           && clip(1, m_node_bounds.min_y[node], m_node_bounds.max_y[node])
+           && clip(2, m_node_bounds.min_z[node], m_node_bounds.max_z[node]);
+  }
+
+  /**
+   * Visits the given node with the rays that hit its parent node. See
+   * octree::visit_intersectors.
+   */
+  template <typename F>
+  void visit_intersectors(
+    const index_type node,
+    const std::vector<vm::ray<T, 3>>& rays,
+    const std::vector<vm::vec<T, 3>>& inv_directions,
+    std::vector<size_t>& ray_indices,
+    const size_t first,
+    const F& f) const
+  {
+    const auto last = ray_indices.size();
+    for (size_t i = first; i < last; ++i)
+    {
+      const auto ray_index = ray_indices[i];
+      if (intersects(rays[ray_index], inv_directions[ray_index], node))
+      {
+        ray_indices.push_back(ray_index);
+      }
+    }
+
+    if (ray_indices.size() > last)
+    {
+      for (auto block = m_node_first_block[node]; block != invalid_index;
+           block = m_block_next[block])
+      {
+        const auto first_item = block * block_size;
+        for (auto j = first_item; j < first_item + m_block_count[block]; ++j)
+        {
+          for (size_t i = last; i < ray_indices.size(); ++i)
+          {
+            f(ray_indices[i], m_item_data[j]);
+          }
+        }
+      }
+
+      for (const auto child : m_node_children[node])
+      {
+        if (child != invalid_index)
+        {
+          visit_intersectors(child, rays, inv_directions, ray_indices, last, f);
+        }
+      }
+    }
+
+    ray_indices.resize(last);
+  }
+
+  static detail::node_address get_root_address(const detail::node_address& address)
+  {
+    return detail::is_root(address) ? address : detail::get_root(address);
+  }
+
+  void insert(const detail::node_address& address, U data)
+  {
+    if (m_root == invalid_index)
+    {
+      m_root = allocate_node(get_root_address(address), invalid_index);
+    }
+    else if (!m_node_address[m_root].contains(address))
+    {
+      // Growing the root invalidates the quadrants of all nodes, so we rebuild the tree.
+      auto items = get_items();
+      items.emplace_back(address, std::move(data));
+      build_from_addresses(get_root_address(address), std::move(items));
+      return;
+    }
+
+    const auto node = find_or_create_node(address);
+    const auto location = add_item(node, address, std::move(data));
+    add_to_index(location);
+    ++m_size;
+  }
+
+  std::vector<std::pair<detail::node_address, U>> get_items() const
+  {
+    auto result = std::vector<std::pair<detail::node_address, U>>{};
+    result.reserve(m_size);
+    for (index_type block = 0; block < m_block_count.size(); ++block)
+    {
+      const auto first = block * block_size;
+      for (auto i = first; i < first + m_block_count[block]; ++i)
+      {
+        result.emplace_back(m_item_address[i], m_item_data[i]);
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Builds this tree from the given pairs of node addresses and data. The root address is
+   * the smallest address that contains all items, unless a larger one is given.
+   */
+  void build_from_addresses(
+    const std::optional<detail::node_address>& min_root_address,
+    std::vector<std::pair<detail::node_address, U>> items)
+  {
+    clear();
+
+    if (items.empty())
+    {
+      return;
+    }
+
+    auto root_address = min_root_address.value_or(get_root_address(items.front().first));
+    for (const auto& [address, data] : items)
+    {
+      const auto item_root_address = get_root_address(address);
+      if (item_root_address.size > root_address.size)
+      {
+        root_address = item_root_address;
+      }
+    }
+
+    auto order = std::vector<size_t>(items.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+
+    auto scratch = build_scratch{
+      std::vector<size_t>(items.size()), std::vector<uint8_t>(items.size())};
+    m_root =
+      build_node(root_address, invalid_index, items, order, 0, order.size(), scratch);
+    m_size = items.size();
+
+    rehash(items.size());
+    for (index_type block = 0; block < m_block_count.size(); ++block)
+    {
+      const auto first = block * block_size;
+      for (auto i = first; i < first + m_block_count[block]; ++i)
+      {
+        if (!add_to_index(i))
+        {
+          clear();
+          throw NodeTreeException("Data already in tree");
+        }
+      }
+    }
+  }
+
+  /**
+   * Creates a node with the given address for the items order[first, last). The items
+   * that don't fit into any quadrant of the node are added to it, and the remaining items
+   * are distributed over its children.
+   *
+   * The items are grouped by their quadrants at every level, which is a radix sort by the
+   * Morton codes of their addresses. Since the nodes and their items are created in depth
+   * first order, the items end up in Morton order.
+   */
+  index_type build_node(
+    const detail::node_address& address,
+    const index_type parent,
+    std::vector<std::pair<detail::node_address, U>>& items,
+    std::vector<size_t>& order,
+    const size_t first,
+    const size_t last,
+    build_scratch& scratch)
+  {
+    const auto node = allocate_node(address, parent);
+
+    // bucket 0 holds the items that don't fit into a quadrant, bucket i + 1 holds the
+    // items in quadrant i
+    auto bucket_begin = std::array<size_t, 10>{};
+    for (auto i = first; i < last; ++i)
+    {
+      const auto quadrant = detail::get_quadrant(address, items[order[i]].first);
+      scratch.quadrants[i] = quadrant ? uint8_t(*quadrant + 1) : uint8_t(0);
+      ++bucket_begin[scratch.quadrants[i] + 1u];
+    }
+
+    bucket_begin[0] = first;
+    for (size_t b = 1; b < bucket_begin.size(); ++b)
+    {
+      bucket_begin[b] += bucket_begin[b - 1];
+    }
+
+    auto bucket_end = bucket_begin;
+    for (auto i = first; i < last; ++i)
+    {
+      scratch.order[bucket_end[scratch.quadrants[i]]++] = order[i];
+    }
+    std::copy(
+      scratch.order.begin() + std::ptrdiff_t(first),
+      scratch.order.begin() + std::ptrdiff_t(last),
+      order.begin() + std::ptrdiff_t(first));
+
+    // only the first block may be partially filled
+    const auto count = index_type(bucket_end[0] - first);
+    auto prev_block = invalid_index;
+    auto it = first;
+    for (auto remaining = count; remaining > 0;)
+    {
+      const auto block = allocate_block(node);
+      const auto block_count = remaining == count && remaining % block_size != 0
+                                 ? remaining % block_size
+                                 : block_size;
+      for (auto i = block * block_size; i < block * block_size + block_count; ++i, ++it)
+      {
+        auto& [item_address, data] = items[order[it]];
+        m_item_data[i] = std::move(data);
+        m_item_address[i] = item_address;
+      }
+      m_block_count[block] = block_count;
+      remaining -= block_count;
+
+      if (prev_block == invalid_index)
+      {
+        m_node_first_block[node] = block;
+      }
+      else
+      {
+        m_block_next[prev_block] = block;
+      }
+      prev_block = block;
+    }
+
+    for (size_t quadrant = 0; quadrant < 8; ++quadrant)
+    {
+      const auto child_first = bucket_begin[quadrant + 1];
+      const auto child_last = bucket_end[quadrant + 1];
+      if (child_first < child_last)
+      {
+        auto child_address = items[order[child_first]].first;
+        for (auto i = child_first + 1; i < child_last; ++i)
+        {
+          child_address = detail::get_container(child_address, items[order[i]].first);
+        }
+
+        const auto child = build_node(
+          child_address, node, items, order, child_first, child_last, scratch);
+        m_node_children[node][quadrant] = child;
+      }
+    }
+
+    return node;
+  }
+
+  /**
+   * Returns the node with the given address, or the node that the given address must be
+   * added to because it does not fit into one of the node's quadrants. Missing nodes are
+   * created on the way down from the root.
+   */
+  index_type find_or_create_node(const detail::node_address& address)
+  {
+    auto node = m_root;
+    while (true)
+    {
+      const auto quadrant = detail::get_quadrant(m_node_address[node], address);
+      if (!quadrant)
+      {
+        return node;
+      }
+
+      const auto child = m_node_children[node][*quadrant];
+      if (child == invalid_index)
+      {
+        const auto new_child = allocate_node(address, node);
+        m_node_children[node][*quadrant] = new_child;
+        return new_child;
+      }
+
+      if (m_node_address[child].contains(address))
+      {
+        node = child;
+        continue;
+      }
+
+      // insert a node between node and child that contains both child and address
+      const auto container_address =
+        detail::get_container(m_node_address[child], address);
+      const auto container_quadrant =
+        detail::get_quadrant(container_address, m_node_address[child]);
+      ensure(container_quadrant.has_value(), "child fits into a quadrant of container");
+
+      const auto container = allocate_node(container_address, node);
+      m_node_children[container][*container_quadrant] = child;
+      m_node_parent[child] = container;
+      m_node_children[node][*quadrant] = container;
+      node = container;
+    }
+  }
+
+  /**
+   * Removes the given node and its ancestors while they are empty.
+   */
+  void prune_node(index_type node)
+  {
+    while (node != m_root && m_node_first_block[node] == invalid_index
+           && std::all_of(
+             m_node_children[node].begin(),
+             m_node_children[node].end(),
+             [](const auto child) { return child == invalid_index; }))
+    {
+      const auto parent = m_node_parent[node];
+      auto& siblings = m_node_children[parent];
+      std::replace(siblings.begin(), siblings.end(), node, invalid_index);
+      free_node(node);
+      node = parent;
+    }
+  }
+
+  index_type allocate_node(const detail::node_address& address, const index_type parent)
+  {
+    const auto bounds = address.to_bounds(m_min_size);
+    if (!m_free_nodes.empty())
+    {
+      const auto node = m_free_nodes.back();
+      m_free_nodes.pop_back();
+
+      m_node_address[node] = address;
+      m_node_bounds.min_x[node] = bounds.min.x();
+      m_node_bounds.min_y[node] = bounds.min.y();
+      m_node_bounds.min_z[node] = bounds.min.z();
+      m_node_bounds.max_x[node] = bounds.max.x();
+      m_node_bounds.max_y[node] = bounds.max.y();
+      m_node_bounds.max_z[node] = bounds.max.z();
+      m_node_children[node].fill(invalid_index);
+      m_node_parent[node] = parent;
+      m_node_first_block[node] = invalid_index;
+      return node;
+    }
+
+    const auto node = index_type(m_node_address.size());
+    ensure(node < deleted_index, "too many nodes");
+
+    m_node_address.push_back(address);
+    m_node_bounds.min_x.push_back(bounds.min.x());
+    m_node_bounds.min_y.push_back(bounds.min.y());
+    m_node_bounds.min_z.push_back(bounds.min.z());
+    m_node_bounds.max_x.push_back(bounds.max.x());
+    m_node_bounds.max_y.push_back(bounds.max.y());
+    m_node_bounds.max_z.push_back(bounds.max.z());
+    m_node_children.emplace_back().fill(invalid_index);
+    m_node_parent.push_back(parent);
+    m_node_first_block.push_back(invalid_index);
+    return node;
+  }
+
+  void free_node(const index_type node) { m_free_nodes.push_back(node); }
+
+  index_type allocate_block(const index_type node)
+  {
+    if (!m_free_blocks.empty())
+    {
+      const auto block = m_free_blocks.back();
+      m_free_blocks.pop_back();
+
+      m_block_count[block] = 0;
+      m_block_node[block] = node;
+      m_block_next[block] = invalid_index;
+      return block;
+    }
+
+    const auto block = index_type(m_block_count.size());
+    ensure(block < deleted_index / block_size, "too many blocks");
+
+    m_item_data.resize(m_item_data.size() + block_size);
+    m_item_address.resize(m_item_address.size() + block_size, {0, 0, 0, 0});
+    m_block_count.push_back(0);
+    m_block_node.push_back(node);
+    m_block_next.push_back(invalid_index);
+    return block;
+  }
+
+  void free_block(const index_type block)
+  {
+    m_block_count[block] = 0;
+    m_block_node[block] = invalid_index;
+    m_free_blocks.push_back(block);
+  }
+
+  const U& get_data(const index_type location) const { return m_item_data[location]; }
+
+  const detail::node_address& get_address(const index_type location) const
+  {
+    return m_item_address[location];
+  }
+
+  /**
+   * Adds the given item to the first block of the given node and returns its location.
+   */
+  index_type add_item(const index_type node, const detail::node_address& address, U data)
+  {
+    auto block = m_node_first_block[node];
+    if (block == invalid_index || m_block_count[block] == block_size)
+    {
+      const auto new_block = allocate_block(node);
+      m_block_next[new_block] = block;
+      m_node_first_block[node] = new_block;
+      block = new_block;
+    }
+
+    const auto location = block * block_size + m_block_count[block]++;
+    m_item_data[location] = std::move(data);
+    m_item_address[location] = address;
+    return location;
+  }
+
+  /**
+   * Removes the item at the given location by moving the last item of the first block of
+   * its node into its place. The first block is released when it becomes empty.
+   */
+  void remove_item(const index_type location)
+  {
+    const auto block = location / block_size;
+    const auto node = m_block_node[block];
+    const auto first_block = m_node_first_block[node];
+    const auto last_location = first_block * block_size + m_block_count[first_block] - 1;
+
+    if (location != last_location)
+    {
+      m_item_data[location] = std::move(m_item_data[last_location]);
+      m_item_address[location] = m_item_address[last_location];
+      update_index(m_item_data[location], location);
+    }
+
+    if (--m_block_count[first_block] == 0)
+    {
+      m_node_first_block[node] = m_block_next[first_block];
+      free_block(first_block);
+    }
+  }
+
+  size_t get_index_slot(const U& data) const
+  {
+    return size_t(detail::mix_hash(std::hash<U>{}(data))) & (m_index.size() - 1);
+  }
+
+  index_type find_location(const U& data) const
+  {
+    if (m_index.empty())
+    {
+      return invalid_index;
+    }
+
+    for (auto slot = get_index_slot(data);; slot = (slot + 1) & (m_index.size() - 1))
+    {
+      const auto location = m_index[slot];
+      if (location == invalid_index)
+      {
+        return invalid_index;
+      }
+      if (location != deleted_index && get_data(location) == data)
+      {
+        return location;
+      }
+    }
+  }
+
+  /**
+   * Adds the item at the given location to the index. Returns false if the index already
+   * contains an item with the same data.
+   */
+  bool add_to_index(const index_type location)
+  {
+    if (2 * (m_index_used + 1) > m_index.size())
+    {
+      rehash(m_size + 1);
+    }
+
+    const auto& data = get_data(location);
+    auto free_slot = std::optional<size_t>{};
+    for (auto slot = get_index_slot(data);; slot = (slot + 1) & (m_index.size() - 1))
+    {
+      const auto other = m_index[slot];
+      if (other == invalid_index)
+      {
+        if (!free_slot)
+        {
+          free_slot = slot;
+          ++m_index_used;
+        }
+        break;
+      }
+      if (other == deleted_index)
+      {
+        if (!free_slot)
+        {
+          free_slot = slot;
+        }
+      }
+      else if (get_data(other) == data)
+      {
+        return false;
+      }
+    }
+
+    m_index[*free_slot] = location;
+    return true;
+  }
+
+  /**
+   * Sets the location of the given data in the index.
+   */
+  void update_index(const U& data, const index_type location)
+  {
+    for (auto slot = get_index_slot(data);; slot = (slot + 1) & (m_index.size() - 1))
+    {
+      const auto other = m_index[slot];
+      assert(other != invalid_index);
+      if (other != deleted_index && get_data(other) == data)
+      {
+        m_index[slot] = location;
+        return;
+      }
+    }
+  }
+
+  void remove_from_index(const U& data)
+  {
+    for (auto slot = get_index_slot(data);; slot = (slot + 1) & (m_index.size() - 1))
+    {
+      const auto location = m_index[slot];
+      assert(location != invalid_index);
+      if (location != deleted_index && get_data(location) == data)
+      {
+        m_index[slot] = deleted_index;
+        return;
+      }
+    }
+  }
+
+  /**
+   * Resizes the index so that it can hold the given number of items at a load factor of
+   * at most one quarter, and drops all deleted slots. The index grows again once more
+   * than half of its slots are used.
+   */
+  void rehash(const size_t count)
+  {
+    auto capacity = size_t(16);
+    while (capacity < 4 * count)
+    {
+      capacity *= 2;
+    }
+
+    const auto old_index =
+      std::exchange(m_index, std::vector<index_type>(capacity, invalid_index));
+    m_index_used = 0;
+
+    for (const auto location : old_index)
+    {
+      if (location != invalid_index && location != deleted_index)
+      {
+        auto slot = get_index_slot(get_data(location));
+        while (m_index[slot] != invalid_index)
+        {
+          slot = (slot + 1) & (m_index.size() - 1);
+        }
+        m_index[slot] = location;
+        ++m_index_used;
+      }
+    }
+  }
+};
+
+} // namespace TrenchBroom
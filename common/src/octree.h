@@ -30,6 +30,7 @@
 #include <vecmath/bbox.h>
 #include <vecmath/bbox_io.h>
 #include <vecmath/intersection.h>
+#include <vecmath/plane.h>
 #include <vecmath/ray.h>
 #include <vecmath/scalar.h>
 
@@ -119,6 +120,21 @@ node_address get_container(const vm::bbox<T, 3>& bounds, const T min_size)
   return min_address;
 }
 
+/**
+ * Indicates whether the given bounding box lies entirely above the given plane, i.e., on
+ * the side that the plane normal points to.
+ */
+template <typename T>
+bool is_above(const vm::bbox<T, 3>& bounds, const vm::plane<T, 3>& plane)
+{
+  // the corner that is farthest from the plane in the opposite direction of its normal
+  const auto corner = vm::vec<T, 3>{
+    plane.normal.x() >= T(0) ? bounds.min.x() : bounds.max.x(),
+    plane.normal.y() >= T(0) ? bounds.min.y() : bounds.max.y(),
+    plane.normal.z() >= T(0) ? bounds.min.z() : bounds.max.z()};
+  return plane.point_distance(corner) > T(0);
+}
+
 } // namespace detail
 
 /**
@@ -531,6 +547,134 @@ public:
    */
   template <typename O>
   void find_intersectors(const vm::ray<T, 3>& ray, O out) const
+  {
+    if (m_root)
+    {
+      visit_node_if(
+        *m_root,
+        [&](const auto& node) {
+          const auto& data = get_data(node);
+          std::copy(data.begin(), data.end(), out);
+        },
+        [&](const auto& node) {
+          return intersects(ray, get_address(node).to_bounds(m_min_size));
+        });
+    }
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with any of the
+   * given rays. The result is the same as calling find_intersectors for each ray, but the
+   * tree is only traversed once, and every node is only visited by the rays that hit its
+   * parent node.
+   *
+   * @param rays the rays to test
+   * @return a list containing a list of the found data items for each of the given rays
+   */
+  std::vector<std::vector<U>> find_intersectors(
+    const std::vector<vm::ray<T, 3>>& rays) const
+  {
+    auto result = std::vector<std::vector<U>>(rays.size());
+    visit_intersectors(rays, [&](const size_t ray_index, const U& data) {
+      result[ray_index].push_back(data);
+    });
+    return result;
+  }
+
+  /**
+   * Calls the given function for every pair of a ray and a data item whose bounding box
+   * intersects with that ray. The function is called with the index of the ray and the
+   * data item. All rays that intersect a tree node are passed to the function for each of
+   * the node's data items before the traversal moves on to the next node.
+   *
+   * @tparam F the type of the function to call
+   * @param rays the rays to test
+   * @param f the function to call
+   */
+  template <typename F>
+  void visit_intersectors(const std::vector<vm::ray<T, 3>>& rays, const F& f) const
+  {
+    if (m_root && !rays.empty())
+    {
+      auto ray_indices = std::vector<size_t>{};
+      ray_indices.reserve(2 * rays.size());
+      for (size_t i = 0; i < rays.size(); ++i)
+      {
+        ray_indices.push_back(i);
+      }
+
+      visit_intersectors(*m_root, rays, ray_indices, 0, f);
+    }
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the given
+   * bounding box and returns a list of those items.
+   *
+   * @param bounds the bounding box to test
+   * @return a list containing all found data items
+   */
+  std::vector<U> find_overlapping(const vm::bbox<T, 3>& bounds) const
+  {
+    auto result = std::vector<U>{};
+    find_overlapping(bounds, std::back_inserter(result));
+    return result;
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the given
+   * bounding box and appends it to the given output iterator.
+   *
+   * @tparam O the output iterator type
+   * @param bounds the bounding box to test
+   * @param out the output iterator to append to
+   */
+  template <typename O>
+  void find_overlapping(const vm::bbox<T, 3>& bounds, O out) const
+  {
+    if (m_root)
+    {
+      visit_node_if(
+        *m_root,
+        [&](const auto& node) {
+          const auto& data = get_data(node);
+          std::copy(data.begin(), data.end(), out);
+        },
+        [&](const auto& node) {
+          return get_address(node).to_bounds(m_min_size).intersects(bounds);
+        });
+    }
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the convex
+   * volume bounded by the given planes, such as a view frustum, and returns a list of
+   * those items. The plane normals must point out of the volume.
+   *
+   * @param planes the planes bounding the volume to test
+   * @return a list containing all found data items
+   */
+  std::vector<U> find_overlapping(const std::vector<vm::plane<T, 3>>& planes) const
+  {
+    auto result = std::vector<U>{};
+    find_overlapping(planes, std::back_inserter(result));
+    return result;
+  }
+
+  /**
+   * Finds every data item in this tree whose bounding box intersects with the convex
+   * volume bounded by the given planes and appends it to the given output iterator. The
+   * plane normals must point out of the volume.
+   *
+   * The test is conservative: a bounding box is only rejected if it lies entirely above
+   * one of the planes.
+   *
+   * @tparam O the output iterator type
+   * @param planes the planes bounding the volume to test
+   * @param out the output iterator to append to
+   */
+  template <typename O>
+  void find_overlapping(const std::vector<vm::plane<T, 3>>& planes, O out) const
   {
     if (m_root)
     {
@@ -542,8 +686,9 @@ public:
         },
         [&](const auto& node) {
           const auto bounds = get_address(node).to_bounds(m_min_size);
-          return bounds.contains(ray.origin)
-                 || !vm::is_nan(vm::intersect_ray_bbox(ray, bounds));
+          return std::none_of(planes.begin(), planes.end(), [&](const auto& plane) {
+            return detail::is_above(bounds, plane);
+          });
         });
     }
   }
@@ -590,6 +735,59 @@ public:
   kdl_reflect_inline(octree, m_root, m_min_size, m_node_address_for_data);
 
 private:
+  static bool intersects(const vm::ray<T, 3>& ray, const vm::bbox<T, 3>& bounds)
+  {
+    return bounds.contains(ray.origin)
+           || !vm::is_nan(vm::intersect_ray_bbox(ray, bounds));
+  }
+
+  /**
+   * Visits the given node with the rays that hit its parent node. The indices of these
+   * rays are stored in ray_indices, starting at the given offset. The indices of the rays
+   * that hit the given node are appended to ray_indices for the node's children and
+   * removed again before returning.
+   */
+  template <typename F>
+  void visit_intersectors(
+    const node& node_,
+    const std::vector<vm::ray<T, 3>>& rays,
+    std::vector<size_t>& ray_indices,
+    const size_t first,
+    const F& f) const
+  {
+    const auto bounds = get_address(node_).to_bounds(m_min_size);
+    const auto last = ray_indices.size();
+    for (size_t i = first; i < last; ++i)
+    {
+      const auto ray_index = ray_indices[i];
+      if (intersects(rays[ray_index], bounds))
+      {
+        ray_indices.push_back(ray_index);
+      }
+    }
+
+    if (ray_indices.size() > last)
+    {
+      for (const auto& data : get_data(node_))
+      {
+        for (size_t i = last; i < ray_indices.size(); ++i)
+        {
+          f(ray_indices[i], data);
+        }
+      }
+
+      if (const auto* inner = std::get_if<inner_node>(&node_))
+      {
+        for (const auto& child : inner->children)
+        {
+          visit_intersectors(child, rays, ray_indices, last, f);
+        }
+      }
+    }
+
+    ray_indices.resize(last);
+  }
+
   void check(const vm::bbox<T, 3>& bounds) const
   {
     if (vm::is_nan(bounds.min) || vm::is_nan(bounds.max))
@@ -0,0 +1,273 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/EntityModel.h"
+#include "Assets/EntityModelManager.h"
+#include "Assets/ModelDefinition.h"
+#include "Exceptions.h"
+#include "IO/EntityModelLoader.h"
+#include "TestLogger.h"
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Assets
+{
+namespace
+{
+class TestEntityModelLoader : public IO::EntityModelLoader
+{
+public:
+  mutable std::atomic<size_t> initializeCount = 0;
+  mutable std::atomic<size_t> loadFrameCount = 0;
+
+private:
+  std::unique_ptr<EntityModel> doInitializeModel(
+    const std::filesystem::path& path, Logger& logger) const override
+  {
+    ++initializeCount;
+    if (path == "missing.mdl")
+    {
+      throw GameException{"Could not load model " + path.string()};
+    }
+
+    logger.info() << "Initialized " << path;
+    auto model = std::make_unique<EntityModel>(
+      path.string(), PitchType::Normal, Orientation::Oriented);
+    model->addFrame();
+    model->addFrame();
+    return model;
+  }
+
+  void doLoadFrame(
+    const std::filesystem::path& /* path */,
+    const size_t frameIndex,
+    EntityModel& model,
+    Logger& /* logger */) const override
+  {
+    ++loadFrameCount;
+    model.loadFrame(frameIndex, "frame", vm::bbox3f{8.0f});
+  }
+};
+
+std::vector<std::filesystem::path> processAllLoadedModels(EntityModelManager& manager)
+{
+  auto result = std::vector<std::filesystem::path>{};
+  while (manager.queuedModelCount() > 0)
+  {
+    const auto loadedPaths = manager.processLoadedModels();
+    result.insert(result.end(), loadedPaths.begin(), loadedPaths.end());
+    std::this_thread::yield();
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("EntityModelManagerTest.loadedFrame")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  const auto spec = ModelSpecification{"model.mdl", 0, 1};
+
+  CHECK(manager.loadedFrame(spec) == nullptr);
+  CHECK(manager.renderer(spec) == nullptr);
+  CHECK(manager.queuedModelCount() == 1u);
+
+  CHECK(
+    processAllLoadedModels(manager) == std::vector<std::filesystem::path>{"model.mdl"});
+  CHECK(manager.queuedModelCount() == 0u);
+  CHECK(manager.loadedModelCount() == 1u);
+  CHECK(manager.failedModelCount() == 0u);
+
+  // the requested frame was loaded in the background
+  CHECK(loader.loadFrameCount == 1u);
+  CHECK(logger.countMessages(LogLevel::Info) == 1u);
+
+  const auto* frame = manager.loadedFrame(spec);
+  REQUIRE(frame != nullptr);
+  CHECK(frame->index() == 1u);
+  CHECK(frame->loaded());
+
+  // other frames of a loaded model are loaded on demand
+  const auto* otherFrame = manager.loadedFrame(ModelSpecification{"model.mdl", 0, 0});
+  REQUIRE(otherFrame != nullptr);
+  CHECK(otherFrame->loaded());
+  CHECK(loader.loadFrameCount == 2u);
+  CHECK(loader.initializeCount == 1u);
+
+  CHECK(manager.loadedFrame(ModelSpecification{"model.mdl", 0, 2}) == nullptr);
+  CHECK(manager.loadedFrame(ModelSpecification{}) == nullptr);
+  CHECK(manager.queuedModelCount() == 0u);
+}
+
+TEST_CASE("EntityModelManagerTest.frame")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  const auto spec = ModelSpecification{"model.mdl", 0, 0};
+
+  SECTION("Loads model immediately")
+  {
+    const auto* frame = manager.frame(spec);
+    REQUIRE(frame != nullptr);
+    CHECK(frame->loaded());
+  }
+
+  SECTION("Waits for pending model")
+  {
+    CHECK(manager.loadedFrame(spec) == nullptr);
+    CHECK(manager.frame(spec) != nullptr);
+
+    // the model was installed by frame, so it is not reported again
+    CHECK(manager.processLoadedModels().empty());
+  }
+
+  CHECK(manager.queuedModelCount() == 0u);
+  CHECK(manager.loadedModelCount() == 1u);
+  CHECK(loader.initializeCount == 1u);
+}
+
+TEST_CASE("EntityModelManagerTest.failedModel")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  const auto spec = ModelSpecification{"missing.mdl", 0, 0};
+
+  CHECK(manager.loadedFrame(spec) == nullptr);
+  CHECK(
+    processAllLoadedModels(manager) == std::vector<std::filesystem::path>{"missing.mdl"});
+  CHECK(manager.loadedModelCount() == 0u);
+  CHECK(manager.failedModelCount() == 1u);
+  CHECK(logger.countMessages(LogLevel::Error) == 1u);
+
+  // failed models are not loaded again
+  CHECK(manager.loadedFrame(spec) == nullptr);
+  CHECK(manager.frame(spec) == nullptr);
+  CHECK(manager.queuedModelCount() == 0u);
+  CHECK(loader.initializeCount == 1u);
+}
+
+TEST_CASE("EntityModelManagerTest.prefetch")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  manager.prefetch({
+    {"model1.mdl", 0, 0},
+    {"model1.mdl", 0, 1},
+    {"model2.mdl", 0, 1},
+    {"missing.mdl", 0, 0},
+    {},
+  });
+  CHECK(manager.queuedModelCount() == 3u);
+
+  // prefetching again does not queue the models again
+  manager.prefetch({{"model1.mdl", 0, 0}});
+  CHECK(manager.queuedModelCount() == 3u);
+
+  CHECK_THAT(
+    processAllLoadedModels(manager),
+    Catch::UnorderedEquals(
+      std::vector<std::filesystem::path>{"model1.mdl", "model2.mdl", "missing.mdl"}));
+  CHECK(manager.loadedModelCount() == 2u);
+  CHECK(manager.failedModelCount() == 1u);
+
+  // all prefetched frames were loaded in the background
+  CHECK(loader.loadFrameCount == 3u);
+  CHECK(manager.loadedFrame({"model1.mdl", 0, 0}) != nullptr);
+  CHECK(manager.loadedFrame({"model1.mdl", 0, 1}) != nullptr);
+  CHECK(manager.loadedFrame({"model2.mdl", 0, 1}) != nullptr);
+  CHECK(loader.loadFrameCount == 3u);
+}
+
+TEST_CASE("EntityModelManagerTest.clear")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  manager.prefetch({{"model1.mdl", 0, 0}, {"model2.mdl", 0, 0}});
+  CHECK(manager.queuedModelCount() == 2u);
+
+  auto otherLoader = TestEntityModelLoader{};
+  manager.setLoader(&otherLoader);
+
+  // pending models were cancelled and will not be installed
+  CHECK(manager.queuedModelCount() == 0u);
+  CHECK(manager.processLoadedModels().empty());
+  CHECK(manager.loadedModelCount() == 0u);
+  CHECK(loader.initializeCount <= 2u);
+
+  CHECK(manager.loadedFrame({"model1.mdl", 0, 0}) == nullptr);
+  CHECK(
+    processAllLoadedModels(manager) == std::vector<std::filesystem::path>{"model1.mdl"});
+  CHECK(otherLoader.initializeCount == 1u);
+}
+
+TEST_CASE("EntityModelManagerTest.suspendPendingModels")
+{
+  auto logger = TestLogger{};
+  auto loader = TestEntityModelLoader{};
+  auto manager = EntityModelManager{0, 0, logger};
+  manager.setLoader(&loader);
+
+  CHECK(manager.frame({"model1.mdl", 0, 0}) != nullptr);
+  CHECK(loader.initializeCount == 1u);
+
+  manager.reloadModels({"model1.mdl"});
+  manager.prefetch({{"model2.mdl", 0, 0}});
+  CHECK(manager.queuedModelCount() == 2u);
+
+  // no loads are pending or running while the models are suspended
+  manager.suspendPendingModels();
+  CHECK(manager.queuedModelCount() == 0u);
+  CHECK(manager.processLoadedModels().empty());
+  const auto initializeCount = loader.initializeCount.load();
+
+  // the suspended models are queued again
+  manager.resumePendingModels();
+  CHECK(manager.queuedModelCount() == 2u);
+  CHECK_THAT(
+    processAllLoadedModels(manager),
+    Catch::UnorderedEquals(
+      std::vector<std::filesystem::path>{"model1.mdl", "model2.mdl"}));
+  CHECK(loader.initializeCount == initializeCount + 2u);
+  CHECK(manager.loadedModelCount() == 2u);
+}
+} // namespace Assets
+} // namespace TrenchBroom
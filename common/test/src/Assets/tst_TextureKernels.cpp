@@ -0,0 +1,233 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/TextureBuffer.h"
+#include "Assets/TextureKernels.h"
+
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom::Assets
+{
+
+namespace
+{
+std::vector<unsigned char> makeRandomBytes(const size_t count, const unsigned int seed)
+{
+  auto engine = std::mt19937{seed};
+  auto distribution = std::uniform_int_distribution<int>{0, 255};
+
+  auto result = std::vector<unsigned char>(count);
+  for (auto& b : result)
+  {
+    b = static_cast<unsigned char>(distribution(engine));
+  }
+  return result;
+}
+
+std::vector<unsigned char> makePalette(const bool transparentIndex)
+{
+  auto result = makeRandomBytes(1024, 7);
+  for (size_t i = 0; i < 256; ++i)
+  {
+    result[4 * i + 3] = 0xFF;
+  }
+  if (transparentIndex)
+  {
+    result[1023] = 0;
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("TextureKernelsTest.availableInstructionSets")
+{
+  const auto instructionSets = availableKernelInstructionSets();
+  REQUIRE(!instructionSets.empty());
+  CHECK(instructionSets.front() == KernelInstructionSet::Scalar);
+  CHECK(instructionSets.back() == bestKernelInstructionSet());
+}
+
+TEST_CASE("TextureKernelsTest.expandPalette")
+{
+  const auto instructionSet = GENERATE(from_range(availableKernelInstructionSets()));
+  const auto pixelCount =
+    GENERATE(size_t(0), size_t(1), size_t(7), size_t(33), size_t(4096));
+
+  CAPTURE(instructionSet, pixelCount);
+
+  SECTION("Opaque palette")
+  {
+    const auto palette = makePalette(false);
+    auto indices = makeRandomBytes(pixelCount, 1);
+
+    auto expected = std::vector<unsigned char>(4 * pixelCount);
+    const auto expectedResult = expandPalette(
+      indices.data(),
+      pixelCount,
+      palette.data(),
+      expected.data(),
+      KernelInstructionSet::Scalar);
+
+    auto actual = std::vector<unsigned char>(4 * pixelCount);
+    const auto actualResult = expandPalette(
+      indices.data(), pixelCount, palette.data(), actual.data(), instructionSet);
+
+    CHECK(actual == expected);
+    CHECK(actualResult.colorSum == expectedResult.colorSum);
+    CHECK(actualResult.alphaAnd == 0xFF);
+    CHECK(expectedResult.alphaAnd == 0xFF);
+  }
+
+  SECTION("Palette with transparent index")
+  {
+    const auto palette = makePalette(true);
+    auto indices = makeRandomBytes(pixelCount, 2);
+    for (auto& index : indices)
+    {
+      // avoid that the random data contains the transparent index
+      index = static_cast<unsigned char>(index % 255);
+    }
+
+    const auto transparentPixel = GENERATE(size_t(0), size_t(6), size_t(4095));
+    const auto hasTransparentPixel = transparentPixel < pixelCount;
+    if (hasTransparentPixel)
+    {
+      indices[transparentPixel] = 255;
+    }
+
+    auto expected = std::vector<unsigned char>(4 * pixelCount);
+    const auto expectedResult = expandPalette(
+      indices.data(),
+      pixelCount,
+      palette.data(),
+      expected.data(),
+      KernelInstructionSet::Scalar);
+
+    auto actual = std::vector<unsigned char>(4 * pixelCount);
+    const auto actualResult = expandPalette(
+      indices.data(), pixelCount, palette.data(), actual.data(), instructionSet);
+
+    CHECK(actual == expected);
+    CHECK(actualResult.colorSum == expectedResult.colorSum);
+    CHECK(actualResult.alphaAnd == expectedResult.alphaAnd);
+    CHECK((actualResult.alphaAnd != 0xFF) == hasTransparentPixel);
+  }
+}
+
+TEST_CASE("TextureKernelsTest.sumColors")
+{
+  const auto instructionSet = GENERATE(from_range(availableKernelInstructionSets()));
+  const auto pixelCount = GENERATE(size_t(0), size_t(1), size_t(13), size_t(65536));
+
+  CAPTURE(instructionSet, pixelCount);
+
+  const auto rgba = makeRandomBytes(4 * pixelCount, 3);
+  CHECK(
+    sumColors(rgba.data(), pixelCount, instructionSet)
+    == sumColors(rgba.data(), pixelCount, KernelInstructionSet::Scalar));
+
+  const auto white = std::vector<unsigned char>(4 * pixelCount, 0xFF);
+  const auto expected = uint64_t(255) * pixelCount;
+  CHECK(
+    sumColors(white.data(), pixelCount, instructionSet)
+    == std::array<uint64_t, 3>{expected, expected, expected});
+}
+
+TEST_CASE("TextureKernelsTest.downsampleBox")
+{
+  SECTION("Rounds the average of each 2x2 block")
+  {
+    // clang-format off
+    const auto src = std::vector<unsigned char>{
+      0,   0,   0,   0,      1,   2,   3,   4,
+      255, 255, 255, 255,    1,   2,   3,   5,
+    };
+    // clang-format on
+
+    for (const auto instructionSet : availableKernelInstructionSets())
+    {
+      CAPTURE(instructionSet);
+
+      auto dst = std::vector<unsigned char>(4);
+      downsampleBox(src.data(), 2, 2, dst.data(), instructionSet);
+      CHECK(dst == std::vector<unsigned char>{64, 65, 65, 66});
+    }
+  }
+
+  SECTION("Matches the scalar kernel")
+  {
+    const auto instructionSet = GENERATE(from_range(availableKernelInstructionSets()));
+    const auto [width, height] = GENERATE(values<std::tuple<size_t, size_t>>({
+      {1, 1},
+      {2, 1},
+      {1, 2},
+      {5, 3},
+      {16, 16},
+      {34, 18},
+      {64, 1},
+      {1, 64},
+      {256, 128},
+    }));
+
+    CAPTURE(instructionSet, width, height);
+
+    const auto src = makeRandomBytes(4 * width * height, 4);
+    const auto dstSize = sizeAtMipLevel(width, height, 1);
+
+    auto expected = std::vector<unsigned char>(4 * dstSize.x() * dstSize.y());
+    downsampleBox(
+      src.data(), width, height, expected.data(), KernelInstructionSet::Scalar);
+
+    auto actual = std::vector<unsigned char>(4 * dstSize.x() * dstSize.y());
+    downsampleBox(src.data(), width, height, actual.data(), instructionSet);
+
+    CHECK(actual == expected);
+  }
+}
+
+TEST_CASE("TextureKernelsTest.generateMips")
+{
+  auto buffers = TextureBufferList{};
+  setMipBufferSize(buffers, 4, 16, 8, GL_RGBA);
+  std::fill_n(buffers[0].data(), buffers[0].size(), 0x40);
+  std::fill_n(buffers[1].data(), buffers[1].size(), 0x80);
+
+  generateMips(buffers, 16, 8, 2);
+
+  CHECK(buffers[2].size() == 4 * 4 * 2);
+  CHECK(buffers[3].size() == 4 * 2 * 1);
+
+  for (size_t level = 2; level < 4; ++level)
+  {
+    CHECK(std::all_of(
+      buffers[level].data(),
+      buffers[level].data() + buffers[level].size(),
+      [](const auto b) { return b == 0x80; }));
+  }
+}
+
+} // namespace TrenchBroom::Assets
@@ -739,6 +739,14 @@ TEST_CASE("ExpressionTest.testOptimize")
                           Expression{VariableExpression{"a"}, 0, 0}}
                       }, 0, 0}},
   {"{a:1, b:2, c:3}", Expression{LiteralExpression{Value{MapType{{"a", Value{1}}, {"b", Value{2}}, {"c", Value{3}}}}}, 0, 0}},
+  {"a == 1",          Expression{BinaryExpression{BinaryOperator::Equal,
+                          Expression{VariableExpression{"a"}, 0, 0},
+                          Expression{LiteralExpression{Value{1}}, 0, 0}
+                      }, 0, 0}},
+  {"a == 2 - 1",      Expression{BinaryExpression{BinaryOperator::Equal,
+                          Expression{VariableExpression{"a"}, 0, 0},
+                          Expression{LiteralExpression{Value{1}}, 0, 0}
+                      }, 0, 0}},
   }));
   // clang-format on
 
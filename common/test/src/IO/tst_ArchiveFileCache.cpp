@@ -0,0 +1,132 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Exceptions.h"
+#include "IO/ArchiveFileCache.h"
+#include "IO/File.h"
+
+#include <memory>
+#include <string>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+auto makeFile(const size_t size)
+{
+  return [=]() -> std::shared_ptr<File> {
+    return std::make_shared<OwningBufferFile>(
+      "file", std::make_unique<char[]>(size), size);
+  };
+}
+} // namespace
+
+TEST_CASE("ArchiveFileCacheTest.getOrLoad")
+{
+  auto cache = ArchiveFileCache{100};
+  const auto archiveId = cache.createArchiveId();
+
+  const auto file1 = cache.getOrLoad(archiveId, 1, makeFile(10));
+  CHECK(cache.stats() == ArchiveFileCacheStats{0, 1, 1, 10});
+
+  CHECK(cache.getOrLoad(archiveId, 1, makeFile(10)) == file1);
+  CHECK(cache.stats() == ArchiveFileCacheStats{1, 1, 1, 10});
+
+  const auto file2 = cache.getOrLoad(archiveId, 2, makeFile(20));
+  CHECK(file2 != file1);
+  CHECK(cache.stats() == ArchiveFileCacheStats{1, 2, 2, 30});
+
+  // entries of different archives are distinct
+  const auto otherArchiveId = cache.createArchiveId();
+  CHECK(otherArchiveId != archiveId);
+  CHECK(cache.getOrLoad(otherArchiveId, 1, makeFile(10)) != file1);
+  CHECK(cache.stats() == ArchiveFileCacheStats{1, 3, 3, 40});
+
+  SECTION("Exceptions thrown by the load function are propagated")
+  {
+    CHECK_THROWS_AS(
+      cache.getOrLoad(
+        archiveId,
+        3,
+        []() -> std::shared_ptr<File> { throw FileSystemException{"error"}; }),
+      FileSystemException);
+    CHECK(cache.stats() == ArchiveFileCacheStats{1, 4, 3, 40});
+  }
+
+  SECTION("clear")
+  {
+    cache.clear();
+    CHECK(cache.stats() == ArchiveFileCacheStats{0, 0, 0, 0});
+    CHECK(cache.getOrLoad(archiveId, 1, makeFile(10)) != file1);
+  }
+}
+
+TEST_CASE("ArchiveFileCacheTest.evictLeastRecentlyUsed")
+{
+  auto cache = ArchiveFileCache{100};
+  const auto archiveId = cache.createArchiveId();
+
+  const auto file1 = cache.getOrLoad(archiveId, 1, makeFile(40));
+  const auto file2 = cache.getOrLoad(archiveId, 2, makeFile(40));
+
+  // use file1 so that file2 becomes the least recently used file
+  cache.getOrLoad(archiveId, 1, makeFile(40));
+
+  const auto file3 = cache.getOrLoad(archiveId, 3, makeFile(40));
+  CHECK(cache.stats() == ArchiveFileCacheStats{1, 3, 2, 80});
+
+  CHECK(cache.getOrLoad(archiveId, 1, makeFile(40)) == file1);
+  CHECK(cache.getOrLoad(archiveId, 3, makeFile(40)) == file3);
+  CHECK(cache.getOrLoad(archiveId, 2, makeFile(40)) != file2);
+
+  SECTION("Files larger than the capacity are not cached")
+  {
+    cache.getOrLoad(archiveId, 4, makeFile(101));
+    CHECK(cache.stats().cachedBytes == 80u);
+  }
+
+  SECTION("Reducing the capacity evicts files")
+  {
+    cache.setCapacity(50);
+    CHECK(cache.capacity() == 50u);
+    CHECK(cache.stats().cachedFiles == 1u);
+    CHECK(cache.stats().cachedBytes == 40u);
+  }
+}
+
+TEST_CASE("ArchiveFileCacheTest.evictArchive")
+{
+  auto cache = ArchiveFileCache{100};
+  const auto archiveId1 = cache.createArchiveId();
+  const auto archiveId2 = cache.createArchiveId();
+
+  cache.getOrLoad(archiveId1, 1, makeFile(10));
+  cache.getOrLoad(archiveId1, 2, makeFile(10));
+  const auto file = cache.getOrLoad(archiveId2, 1, makeFile(10));
+
+  cache.evictArchive(archiveId1);
+  CHECK(cache.stats() == ArchiveFileCacheStats{0, 3, 1, 10});
+  CHECK(cache.getOrLoad(archiveId2, 1, makeFile(10)) == file);
+}
+} // namespace IO
+} // namespace TrenchBroom
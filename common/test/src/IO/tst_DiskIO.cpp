@@ -26,12 +26,17 @@
 #include "IO/File.h"
 #include "IO/PathInfo.h"
 #include "IO/PathQt.h"
+#include "IO/Reader.h"
 #include "IO/TestEnvironment.h"
 #include "Macros.h"
 
+#include <kdl/invoke.h>
+
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <string>
 
 #include "Catch2.h"
 
@@ -162,6 +167,16 @@ TEST_CASE("DiskIO")
     CHECK(Disk::openFile(env.dir() / "anotherDir/subDirTest/test2.map") != nullptr);
   }
 
+  SECTION("openMappedFile")
+  {
+    CHECK_THROWS_AS(
+      Disk::openMappedFile(env.dir() / "does_not_exist.txt"), FileNotFoundException);
+    CHECK(
+      std::dynamic_pointer_cast<MmapFile>(
+        Disk::openMappedFile(env.dir() / "anotherDir/subDirTest/test2.map"))
+      != nullptr);
+  }
+
   SECTION("withStream")
   {
     SECTION("withInputStream")
@@ -432,6 +447,97 @@ TEST_CASE("DiskIO")
     }
   }
 
+  SECTION("makeTemporaryPath")
+  {
+    const auto path1 = Disk::makeTemporaryPath(env.dir() / "test.txt");
+    const auto path2 = Disk::makeTemporaryPath(env.dir() / "test.txt");
+    CHECK(path1 != path2);
+    CHECK(path1.parent_path() == env.dir());
+    CHECK(path1.extension() == ".tmp");
+    CHECK(Disk::pathInfo(path1) == PathInfo::Unknown);
+  }
+
+  SECTION("withAtomicOutputStream")
+  {
+    const auto temporaryFiles = [&]() {
+      return Disk::find(env.dir(), makeExtensionPathMatcher({".tmp"}));
+    };
+
+    SECTION("write new file")
+    {
+      REQUIRE(Disk::pathInfo(env.dir() / "new.txt") == PathInfo::Unknown);
+
+      Disk::withAtomicOutputStream(
+        env.dir() / "new.txt", [](auto& stream) { stream << "new content"; });
+
+      CHECK(Disk::withInputStream(env.dir() / "new.txt", readAll) == "new content");
+      CHECK(temporaryFiles().empty());
+    }
+
+    SECTION("replace existing file")
+    {
+      Disk::withAtomicOutputStream(
+        env.dir() / "test.txt", [](auto& stream) { stream << "new content"; });
+
+      CHECK(Disk::withInputStream(env.dir() / "test.txt", readAll) == "new content");
+      CHECK(temporaryFiles().empty());
+    }
+
+    SECTION("existing file is unchanged if writing fails")
+    {
+      CHECK_THROWS_AS(
+        Disk::withAtomicOutputStream(
+          env.dir() / "test.txt",
+          [](auto& stream) {
+            stream << "partial content";
+            throw FileSystemException{"failure"};
+          }),
+        FileSystemException);
+
+      CHECK(Disk::withInputStream(env.dir() / "test.txt", readAll) == "some content");
+      CHECK(temporaryFiles().empty());
+    }
+
+#ifndef _WIN32
+    // These tests don't work on Windows due to differences in links and permissions
+    SECTION("replace the target of a symbolic link")
+    {
+      std::filesystem::create_symlink(env.dir() / "test.txt", env.dir() / "link.txt");
+
+      Disk::withAtomicOutputStream(
+        env.dir() / "link.txt", [](auto& stream) { stream << "new content"; });
+
+      CHECK(std::filesystem::is_symlink(env.dir() / "link.txt"));
+      CHECK(Disk::withInputStream(env.dir() / "test.txt", readAll) == "new content");
+    }
+
+    SECTION("keep hard links")
+    {
+      std::filesystem::create_hard_link(env.dir() / "test.txt", env.dir() / "link.txt");
+
+      Disk::withAtomicOutputStream(
+        env.dir() / "test.txt", [](auto& stream) { stream << "new content"; });
+
+      CHECK(Disk::withInputStream(env.dir() / "link.txt", readAll) == "new content");
+      CHECK(std::filesystem::hard_link_count(env.dir() / "test.txt") == 2u);
+      CHECK(temporaryFiles().empty());
+    }
+
+    SECTION("keep permissions")
+    {
+      const auto perms = std::filesystem::perms::owner_read
+                         | std::filesystem::perms::owner_write
+                         | std::filesystem::perms::group_read;
+      std::filesystem::permissions(env.dir() / "test.txt", perms);
+
+      Disk::withAtomicOutputStream(
+        env.dir() / "test.txt", [](auto& stream) { stream << "new content"; });
+
+      CHECK(std::filesystem::status(env.dir() / "test.txt").permissions() == perms);
+    }
+#endif
+  }
+
   SECTION("resolvePath")
   {
     const auto rootPaths =
@@ -447,4 +553,87 @@ TEST_CASE("DiskIO")
     CHECK(Disk::resolvePath(rootPaths, "adk3kdk/bhb") == "");
   }
 }
+
+TEST_CASE("openPhysicalFile")
+{
+  auto env = makeTestEnvironment();
+
+  auto contents = std::string{};
+  for (size_t i = 0; i < 1024; ++i)
+  {
+    contents += char('a' + i % 26);
+  }
+
+  env.createFile("file.txt", contents);
+  env.createFile("empty.txt", "");
+
+  const auto readAllFrom = [](const File& file) {
+    auto reader = file.reader();
+    return reader.readString(reader.size());
+  };
+
+  SECTION("Files are mapped into memory")
+  {
+    const auto file = openPhysicalFile(env.dir() / "file.txt");
+    const auto mmapFile = std::dynamic_pointer_cast<MmapFile>(file);
+    REQUIRE(mmapFile != nullptr);
+
+    CHECK(file->size() == contents.size());
+    CHECK(readAllFrom(*file) == contents);
+
+    const auto fileView = FileView{"view", file, 100, 10};
+    CHECK(readAllFrom(fileView) == contents.substr(100, 10));
+
+    // buffering a reader of a mapped file does not copy the file contents
+    CHECK(file->reader().buffer().begin() == mmapFile->begin());
+    CHECK(fileView.reader().buffer().begin() == mmapFile->begin() + 100);
+  }
+
+  SECTION("Small files are copied into memory")
+  {
+    const auto file = openPhysicalFile(env.dir() / "file.txt", 2048);
+    CHECK(std::dynamic_pointer_cast<OwningBufferFile>(file) != nullptr);
+    CHECK(readAllFrom(*file) == contents);
+
+    // the file can be changed on the disk while the copy is read
+    env.createFile("file.txt", "");
+    CHECK(readAllFrom(*file) == contents);
+  }
+
+#if !defined _WIN32
+  // mapped files cannot be truncated on Windows
+  SECTION("Truncated mapped files cannot be read")
+  {
+    const auto file = openPhysicalFile(env.dir() / "file.txt");
+    REQUIRE(std::dynamic_pointer_cast<MmapFile>(file) != nullptr);
+
+    std::filesystem::resize_file(env.dir() / "file.txt", 100);
+    CHECK_THROWS_AS(file->reader(), FileSystemException);
+    CHECK_THROWS_AS(FileView("view", file, 0, 10).reader(), FileSystemException);
+  }
+#endif
+
+  SECTION("Empty files are not mapped into memory")
+  {
+    const auto file = openPhysicalFile(env.dir() / "empty.txt");
+    CHECK(std::dynamic_pointer_cast<CFile>(file) != nullptr);
+    CHECK(file->size() == 0u);
+  }
+
+  SECTION("Files are not mapped if memory mapping is disabled")
+  {
+    setMemoryMappingEnabled(false);
+    auto resetMemoryMapping = kdl::invoke_later{[]() { setMemoryMappingEnabled(true); }};
+
+    const auto file = openPhysicalFile(env.dir() / "file.txt");
+    CHECK(std::dynamic_pointer_cast<CFile>(file) != nullptr);
+    CHECK(readAllFrom(*file) == contents);
+  }
+
+  SECTION("Missing files cannot be opened")
+  {
+    CHECK_THROWS_AS(
+      openPhysicalFile(env.dir() / "does_not_exist.txt"), FileSystemException);
+  }
+}
 } // namespace TrenchBroom::IO
@@ -0,0 +1,144 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IO/FileWatcher.h"
+#include "IO/TestEnvironment.h"
+
+#include <chrono>
+#include <filesystem>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+using namespace std::chrono_literals;
+
+std::vector<std::filesystem::path> waitForChangedPaths(
+  FileWatcher& fileWatcher, const size_t expectedCount)
+{
+  auto result = std::set<std::filesystem::path>{};
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (result.size() < expectedCount && std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(10ms);
+    for (auto& path : fileWatcher.takeChangedPaths())
+    {
+      result.insert(std::move(path));
+    }
+  }
+
+  // give unexpected changes a chance to be reported, too
+  std::this_thread::sleep_for(100ms);
+  for (auto& path : fileWatcher.takeChangedPaths())
+  {
+    result.insert(std::move(path));
+  }
+
+  return {result.begin(), result.end()};
+}
+} // namespace
+
+TEST_CASE("FileWatcher")
+{
+  const auto mode = GENERATE(FileWatcher::Mode::Native, FileWatcher::Mode::Polling);
+
+  auto env = TestEnvironment{[](auto& e) {
+    e.createFile("a.txt", "a");
+    e.createFile("b.txt", "b");
+    e.createDirectory("dir");
+    e.createFile("dir/c.txt", "c");
+  }};
+
+  const auto a = env.dir() / "a.txt";
+  const auto c = env.dir() / "dir" / "c.txt";
+  const auto d = env.dir() / "d.txt";
+
+  auto fileWatcher = FileWatcher{mode, 20ms};
+  fileWatcher.setWatchedPaths({a, c, d});
+
+  SECTION("Modified files are reported")
+  {
+    env.createFile("a.txt", "modified");
+    CHECK(waitForChangedPaths(fileWatcher, 1) == std::vector<std::filesystem::path>{a});
+  }
+
+  SECTION("Replaced files are reported")
+  {
+    env.createFile("tmp.txt", "replaced");
+    std::filesystem::rename(env.dir() / "tmp.txt", c);
+    CHECK(waitForChangedPaths(fileWatcher, 1) == std::vector<std::filesystem::path>{c});
+  }
+
+  SECTION("Created files are reported")
+  {
+    env.createFile("d.txt", "created");
+    CHECK(waitForChangedPaths(fileWatcher, 1) == std::vector<std::filesystem::path>{d});
+  }
+
+  SECTION("Removed files are reported")
+  {
+    std::filesystem::remove(a);
+    CHECK(waitForChangedPaths(fileWatcher, 1) == std::vector<std::filesystem::path>{a});
+  }
+
+  SECTION("Files that are not watched are not reported")
+  {
+    env.createFile("b.txt", "modified");
+    env.createFile("a.txt", "modified");
+    CHECK(waitForChangedPaths(fileWatcher, 1) == std::vector<std::filesystem::path>{a});
+  }
+
+  SECTION("Files that are no longer watched are not reported")
+  {
+    fileWatcher.setWatchedPaths({c});
+
+    env.createFile("a.txt", "modified");
+    env.createFile("dir/c.txt", "modified");
+    CHECK(waitForChangedPaths(fileWatcher, 1) == std::vector<std::filesystem::path>{c});
+  }
+
+  SECTION("Added files are reported")
+  {
+    const auto b = env.dir() / "b.txt";
+    fileWatcher.addWatchedPaths({a, b});
+
+    env.createFile("b.txt", "modified");
+    env.createFile("a.txt", "modified");
+    CHECK(
+      waitForChangedPaths(fileWatcher, 2) == std::vector<std::filesystem::path>{a, b});
+  }
+
+  SECTION("Changes are taken only once")
+  {
+    env.createFile("a.txt", "modified");
+    env.createFile("dir/c.txt", "modified");
+    CHECK(
+      waitForChangedPaths(fileWatcher, 2) == std::vector<std::filesystem::path>{a, c});
+    CHECK(fileWatcher.takeChangedPaths().empty());
+  }
+}
+} // namespace IO
+} // namespace TrenchBroom
@@ -18,6 +18,7 @@
  */
 
 #include "Exceptions.h"
+#include "IO/ArchiveFileCache.h"
 #include "IO/DiskIO.h"
 #include "IO/DkPakFileSystem.h"
 #include "IO/File.h"
@@ -27,6 +28,7 @@
 #include "IO/ZipFileSystem.h"
 
 #include <filesystem>
+#include <memory>
 
 #include "Catch2.h"
 
@@ -943,5 +945,74 @@ TEST_CASE("Flat ImageFileSystems")
     CHECK(contents == cr8_czg_03_contents);
   }
 }
+
+TEST_CASE("ZipFileSystemTest.cacheDecompressedFiles")
+{
+  const auto fsTestPath = std::filesystem::current_path() / "fixture/test/IO/";
+
+  auto cache = ArchiveFileCache{};
+  {
+    auto fs = ZipFileSystem{fsTestPath / "Zip/zip.zip", cache};
+
+    const auto amnet_cfg = fs.openFile("amnet.cfg");
+    CHECK(cache.stats() == ArchiveFileCacheStats{0, 1, 1, 419});
+
+    CHECK(fs.openFile("amnet.cfg") == amnet_cfg);
+    CHECK(cache.stats() == ArchiveFileCacheStats{1, 1, 1, 419});
+
+    fs.openFile("bear.cfg");
+    CHECK(cache.stats() == ArchiveFileCacheStats{1, 2, 2, 419 + 1489});
+
+    // evict amnet.cfg, but it remains valid
+    cache.setCapacity(1500);
+    CHECK(cache.stats() == ArchiveFileCacheStats{1, 2, 1, 1489});
+
+    auto reader = amnet_cfg->reader();
+    CHECK(reader.readString(2) == "//");
+
+    CHECK(fs.openFile("amnet.cfg") != amnet_cfg);
+    CHECK(cache.stats() == ArchiveFileCacheStats{1, 3, 1, 419});
+  }
+
+  // destroying the file system evicts its files
+  CHECK(cache.stats() == ArchiveFileCacheStats{1, 3, 0, 0});
+}
+
+TEST_CASE("ZipFileSystemTest.openStoredFiles")
+{
+  const auto fsTestPath = std::filesystem::current_path() / "fixture/test/IO/";
+
+  auto cache = ArchiveFileCache{};
+  auto fs = ZipFileSystem{fsTestPath / "Zip/stored.zip", cache};
+
+  SECTION("Stored files are views of the archive file")
+  {
+    const auto file = fs.openFile("stored.txt");
+    CHECK(std::dynamic_pointer_cast<FileView>(file) != nullptr);
+    CHECK(file->path() == "stored.txt");
+
+    auto reader = file->reader();
+    CHECK(
+      reader.readString(reader.size()) == "this entry is stored without compression\n");
+    CHECK(cache.stats() == ArchiveFileCacheStats{0, 0, 0, 0});
+  }
+
+  SECTION("Compressed files are decompressed")
+  {
+    const auto file = fs.openFile("textures/deflated.txt");
+    CHECK(std::dynamic_pointer_cast<FileView>(file) == nullptr);
+
+    auto reader = file->reader();
+    CHECK(reader.size() == 100u);
+    CHECK(reader.readString(25) == "this entry is compressed\n");
+    CHECK(cache.stats() == ArchiveFileCacheStats{0, 1, 1, 100});
+  }
+
+  SECTION("Truncated stored files cannot be opened")
+  {
+    auto truncatedFs = ZipFileSystem{fsTestPath / "Zip/truncated_stored.zip", cache};
+    CHECK_THROWS_AS(truncatedFs.openFile("truncated.txt"), FileSystemException);
+  }
+}
 } // namespace IO
 } // namespace TrenchBroom
@@ -29,6 +29,7 @@
 #include "IO/WadFileSystem.h"
 #include "Logger.h"
 #include "Model/GameConfig.h"
+#include "TestLogger.h"
 
 #include <kdl/reflection_impl.h>
 #include <kdl/result.h>
@@ -207,6 +208,40 @@ TEST_CASE("loadTextureCollection")
         },
       });
   }
+
+  SECTION("loading a directory with unreadable images")
+  {
+    const auto textureConfig = Model::TextureConfig{
+      "fixture/test/IO/Image",
+      {".png", ".jpg"},
+      "",
+      "",
+      "",
+      {},
+    };
+
+    auto testLogger = TestLogger{};
+
+    // unreadable images are replaced by default textures in their original position
+    CHECK(
+      makeInfo(
+        loadTextureCollection("fixture/test/IO/Image", fs, textureConfig, testLogger))
+      == TextureCollectionInfo{
+        "fixture/test/IO/Image",
+        {
+          {"16bitGrayscale", 32, 32},
+          {"5x5", 5, 5},
+          {"707x710", 707, 710},
+          {"alphaMaskTest", 25, 10},
+          {"corruptPngTest", 32, 32},
+          {"jpgContentsTest", 64, 64},
+          {"pngContentsTest", 64, 64},
+        },
+      });
+
+    // both unreadable images log an error and fail to load the default texture
+    CHECK(testLogger.countMessages(LogLevel::Error) == 4u);
+  }
 }
 } // namespace IO
 } // namespace TrenchBroom
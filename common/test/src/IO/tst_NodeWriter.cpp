@@ -18,6 +18,7 @@
  */
 
 #include "Exceptions.h"
+#include "IO/NodeSerializationCache.h"
 #include "IO/NodeWriter.h"
 #include "Model/BezierPatch.h"
 #include "Model/BrushBuilder.h"
@@ -1307,5 +1308,113 @@ common/caulk
   CHECK(actual == expected);
 }
 
+TEST_CASE("NodeWriterTest.writeMapWithCache")
+{
+  const auto worldBounds = vm::bbox3{8192.0};
+
+  auto map = Model::WorldNode{{}, {}, Model::MapFormat::Standard};
+  const auto builder = Model::BrushBuilder{map.mapFormat(), worldBounds};
+
+  auto* brushNode1 = new Model::BrushNode{builder.createCube(64.0, "none").value()};
+  auto* brushNode2 = new Model::BrushNode{builder.createCube(32.0, "none").value()};
+  auto* entityNode =
+    new Model::EntityNode{Model::Entity{{}, {{"classname", "func_door"}}}};
+  entityNode->addChild(brushNode2);
+  map.defaultLayer()->addChild(brushNode1);
+  map.defaultLayer()->addChild(entityNode);
+
+  const auto writeMap = [&](auto&... cache) {
+    auto str = std::stringstream{};
+    auto writer = NodeWriter{map, str, cache...};
+    writer.writeMap();
+    return str.str();
+  };
+
+  auto cache = NodeSerializationCache{};
+
+  const auto original = writeMap(cache);
+  CHECK(original == writeMap());
+  CHECK(cache.size() == 2u);
+
+  const auto serializedBrush2 =
+    cache.find(Model::MapFormat::Standard, brushNode2->revision());
+  REQUIRE(serializedBrush2 != nullptr);
+  CHECK(serializedBrush2->lineCount == 6u);
+  CHECK(cache.find(Model::MapFormat::Valve, brushNode2->revision()) == nullptr);
+
+  SECTION("Unchanged map")
+  {
+    CHECK(writeMap(cache) == original);
+    CHECK(
+      cache.find(Model::MapFormat::Standard, brushNode2->revision())
+      == serializedBrush2);
+  }
+
+  SECTION("Changed brush")
+  {
+    const auto oldRevision = brushNode1->revision();
+
+    auto brush = brushNode1->brush();
+    REQUIRE(
+      brush.transform(worldBounds, vm::translation_matrix(vm::vec3{16, 0, 0}), false)
+        .is_success());
+    brushNode1->setBrush(std::move(brush));
+    REQUIRE(brushNode1->revision() != oldRevision);
+
+    const auto changed = writeMap(cache);
+    CHECK(changed != original);
+    CHECK(changed == writeMap());
+    CHECK(cache.size() == 2u);
+    CHECK(cache.find(Model::MapFormat::Standard, oldRevision) == nullptr);
+
+    // the unchanged brush was not serialized again
+    CHECK(
+      cache.find(Model::MapFormat::Standard, brushNode2->revision())
+      == serializedBrush2);
+  }
+
+  SECTION("Removed brush")
+  {
+    const auto revision = brushNode1->revision();
+    map.defaultLayer()->removeChild(brushNode1);
+    delete brushNode1;
+
+    CHECK(writeMap(cache) == writeMap());
+    CHECK(cache.size() == 1u);
+    CHECK(cache.find(Model::MapFormat::Standard, revision) == nullptr);
+  }
+
+  SECTION("Exporting does not change the cache")
+  {
+    const auto oldRevision = brushNode1->revision();
+
+    auto brush = brushNode1->brush();
+    REQUIRE(
+      brush.transform(worldBounds, vm::translation_matrix(vm::vec3{16, 0, 0}), false)
+        .is_success());
+    brushNode1->setBrush(std::move(brush));
+
+    auto str = std::stringstream{};
+    auto writer = NodeWriter{map, str, cache};
+    writer.setExporting(true);
+    writer.writeMap();
+
+    CHECK(str.str() == writeMap());
+    CHECK(cache.size() == 2u);
+    CHECK(cache.find(Model::MapFormat::Standard, oldRevision) != nullptr);
+    CHECK(cache.find(Model::MapFormat::Standard, brushNode1->revision()) == nullptr);
+  }
+
+  SECTION("Nodes are assigned their file positions")
+  {
+    brushNode1->setFilePosition(0, 0);
+    brushNode2->setFilePosition(0, 0);
+
+    writeMap(cache);
+    CHECK(brushNode1->lineNumber() == 5u);
+    CHECK(brushNode2->lineNumber() == 18u);
+  }
+}
+
 } // namespace IO
 } // namespace TrenchBroom
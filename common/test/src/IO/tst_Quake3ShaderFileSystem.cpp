@@ -20,12 +20,16 @@
 #include "Assets/Quake3Shader.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/DiskIO.h"
+#include "IO/File.h"
 #include "IO/Quake3ShaderFileSystem.h"
+#include "IO/TestFileSystem.h"
 #include "IO/VirtualFileSystem.h"
 #include "Logger.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <memory>
+#include <string>
 
 #include "Catch2.h"
 
@@ -33,6 +37,22 @@ namespace TrenchBroom
 {
 namespace IO
 {
+namespace
+{
+std::shared_ptr<File> makeTextFile(std::filesystem::path path, const std::string& text)
+{
+  auto buffer = std::make_unique<char[]>(text.size());
+  std::copy(text.begin(), text.end(), buffer.get());
+  return std::make_shared<OwningBufferFile>(
+    std::move(path), std::move(buffer), text.size());
+}
+
+const Assets::Quake3Shader& getShader(const std::shared_ptr<File>& file)
+{
+  return static_cast<const ObjectFile<Assets::Quake3Shader>&>(*file).object();
+}
+} // namespace
+
 TEST_CASE("Quake3ShaderFileSystemTest.testShaderLinking")
 {
   auto logger = NullLogger{};
@@ -98,5 +118,51 @@ TEST_CASE("Quake3ShaderFileSystemTest.testSkipMalformedFiles")
       texturePrefix / "test/not_existing2",
     }));
 }
+
+TEST_CASE("Quake3ShaderFileSystemTest.testDuplicateShaders")
+{
+  auto logger = NullLogger{};
+
+  // If several shader scripts define the same shader, the last one wins.
+
+  const auto fs = TestFileSystem{DirectoryEntry{
+    "",
+    {
+      DirectoryEntry{
+        "scripts",
+        {
+          FileEntry{
+            "a.shader",
+            makeTextFile(
+              "scripts/a.shader",
+              R"(textures/test/linked { qer_editorimage textures/test/a.tga }
+textures/test/standalone { qer_editorimage textures/test/a.tga })")},
+          FileEntry{
+            "b.shader",
+            makeTextFile(
+              "scripts/b.shader",
+              R"(textures/test/linked { qer_editorimage textures/test/b.tga }
+textures/test/standalone { qer_editorimage textures/test/b.tga })")},
+        }},
+      DirectoryEntry{
+        "textures",
+        {
+          DirectoryEntry{
+            "test",
+            {
+              FileEntry{"linked.tga", makeObjectFile("textures/test/linked.tga", 1)},
+            }},
+        }},
+    }}};
+
+  const auto shaderFs = Quake3ShaderFileSystem{fs, "scripts", {"textures"}, logger};
+
+  CHECK(
+    getShader(shaderFs.openFile("textures/test/linked")).editorImage
+    == "textures/test/b.tga");
+  CHECK(
+    getShader(shaderFs.openFile("textures/test/standalone")).editorImage
+    == "textures/test/b.tga");
+}
 } // namespace IO
 } // namespace TrenchBroom
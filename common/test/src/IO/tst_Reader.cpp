@@ -213,6 +213,10 @@ static void subReader(Reader&& r)
 
   CHECK_THROWS_AS(s.seekForward(1U), ReaderException);
   CHECK(s.position() == 3U);
+
+  CHECK_THROWS_AS(r.subReaderFromBegin(5, 6), ReaderException);
+  CHECK_THROWS_AS(r.subReaderFromBegin(11, 0), ReaderException);
+  CHECK_THROWS_AS(s.subReaderFromBegin(2, 2), ReaderException);
 }
 
 TEST_CASE("BufferReaderTest.subReader")
@@ -0,0 +1,307 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/Texture.h"
+#include "Assets/TextureCollection.h"
+#include "Color.h"
+#include "IO/DiskFileSystem.h"
+#include "IO/DiskIO.h"
+#include "IO/LoadTextureCollection.h"
+#include "IO/TestEnvironment.h"
+#include "IO/TextureCache.h"
+#include "IO/VirtualFileSystem.h"
+#include "IO/WadFileSystem.h"
+#include "Logger.h"
+#include "Model/GameConfig.h"
+
+#include <kdl/reflection_impl.h>
+#include <kdl/result.h>
+#include <kdl/vector_utils.h>
+
+#include <vecmath/vec_io.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace IO
+{
+namespace
+{
+struct TextureData
+{
+  std::string name;
+  size_t width;
+  size_t height;
+  GLenum format;
+  Assets::TextureType type;
+  Color averageColor;
+  Assets::GameData gameData;
+  std::vector<std::vector<unsigned char>> buffers;
+
+  kdl_reflect_inline(
+    TextureData, name, width, height, format, type, averageColor, gameData, buffers);
+};
+
+TextureData makeTextureData(const Assets::Texture& texture)
+{
+  return TextureData{
+    texture.name(),
+    texture.width(),
+    texture.height(),
+    texture.format(),
+    texture.type(),
+    texture.averageColor(),
+    texture.gameData(),
+    kdl::vec_transform(texture.buffersIfUnprepared(), [](const auto& buffer) {
+      return std::vector<unsigned char>(buffer.data(), buffer.data() + buffer.size());
+    })};
+}
+
+std::vector<TextureData> makeTextureData(
+  const kdl::result<Assets::TextureCollection, LoadTextureCollectionError>& result)
+{
+  return kdl::vec_transform(result.value().textures(), [](const auto& texture) {
+    return makeTextureData(texture);
+  });
+}
+
+Assets::TextureBuffer makeBuffer(const size_t size, const unsigned char value)
+{
+  auto buffer = Assets::TextureBuffer{size};
+  std::memset(buffer.data(), value, size);
+  return buffer;
+}
+
+Assets::Texture makeTexture(
+  std::string name,
+  const size_t width,
+  const size_t height,
+  const GLenum format,
+  const Assets::TextureType type,
+  Assets::GameData gameData = std::monostate{})
+{
+  auto buffers = Assets::TextureBufferList{};
+  buffers.push_back(makeBuffer(width * height * 4, 0x1f));
+  buffers.push_back(makeBuffer(4, 0xf1));
+  return Assets::Texture{
+    std::move(name),
+    width,
+    height,
+    Color{0.1f, 0.2f, 0.3f, 0.4f},
+    std::move(buffers),
+    format,
+    type,
+    std::move(gameData)};
+}
+} // namespace
+
+TEST_CASE("TextureCacheTest.writeAndRead")
+{
+  auto env = TestEnvironment{};
+  const auto path = env.dir() / "textures.tbtc";
+
+  const auto opaque =
+    makeTexture("opaque", 2, 2, GL_RGBA, Assets::TextureType::Opaque);
+  const auto masked = makeTexture(
+    "masked", 3, 1, GL_BGRA, Assets::TextureType::Masked, Assets::Q2Data{1, 2, 3});
+
+  writeCachedTextures(path, {{1u, &opaque}, {2u, &masked}});
+
+  const auto cachedTextures = CachedTextures::open(path);
+  CHECK(cachedTextures.size() == 2u);
+  CHECK(cachedTextures.contains(1u));
+  CHECK(cachedTextures.contains(2u));
+  CHECK_FALSE(cachedTextures.contains(3u));
+
+  const auto cachedOpaque = cachedTextures.readTexture(1u);
+  REQUIRE(cachedOpaque);
+  CHECK(makeTextureData(*cachedOpaque) == makeTextureData(opaque));
+
+  const auto cachedMasked = cachedTextures.readTexture(2u);
+  REQUIRE(cachedMasked);
+  CHECK(makeTextureData(*cachedMasked) == makeTextureData(masked));
+
+  CHECK(cachedTextures.readTexture(3u) == std::nullopt);
+}
+
+TEST_CASE("TextureCacheTest.openInvalidFile")
+{
+  auto env = TestEnvironment{};
+
+  SECTION("missing file")
+  {
+    CHECK(CachedTextures::open(env.dir() / "missing.tbtc").size() == 0u);
+  }
+
+  SECTION("wrong magic")
+  {
+    env.createFile("invalid.tbtc", "this is not a texture cache file");
+    CHECK(CachedTextures::open(env.dir() / "invalid.tbtc").size() == 0u);
+  }
+
+  SECTION("truncated file")
+  {
+    const auto path = env.dir() / "truncated.tbtc";
+    const auto texture =
+      makeTexture("texture", 2, 2, GL_RGBA, Assets::TextureType::Opaque);
+    writeCachedTextures(path, {{1u, &texture}});
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 16u);
+    CHECK(CachedTextures::open(path).size() == 0u);
+  }
+}
+
+TEST_CASE("TextureCacheTest.loadTextureCollection")
+{
+  auto env = TestEnvironment{};
+  std::filesystem::copy_file(
+    std::filesystem::current_path() / "fixture/test/palette.lmp",
+    env.dir() / "palette.lmp");
+
+  auto fs = VirtualFileSystem{};
+  fs.mount("", std::make_unique<DiskFileSystem>(env.dir()));
+
+  // copy the wad so that its modification time can be changed
+  const auto wadPath = env.dir() / "cr8_czg.wad";
+  std::filesystem::copy_file(
+    std::filesystem::current_path() / "fixture/test/IO/Wad/cr8_czg.wad", wadPath);
+  fs.mount("textures" / wadPath.filename(), std::make_unique<WadFileSystem>(wadPath));
+
+  const auto textureConfig = Model::TextureConfig{
+    "textures",
+    {".D"},
+    "palette.lmp",
+    "wad",
+    "",
+    {},
+  };
+
+  auto logger = NullLogger{};
+  auto textureCache = TextureCache{env.dir() / "cache"};
+
+  const auto freshTextures = makeTextureData(
+    loadTextureCollection("textures/cr8_czg.wad", fs, textureConfig, logger));
+  REQUIRE(freshTextures.size() == 21u);
+
+  // the first load decodes all textures and fills the cache
+  CHECK(
+    makeTextureData(loadTextureCollection(
+      "textures/cr8_czg.wad", fs, textureConfig, logger, &textureCache))
+    == freshTextures);
+  CHECK(textureCache.stats() == TextureCacheStats{0, 21});
+
+  const auto cacheFiles = Disk::find(env.dir() / "cache");
+  REQUIRE(cacheFiles.size() == 1u);
+  CHECK(CachedTextures::open(cacheFiles.front()).size() == 21u);
+
+  // the second load reads all textures from the cache
+  CHECK(
+    makeTextureData(loadTextureCollection(
+      "textures/cr8_czg.wad", fs, textureConfig, logger, &textureCache))
+    == freshTextures);
+  CHECK(textureCache.stats() == TextureCacheStats{21, 21});
+
+  SECTION("changing the palette invalidates the cache")
+  {
+    {
+      auto stream = std::fstream{
+        env.dir() / "palette.lmp", std::ios::in | std::ios::out | std::ios::binary};
+      stream.seekp(0);
+      stream.put(char(0x7f));
+    }
+
+    const auto changedTextures = makeTextureData(
+      loadTextureCollection("textures/cr8_czg.wad", fs, textureConfig, logger));
+    REQUIRE(changedTextures != freshTextures);
+
+    CHECK(
+      makeTextureData(loadTextureCollection(
+        "textures/cr8_czg.wad", fs, textureConfig, logger, &textureCache))
+      == changedTextures);
+    CHECK(textureCache.stats() == TextureCacheStats{21, 42});
+
+    CHECK(
+      makeTextureData(loadTextureCollection(
+        "textures/cr8_czg.wad", fs, textureConfig, logger, &textureCache))
+      == changedTextures);
+    CHECK(textureCache.stats() == TextureCacheStats{42, 42});
+  }
+
+  SECTION("changing the texture file invalidates the cache")
+  {
+    std::filesystem::last_write_time(
+      wadPath, std::filesystem::last_write_time(wadPath) + std::chrono::hours{1});
+
+    CHECK(
+      makeTextureData(loadTextureCollection(
+        "textures/cr8_czg.wad", fs, textureConfig, logger, &textureCache))
+      == freshTextures);
+    CHECK(textureCache.stats() == TextureCacheStats{21, 42});
+
+    CHECK(
+      makeTextureData(loadTextureCollection(
+        "textures/cr8_czg.wad", fs, textureConfig, logger, &textureCache))
+      == freshTextures);
+    CHECK(textureCache.stats() == TextureCacheStats{42, 42});
+  }
+}
+
+TEST_CASE("TextureCacheTest.removeUnusedFiles")
+{
+  auto env = TestEnvironment{};
+  env.createDirectory("cache");
+  env.createFile("cache/used.tbtc", "");
+  env.createFile("cache/unused.tbtc", "");
+  env.createFile("cache/unused.1234.tmp", "");
+  env.createFile("cache/other.txt", "");
+
+  const auto setAge = [&](const auto& path, const auto age) {
+    std::filesystem::last_write_time(
+      env.dir() / path, std::filesystem::file_time_type::clock::now() - age);
+  };
+  setAge("cache/used.tbtc", std::chrono::hours{1});
+  setAge("cache/unused.tbtc", std::chrono::hours{48});
+  setAge("cache/unused.1234.tmp", std::chrono::hours{48});
+  setAge("cache/other.txt", std::chrono::hours{48});
+
+  const auto textureCache = TextureCache{env.dir() / "cache"};
+  textureCache.removeUnusedFiles(std::chrono::hours{24});
+
+  CHECK(env.fileExists("cache/used.tbtc"));
+  CHECK_FALSE(env.fileExists("cache/unused.tbtc"));
+  CHECK_FALSE(env.fileExists("cache/unused.1234.tmp"));
+  CHECK(env.fileExists("cache/other.txt"));
+
+  SECTION("missing directory")
+  {
+    CHECK_NOTHROW(TextureCache{env.dir() / "missing"}.removeUnusedFiles(
+      std::chrono::hours{24}));
+  }
+}
+
+} // namespace IO
+} // namespace TrenchBroom
@@ -18,18 +18,60 @@
  */
 
 #include "IO/File.h"
+#include "IO/IdPakFileSystem.h"
+#include "IO/ImageFileSystem.h"
+#include "IO/PathMatcher.h"
+#include "IO/TestEnvironment.h"
 #include "IO/TestFileSystem.h"
 #include "IO/VirtualFileSystem.h"
 
 #include <kdl/overload.h>
 #include <kdl/reflection_impl.h>
 
+#include <filesystem>
+#include <string>
+#include <tuple>
+
 #include "Catch2.h"
 
 namespace TrenchBroom
 {
 namespace IO
 {
+namespace
+{
+using TestImageFiles =
+  std::vector<std::tuple<std::filesystem::path, std::shared_ptr<File>>>;
+
+class TestImageFileSystem : public ImageFileSystemBase
+{
+private:
+  TestImageFiles m_files;
+
+public:
+  explicit TestImageFileSystem(TestImageFiles files)
+    : ImageFileSystemBase{"/"}
+    , m_files{std::move(files)}
+  {
+    initialize();
+  }
+
+  void setFiles(TestImageFiles files)
+  {
+    m_files = std::move(files);
+    reload();
+  }
+
+private:
+  void doReadDirectory() override
+  {
+    for (const auto& [path, file] : m_files)
+    {
+      addFile(path, [file = file]() { return file; });
+    }
+  }
+};
+} // namespace
 
 TEST_CASE("VirtualFileSystem")
 {
@@ -407,5 +449,208 @@ TEST_CASE("VirtualFileSystem")
   }
 }
 
+TEST_CASE("VirtualFileSystem with archive file systems")
+{
+  auto foo_bar_baz = std::make_shared<ObjectFile<Object>>("foo/bar/baz", Object{1});
+  auto bar_foo_fs1 = std::make_shared<ObjectFile<Object>>("bar/foo", Object{2});
+  auto bar_foo_fs2 = std::make_shared<ObjectFile<Object>>("bar/foo", Object{3});
+  auto bar_bat_fs2 = std::make_shared<ObjectFile<Object>>("bar/bat", Object{4});
+  auto foo_bar_fs2 = std::make_shared<ObjectFile<Object>>("foo/bar", Object{5});
+  auto bar_bat_fs3 = std::make_shared<ObjectFile<Object>>("bar/bat", Object{6});
+  auto baz_fs4 = std::make_shared<ObjectFile<Object>>("BAZ", Object{7});
+
+  auto vfs = VirtualFileSystem{};
+  vfs.mount(
+    "",
+    std::make_unique<TestFileSystem>(
+      Entry{DirectoryEntry{
+        "",
+        {
+          DirectoryEntry{
+            "foo",
+            {
+              DirectoryEntry{
+                "bar",
+                {
+                  FileEntry{"baz", foo_bar_baz},
+                }},
+            }},
+          DirectoryEntry{
+            "bar",
+            {
+              FileEntry{"foo", bar_foo_fs1},
+            }},
+        }}},
+      "/fs1"));
+
+  auto fs2 = std::make_unique<TestImageFileSystem>(TestImageFiles{
+    {"bar/foo", bar_foo_fs2},
+    {"bar/bat", bar_bat_fs2},
+    {"foo/bar", foo_bar_fs2},
+  });
+  auto& fs2Ref = *fs2;
+  const auto fs2Id = vfs.mount("", std::move(fs2));
+
+  vfs.mount(
+    "",
+    std::make_unique<TestFileSystem>(
+      Entry{DirectoryEntry{
+        "",
+        {
+          DirectoryEntry{
+            "bar",
+            {
+              FileEntry{"bat", bar_bat_fs3},
+            }},
+        }}},
+      "/fs3"));
+
+  vfs.mount(
+    "textures/pak.wad",
+    std::make_unique<TestImageFileSystem>(TestImageFiles{
+      {"BAZ", baz_fs4},
+    }));
+
+  SECTION("pathInfo")
+  {
+    CHECK(vfs.pathInfo("") == PathInfo::Directory);
+    CHECK(vfs.pathInfo("foo") == PathInfo::Directory);
+    CHECK(vfs.pathInfo("foo/bar") == PathInfo::File);
+    CHECK(vfs.pathInfo("FOO/BAR") == PathInfo::File);
+    CHECK(vfs.pathInfo("foo/bar/baz") == PathInfo::File);
+    CHECK(vfs.pathInfo("bar/bat") == PathInfo::File);
+    CHECK(vfs.pathInfo("textures") == PathInfo::Directory);
+    CHECK(vfs.pathInfo("textures/pak.wad") == PathInfo::Directory);
+    CHECK(vfs.pathInfo("textures/pak.wad/baz") == PathInfo::File);
+    CHECK(vfs.pathInfo("textures/baz") == PathInfo::Unknown);
+    CHECK(vfs.pathInfo("bar/baz") == PathInfo::Unknown);
+  }
+
+  SECTION("directoryContents")
+  {
+    CHECK_THAT(
+      vfs.directoryContents(""),
+      Catch::Matchers::UnorderedEquals(std::vector<std::filesystem::path>{
+        "foo",
+        "bar",
+        "textures",
+      }));
+    CHECK_THAT(
+      vfs.directoryContents("foo"),
+      Catch::Matchers::UnorderedEquals(std::vector<std::filesystem::path>{
+        "bar",
+      }));
+    CHECK_THAT(
+      vfs.directoryContents("bar"),
+      Catch::Matchers::UnorderedEquals(std::vector<std::filesystem::path>{
+        "foo",
+        "bat",
+      }));
+    CHECK_THAT(
+      vfs.directoryContents("textures"),
+      Catch::Matchers::UnorderedEquals(std::vector<std::filesystem::path>{
+        "pak.wad",
+      }));
+    CHECK_THAT(
+      vfs.directoryContents("textures/pak.wad"),
+      Catch::Matchers::UnorderedEquals(std::vector<std::filesystem::path>{
+        "BAZ",
+      }));
+  }
+
+  SECTION("findRecursively")
+  {
+    // foo/bar/baz is not found because foo/bar is a file
+    CHECK_THAT(
+      vfs.findRecursively("", makePathInfoPathMatcher({PathInfo::File})),
+      Catch::Matchers::UnorderedEquals(std::vector<std::filesystem::path>{
+        "foo/bar",
+        "bar/foo",
+        "bar/bat",
+        "textures/pak.wad/BAZ",
+      }));
+  }
+
+  SECTION("openFile")
+  {
+    CHECK(vfs.openFile("foo/bar") == foo_bar_fs2);
+    CHECK(vfs.openFile("foo/bar/baz") == foo_bar_baz);
+    CHECK(vfs.openFile("bar/foo") == bar_foo_fs2);
+    CHECK(vfs.openFile("BAR/FOO") == bar_foo_fs2);
+    CHECK(vfs.openFile("bar/bat") == bar_bat_fs3);
+    CHECK(vfs.openFile("textures/pak.wad/baz") == baz_fs4);
+  }
+
+  SECTION("unmount")
+  {
+    CHECK(vfs.unmount(fs2Id));
+    CHECK(vfs.pathInfo("foo/bar") == PathInfo::Directory);
+    CHECK(vfs.openFile("bar/foo") == bar_foo_fs1);
+    CHECK_THAT(
+      vfs.directoryContents("bar"),
+      Catch::Matchers::UnorderedEquals(std::vector<std::filesystem::path>{
+        "foo",
+        "bat",
+      }));
+  }
+
+  SECTION("invalidateIndex")
+  {
+    fs2Ref.setFiles(TestImageFiles{
+      {"bar/cat", bar_foo_fs2},
+    });
+    vfs.invalidateIndex();
+
+    CHECK(vfs.pathInfo("foo/bar") == PathInfo::Directory);
+    CHECK(vfs.openFile("bar/foo") == bar_foo_fs1);
+    CHECK(vfs.openFile("bar/cat") == bar_foo_fs2);
+    CHECK_THAT(
+      vfs.directoryContents("bar"),
+      Catch::Matchers::UnorderedEquals(std::vector<std::filesystem::path>{
+        "foo",
+        "bat",
+        "cat",
+      }));
+  }
+}
+
+TEST_CASE("VirtualFileSystem reopens archives")
+{
+  const auto fixturePath =
+    std::filesystem::current_path() / "fixture/test/IO/Pak/idpak.pak";
+
+  auto env = TestEnvironment{};
+  const auto pakPath = env.dir() / "test.pak";
+  std::filesystem::copy_file(fixturePath, pakPath);
+
+  auto vfs = VirtualFileSystem{};
+  vfs.mount("", std::make_unique<TestFileSystem>(Entry{DirectoryEntry{"", {}}}, "/fs"));
+  vfs.mount("paks", std::make_unique<IdPakFileSystem>(pakPath));
+
+  CHECK(vfs.archivePaths() == std::vector<std::filesystem::path>{pakPath});
+
+  const auto files = vfs.findRecursively("", makePathInfoPathMatcher({PathInfo::File}));
+  REQUIRE(vfs.pathInfo("paks/pics/tag1.pcx") == PathInfo::File);
+
+  SECTION("Other archives are not reopened")
+  {
+    CHECK(vfs.reopenArchives({env.dir() / "other.pak"}).empty());
+    CHECK(vfs.pathInfo("paks/pics/tag1.pcx") == PathInfo::File);
+  }
+
+  SECTION("Changed archives are reopened")
+  {
+    // a pak file without any entries
+    env.createFile("test.pak", std::string{"PACK\x0c\0\0\0\0\0\0\0", 12});
+    CHECK(vfs.reopenArchives({pakPath}).empty());
+    CHECK(vfs.pathInfo("paks/pics/tag1.pcx") == PathInfo::Unknown);
+
+    std::filesystem::copy_file(
+      fixturePath, pakPath, std::filesystem::copy_options::overwrite_existing);
+    CHECK_THAT(vfs.reopenArchives({pakPath}), Catch::Matchers::UnorderedEquals(files));
+    CHECK(vfs.pathInfo("paks/pics/tag1.pcx") == PathInfo::File);
+  }
+}
+
 } // namespace IO
 } // namespace TrenchBroom
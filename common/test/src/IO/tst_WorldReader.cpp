@@ -19,6 +19,7 @@
 
 #include "IO/DiskIO.h"
 #include "IO/File.h"
+#include "IO/NodeWriter.h"
 #include "IO/TestParserStatus.h"
 #include "IO/WorldReader.h"
 #include "Model/BezierPatch.h"
@@ -29,11 +30,14 @@
 #include "Model/EntityNode.h"
 #include "Model/GroupNode.h"
 #include "Model/LayerNode.h"
+#include "Model/ModelUtils.h"
 #include "Model/ParallelTexCoordSystem.h"
 #include "Model/PatchNode.h"
 #include "Model/WorldNode.h"
 #include "TestUtils.h"
 
+#include <kdl/vector_utils.h>
+
 #include <vecmath/mat.h>
 #include <vecmath/mat_ext.h>
 #include <vecmath/vec.h>
@@ -41,7 +45,9 @@
 #include <fmt/format.h>
 
 #include <filesystem>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "Catch2.h"
 
@@ -1949,5 +1955,177 @@ TEST_CASE("WorldReaderTest.parseUnknownFormatEmptyMap")
   REQUIRE(world != nullptr);
   CHECK(world->mapFormat() == Model::MapFormat::Standard);
 }
+
+namespace
+{
+std::string writeWorld(const Model::WorldNode& world)
+{
+  auto str = std::stringstream{};
+  auto writer = NodeWriter{world, str};
+  writer.writeMap();
+  return str.str();
+}
+
+std::vector<size_t> collectLineNumbers(Model::WorldNode& world)
+{
+  return kdl::vec_transform(
+    Model::collectNodes({&world}), [](const auto* node) { return node->lineNumber(); });
+}
+
+std::string makeBrushes(const size_t count, const std::string& textureName)
+{
+  auto result = std::string{};
+  for (size_t i = 0; i < count; ++i)
+  {
+    const auto x = i * 64;
+    result += fmt::format(
+      R"(// brush {0}
+{{
+( {1} 0 0 ) ( {1} 1 0 ) ( {1} 0 1 ) {5} 0 0 0 1 1
+( {1} 0 0 ) ( {1} 0 1 ) ( {2} 0 0 ) {5} 0 0 0 1 1
+( {1} 0 0 ) ( {2} 0 0 ) ( {1} 1 0 ) {5} 0 0 0 1 1
+( {3} 64 64 ) ( {3} 65 64 ) ( {4} 64 64 ) {5} 0 0 0 1 1
+( {3} 64 64 ) ( {4} 64 64 ) ( {3} 64 65 ) {5} 0 0 0 1 1
+( {3} 64 64 ) ( {3} 64 65 ) ( {3} 65 64 ) {5} 0 0 0 1 1
+}}
+)",
+      i,
+      x,
+      x + 1,
+      x + 64,
+      x + 65,
+      textureName);
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("WorldReaderTest.parseInParallelChunks")
+{
+  // clang-format off
+  const auto data =
+    "{\n\"classname\" \"worldspawn\"\n"
+    + makeBrushes(20, "tex")
+    + makeBrushes(3, "{fence")
+    // this brush has an invalid face and will be skipped with two errors
+    + "{\n( 0 0 0 ) ( 0 0 0 ) ( 0 0 0 ) tex 0 0 0 1 1\n"
+      "( 0 0 0 ) ( 0 0 1 ) ( 64 0 0 ) tex 0 0 0 1 1\n}\n"
+    + makeBrushes(20, "tex")
+    + "}\n{\n\"classname\" \"func_detail\"\n\"some\" \"value\"\n\"some\" \"other\"\n"
+    + makeBrushes(10, "\"quoted tex\"")
+    + "}\n{\n\"classname\" \"info_player_start\"\n}\n";
+  // clang-format on
+
+  const auto worldBounds = vm::bbox3{8192.0};
+
+  auto sequentialStatus = TestParserStatus{};
+  auto sequentialReader = WorldReader{data, Model::MapFormat::Standard, {}};
+  sequentialReader.setParallelChunkSize(0);
+  auto sequentialWorld = sequentialReader.read(worldBounds, sequentialStatus);
+
+  // use a tiny chunk size so that the input is split into many chunks
+  auto parallelStatus = TestParserStatus{};
+  auto parallelReader = WorldReader{data, Model::MapFormat::Standard, {}};
+  parallelReader.setParallelChunkSize(256);
+  auto parallelWorld = parallelReader.read(worldBounds, parallelStatus);
+
+  CHECK(sequentialWorld->defaultLayer()->childCount() == 45u);
+  CHECK(writeWorld(*parallelWorld) == writeWorld(*sequentialWorld));
+  CHECK(collectLineNumbers(*parallelWorld) == collectLineNumbers(*sequentialWorld));
+  CHECK(
+    parallelStatus.messages(LogLevel::Warn)
+    == sequentialStatus.messages(LogLevel::Warn));
+  CHECK(
+    parallelStatus.messages(LogLevel::Error)
+    == sequentialStatus.messages(LogLevel::Error));
+  CHECK(sequentialStatus.countStatus(LogLevel::Warn) == 1u);
+  CHECK(sequentialStatus.countStatus(LogLevel::Error) == 2u);
+}
+
+TEST_CASE("WorldReaderTest.parseInParallelChunksWithError")
+{
+  // clang-format off
+  const auto data =
+    "{\n\"classname\" \"worldspawn\"\n"
+    + makeBrushes(20, "tex")
+    + "{\n( 0 0 0 ) ( 0 0 1 ) ( 64 0 0 tex 0 0 0 1 1\n}\n"
+    + makeBrushes(20, "tex")
+    + "}\n";
+  // clang-format on
+
+  const auto worldBounds = vm::bbox3{8192.0};
+
+  const auto readWorld = [&](const size_t parallelChunkSize) {
+    auto status = TestParserStatus{};
+    auto reader = WorldReader{data, Model::MapFormat::Standard, {}};
+    reader.setParallelChunkSize(parallelChunkSize);
+    try
+    {
+      reader.read(worldBounds, status);
+    }
+    catch (const ParserException& e)
+    {
+      return std::string{e.what()};
+    }
+    return std::string{};
+  };
+
+  const auto sequentialError = readWorld(0);
+  CHECK_FALSE(sequentialError.empty());
+  CHECK(readWorld(256) == sequentialError);
+}
+
+TEST_CASE("WorldReaderTest.parseQuake3InParallelChunks")
+{
+  const auto patch = std::string{R"(// patch
+{
+patchDef2
+{
+common/caulk
+( 3 3 0 0 0 )
+(
+( ( -64 -64 4 0 0 ) ( -64 0 4 0 -0.25 ) ( -64 64 4 0 -0.5 ) )
+( ( 0 -64 4 0.2 0 ) ( 0 0 4 0.2 -0.25 ) ( 0 64 4 0.2 -0.5 ) )
+( ( 64 -64 4 0.4 0 ) ( 64 0 4 0.4 -0.25 ) ( 64 64 4 0.4 -0.5 ) )
+)
+}
+}
+)"};
+  const auto brushPrimitive = std::string{R"({
+brushDef
+{
+( -64 64 64 ) ( 64 -64 64 ) ( -64 -64 64 ) ( ( 0.015625 0 0 ) ( 0 0.015625 0 ) ) common/caulk 0 0 0
+( -64 64 -64 ) ( 64 -64 -64 ) ( 64 64 -64 ) ( ( 0.015625 0 0 ) ( 0 0.015625 0 ) ) common/caulk 0 0 0
+}
+}
+)"};
+
+  auto data = std::string{"{\n\"classname\" \"worldspawn\"\n"};
+  for (size_t i = 0; i < 10; ++i)
+  {
+    data += patch + makeBrushes(2, "common/caulk") + brushPrimitive;
+  }
+  data += "}\n";
+
+  const auto worldBounds = vm::bbox3{8192.0};
+
+  auto sequentialStatus = TestParserStatus{};
+  auto sequentialReader = WorldReader{data, Model::MapFormat::Quake3, {}};
+  sequentialReader.setParallelChunkSize(0);
+  auto sequentialWorld = sequentialReader.read(worldBounds, sequentialStatus);
+
+  auto parallelStatus = TestParserStatus{};
+  auto parallelReader = WorldReader{data, Model::MapFormat::Quake3, {}};
+  parallelReader.setParallelChunkSize(512);
+  auto parallelWorld = parallelReader.read(worldBounds, parallelStatus);
+
+  CHECK(sequentialWorld->defaultLayer()->childCount() == 30u);
+  CHECK(writeWorld(*parallelWorld) == writeWorld(*sequentialWorld));
+  CHECK(collectLineNumbers(*parallelWorld) == collectLineNumbers(*sequentialWorld));
+  CHECK(
+    parallelStatus.messages(LogLevel::Warn)
+    == sequentialStatus.messages(LogLevel::Warn));
+  CHECK(sequentialStatus.countStatus(LogLevel::Warn) == 10u);
+}
 } // namespace IO
 } // namespace TrenchBroom
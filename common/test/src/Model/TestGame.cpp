@@ -27,6 +27,7 @@
 #include "IO/DiskFileSystem.h"
 #include "IO/DiskIO.h"
 #include "IO/ExportOptions.h"
+#include "IO/FileSystemUtils.h"
 #include "IO/LoadTextureCollection.h"
 #include "IO/NodeReader.h"
 #include "IO/NodeWriter.h"
@@ -50,6 +51,22 @@ namespace TrenchBroom
 {
 namespace Model
 {
+namespace
+{
+const TextureConfig& textureConfig()
+{
+  static const auto textureConfig = TextureConfig{
+    "textures",
+    {".D"},
+    "fixture/test/palette.lmp",
+    "wad",
+    "",
+    {},
+  };
+  return textureConfig;
+}
+} // namespace
+
 TestGame::TestGame()
   : m_defaultFaceAttributes{Model::BrushFaceAttributes::NoTextureName}
   , m_fs{std::make_unique<IO::VirtualFileSystem>()}
@@ -105,6 +122,13 @@ void TestGame::doSetAdditionalSearchPaths(
   const std::vector<std::filesystem::path>& /* searchPaths */, Logger& /* logger */)
 {
 }
+
+std::filesystem::path TestGame::doMakeAbsolute(const std::filesystem::path& path) const
+{
+  return IO::safeMakeAbsolute(path, [&](const auto& p) { return m_fs->makeAbsolute(p); })
+    .value_or(std::filesystem::path{});
+}
+
 Game::PathErrors TestGame::doCheckAdditionalSearchPaths(
   const std::vector<std::filesystem::path>& /* searchPaths */) const
 {
@@ -201,16 +225,14 @@ void TestGame::doWriteBrushFacesToStream(
 
 void TestGame::doLoadTextureCollections(Assets::TextureManager& textureManager) const
 {
-  const Model::TextureConfig textureConfig{
-    "textures",
-    {".D"},
-    "fixture/test/palette.lmp",
-    "wad",
-    "",
-    {},
-  };
+  textureManager.reload(*m_fs, textureConfig());
+}
 
-  textureManager.reload(*m_fs, textureConfig);
+void TestGame::doReloadTextures(
+  Assets::TextureManager& textureManager,
+  const std::vector<std::filesystem::path>& texturePaths) const
+{
+  textureManager.reloadTextures(texturePaths, *m_fs, textureConfig());
 }
 
 void TestGame::doReloadWads(
@@ -232,6 +254,17 @@ void TestGame::doReloadWads(
 
 void TestGame::doReloadShaders() {}
 
+std::vector<std::filesystem::path> TestGame::doArchivePaths() const
+{
+  return m_fs->archivePaths();
+}
+
+std::vector<std::filesystem::path> TestGame::doReopenArchives(
+  const std::vector<std::filesystem::path>& archivePaths)
+{
+  return m_fs->reopenArchives(archivePaths);
+}
+
 bool TestGame::doIsEntityDefinitionFile(const std::filesystem::path& /* path */) const
 {
   return false;
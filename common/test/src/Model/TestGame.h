@@ -66,6 +66,7 @@ private:
   Game::SoftMapBounds doExtractSoftMapBounds(const Entity& entity) const override;
   void doSetAdditionalSearchPaths(
     const std::vector<std::filesystem::path>& searchPaths, Logger& logger) override;
+  std::filesystem::path doMakeAbsolute(const std::filesystem::path& path) const override;
   PathErrors doCheckAdditionalSearchPaths(
     const std::vector<std::filesystem::path>& searchPaths) const override;
 
@@ -105,12 +106,18 @@ private:
     std::ostream& stream) const override;
 
   void doLoadTextureCollections(Assets::TextureManager& textureManager) const override;
+  void doReloadTextures(
+    Assets::TextureManager& textureManager,
+    const std::vector<std::filesystem::path>& texturePaths) const override;
 
   void doReloadWads(
     const std::filesystem::path& documentPath,
     const std::vector<std::filesystem::path>& wadPaths,
     Logger& logger) override;
   void doReloadShaders() override;
+  std::vector<std::filesystem::path> doArchivePaths() const override;
+  std::vector<std::filesystem::path> doReopenArchives(
+    const std::vector<std::filesystem::path>& archivePaths) override;
 
   bool doIsEntityDefinitionFile(const std::filesystem::path& path) const override;
   std::vector<Assets::EntityDefinitionFileSpec> doAllEntityDefinitionFiles()
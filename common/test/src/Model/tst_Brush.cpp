@@ -39,6 +39,7 @@
 #include <kdl/vector_utils.h>
 
 #include <vecmath/approx.h>
+#include <vecmath/mat_ext.h>
 #include <vecmath/polygon.h>
 #include <vecmath/ray.h>
 #include <vecmath/segment.h>
@@ -287,6 +288,102 @@ TEST_CASE("BrushTest.contractToZero")
   CHECK(brush1.expand(worldBounds, -64, true).is_error());
 }
 
+TEST_CASE("BrushTest.copySharesGeometry")
+{
+  const vm::bbox3 worldBounds(8192.0);
+  const BrushBuilder builder(MapFormat::Standard, worldBounds);
+
+  const Brush original =
+    builder
+      .createCuboid(vm::bbox3(vm::vec3(-64, -64, -64), vm::vec3(64, 64, 64)), "texture")
+      .value();
+
+  Brush copy = original;
+  CHECK(&copy.vertices() == &original.vertices());
+  for (size_t i = 0; i < copy.faceCount(); ++i)
+  {
+    CHECK(copy.face(i).geometry() == original.face(i).geometry());
+  }
+
+  // editing the copy replaces its geometry and leaves the original unchanged
+  const auto faceIndex = copy.findFace(vm::vec3::pos_x());
+  REQUIRE(faceIndex);
+  REQUIRE(copy.moveBoundary(worldBounds, *faceIndex, vm::vec3(16, 0, 0), false)
+            .is_success());
+
+  CHECK(&copy.vertices() != &original.vertices());
+  CHECK(copy.bounds() == vm::bbox3(vm::vec3(-64, -64, -64), vm::vec3(80, 64, 64)));
+  CHECK(original.bounds() == vm::bbox3(vm::vec3(-64, -64, -64), vm::vec3(64, 64, 64)));
+}
+
+TEST_CASE("BrushTest.translate")
+{
+  const vm::bbox3 worldBounds(8192.0);
+  const BrushBuilder builder(MapFormat::Standard, worldBounds);
+
+  const Brush original =
+    builder
+      .createBrush(
+        std::vector<vm::vec3>{
+          vm::vec3(64, -64, 16),
+          vm::vec3(64, 64, 16),
+          vm::vec3(64, -64, -16),
+          vm::vec3(64, 64, -16),
+          vm::vec3(48, 64, 16),
+          vm::vec3(48, 64, -16)},
+        "texture")
+      .value();
+
+  SECTION("Translated geometry matches rebuilt geometry")
+  {
+    const auto delta = vm::vec3(32, -16, 8);
+    const auto transformation = vm::translation_matrix(delta);
+
+    Brush translated = original;
+    REQUIRE(translated.transform(worldBounds, transformation, true).is_success());
+
+    auto faces = original.faces();
+    for (auto& face : faces)
+    {
+      REQUIRE(face.transform(transformation, true).is_success());
+    }
+    const Brush rebuilt = Brush::create(worldBounds, std::move(faces)).value();
+
+    CHECK(translated.bounds() == original.bounds().translate(delta));
+    CHECK_THAT(
+      translated.vertexPositions(),
+      Catch::UnorderedEquals(rebuilt.vertexPositions()));
+    CHECK(translated.edgeCount() == rebuilt.edgeCount());
+
+    for (const auto& face : translated.faces())
+    {
+      const auto rebuiltFaceIndex = rebuilt.findFace(face.boundary());
+      REQUIRE(rebuiltFaceIndex);
+      CHECK_THAT(
+        face.vertexPositions(),
+        Catch::UnorderedEquals(rebuilt.face(*rebuiltFaceIndex).vertexPositions()));
+    }
+
+    // the original brush is unchanged
+    CHECK(original.bounds().min == vm::vec3(48, -64, -16));
+  }
+
+  SECTION("Translating past the world bounds fails")
+  {
+    Brush translated = original;
+    CHECK(translated
+            .transform(worldBounds, vm::translation_matrix(vm::vec3(8192, 0, 0)), true)
+            .is_error());
+  }
+
+  SECTION("Translating by zero keeps the geometry")
+  {
+    Brush translated = original;
+    REQUIRE(translated.transform(worldBounds, vm::mat4x4::identity(), true).is_success());
+    CHECK(&translated.vertices() == &original.vertices());
+  }
+}
+
 TEST_CASE("BrushTest.moveVertex")
 {
   const vm::bbox3 worldBounds(4096.0);
@@ -298,6 +298,86 @@ TEST_CASE("BrushNodeTest.pick")
   CHECK(hits2.empty());
 }
 
+TEST_CASE("BrushNodeTest.pickMatchesFacePolygons")
+{
+  const auto worldBounds = vm::bbox3{4096.0};
+  const auto editorContext = EditorContext{};
+
+  // an irregular brush that is not aligned to any axis
+  auto brushNode = BrushNode{BrushBuilder{MapFormat::Valve, worldBounds}
+                               .createBrush(
+                                 {
+                                   {-32.0, -16.0, -24.0},
+                                   {40.0, -8.0, -32.0},
+                                   {8.0, 48.0, -16.0},
+                                   {-16.0, 8.0, 56.0},
+                                   {24.0, 24.0, 32.0},
+                                   {-40.0, 32.0, 8.0},
+                                 },
+                                 "texture")
+                               .value()};
+  const auto& brush = brushNode.brush();
+
+  const auto findExpectedHit = [&](const vm::ray3& ray) -> std::optional<Hit> {
+    for (size_t i = 0u; i < brush.faceCount(); ++i)
+    {
+      const auto distance = brush.face(i).intersectWithRay(ray);
+      if (!vm::is_nan(distance))
+      {
+        return Hit{
+          BrushNode::BrushHitType,
+          distance,
+          vm::point_at_distance(ray, distance),
+          BrushFaceHandle{&brushNode, i}};
+      }
+    }
+    return std::nullopt;
+  };
+
+  // rays from the corners and edge centers of a box around the brush towards points
+  // in and around the brush, some of which start inside the brush
+  auto rays = std::vector<vm::ray3>{};
+  for (const auto x : {-96.0, 0.0, 96.0})
+  {
+    for (const auto y : {-96.0, 0.0, 96.0})
+    {
+      for (const auto z : {-96.0, 0.0, 96.0})
+      {
+        const auto origin = vm::vec3{x, y, z};
+        for (const auto& target : std::vector<vm::vec3>{
+               {0.0, 0.0, 0.0},
+               {24.0, -8.0, 0.0},
+               {-36.0, 12.0, 4.0},
+               {8.0, 40.0, -12.0},
+               {0.0, 0.0, 64.0}})
+        {
+          if (origin != target)
+          {
+            rays.emplace_back(origin, vm::normalize(target - origin));
+          }
+        }
+      }
+    }
+  }
+
+  for (const auto& ray : rays)
+  {
+    CAPTURE(ray);
+
+    auto pickResult = PickResult{};
+    brushNode.pick(editorContext, ray, pickResult);
+
+    const auto expectedHit = findExpectedHit(ray);
+    REQUIRE(pickResult.size() == (expectedHit ? 1u : 0u));
+    if (expectedHit)
+    {
+      const auto& hit = pickResult.all().front();
+      CHECK(hit.distance() == vm::approx(expectedHit->distance()));
+      CHECK(hitToFaceHandle(hit) == hitToFaceHandle(*expectedHit));
+    }
+  }
+}
+
 TEST_CASE("BrushNodeTest.clone")
 {
   const vm::bbox3 worldBounds(4096.0);
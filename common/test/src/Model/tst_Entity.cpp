@@ -186,6 +186,59 @@ TEST_CASE("EntityTest.modelSpecification")
     entity.modelSpecification() == Assets::ModelSpecification{"maps/b_shell1.bsp", 0, 0});
 }
 
+TEST_CASE("EntityTest.modelSpecificationIsUpdated")
+{
+  auto modelExpression = IO::ELParser::parseStrict(R"({{
+      skin == "1" -> { path: "maps/b_shell1.bsp", skin: 1 },
+                     { path: "maps/b_shell0.bsp", frame: frame }
+  }})");
+
+  auto definition = Assets::PointEntityDefinition{
+    "some_name",
+    Color(),
+    vm::bbox3(32.0),
+    "",
+    {},
+    Assets::ModelDefinition{modelExpression}};
+
+  auto entity = Entity{};
+  entity.setDefinition({}, &definition);
+  REQUIRE(
+    entity.modelSpecification() == Assets::ModelSpecification{"maps/b_shell0.bsp", 0, 0});
+
+  SECTION("Changing a property that is not read by the expression")
+  {
+    entity.addOrUpdateProperty({}, "target", "some_target");
+    CHECK(
+      entity.modelSpecification()
+      == Assets::ModelSpecification{"maps/b_shell0.bsp", 0, 0});
+  }
+
+  SECTION("Changing a property that is read by the expression")
+  {
+    entity.addOrUpdateProperty({}, "frame", "2");
+    CHECK(
+      entity.modelSpecification()
+      == Assets::ModelSpecification{"maps/b_shell0.bsp", 0, 2});
+
+    entity.addOrUpdateProperty({}, "skin", "1");
+    CHECK(
+      entity.modelSpecification()
+      == Assets::ModelSpecification{"maps/b_shell1.bsp", 1, 0});
+
+    entity.removeProperty({}, "skin");
+    CHECK(
+      entity.modelSpecification()
+      == Assets::ModelSpecification{"maps/b_shell0.bsp", 0, 2});
+  }
+
+  SECTION("Unsetting the definition")
+  {
+    entity.unsetEntityDefinitionAndModel();
+    CHECK(entity.modelSpecification() == Assets::ModelSpecification{});
+  }
+}
+
 TEST_CASE("EntityTest.unsetEntityDefinitionAndModel")
 {
   auto config = EntityPropertyConfig{{{EL::LiteralExpression{EL::Value{2.0}}, 0, 0}}};
@@ -20,9 +20,11 @@
 #include "Model/EntityNode.h"
 #include "Model/EntityNodeBase.h"
 #include "Model/EntityNodeIndex.h"
+#include "Model/InternedString.h"
 
 #include <kdl/vector_utils.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -114,7 +116,7 @@ TEST_CASE("EntityNodeIndexTest.addProperty")
       {"test", "somevalue"},
       {"other", "someothervalue"},
     }));
-  index.addProperty(entity2, "other", "someothervalue");
+  index.addProperty(entity2, InternedString{"other"}, InternedString{"someothervalue"});
 
   CHECK(findExactExact(index, "test", "notfound").empty());
 
@@ -143,7 +145,8 @@ TEST_CASE("EntityNodeIndexTest.removeProperty")
   index.addEntityNode(entity1);
   index.addEntityNode(entity2);
 
-  index.removeProperty(entity2, "other", "someothervalue");
+  index.removeProperty(
+    entity2, InternedString{"other"}, InternedString{"someothervalue"});
 
   const std::vector<EntityNodeBase*>& nodes = findExactExact(index, "test", "somevalue");
   CHECK(nodes.size() == 2u);
@@ -156,6 +159,69 @@ TEST_CASE("EntityNodeIndexTest.removeProperty")
   delete entity2;
 }
 
+TEST_CASE("EntityNodeIndexTest.removeRepeatedValue")
+{
+  EntityNodeIndex index;
+
+  EntityNode* entity1 =
+    new EntityNode({}, {{"target", "somevalue"}, {"killtarget", "somevalue"}});
+
+  index.addEntityNode(entity1);
+
+  index.removeProperty(entity1, InternedString{"target"}, InternedString{"somevalue"});
+  CHECK(
+    findExactExact(index, "killtarget", "somevalue")
+    == std::vector<EntityNodeBase*>{entity1});
+  CHECK_THAT(
+    index.allKeys(), Catch::UnorderedEquals(std::vector<std::string>{"killtarget"}));
+
+  index.removeProperty(
+    entity1, InternedString{"killtarget"}, InternedString{"somevalue"});
+  CHECK(findExactExact(index, "killtarget", "somevalue").empty());
+  CHECK(index.allKeys().empty());
+
+  delete entity1;
+}
+
+TEST_CASE("EntityNodeIndexTest.manyNodesWithSameValue")
+{
+  EntityNodeIndex index;
+
+  auto entities = std::vector<std::unique_ptr<EntityNode>>{};
+  for (size_t i = 0; i < 200u; ++i)
+  {
+    entities.emplace_back(new EntityNode(
+      {}, {{"classname", "light"}, {"targetname", "t" + std::to_string(i)}}));
+    index.addEntityNode(entities.back().get());
+  }
+
+  CHECK(findExactExact(index, "classname", "light").size() == 200u);
+  CHECK(
+    findExactExact(index, "targetname", "t42")
+    == std::vector<EntityNodeBase*>{entities[42].get()});
+
+  for (size_t i = 0; i < 200u; i += 2u)
+  {
+    index.removeEntityNode(entities[i].get());
+  }
+
+  auto expected = std::vector<EntityNodeBase*>{};
+  for (size_t i = 1; i < 200u; i += 2u)
+  {
+    expected.push_back(entities[i].get());
+  }
+  CHECK_THAT(
+    findExactExact(index, "classname", "light"), Catch::UnorderedEquals(expected));
+  CHECK(findExactExact(index, "targetname", "t42").empty());
+
+  for (size_t i = 1; i < 200u; i += 2u)
+  {
+    index.removeEntityNode(entities[i].get());
+  }
+  CHECK(findExactExact(index, "classname", "light").empty());
+  CHECK(index.allKeys().empty());
+}
+
 TEST_CASE("EntityNodeIndexTest.addNumberedEntityProperty")
 {
   EntityNodeIndex index;
@@ -186,7 +252,7 @@ TEST_CASE("EntityNodeIndexTest.addRemoveFloatProperty")
   CHECK(nodes.size() == 1u);
   CHECK(kdl::vec_contains(nodes, entity1));
 
-  index.removeProperty(entity1, "delay", "3.5");
+  index.removeProperty(entity1, InternedString{"delay"}, InternedString{"3.5"});
 
   delete entity1;
 }
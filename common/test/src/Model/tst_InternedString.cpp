@@ -0,0 +1,139 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/InternedString.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+TEST_CASE("InternedStringTest.constructor")
+{
+  const auto poolSize = InternedString::poolSize();
+
+  CHECK(InternedString{}.str() == "");
+  CHECK(InternedString{}.empty());
+  CHECK(InternedString{""} == InternedString{});
+  CHECK(InternedString::poolSize() == poolSize);
+
+  const auto str = InternedString{"some string"};
+  CHECK(str.str() == "some string");
+  CHECK_FALSE(str.empty());
+  CHECK(InternedString::poolSize() == poolSize + 1u);
+
+  CHECK(InternedString{std::string{"some string"}} == str);
+  CHECK(InternedString{std::string_view{"some string"}} == str);
+  CHECK(InternedString{"other string"} != str);
+}
+
+TEST_CASE("InternedStringTest.sharedStorage")
+{
+  const auto poolSize = InternedString::poolSize();
+
+  auto str1 = InternedString{"some string"};
+  const auto str2 = InternedString{"some string"};
+  CHECK(&str1.str() == &str2.str());
+  CHECK(std::hash<InternedString>{}(str1) == std::hash<InternedString>{}(str2));
+  CHECK(InternedString::poolSize() == poolSize + 1u);
+
+  auto str3 = str1;
+  CHECK(&str3.str() == &str1.str());
+
+  auto str4 = std::move(str1);
+  CHECK(str1.empty());
+  CHECK(&str4.str() == &str2.str());
+  CHECK(InternedString::poolSize() == poolSize + 1u);
+}
+
+TEST_CASE("InternedStringTest.release")
+{
+  const auto poolSize = InternedString::poolSize();
+
+  {
+    auto str1 = InternedString{"some string"};
+    auto str2 = str1;
+    CHECK(InternedString::poolSize() == poolSize + 1u);
+
+    str1 = InternedString{"other string"};
+    CHECK(InternedString::poolSize() == poolSize + 2u);
+
+    str2 = str1;
+    CHECK(InternedString::poolSize() == poolSize + 1u);
+  }
+
+  CHECK(InternedString::poolSize() == poolSize);
+}
+
+TEST_CASE("InternedStringTest.comparison")
+{
+  const auto a = InternedString{"a"};
+  const auto b = InternedString{"b"};
+
+  CHECK(a < b);
+  CHECK(a <= b);
+  CHECK(b > a);
+  CHECK(b >= a);
+  CHECK_FALSE(a < a);
+  CHECK(a <= a);
+  CHECK(InternedString{} < a);
+}
+
+TEST_CASE("InternedStringTest.streamOperator")
+{
+  auto str = std::stringstream{};
+  str << InternedString{"some string"};
+  CHECK(str.str() == "some string");
+}
+
+TEST_CASE("InternedStringTest.threads")
+{
+  const auto poolSize = InternedString::poolSize();
+
+  const auto keys = std::vector<std::string>{"classname", "origin", "angle", "target"};
+  const auto intern = [&]() {
+    for (size_t i = 0; i < 10000; ++i)
+    {
+      const auto str = InternedString{keys[i % keys.size()]};
+      auto copy = str;
+      copy = InternedString{keys[(i + 1) % keys.size()]};
+    }
+  };
+
+  auto threads = std::vector<std::thread>{};
+  for (size_t i = 0; i < 4; ++i)
+  {
+    threads.emplace_back(intern);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  CHECK(InternedString::poolSize() == poolSize);
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -479,6 +479,68 @@ TEST_CASE("ModelUtils.collectTouchingNodes")
       std::vector<Node*>{&groupNode, &entityNode, &brushNode, &patchNode}));
 }
 
+TEST_CASE("ModelUtils.collectTouchingNodesInWorld")
+{
+  constexpr auto worldBounds = vm::bbox3d{8192.0};
+  constexpr auto mapFormat = MapFormat::Quake3;
+
+  const auto builder = BrushBuilder{mapFormat, worldBounds};
+  const auto createBrushNode = [&](const vm::vec3& center, const FloatType size) {
+    auto* brushNode = new BrushNode{builder.createCube(size, "texture").value()};
+    transformNode(*brushNode, vm::translation_matrix(center), worldBounds);
+    return brushNode;
+  };
+
+  auto worldNode = WorldNode{{}, {}, mapFormat};
+
+  auto* brushNode = createBrushNode(vm::vec3{0, 0, 0}, 64.0);
+  auto* distantBrushNode = createBrushNode(vm::vec3{1024, 0, 0}, 64.0);
+
+  auto* groupNode = new GroupNode{Group{"group"}};
+  groupNode->addChild(createBrushNode(vm::vec3{4, 0, 0}, 8.0));
+
+  auto* distantGroupNode = new GroupNode{Group{"distant group"}};
+  distantGroupNode->addChild(createBrushNode(vm::vec3{0, 1024, 0}, 8.0));
+
+  auto* entityNode = new EntityNode{Entity{}};
+  auto* entityBrushNode = createBrushNode(vm::vec3{0, 0, 16}, 16.0);
+  auto* distantEntityBrushNode = createBrushNode(vm::vec3{0, 0, 1024}, 16.0);
+  entityNode->addChildren({entityBrushNode, distantEntityBrushNode});
+
+  auto* queryBrushNode = createBrushNode(vm::vec3{0, 0, 0}, 24.0);
+
+  worldNode.defaultLayer()->addChildren(
+    {brushNode,
+     distantBrushNode,
+     groupNode,
+     distantGroupNode,
+     entityNode,
+     queryBrushNode});
+
+  CHECK_THAT(
+    collectTouchingNodes({&worldNode}, {queryBrushNode}),
+    Catch::Matchers::UnorderedEquals(
+      std::vector<Node*>{brushNode, groupNode, entityBrushNode}));
+
+  CHECK_THAT(
+    collectTouchingNodes({worldNode.defaultLayer()}, {queryBrushNode}),
+    Catch::Matchers::Equals(std::vector<Node*>{brushNode, groupNode, entityBrushNode}));
+
+  CHECK_THAT(
+    collectContainedNodes({&worldNode}, {queryBrushNode}),
+    Catch::Matchers::Equals(std::vector<Node*>{groupNode}));
+
+  SECTION("Nodes in opened groups are collected individually")
+  {
+    groupNode->open();
+
+    CHECK_THAT(
+      collectTouchingNodes({&worldNode}, {queryBrushNode}),
+      Catch::Matchers::UnorderedEquals(
+        std::vector<Node*>{brushNode, groupNode->children().front(), entityBrushNode}));
+  }
+}
+
 TEST_CASE("ModelUtils.collectContainedNodes")
 {
   constexpr auto worldBounds = vm::bbox3d{8192.0};
@@ -0,0 +1,271 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushFace.h"
+#include "Model/BrushNode.h"
+#include "Model/Entity.h"
+#include "Model/EntityNode.h"
+#include "Model/EntityProperties.h"
+#include "Model/MapFormat.h"
+#include "Model/NodeContents.h"
+#include "Model/NodeContentsDelta.h"
+#include "Model/TexCoordSystem.h"
+
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+const auto worldBounds = vm::bbox3{8192.0};
+
+void checkFaces(const Brush& actual, const Brush& expected)
+{
+  REQUIRE(actual.faceCount() == expected.faceCount());
+  for (size_t i = 0; i < actual.faceCount(); ++i)
+  {
+    CHECK(actual.face(i).points() == expected.face(i).points());
+    CHECK(actual.face(i).attributes() == expected.face(i).attributes());
+    CHECK(actual.face(i).texCoordSystem() == expected.face(i).texCoordSystem());
+  }
+}
+} // namespace
+
+TEST_CASE("NodeContentsDelta.entityProperties")
+{
+  const auto config = EntityPropertyConfig{};
+  const auto original = Entity{
+    config,
+    {{"classname", "light"}, {"origin", "0 0 0"}, {"light", "300"}, {"target", "t1"}}};
+
+  auto changed = original;
+
+  SECTION("Change value")
+  {
+    changed.addOrUpdateProperty(config, "light", "200");
+  }
+
+  SECTION("Add property")
+  {
+    changed.addOrUpdateProperty(config, "style", "1");
+  }
+
+  SECTION("Remove property")
+  {
+    changed.removeProperty(config, "origin");
+  }
+
+  SECTION("Rename property")
+  {
+    changed.renameProperty(config, "target", "targetname");
+  }
+
+  SECTION("Change protected properties")
+  {
+    changed.setProtectedProperties({"light"});
+  }
+
+  const auto currentContents = NodeContents{changed};
+  const auto snapshot = NodeContents{original};
+
+  const auto delta = NodeContentsDelta::create(currentContents, snapshot, config);
+  REQUIRE(delta);
+  CHECK(delta->memoryUsage() < memoryUsage(snapshot));
+
+  const auto restored = delta->apply(currentContents, config).value();
+  const auto& restoredEntity = std::get<Entity>(restored.get());
+  CHECK(restoredEntity.properties() == original.properties());
+  CHECK(restoredEntity.protectedProperties() == original.protectedProperties());
+  CHECK(restoredEntity.pointEntity() == original.pointEntity());
+}
+
+TEST_CASE("NodeContentsDelta.faceAttributes")
+{
+  const auto config = EntityPropertyConfig{};
+  const auto mapFormat = GENERATE(MapFormat::Standard, MapFormat::Valve);
+
+  auto builder = BrushBuilder{mapFormat, worldBounds};
+  const auto original = builder.createCube(64.0, "texture").value();
+
+  auto changed = original;
+  auto& face = changed.face(2);
+  auto attributes = face.attributes();
+  attributes.setTextureName("other");
+  attributes.setXOffset(16.0f);
+  attributes.setRotation(45.0f);
+  face.setAttributes(attributes);
+
+  const auto currentContents = NodeContents{changed};
+  const auto snapshot = NodeContents{original};
+
+  const auto delta = NodeContentsDelta::create(currentContents, snapshot, config);
+  REQUIRE(delta);
+  CHECK(delta->memoryUsage() < memoryUsage(snapshot));
+
+  const auto restored = delta->apply(currentContents, config).value();
+  checkFaces(std::get<Brush>(restored.get()), original);
+}
+
+TEST_CASE("NodeContentsDelta.transformation")
+{
+  const auto config = EntityPropertyConfig{};
+  const auto mapFormat = GENERATE(MapFormat::Standard, MapFormat::Valve);
+  const auto lockTextures = GENERATE(true, false);
+
+  auto builder = BrushBuilder{mapFormat, worldBounds};
+  const auto original = builder.createCube(64.0, "texture").value();
+
+  const auto transformation = BrushTransformation{
+    worldBounds, vm::translation_matrix(vm::vec3{16.0, 32.0, -8.0}), lockTextures};
+
+  auto changed = original;
+  REQUIRE(changed
+            .transform(
+              transformation.worldBounds,
+              transformation.transformation,
+              transformation.lockTextures)
+            .is_success());
+
+  const auto currentContents = NodeContents{changed};
+  const auto snapshot = NodeContents{original};
+
+  const auto delta =
+    NodeContentsDelta::create(currentContents, snapshot, config, transformation);
+  REQUIRE(delta);
+  CHECK(delta->memoryUsage() < memoryUsage(snapshot));
+
+  const auto restored = delta->apply(currentContents, config).value();
+  checkFaces(std::get<Brush>(restored.get()), original);
+
+  const auto inverseDelta = delta->inverse();
+  REQUIRE(inverseDelta);
+
+  const auto redone = inverseDelta->apply(restored, config).value();
+  checkFaces(std::get<Brush>(redone.get()), changed);
+}
+
+TEST_CASE("NodeContentsDelta.composedTransformation")
+{
+  const auto config = EntityPropertyConfig{};
+  const auto mapFormat = GENERATE(MapFormat::Standard, MapFormat::Valve);
+  const auto lockTextures = GENERATE(true, false);
+
+  auto builder = BrushBuilder{mapFormat, worldBounds};
+  const auto original = builder.createCube(64.0, "texture").value();
+
+  const auto first = BrushTransformation{
+    worldBounds, vm::translation_matrix(vm::vec3{16.0, 32.0, -8.0}), lockTextures};
+  const auto second = BrushTransformation{
+    worldBounds, vm::translation_matrix(vm::vec3{-32.0, 8.0, 64.0}), lockTextures};
+
+  auto changed = original;
+  for (const auto& transformation : {first, second})
+  {
+    REQUIRE(changed
+              .transform(
+                transformation.worldBounds,
+                transformation.transformation,
+                transformation.lockTextures)
+              .is_success());
+  }
+
+  const auto composed = composeBrushTransformations(first, second);
+  REQUIRE(composed);
+
+  const auto currentContents = NodeContents{changed};
+  const auto delta =
+    NodeContentsDelta::create(currentContents, NodeContents{original}, config, composed);
+  REQUIRE(delta);
+
+  const auto restored = delta->apply(currentContents, config).value();
+  checkFaces(std::get<Brush>(restored.get()), original);
+
+  auto otherTransformation = second;
+  otherTransformation.lockTextures = !lockTextures;
+  CHECK(composeBrushTransformations(first, otherTransformation) == std::nullopt);
+}
+
+TEST_CASE("NodeContentsDelta.fallbackToSnapshot")
+{
+  const auto config = EntityPropertyConfig{};
+
+  auto builder = BrushBuilder{MapFormat::Valve, worldBounds};
+  const auto original = builder.createCube(64.0, "texture").value();
+
+  SECTION("Changed geometry without transformation")
+  {
+    const auto changed = builder.createCube(32.0, "texture").value();
+    CHECK_FALSE(
+      NodeContentsDelta::create(NodeContents{changed}, NodeContents{original}, config));
+  }
+
+  SECTION("Wrong transformation")
+  {
+    auto changed = original;
+    REQUIRE(changed
+              .transform(worldBounds, vm::translation_matrix(vm::vec3{16, 0, 0}), false)
+              .is_success());
+
+    const auto transformation =
+      BrushTransformation{worldBounds, vm::translation_matrix(vm::vec3{8, 0, 0}), false};
+    CHECK_FALSE(NodeContentsDelta::create(
+      NodeContents{changed}, NodeContents{original}, config, transformation));
+  }
+
+  SECTION("Different types")
+  {
+    const auto entity = Entity{config, {{"classname", "light"}}};
+    CHECK_FALSE(
+      NodeContentsDelta::create(NodeContents{entity}, NodeContents{original}, config));
+  }
+}
+
+TEST_CASE("NodeContentsDelta.nodeMemoryUsage")
+{
+  auto builder = BrushBuilder{MapFormat::Valve, worldBounds};
+  const auto brush = builder.createCube(64.0, "texture").value();
+
+  auto entityNode = EntityNode{Entity{{}, {{"classname", "func_door"}}}};
+  const auto entityOnly = memoryUsage(entityNode);
+  CHECK(entityOnly >= memoryUsage(NodeContents{entityNode.entity()}));
+
+  auto* brushNode = new BrushNode{brush};
+  entityNode.addChild(brushNode);
+
+  // the descendants are included
+  CHECK(memoryUsage(*brushNode) >= memoryUsage(NodeContents{brush}));
+  CHECK(memoryUsage(entityNode) == entityOnly + memoryUsage(*brushNode));
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -0,0 +1,305 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/EmptyGroupValidator.h"
+#include "Model/EmptyPropertyKeyValidator.h"
+#include "Model/Entity.h"
+#include "Model/EntityNode.h"
+#include "Model/EntityProperties.h"
+#include "Model/Group.h"
+#include "Model/GroupNode.h"
+#include "Model/Issue.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/ValidationEngine.h"
+#include "Model/Validator.h"
+#include "Model/WorldNode.h"
+#include "TestUtils.h"
+
+#include <kdl/result.h>
+#include <kdl/vector_utils.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace Model
+{
+namespace
+{
+class CountingValidator : public Validator
+{
+public:
+  mutable size_t count = 0;
+
+  explicit CountingValidator(const ValidatorDependency::Type dependencies)
+    : Validator{freeIssueType(), "Counting", dependencies}
+  {
+  }
+
+private:
+  void doValidate(
+    EntityNodeBase& entityNode,
+    std::vector<std::unique_ptr<Issue>>& issues) const override
+  {
+    ++count;
+    issues.push_back(std::make_unique<Issue>(type(), entityNode, "entity"));
+  }
+
+  void doValidate(
+    BrushNode& brushNode, std::vector<std::unique_ptr<Issue>>& issues) const override
+  {
+    ++count;
+    issues.push_back(std::make_unique<Issue>(type(), brushNode, "brush"));
+  }
+};
+
+std::vector<IssueType> issueTypes(const std::vector<const Issue*>& issues)
+{
+  return kdl::vec_transform(issues, [](const auto* issue) { return issue->type(); });
+}
+
+std::vector<size_t> issueSeqIds(const std::vector<const Issue*>& issues)
+{
+  return kdl::vec_transform(issues, [](const auto* issue) { return issue->seqId(); });
+}
+} // namespace
+
+TEST_CASE("ValidationEngine.validate")
+{
+  constexpr auto worldBounds = vm::bbox3{8192.0};
+  constexpr auto mapFormat = MapFormat::Quake3;
+
+  auto worldNode = WorldNode{{}, {}, mapFormat};
+  auto* groupNode = new GroupNode{Group{"group"}};
+  auto* entityNode = new EntityNode{Entity{{}, {{"", "value"}}}};
+  auto* brushNode = new BrushNode{
+    BrushBuilder{mapFormat, worldBounds}.createCube(64.0, "texture").value()};
+  worldNode.defaultLayer()->addChildren({groupNode, entityNode, brushNode});
+
+  const auto emptyGroupValidator = EmptyGroupValidator{};
+  const auto emptyPropertyKeyValidator = EmptyPropertyKeyValidator{};
+  const auto validators =
+    std::vector<const Validator*>{&emptyGroupValidator, &emptyPropertyKeyValidator};
+
+  auto validationEngine = ValidationEngine{2};
+  CHECK(validationEngine.done());
+
+  validationEngine.reset(worldNode);
+  CHECK(validationEngine.pendingNodeCount() == 5u);
+
+  SECTION("Validate in batches")
+  {
+    // world and layer
+    CHECK(validationEngine.validateNextBatch(validators).empty());
+    CHECK(validationEngine.pendingNodeCount() == 3u);
+
+    CHECK(
+      issueTypes(validationEngine.validateNextBatch(validators))
+      == std::vector<IssueType>{
+        emptyGroupValidator.type(), emptyPropertyKeyValidator.type()});
+    CHECK(validationEngine.pendingNodeCount() == 1u);
+
+    CHECK(validationEngine.validateNextBatch(validators).empty());
+    CHECK(validationEngine.done());
+
+    CHECK(validationEngine.validateNextBatch(validators).empty());
+  }
+
+  SECTION("Validate all nodes")
+  {
+    CHECK(
+      issueTypes(validationEngine.validateAll(validators))
+      == std::vector<IssueType>{
+        emptyGroupValidator.type(), emptyPropertyKeyValidator.type()});
+    CHECK(validationEngine.done());
+  }
+
+  SECTION("Reset discards pending nodes")
+  {
+    validationEngine.reset();
+    CHECK(validationEngine.done());
+    CHECK(validationEngine.validateAll(validators).empty());
+  }
+
+  SECTION("Pending nodes are not scheduled again")
+  {
+    validationEngine.schedule({groupNode, entityNode});
+    CHECK(validationEngine.pendingNodeCount() == 5u);
+  }
+
+  SECTION("Validated nodes can be scheduled again")
+  {
+    validationEngine.validateAll(validators);
+    validationEngine.schedule({worldNode.defaultLayer()});
+    CHECK(validationEngine.pendingNodeCount() == 4u);
+    CHECK(
+      validationEngine.nextBatch()
+      == std::vector<Node*>{worldNode.defaultLayer(), groupNode});
+  }
+
+  SECTION("Only invalid nodes are scheduled")
+  {
+    validationEngine.validateAll(validators);
+    validationEngine.scheduleInvalidNodes({groupNode, entityNode, brushNode}, validators);
+    CHECK(validationEngine.done());
+
+    entityNode->setEntity(Entity{{}, {{"key", "value"}}});
+    validationEngine.scheduleInvalidNodes({entityNode}, validators);
+    // the ancestors are invalidated because they depend on their children
+    CHECK(
+      validationEngine.nextBatch()
+      == std::vector<Node*>{entityNode, worldNode.defaultLayer()});
+    validationEngine.validateNextBatch(validators);
+    CHECK(validationEngine.nextBatch() == std::vector<Node*>{&worldNode});
+    CHECK(validationEngine.validateAll(validators).empty());
+
+    // other nodes are not visited even if their issues are invalid
+    brushNode->invalidateIssues();
+    groupNode->invalidateIssues();
+    validationEngine.scheduleInvalidNodes({entityNode}, validators);
+    CHECK(validationEngine.done());
+
+    validationEngine.scheduleInvalidNodes({brushNode, groupNode}, validators);
+    CHECK(validationEngine.nextBatch() == std::vector<Node*>{brushNode, groupNode});
+  }
+
+  SECTION("Unscheduling removes nodes and their descendants")
+  {
+    // world and layer
+    validationEngine.validateNextBatch(validators);
+
+    validationEngine.unschedule({groupNode});
+    CHECK(validationEngine.nextBatch() == std::vector<Node*>{entityNode, brushNode});
+
+    validationEngine.unschedule({worldNode.defaultLayer()});
+    CHECK(validationEngine.done());
+  }
+}
+
+TEST_CASE("ValidationEngine.invalidateIssues")
+{
+  constexpr auto worldBounds = vm::bbox3{8192.0};
+  constexpr auto mapFormat = MapFormat::Quake3;
+
+  auto entityNode = EntityNode{Entity{}};
+  auto* brushNode = new BrushNode{
+    BrushBuilder{mapFormat, worldBounds}.createCube(64.0, "texture").value()};
+
+  // every validator allocates an issue type, so we create them only once
+  static const auto propertiesValidator =
+    CountingValidator{ValidatorDependency::Properties};
+  static const auto geometryValidator = CountingValidator{ValidatorDependency::Geometry};
+  static const auto hierarchyValidator =
+    CountingValidator{ValidatorDependency::Hierarchy};
+
+  propertiesValidator.count = 0;
+  geometryValidator.count = 0;
+  hierarchyValidator.count = 0;
+
+  const auto validators = std::vector<const Validator*>{
+    &propertiesValidator, &geometryValidator, &hierarchyValidator};
+
+  const auto validationCounts = [&]() {
+    return std::vector<size_t>{
+      propertiesValidator.count, geometryValidator.count, hierarchyValidator.count};
+  };
+
+  const auto entityIssues = entityNode.issues(validators);
+  CHECK(entityIssues.size() == 3u);
+  CHECK(validationCounts() == std::vector<size_t>{1, 1, 1});
+
+  SECTION("Issues are only validated once")
+  {
+    CHECK(entityNode.issues(validators) == entityIssues);
+    CHECK(validationCounts() == std::vector<size_t>{1, 1, 1});
+  }
+
+  SECTION("Changing properties only invalidates dependent validators")
+  {
+    const auto seqIds = issueSeqIds(entityIssues);
+    entityNode.setEntity(Entity{{}, {{EntityPropertyKeys::Classname, "light"}}});
+
+    const auto newEntityIssues = entityNode.issues(validators);
+    CHECK(newEntityIssues.size() == 3u);
+    CHECK(validationCounts() == std::vector<size_t>{2, 1, 1});
+
+    // the issues of the other validators are retained
+    const auto newSeqIds = issueSeqIds(newEntityIssues);
+    CHECK(kdl::vec_contains(newSeqIds, seqIds[1]));
+    CHECK(kdl::vec_contains(newSeqIds, seqIds[2]));
+    CHECK_FALSE(kdl::vec_contains(newSeqIds, seqIds[0]));
+  }
+
+  SECTION("Adding children only invalidates dependent validators")
+  {
+    entityNode.addChild(brushNode);
+
+    CHECK(entityNode.issues(validators).size() == 3u);
+    CHECK(validationCounts() == std::vector<size_t>{1, 1, 2});
+
+    SECTION("Changing the geometry only invalidates dependent validators")
+    {
+      CHECK(brushNode->issues(validators).size() == 3u);
+      CHECK(validationCounts() == std::vector<size_t>{2, 2, 3});
+
+      transformNode(
+        *brushNode, vm::translation_matrix(vm::vec3{16.0, 0.0, 0.0}), worldBounds);
+
+      CHECK(brushNode->issues(validators).size() == 3u);
+      CHECK(validationCounts() == std::vector<size_t>{2, 3, 3});
+
+      // the parent's issues that depend on its children are invalidated
+      CHECK(entityNode.issues(validators).size() == 3u);
+      CHECK(validationCounts() == std::vector<size_t>{2, 3, 4});
+    }
+  }
+
+  SECTION("Removing a validator drops its issues")
+  {
+    CHECK(
+      issueTypes(entityNode.issues({&propertiesValidator}))
+      == std::vector<IssueType>{propertiesValidator.type()});
+    CHECK(validationCounts() == std::vector<size_t>{1, 1, 1});
+  }
+
+  SECTION("Invalidating all issues runs all validators")
+  {
+    entityNode.invalidateIssues();
+    CHECK(entityNode.issues(validators).size() == 3u);
+    CHECK(validationCounts() == std::vector<size_t>{2, 2, 2});
+  }
+
+  if (brushNode->parent() == nullptr)
+  {
+    delete brushNode;
+  }
+}
+} // namespace Model
+} // namespace TrenchBroom
@@ -19,7 +19,9 @@
 
 #include "Model/BezierPatch.h"
 #include "Model/BrushBuilder.h"
+#include "Model/BrushFaceHandle.h"
 #include "Model/BrushNode.h"
+#include "Model/EditorContext.h"
 #include "Model/Entity.h"
 #include "Model/EntityNode.h"
 #include "Model/Group.h"
@@ -28,17 +30,23 @@
 #include "Model/LayerNode.h"
 #include "Model/MapFormat.h"
 #include "Model/PatchNode.h"
+#include "Model/PickResult.h"
 #include "Model/WorldNode.h"
 #include "TestUtils.h"
-#include "octree.h"
+#include "flat_octree.h"
 
 #include <kdl/result.h>
 #include <kdl/result_io.h>
 #include <kdl/string_utils.h>
+#include <kdl/vector_utils.h>
 
 #include <vecmath/mat.h>
 #include <vecmath/mat_ext.h>
 #include <vecmath/mat_io.h>
+#include <vecmath/ray.h>
+#include <vecmath/ray_io.h>
+
+#include <vector>
 
 #include "Catch2.h"
 
@@ -323,6 +331,163 @@ TEST_CASE("WorldNodeTest.disableNodeTreeUpdates")
   CHECK(nodeTree.contains(patchNode));
 }
 
+TEST_CASE("WorldNodeTest.pickRays")
+{
+  constexpr auto worldBounds = vm::bbox3d{8192.0};
+  constexpr auto mapFormat = MapFormat::Quake3;
+
+  auto worldNode = WorldNode{{}, {}, mapFormat};
+  const auto builder = BrushBuilder{mapFormat, worldBounds};
+  for (size_t i = 0; i < 64; ++i)
+  {
+    const auto min = vm::vec3{double(i % 4), double((i / 4) % 4), double(i / 16)} * 128.0;
+    const auto bounds = vm::bbox3{min, min + vm::vec3::fill(64.0)};
+    worldNode.defaultLayer()->addChild(
+      new BrushNode{builder.createCuboid(bounds, "texture").value()});
+  }
+
+  const auto rays = std::vector<vm::ray3>{
+    {{-64, 32, 32}, {1, 0, 0}},
+    {{32, -64, 160}, {0, 1, 0}},
+    {{-64, -64, -64}, vm::normalize(vm::vec3{1, 1, 1})},
+    {{32, 32, -64}, {0, 0, 1}},
+    {{96, 96, 96}, {0, 0, 1}},
+    {{-64, 32, 32}, {-1, 0, 0}},
+  };
+
+  const auto editorContext = EditorContext{};
+  auto pickResults = std::vector<PickResult>(rays.size(), PickResult::byDistance());
+  worldNode.pick(editorContext, rays, pickResults);
+
+  for (size_t i = 0; i < rays.size(); ++i)
+  {
+    CAPTURE(rays[i]);
+
+    auto pickResult = PickResult::byDistance();
+    worldNode.pick(editorContext, rays[i], pickResult);
+
+    const auto& expectedHits = pickResult.all();
+    const auto& actualHits = pickResults[i].all();
+    REQUIRE(actualHits.size() == expectedHits.size());
+    for (size_t j = 0; j < expectedHits.size(); ++j)
+    {
+      CHECK(
+        actualHits[j].target<BrushFaceHandle>()
+        == expectedHits[j].target<BrushFaceHandle>());
+      CHECK(actualHits[j].distance() == expectedHits[j].distance());
+    }
+  }
+
+  CHECK(pickResults[0].size() == 4u);
+  CHECK(pickResults[3].size() == 4u);
+  CHECK(pickResults[4].empty());
+  CHECK(pickResults[5].empty());
+}
+
+TEST_CASE("WorldNodeTest.pickManyCandidates")
+{
+  constexpr auto worldBounds = vm::bbox3d{8192.0};
+  constexpr auto mapFormat = MapFormat::Quake3;
+
+  // enough brushes along the X axis to pick them in parallel
+  auto worldNode = WorldNode{{}, {}, mapFormat};
+  const auto builder = BrushBuilder{mapFormat, worldBounds};
+  auto brushNodes = std::vector<BrushNode*>{};
+  for (size_t i = 0; i < 1024; ++i)
+  {
+    const auto min = vm::vec3{double(i) * 8.0 - 4096.0, 0.0, double(i % 3) * 4.0};
+    const auto bounds = vm::bbox3{min, min + vm::vec3{4.0, 16.0, 16.0}};
+    auto* brushNode = new BrushNode{builder.createCuboid(bounds, "texture").value()};
+    worldNode.defaultLayer()->addChild(brushNode);
+    brushNodes.push_back(brushNode);
+  }
+
+  const auto ray = vm::ray3{{-5000.0, 8.0, 14.0}, vm::normalize(vm::vec3{1, 0, 0.0001})};
+  const auto editorContext = EditorContext{};
+
+  auto pickResult = PickResult::byDistance();
+  worldNode.pick(editorContext, ray, pickResult);
+
+  auto expectedPickResult = PickResult::byDistance();
+  for (auto* brushNode : brushNodes)
+  {
+    brushNode->pick(editorContext, ray, expectedPickResult);
+  }
+
+  const auto& expectedHits = expectedPickResult.all();
+  const auto& actualHits = pickResult.all();
+  CHECK(expectedHits.size() > 512u);
+  REQUIRE(actualHits.size() == expectedHits.size());
+  for (size_t i = 0; i < expectedHits.size(); ++i)
+  {
+    CHECK(
+      actualHits[i].target<BrushFaceHandle>()
+      == expectedHits[i].target<BrushFaceHandle>());
+    CHECK(actualHits[i].distance() == expectedHits[i].distance());
+  }
+}
+
+TEST_CASE("WorldNodeTest.findNodesIntersecting")
+{
+  constexpr auto worldBounds = vm::bbox3d{8192.0};
+  constexpr auto mapFormat = MapFormat::Quake3;
+
+  auto worldNode = WorldNode{{}, {}, mapFormat};
+  auto* groupNode = new GroupNode{Group{"group"}};
+  worldNode.defaultLayer()->addChild(groupNode);
+
+  const auto builder = BrushBuilder{mapFormat, worldBounds};
+  for (size_t i = 0; i < 64; ++i)
+  {
+    const auto min = vm::vec3{double(i % 4), double((i / 4) % 4), double(i / 16)} * 128.0;
+    const auto bounds = vm::bbox3{min, min + vm::vec3::fill(64.0)};
+    auto* brushNode = new BrushNode{builder.createCuboid(bounds, "texture").value()};
+    if (i % 2 == 0)
+    {
+      worldNode.defaultLayer()->addChild(brushNode);
+    }
+    else
+    {
+      groupNode->addChild(brushNode);
+    }
+  }
+
+  const auto findInWorld = [&](const auto& query) {
+    auto result = std::vector<Node*>{};
+    worldNode.findNodesIntersecting(query, result);
+    return kdl::vec_sort(std::move(result));
+  };
+
+  // the layer does not use the spatial index, so it visits all of its descendants
+  const auto findInLayer = [&](const auto& query) {
+    auto result = std::vector<Node*>{};
+    worldNode.defaultLayer()->findNodesIntersecting(query, result);
+    return kdl::vec_sort(std::move(result));
+  };
+
+  SECTION("bounding box")
+  {
+    const auto bounds = vm::bbox3{{100, 100, 100}, {300, 300, 300}};
+    const auto result = findInWorld(bounds);
+    CHECK(result.size() == 8u);
+    CHECK(result == findInLayer(bounds));
+
+    CHECK(findInWorld(vm::bbox3{{65, 65, 65}, {127, 127, 127}}).empty());
+  }
+
+  SECTION("planes")
+  {
+    const auto planes = std::vector<vm::plane3>{
+      {{100, 0, 0}, {-1, 0, 0}},
+      {{300, 0, 0}, {1, 0, 0}},
+      {{0, 0, 200}, {0, 0, 1}},
+    };
+    const auto result = findInWorld(planes);
+    CHECK(result.size() == 16u);
+    CHECK(result == findInLayer(planes));
+  }
+}
+
 TEST_CASE("WorldNodeTest.persistentIdOfDefaultLayer")
 {
   auto worldNode = WorldNode{{}, {}, MapFormat::Standard};
@@ -242,6 +242,31 @@ public:
   }
 };
 
+class MemoryCommand : public UndoableCommand
+{
+private:
+  size_t m_memoryUsage;
+
+public:
+  MemoryCommand(std::string name, const size_t memoryUsage)
+    : UndoableCommand{std::move(name), false}
+    , m_memoryUsage{memoryUsage}
+  {
+  }
+
+  std::unique_ptr<CommandResult> doPerformDo(MapDocumentCommandFacade*) override
+  {
+    return std::make_unique<CommandResult>(true);
+  }
+
+  std::unique_ptr<CommandResult> doPerformUndo(MapDocumentCommandFacade*) override
+  {
+    return std::make_unique<CommandResult>(true);
+  }
+
+  size_t doGetMemoryUsage() const override { return m_memoryUsage; }
+};
+
 TEST_CASE("CommandProcessorTest.doAndUndoSuccessfulCommand")
 {
   /*
@@ -818,5 +843,53 @@ TEST_CASE("CommandProcessorTest.collateTransactions")
 
   commandProcessor.undo();
 }
+
+TEST_CASE("CommandProcessorTest.memoryLimit")
+{
+  auto commandProcessor =
+    CommandProcessor{nullptr, std::chrono::milliseconds{1000}, 100u};
+
+  SECTION("Oldest commands are removed when the limit is exceeded")
+  {
+    commandProcessor.executeAndStore(std::make_unique<MemoryCommand>("cmd1", 40u));
+    commandProcessor.executeAndStore(std::make_unique<MemoryCommand>("cmd2", 40u));
+    CHECK(commandProcessor.memoryUsage() == 80u);
+
+    commandProcessor.executeAndStore(std::make_unique<MemoryCommand>("cmd3", 40u));
+    CHECK(commandProcessor.memoryUsage() == 80u);
+
+    CHECK(commandProcessor.undoCommandName() == "cmd3");
+    commandProcessor.undo();
+    CHECK(commandProcessor.undoCommandName() == "cmd2");
+    commandProcessor.undo();
+    CHECK_FALSE(commandProcessor.canUndo());
+  }
+
+  SECTION("The most recent command is kept even if it exceeds the limit")
+  {
+    commandProcessor.executeAndStore(std::make_unique<MemoryCommand>("cmd1", 40u));
+    commandProcessor.executeAndStore(std::make_unique<MemoryCommand>("cmd2", 200u));
+    CHECK(commandProcessor.memoryUsage() == 200u);
+
+    CHECK(commandProcessor.undoCommandName() == "cmd2");
+    commandProcessor.undo();
+    CHECK_FALSE(commandProcessor.canUndo());
+  }
+
+  SECTION("Transactions are limited by the memory used by their commands")
+  {
+    commandProcessor.executeAndStore(std::make_unique<MemoryCommand>("cmd1", 40u));
+
+    commandProcessor.startTransaction("transaction", TransactionScope::Oneshot);
+    commandProcessor.executeAndStore(std::make_unique<MemoryCommand>("cmd2", 40u));
+    commandProcessor.executeAndStore(std::make_unique<MemoryCommand>("cmd3", 40u));
+    commandProcessor.commitTransaction();
+
+    CHECK(commandProcessor.memoryUsage() == 80u);
+    CHECK(commandProcessor.undoCommandName() == "transaction");
+    commandProcessor.undo();
+    CHECK_FALSE(commandProcessor.canUndo());
+  }
+}
 } // namespace View
 } // namespace TrenchBroom
@@ -23,7 +23,9 @@
 #include "FloatType.h"
 #include "Model/BezierPatch.h"
 #include "Model/Brush.h"
+#include "Model/BrushFace.h"
 #include "Model/BrushNode.h"
+#include "Model/ChangeBrushFaceAttributesRequest.h"
 #include "Model/Entity.h"
 #include "Model/EntityNode.h"
 #include "Model/Group.h"
@@ -36,7 +38,9 @@
 #include "View/SwapNodeContentsCommand.h"
 
 #include <kdl/memory_utils.h>
+#include <kdl/reflection_impl.h>
 #include <kdl/result.h>
+#include <kdl/vector_utils.h>
 
 #include <vecmath/bbox.h>
 #include <vecmath/bbox_io.h>
@@ -47,7 +51,10 @@
 #include <vecmath/vec_io.h>
 
 #include <filesystem>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "Catch2.h"
 
@@ -77,6 +84,121 @@ TEST_CASE_METHOD(MapDocumentTest, "SwapNodeContentsTest.swapBrushes")
   CHECK(brushNode->brush() == originalBrush);
 }
 
+namespace
+{
+struct FaceState
+{
+  Model::BrushFace::Points points;
+  Model::BrushFaceAttributes attributes;
+  vm::vec3 textureXAxis;
+  vm::vec3 textureYAxis;
+
+  kdl_reflect_inline(FaceState, points, attributes, textureXAxis, textureYAxis);
+};
+
+struct NodeState
+{
+  std::vector<Model::EntityProperty> properties;
+  std::vector<std::string> protectedProperties;
+  std::vector<FaceState> faces;
+
+  kdl_reflect_inline(NodeState, properties, protectedProperties, faces);
+};
+
+NodeState getNodeState(const Model::EntityNode& entityNode)
+{
+  auto result = NodeState{
+    entityNode.entity().properties(), entityNode.entity().protectedProperties(), {}};
+
+  for (const auto* child : entityNode.children())
+  {
+    const auto& brush = static_cast<const Model::BrushNode*>(child)->brush();
+    for (const auto& face : brush.faces())
+    {
+      result.faces.push_back(FaceState{
+        face.points(),
+        face.attributes(),
+        face.textureXAxis(),
+        face.textureYAxis()});
+    }
+  }
+
+  return result;
+}
+} // namespace
+
+TEST_CASE_METHOD(ValveMapDocumentTest, "SwapNodeContentsTest.undoRestoresExactContents")
+{
+  // the command stores deltas instead of snapshots where possible, undo and redo must
+  // still restore the exact contents that a snapshot would restore
+  auto* brushNode = createBrushNode();
+  auto* entityNode = new Model::EntityNode{
+    {}, {{"classname", "func_door"}, {"speed", "100"}, {"target", "t1"}}};
+
+  document->addNodes({{document->parentForNodes(), {entityNode}}});
+  document->addNodes({{entityNode, {brushNode}}});
+
+  using Edit = std::function<void()>;
+  const auto edits = std::vector<Edit>{
+    [&]() { document->setProperty("speed", "200"); },
+    [&]() { document->setProperty("wait", "-1"); },
+    [&]() { document->renameProperty("target", "targetname"); },
+    [&]() { document->removeProperty("speed"); },
+    [&]() {
+      document->selectBrushFaces({{brushNode, 0u}, {brushNode, 3u}});
+      auto request = Model::ChangeBrushFaceAttributesRequest{};
+      request.setTextureName("other");
+      request.addRotation(15.0f);
+      request.addXOffset(8.0f);
+      document->setFaceAttributes(request);
+      document->deselectAll();
+      document->selectNodes({entityNode});
+    },
+    [&]() { document->translateObjects(vm::vec3{16, 8, 0}); },
+    [&]() {
+      document->rotateObjects(vm::vec3{0, 0, 0}, vm::vec3{0, 0, 1}, vm::to_radians(30.0));
+    },
+    [&]() { document->translateObjects(vm::vec3{-16, 0, 32}); },
+  };
+
+  document->selectNodes({entityNode});
+  const auto initialState = getNodeState(*entityNode);
+
+  auto states = std::vector<NodeState>{initialState};
+  for (const auto& edit : edits)
+  {
+    const auto previousState = getNodeState(*entityNode);
+    edit();
+
+    const auto newState = getNodeState(*entityNode);
+    REQUIRE(newState != previousState);
+
+    document->undoCommand();
+    CHECK(getNodeState(*entityNode) == previousState);
+
+    document->redoCommand();
+    CHECK(getNodeState(*entityNode) == newState);
+
+    states.push_back(newState);
+  }
+
+  const auto finalState = getNodeState(*entityNode);
+
+  while (document->canUndoCommand())
+  {
+    document->undoCommand();
+    CHECK(kdl::vec_contains(states, getNodeState(*entityNode)));
+  }
+  CHECK(getNodeState(*entityNode) == initialState);
+
+  while (document->canRedoCommand())
+  {
+    document->redoCommand();
+    CHECK(kdl::vec_contains(states, getNodeState(*entityNode)));
+  }
+  CHECK(getNodeState(*entityNode) == finalState);
+}
+
 TEST_CASE_METHOD(MapDocumentTest, "SwapNodeContentsTest.swapPatches")
 {
   auto* patchNode = createPatchNode();
@@ -0,0 +1,309 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/Hit.h"
+#include "Model/MapFormat.h"
+#include "Model/PickResult.h"
+#include "Model/Polyhedron.h"
+#include "PreferenceManager.h"
+#include "Preferences.h"
+#include "Renderer/OrthographicCamera.h"
+#include "Renderer/PerspectiveCamera.h"
+#include "View/Lasso.h"
+#include "View/VertexHandleManager.h"
+
+#include <kdl/result.h>
+#include <kdl/vector_utils.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/ray.h>
+#include <vecmath/segment.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace View
+{
+namespace
+{
+std::vector<std::unique_ptr<Model::BrushNode>> makeBrushes()
+{
+  const auto builder = Model::BrushBuilder{Model::MapFormat::Standard, vm::bbox3{8192.0}};
+
+  auto result = std::vector<std::unique_ptr<Model::BrushNode>>{};
+  for (size_t x = 0; x < 8; ++x)
+  {
+    for (size_t y = 0; y < 8; ++y)
+    {
+      for (size_t z = 0; z < 4; ++z)
+      {
+        // adjacent brushes share some of their vertices, edges and faces
+        const auto min =
+          vm::vec3{double(x), double(y), double(z)} * 64.0 - vm::vec3{256, 256, 128};
+        const auto max = min + vm::vec3{64.0, 64.0, double(z + 1) * 16.0};
+        result.push_back(std::make_unique<Model::BrushNode>(
+          builder.createCuboid(vm::bbox3{min, max}, "texture").value()));
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<std::unique_ptr<Renderer::Camera>> makeCameras()
+{
+  const auto viewport = Renderer::Camera::Viewport{0, 0, 1024, 768};
+
+  auto result = std::vector<std::unique_ptr<Renderer::Camera>>{};
+  result.push_back(std::make_unique<Renderer::PerspectiveCamera>(
+    90.0f,
+    1.0f,
+    65536.0f,
+    viewport,
+    vm::vec3f{-512.0f, -64.0f, 128.0f},
+    vm::normalize(vm::vec3f{1.0f, 0.1f, -0.2f}),
+    vm::vec3f{0.0f, 0.0f, 1.0f}));
+
+  auto orthographicCamera = std::make_unique<Renderer::OrthographicCamera>(
+    1.0f,
+    65536.0f,
+    viewport,
+    vm::vec3f{-512.0f, 0.0f, 0.0f},
+    vm::vec3f{1.0f, 0.0f, 0.0f},
+    vm::vec3f{0.0f, 0.0f, 1.0f});
+  orthographicCamera->setZoom(2.0f);
+  result.push_back(std::move(orthographicCamera));
+
+  return result;
+}
+
+std::vector<vm::ray3> makePickRays(const Renderer::Camera& camera)
+{
+  auto result = std::vector<vm::ray3>{};
+  for (int x = 0; x < 1024; x += 16)
+  {
+    for (int y = 0; y < 768; y += 16)
+    {
+      result.emplace_back(camera.pickRay(float(x), float(y)));
+    }
+  }
+  return result;
+}
+
+template <typename H>
+std::vector<H> hitHandles(const Model::PickResult& pickResult)
+{
+  return kdl::vec_sort(kdl::vec_transform(
+    pickResult.all(), [](const auto& hit) { return hit.template target<H>(); }));
+}
+} // namespace
+
+TEST_CASE("VertexHandleManagerTest.intersectsBounds")
+{
+  const auto bounds = vm::bbox3{{-2080, 992, -32}, {-992, 2080, 1056}};
+
+  // origin is inside of the bounds
+  CHECK(intersectsBounds(vm::ray3{{-1000, 1000, 0}, {1, 0, 0}}, bounds));
+  CHECK(intersectsBounds(vm::ray3{{-1000, 1000, 0}, {-1, 0, 0}}, bounds));
+
+  // ray enters the bounds through an edge
+  CHECK(intersectsBounds(
+    vm::ray3{{-3072, 0, 0}, vm::normalize(vm::vec3{2, 2, 1})}, bounds));
+
+  CHECK_FALSE(intersectsBounds(vm::ray3{{-3072, 0, 0}, {1, 0, 0}}, bounds));
+  CHECK_FALSE(intersectsBounds(vm::ray3{{-3072, 1000, 0}, {-1, 0, 0}}, bounds));
+}
+
+TEST_CASE("VertexHandleManagerTest.pick")
+{
+  const auto brushes = makeBrushes();
+  const auto brushNodes =
+    kdl::vec_transform(brushes, [](const auto& b) { return b.get(); });
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+
+  auto manager = VertexHandleManager{};
+  manager.addHandles(std::begin(brushNodes), std::end(brushNodes));
+
+  for (const auto& camera : makeCameras())
+  {
+    for (const auto& pickRay : makePickRays(*camera))
+    {
+      CAPTURE(pickRay);
+
+      auto pickResult = Model::PickResult{};
+      manager.pick(pickRay, *camera, pickResult);
+
+      auto expectedHandles = std::vector<vm::vec3>{};
+      for (const auto& handle : manager.allHandles())
+      {
+        if (!vm::is_nan(camera->pickPointHandle(pickRay, handle, handleRadius)))
+        {
+          expectedHandles.push_back(handle);
+        }
+      }
+
+      CHECK(hitHandles<vm::vec3>(pickResult) == expectedHandles);
+    }
+  }
+}
+
+TEST_CASE("VertexHandleManagerTest.pickEdgeCenterHandle")
+{
+  const auto brushes = makeBrushes();
+  const auto brushNodes =
+    kdl::vec_transform(brushes, [](const auto& b) { return b.get(); });
+  const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+
+  auto manager = EdgeHandleManager{};
+  manager.addHandles(std::begin(brushNodes), std::end(brushNodes));
+
+  for (const auto& camera : makeCameras())
+  {
+    for (const auto& pickRay : makePickRays(*camera))
+    {
+      CAPTURE(pickRay);
+
+      auto pickResult = Model::PickResult{};
+      manager.pickCenterHandle(pickRay, *camera, pickResult);
+
+      auto expectedHandles = std::vector<vm::segment3>{};
+      for (const auto& handle : manager.allHandles())
+      {
+        if (!vm::is_nan(
+              camera->pickPointHandle(pickRay, handle.center(), handleRadius)))
+        {
+          expectedHandles.push_back(handle);
+        }
+      }
+
+      CHECK(hitHandles<vm::segment3>(pickResult) == expectedHandles);
+    }
+  }
+}
+
+TEST_CASE("VertexHandleManagerTest.findIncidentBrushes")
+{
+  const auto brushes = makeBrushes();
+  auto brushNodes =
+    kdl::vec_transform(brushes, [](const auto& b) { return b.get(); });
+
+  auto manager = VertexHandleManager{};
+  manager.addHandles(std::begin(brushNodes), std::end(brushNodes));
+
+  const auto findIncidentBrushesByTesting = [&](const vm::vec3& handle) {
+    return kdl::vec_sort(kdl::vec_filter(brushNodes, [&](const auto* brushNode) {
+      return brushNode->brush().hasVertex(handle);
+    }));
+  };
+
+  for (const auto& handle : manager.allHandles())
+  {
+    CAPTURE(handle);
+    CHECK(
+      manager.findIncidentBrushes(handle, std::begin(brushNodes), std::end(brushNodes))
+      == findIncidentBrushesByTesting(handle));
+  }
+
+  SECTION("Only brushes in the given range are returned")
+  {
+    const auto handle = brushNodes.front()->brush().vertices().front()->position();
+    REQUIRE(findIncidentBrushesByTesting(handle).size() > 1u);
+
+    const auto range = std::vector<Model::BrushNode*>{brushNodes.front()};
+    CHECK(
+      manager.findIncidentBrushes(handle, std::begin(range), std::end(range)) == range);
+  }
+
+  SECTION("Removed brushes are not returned")
+  {
+    auto* brushNode = brushNodes.front();
+    manager.removeHandles(brushNode);
+
+    const auto handle = brushNode->brush().vertices().front()->position();
+    CHECK_FALSE(kdl::vec_contains(
+      manager.findIncidentBrushes(handle, std::begin(brushNodes), std::end(brushNodes)),
+      brushNode));
+  }
+}
+
+TEST_CASE("VertexHandleManagerTest.selectCloseHandles")
+{
+  auto manager = VertexHandleManager{};
+  manager.add(vm::vec3{1, 2, 3});
+  manager.add(vm::vec3{1, 2, 4});
+  manager.add(vm::vec3{1, 2, 3.0000001});
+
+  manager.select(vm::vec3{1, 2, 3});
+  CHECK(manager.selected(vm::vec3{1, 2, 3}));
+  CHECK(manager.selected(vm::vec3{1, 2, 3.0000001}));
+  CHECK_FALSE(manager.selected(vm::vec3{1, 2, 4}));
+  CHECK(manager.selectedHandleCount() == 2u);
+
+  manager.deselect(vm::vec3{1, 2, 3.0000001});
+  CHECK(manager.selectedHandleCount() == 0u);
+
+  CHECK(manager.remove(vm::vec3{1, 2, 3}));
+  manager.select(vm::vec3{1, 2, 3});
+  CHECK(manager.selectedHandles() == std::vector<vm::vec3>{{1, 2, 3.0000001}});
+}
+
+TEST_CASE("VertexHandleManagerTest.findCandidateHandles")
+{
+  const auto brushes = makeBrushes();
+  const auto brushNodes =
+    kdl::vec_transform(brushes, [](const auto& b) { return b.get(); });
+
+  auto manager = VertexHandleManager{};
+  manager.addHandles(std::begin(brushNodes), std::end(brushNodes));
+
+  for (const auto& camera : makeCameras())
+  {
+    const auto start = vm::vec3{camera->unproject(256.0f, 128.0f, 0.5f)};
+    const auto end = vm::vec3{camera->unproject(640.0f, 512.0f, 0.5f)};
+
+    auto lasso = Lasso{*camera, 64.0, start};
+    lasso.update(end);
+
+    const auto allHandles = manager.allHandles();
+    auto expectedHandles = std::vector<vm::vec3>{};
+    lasso.selected(
+      std::begin(allHandles), std::end(allHandles), std::back_inserter(expectedHandles));
+
+    const auto candidateHandles = manager.findCandidateHandles(lasso.boundingPlanes());
+    auto selectedHandles = std::vector<vm::vec3>{};
+    lasso.selected(
+      std::begin(candidateHandles),
+      std::end(candidateHandles),
+      std::back_inserter(selectedHandles));
+
+    CHECK(!expectedHandles.empty());
+    CHECK(selectedHandles == expectedHandles);
+    CHECK(candidateHandles.size() < allHandles.size());
+  }
+}
+} // namespace View
+} // namespace TrenchBroom
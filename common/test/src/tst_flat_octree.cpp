@@ -0,0 +1,346 @@
+/*
+ Copyright (C) 2023 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Exceptions.h"
+#include "flat_octree.h"
+#include "octree.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/plane.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Catch2.h"
+
+namespace TrenchBroom
+{
+namespace
+{
+template <typename T>
+std::vector<T> sorted(std::vector<T> v)
+{
+  std::sort(v.begin(), v.end());
+  return v;
+}
+
+class random_bounds
+{
+private:
+  std::mt19937 m_engine;
+  std::uniform_real_distribution<double> m_coord;
+  std::uniform_real_distribution<double> m_size;
+  std::uniform_real_distribution<double> m_direction;
+
+public:
+  random_bounds(const unsigned int seed, const double min_coord, const double max_coord)
+    : m_engine{seed}
+    , m_coord{min_coord, max_coord}
+    , m_size{1.0, 256.0}
+    , m_direction{-1.0, 1.0}
+  {
+  }
+
+  vm::bbox3d bounds()
+  {
+    const auto min = point();
+    return {min, min + vm::vec3d{m_size(m_engine), m_size(m_engine), m_size(m_engine)}};
+  }
+
+  vm::vec3d point()
+  {
+    return {m_coord(m_engine), m_coord(m_engine), m_coord(m_engine)};
+  }
+
+  vm::ray3d ray()
+  {
+    const auto origin = point();
+    return {
+      origin,
+      vm::normalize(
+        vm::vec3d{m_direction(m_engine), m_direction(m_engine), m_direction(m_engine)})};
+  }
+
+  template <typename T>
+  T index(const T count)
+  {
+    return std::uniform_int_distribution<T>{0, count - 1}(m_engine);
+  }
+};
+
+template <typename U>
+void checkQueriesMatch(
+  const flat_octree<double, U>& flat, const octree<double, U>& tree, random_bounds& random)
+{
+  REQUIRE(flat.empty() == tree.empty());
+
+  auto rays = std::vector<vm::ray3d>{};
+  for (size_t i = 0; i < 20; ++i)
+  {
+    rays.push_back(random.ray());
+  }
+
+  const auto flatResults = flat.find_intersectors(rays);
+  REQUIRE(flatResults.size() == rays.size());
+  for (size_t i = 0; i < rays.size(); ++i)
+  {
+    CAPTURE(rays[i]);
+    const auto expected = sorted(tree.find_intersectors(rays[i]));
+    CHECK(sorted(flat.find_intersectors(rays[i])) == expected);
+    CHECK(sorted(flatResults[i]) == expected);
+  }
+
+  for (size_t i = 0; i < 10; ++i)
+  {
+    const auto bounds = random.bounds();
+    CAPTURE(bounds);
+    CHECK(
+      sorted(flat.find_overlapping(bounds)) == sorted(tree.find_overlapping(bounds)));
+    CHECK(
+      sorted(flat.find_matching([&](const auto& nodeBounds) {
+        return nodeBounds.intersects(bounds);
+      }))
+      == sorted(tree.find_overlapping(bounds)));
+
+    const auto planes = std::vector<vm::plane3d>{
+      {bounds.min, {-1, 0, 0}},
+      {bounds.min, {0, -1, 0}},
+      {bounds.min, vm::normalize(vm::vec3d{-1, -1, -1})},
+      {bounds.max, {1, 0, 0}},
+      {bounds.max, vm::normalize(vm::vec3d{0, 1, 1})},
+    };
+    CHECK(
+      sorted(flat.find_overlapping(planes)) == sorted(tree.find_overlapping(planes)));
+
+    const auto point = random.point();
+    CAPTURE(point);
+    CHECK(sorted(flat.find_containers(point)) == sorted(tree.find_containers(point)));
+  }
+}
+} // namespace
+
+TEST_CASE("flat_octree.insert")
+{
+  auto tree = flat_octree<double, int>{32.0};
+  REQUIRE(tree.empty());
+
+  tree.insert({{32, 32, 32}, {64, 64, 64}}, 1);
+  CHECK_FALSE(tree.empty());
+  CHECK(tree.size() == 1u);
+  CHECK(tree.contains(1));
+
+  tree.insert({{-16, -16, -16}, {16, 16, 16}}, 2);
+  CHECK(tree.size() == 2u);
+  CHECK(tree.contains(2));
+
+  // the root grows
+  tree.insert({{-1000, -1000, -1000}, {-900, -900, -900}}, 3);
+  CHECK(tree.size() == 3u);
+  CHECK(tree.contains(1));
+  CHECK(tree.contains(2));
+  CHECK(tree.contains(3));
+
+  // data 2 crosses zero and therefore goes into the root node, which contains every point
+  CHECK(sorted(tree.find_containers({48, 48, 48})) == std::vector<int>{1, 2});
+  CHECK(sorted(tree.find_containers({-950, -950, -950})) == std::vector<int>{2, 3});
+  CHECK(tree.find_containers({5000, 5000, 5000}).empty());
+
+  CHECK_THROWS_AS(tree.insert({{0, 0, 0}, {1, 1, 1}}, 1), NodeTreeException);
+  CHECK_THROWS_AS(
+    tree.insert({{0, 0, 0}, {vm::nan<double>(), 1, 1}}, 4), NodeTreeException);
+  CHECK(tree.size() == 3u);
+}
+
+TEST_CASE("flat_octree.remove")
+{
+  auto tree = flat_octree<double, int>{32.0};
+
+  CHECK_FALSE(tree.remove(1));
+
+  tree.insert({{32, 32, 32}, {64, 64, 64}}, 1);
+  tree.insert({{40, 40, 40}, {50, 50, 50}}, 2);
+  tree.insert({{-16, -16, -16}, {-8, -8, -8}}, 3);
+
+  CHECK(tree.remove(2));
+  CHECK_FALSE(tree.contains(2));
+  CHECK_FALSE(tree.remove(2));
+  CHECK(tree.find_containers({48, 48, 48}) == std::vector<int>{1});
+
+  CHECK(tree.remove(1));
+  CHECK(tree.find_containers({48, 48, 48}).empty());
+  CHECK(tree.find_containers({-12, -12, -12}) == std::vector<int>{3});
+
+  CHECK(tree.remove(3));
+  CHECK(tree.empty());
+  CHECK(tree.size() == 0u);
+
+  // the tree is usable after it became empty
+  tree.insert({{32, 32, 32}, {64, 64, 64}}, 1);
+  CHECK(tree.find_containers({48, 48, 48}) == std::vector<int>{1});
+}
+
+TEST_CASE("flat_octree.update")
+{
+  auto tree = flat_octree<double, int>{32.0};
+
+  CHECK_THROWS_AS(tree.update({{0, 0, 0}, {1, 1, 1}}, 1), NodeTreeException);
+
+  tree.insert({{32, 32, 32}, {64, 64, 64}}, 1);
+
+  // the node address doesn't change
+  tree.update({{33, 33, 33}, {63, 63, 63}}, 1);
+  CHECK(tree.find_containers({48, 48, 48}) == std::vector<int>{1});
+
+  tree.update({{-64, -64, -64}, {-32, -32, -32}}, 1);
+  CHECK(tree.find_containers({48, 48, 48}).empty());
+  CHECK(tree.find_containers({-48, -48, -48}) == std::vector<int>{1});
+  CHECK(tree.size() == 1u);
+}
+
+TEST_CASE("flat_octree.build")
+{
+  auto tree = flat_octree<double, int>{32.0};
+
+  SECTION("empty")
+  {
+    tree.insert({{32, 32, 32}, {64, 64, 64}}, 1);
+    tree.build({});
+    CHECK(tree.empty());
+    CHECK_FALSE(tree.contains(1));
+  }
+
+  SECTION("invalid bounds")
+  {
+    CHECK_THROWS_AS(
+      tree.build({
+        {{{0, 0, 0}, {1, 1, 1}}, 1},
+        {{{0, 0, 0}, {vm::nan<double>(), 1, 1}}, 2},
+      }),
+      NodeTreeException);
+    CHECK(tree.empty());
+  }
+
+  SECTION("duplicate data")
+  {
+    CHECK_THROWS_AS(
+      tree.build({
+        {{{0, 0, 0}, {1, 1, 1}}, 1},
+        {{{64, 64, 64}, {65, 65, 65}}, 1},
+      }),
+      NodeTreeException);
+    CHECK(tree.empty());
+    CHECK_FALSE(tree.contains(1));
+  }
+
+  SECTION("matches incremental insertion")
+  {
+    auto random = random_bounds{3, -2048.0, 2048.0};
+    auto items = std::vector<std::pair<vm::bbox3d, int>>{};
+    auto expected = octree<double, int>{32.0};
+    for (int i = 0; i < 1000; ++i)
+    {
+      items.emplace_back(random.bounds(), i);
+      expected.insert(items.back().first, i);
+    }
+
+    tree.build(items);
+    CHECK(tree.size() == items.size());
+    for (const auto& [bounds, data] : items)
+    {
+      CHECK(tree.contains(data));
+    }
+
+    checkQueriesMatch(tree, expected, random);
+
+    // the tree can be edited after building it
+    for (int i = 0; i < 100; ++i)
+    {
+      CHECK(tree.remove(i));
+      CHECK(expected.remove(i));
+    }
+    for (int i = 100; i < 200; ++i)
+    {
+      const auto bounds = random.bounds();
+      tree.update(bounds, i);
+      expected.update(bounds, i);
+    }
+    for (int i = 1000; i < 1100; ++i)
+    {
+      const auto bounds = random.bounds();
+      tree.insert(bounds, i);
+      expected.insert(bounds, i);
+    }
+
+    checkQueriesMatch(tree, expected, random);
+  }
+}
+
+TEST_CASE("flat_octree.matches_octree")
+{
+  auto random = random_bounds{4, -4096.0, 4096.0};
+
+  auto flat = flat_octree<double, size_t>{64.0};
+  auto tree = octree<double, size_t>{64.0};
+  auto present = std::vector<size_t>{};
+  auto next = size_t(0);
+
+  for (size_t round = 0; round < 10; ++round)
+  {
+    for (size_t i = 0; i < 300; ++i)
+    {
+      const auto bounds = random.bounds();
+      flat.insert(bounds, next);
+      tree.insert(bounds, next);
+      present.push_back(next++);
+    }
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+      const auto data = present[random.index(present.size())];
+      const auto bounds = random.bounds();
+      flat.update(bounds, data);
+      tree.update(bounds, data);
+    }
+
+    for (size_t i = 0; i < 150; ++i)
+    {
+      const auto j = random.index(present.size());
+      CHECK(flat.remove(present[j]));
+      CHECK(tree.remove(present[j]));
+      present.erase(present.begin() + std::ptrdiff_t(j));
+    }
+
+    CHECK(flat.size() == present.size());
+    checkQueriesMatch(flat, tree, random);
+  }
+
+  while (!present.empty())
+  {
+    CHECK(flat.remove(present.back()));
+    CHECK(tree.remove(present.back()));
+    present.pop_back();
+  }
+  CHECK(flat.empty());
+}
+} // namespace TrenchBroom
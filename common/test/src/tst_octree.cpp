@@ -23,9 +23,14 @@
 
 #include <vecmath/bbox.h>
 #include <vecmath/forward.h>
+#include <vecmath/plane.h>
 #include <vecmath/ray.h>
 #include <vecmath/vec.h>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "Catch2.h"
 
 namespace TrenchBroom
@@ -615,6 +620,144 @@ TEST_CASE("octree.find_intersectors")
   }
 }
 
+TEST_CASE("octree.find_intersectors_with_multiple_rays")
+{
+  auto tree = octree<double, int>{32.0};
+
+  SECTION("empty tree")
+  {
+    CHECK(
+      tree.find_intersectors(std::vector<vm::ray3d>{{{0, 0, 0}, {1, 0, 0}}})
+      == std::vector<std::vector<int>>{{}});
+  }
+
+  SECTION("no rays")
+  {
+    tree.insert({{32, 32, 32}, {64, 64, 64}}, 1);
+    CHECK(tree.find_intersectors(std::vector<vm::ray3d>{}).empty());
+  }
+
+  SECTION("many nodes")
+  {
+    auto engine = std::mt19937{1};
+    auto coord = std::uniform_real_distribution<double>{-1024.0, 1024.0};
+    auto size = std::uniform_real_distribution<double>{1.0, 256.0};
+    auto direction = std::uniform_real_distribution<double>{-1.0, 1.0};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+      const auto min = vm::vec3d{coord(engine), coord(engine), coord(engine)};
+      const auto max = min + vm::vec3d{size(engine), size(engine), size(engine)};
+      tree.insert({min, max}, i);
+    }
+
+    auto rays = std::vector<vm::ray3d>{};
+    for (int i = 0; i < 100; ++i)
+    {
+      const auto origin = vm::vec3d{coord(engine), coord(engine), coord(engine)};
+      const auto dir =
+        vm::normalize(vm::vec3d{direction(engine), direction(engine), direction(engine)});
+      rays.emplace_back(origin, dir);
+    }
+
+    const auto result = tree.find_intersectors(rays);
+    REQUIRE(result.size() == rays.size());
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+      CHECK(result[i] == tree.find_intersectors(rays[i]));
+    }
+  }
+}
+
+TEST_CASE("octree.find_overlapping")
+{
+  auto tree = octree<double, int>{32.0};
+
+  SECTION("empty tree")
+  {
+    CHECK(tree.find_overlapping(vm::bbox3d{{0, 0, 0}, {1, 1, 1}}).empty());
+    CHECK(tree.find_overlapping(std::vector<vm::plane3d>{}).empty());
+  }
+
+  SECTION("single node")
+  {
+    tree.insert({{32, 32, 32}, {64, 64, 64}}, 1);
+
+    // the leaf that contains the data does not intersect the box
+    CHECK(tree.find_overlapping(vm::bbox3d{{0, 0, 0}, {16, 16, 16}}).empty());
+
+    // the leaf that contains the data intersects the box
+    CHECK(
+      tree.find_overlapping(vm::bbox3d{{0, 0, 0}, {40, 40, 40}}) == std::vector<int>{1});
+
+    // the leaf that contains the data touches the box
+    CHECK(
+      tree.find_overlapping(vm::bbox3d{{0, 0, 0}, {32, 32, 32}}) == std::vector<int>{1});
+
+    // the leaf that contains the data is above one of the planes
+    CHECK(tree
+            .find_overlapping(std::vector<vm::plane3d>{
+              {{16, 0, 0}, {1, 0, 0}},
+              {{0, 0, 0}, {0, 1, 0}},
+            })
+            .empty());
+
+    // the leaf that contains the data is below all planes
+    CHECK(
+      tree.find_overlapping(std::vector<vm::plane3d>{
+        {{128, 0, 0}, {1, 0, 0}},
+        {{0, 128, 0}, {0, 1, 0}},
+      })
+      == std::vector<int>{1});
+
+    // the leaf that contains the data is cut by a plane
+    CHECK(
+      tree.find_overlapping(std::vector<vm::plane3d>{
+        {{48, 48, 48}, vm::normalize(vm::vec3d{1, 1, 1})},
+      })
+      == std::vector<int>{1});
+  }
+
+  SECTION("many nodes")
+  {
+    auto engine = std::mt19937{2};
+    auto coord = std::uniform_real_distribution<double>{-1024.0, 1024.0};
+    auto size = std::uniform_real_distribution<double>{1.0, 256.0};
+
+    auto bounds = std::vector<vm::bbox3d>{};
+    for (int i = 0; i < 1000; ++i)
+    {
+      const auto min = vm::vec3d{coord(engine), coord(engine), coord(engine)};
+      const auto max = min + vm::vec3d{size(engine), size(engine), size(engine)};
+      bounds.emplace_back(min, max);
+      tree.insert(bounds.back(), i);
+    }
+
+    const auto query = vm::bbox3d{{-200, -300, -100}, {100, 200, 300}};
+    const auto result = tree.find_overlapping(query);
+
+    // every item whose bounds intersect the query must be found
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+      if (bounds[i].intersects(query))
+      {
+        CHECK(std::find(result.begin(), result.end(), int(i)) != result.end());
+      }
+    }
+
+    // the box and the volume bounded by its face planes must yield the same result
+    const auto planes = std::vector<vm::plane3d>{
+      {query.min, {-1, 0, 0}},
+      {query.min, {0, -1, 0}},
+      {query.min, {0, 0, -1}},
+      {query.max, {1, 0, 0}},
+      {query.max, {0, 1, 0}},
+      {query.max, {0, 0, 1}},
+    };
+    CHECK(tree.find_overlapping(planes) == result);
+  }
+}
+
 TEST_CASE("octree.find_containers")
 {
   auto tree = octree<double, int>{32.0};
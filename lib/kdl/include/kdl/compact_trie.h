@@ -21,15 +21,16 @@
 #pragma once
 
 #include <kdl/string_compare.h>
-#include <kdl/string_format.h>
-#include <kdl/vector_utils.h>
 
+#include <algorithm>
 #include <cassert>
-#include <exception>
-#include <set>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace kdl
@@ -39,12 +40,12 @@ namespace kdl
  * regular std::map. Another difference is that values can be stored multiple times in
  * each node.
  *
- * A trie is implemented as a search tree with ordered nodes. Each node in the trie is
- * associated with a string key, and it stores all of the values which were inserted with
- * that key. However, a node `n` only stores a suffix of the key it is associated with,
- * and the full key can be restored by concatenating all partial keys stored at the nodes
- * on the path from the root to node `n` itself. This implies that the keys of all of the
- * children of node `n` contain `n`'s key as their prefix.
+ * A trie is implemented as a compressed radix tree. Each node in the trie is associated
+ * with a string key, and it stores all of the values which were inserted with that key.
+ * However, a node `n` only stores a suffix of the key it is associated with, and the full
+ * key can be restored by concatenating all partial keys stored at the nodes on the path
+ * from the root to node `n` itself. This implies that the keys of all of the children of
+ * node `n` contain `n`'s key as their prefix.
  *
  * Consider an example of a trie where the following keys and values have been inserted:
  * - key: "key",     value: "value"
@@ -64,798 +65,718 @@ namespace kdl
  * - { key: "test, values: { "test value" } }
  *   - { key: "ing, values: { "testing testing" } }
  *
+ * All nodes are stored in a single vector and refer to each other by index. The children
+ * of a node are stored in a sorted vector of (first character, index) pairs, so that
+ * finding a child only touches a single contiguous block of memory. Removed nodes are
+ * recycled by later insertions.
+ *
+ * Exact queries, prefix queries (patterns that end in a single `*`) and numbered queries
+ * (patterns that end in `%*`) do not allocate any memory. Other patterns fall back to a
+ * general matcher.
+ *
  * @tparam V the type of the values associated with each node
  */
 template <typename V>
 class compact_trie
 {
 private:
-  struct node_cmp;
-  class node;
+  using node_index = std::uint32_t;
+  static constexpr auto root_index = node_index(0);
+
+  struct child
+  {
+    unsigned char first;
+    node_index index;
+  };
+
+  struct node
+  {
+    /**
+     * The partial key of this node.
+     */
+    std::string key;
 
+    /**
+     * The children of this node, ordered by the first character of their keys.
+     */
+    std::vector<child> children;
+
+    /**
+     * Every value stored in this node, and the number of times it was stored.
+     */
+    std::vector<std::pair<V, std::size_t>> values;
+
+    node_index parent = root_index;
+  };
+
+  std::vector<node> m_nodes;
+  std::vector<node_index> m_free_nodes;
+
+public:
   /**
-   * To avoid matching the same node multiple times using different partial patterns, we
-   * store tsome state for each node that is encountered during matching. For each node,
-   * we remember its parent node, whether or not the node was previously matched by a
-   * partial pattern, and whether or not all children of the node are already fully
-   * matched.
+   * Creates a new empty trie.
+   */
+  compact_trie()
+    : m_nodes(1u)
+  {
+  }
+
+  /**
+   * Inserts the given value under the given key.
    *
-   * A node is fully matched if the node itself was matched and each of its children is
-   * fully matched.
+   * @param key the key to insert
+   * @param value the value to insert
    */
-  class match_state
+  void insert(std::string_view key, const V& value)
   {
-  private:
-    struct node_match_state
+    auto n = root_index;
+    while (!key.empty())
     {
-      /**
-       * The parent of a node.
-       */
-      const node* parent;
-
-      /**
-       * Indicates whether a node was matched by a pattern.
-       */
-      bool node_matched;
-
-      /**
-       * The number of fully matched children.
-       */
-      std::size_t fully_matched_children;
-
-    public:
-      /**
-       * Creates a new state with the given parent. `node_matched` is initialized to
-       * `false` and `fully_matched_children` to 0.
-       *
-       * @param i_parent the parent, can be null
-       */
-      explicit node_match_state(const node* i_parent)
-        : parent(i_parent)
-        , node_matched(false)
-        , fully_matched_children(0u)
+      const auto c = find_child(n, key[0]);
+      if (c == root_index)
       {
+        const auto new_node = create_node(std::string{key}, n);
+        add_child(n, new_node);
+        n = new_node;
+        break;
       }
-    };
 
-    std::unordered_map<const node*, node_match_state> m_state;
+      const auto mismatch = kdl::cs::str_mismatch(key, m_nodes[c].key);
+      assert(mismatch > 0u);
 
-  public:
-    /**
-     * Inserts a match state for the given node and its parent.
-     *
-     * @param n the node, must not be null
-     * @param parent the parent, may be null
-     */
-    void insert(const node* n, const node* parent)
-    {
-      assert(n != nullptr);
-      m_state.try_emplace(n, parent);
+      if (mismatch < m_nodes[c].key.size())
+      {
+        split_node(c, mismatch);
+      }
+
+      key = key.substr(mismatch);
+      n = c;
     }
 
-    /**
-     * Indicates whether the given node is fully matched.
-     *
-     * Precondition: the node must have an associated state (insert was previously called
-     * for the node)
-     *
-     * @param n the node to check
-     * @return true if the given node is fully matched and false otherwise
-     */
-    bool is_fully_matched(const node* n)
+    insert_value(n, value);
+  }
+
+  /**
+   * Builds this trie from the given key value pairs, replacing its previous contents.
+   *
+   * This is faster than inserting every pair on its own, especially if the given pairs
+   * are already sorted by their keys. Unsorted pairs are sorted first.
+   *
+   * @param entries the key value pairs to insert
+   */
+  void build(std::vector<std::pair<std::string, V>> entries)
+  {
+    const auto by_key = [](const auto& lhs, const auto& rhs) {
+      return lhs.first < rhs.first;
+    };
+    if (!std::is_sorted(std::begin(entries), std::end(entries), by_key))
     {
-      auto it = m_state.find(n);
-      assert(it != std::end(m_state));
-      const auto& state = it->second;
-      return state.node_matched && state.fully_matched_children == n->m_children.size();
+      std::stable_sort(std::begin(entries), std::end(entries), by_key);
     }
 
-    /**
-     * Sets the given node to be fully matched. Note that none of the node's descendents
-     * are set to be fully matched, but this is not necessary as the match algorithm will
-     * not traverse into the given node's subtree anymore.
-     *
-     * Precondition: the node must have an associated state (insert was previously called
-     * for the node)
-     *
-     * @param n the node to set to fully matched
-     */
-    void set_fully_matched(const node* n)
-    {
-      auto it = m_state.find(n);
-      assert(it != std::end(m_state));
+    clear();
+    m_nodes.reserve(2u * entries.size() + 1u);
 
-      auto& state = it->second;
-      state.node_matched = true;
-      state.fully_matched_children = n->m_children.size();
-      update_parent_states(state.parent);
+    auto it = std::begin(entries);
+    while (it != std::end(entries) && it->first.empty())
+    {
+      insert_value(root_index, it->second);
+      ++it;
     }
+    build_subtree(root_index, it, std::end(entries), 0u);
+  }
 
-    /**
-     * Sets the given node to be matched if it isn't already. If the given node is already
-     * matched, then the function immediately returns `false`. Otherwise, the given node's
-     * state is set to matched, and if the node is now fully matched, its parents are
-     * updated recursively in case they are now fully matched. In this case, the function
-     * returns `true`.
-     *
-     * Precondition: the node must have an associated state (insert was previously called
-     * for the node)
-     *
-     * @param n the node to set to matched
-     * @return `false` if the given node is already matched, and `true` otherwise
-     */
-    bool set_matched(const node* n)
+  /**
+   * Removes the given value using the given key.
+   *
+   * @param key the key to remove
+   * @param value the value to remove
+   * @return `true` if the given value was found under the given key, and `false`
+   * otherwise
+   */
+  bool remove(std::string_view key, const V& value)
+  {
+    auto n = root_index;
+    while (!key.empty())
     {
-      auto it = m_state.find(n);
-      assert(it != std::end(m_state));
-
-      auto& state = it->second;
-      if (state.node_matched)
+      n = find_child(n, key[0]);
+      if (n == root_index)
       {
         return false;
       }
 
-      state.node_matched = true;
-      if (state.fully_matched_children == n->m_children.size())
+      const auto& node_key = m_nodes[n].key;
+      if (key.substr(0u, node_key.size()) != node_key)
       {
-        // update the subtree match counts of all nodes on the path to the given node
-        update_parent_states(state.parent);
+        return false;
       }
+      key = key.substr(node_key.size());
+    }
 
-      return true;
+    if (!remove_value(n, value))
+    {
+      return false;
     }
 
-  private:
-    void update_parent_states(const node* n)
+    compact_node(n);
+    return true;
+  }
+
+  /**
+   * Clears this trie.
+   */
+  void clear()
+  {
+    m_nodes.clear();
+    m_nodes.emplace_back();
+    m_free_nodes.clear();
+  }
+
+  /**
+   * Finds all values whose keys match the given glob pattern. See `kdl::str_matches_glob`
+   * for the definition and semantics of glob patterns and adds the values to the given
+   * output iterator.
+   *
+   * @tparam O the type of the output iterator
+   * @param pattern the pattern to match
+   * @param out the output iterator
+   *
+   * @throws std::invalid_argument if the given pattern contains an invalid escape
+   * sequence
+   */
+  template <typename O>
+  void find_matches(const std::string_view pattern, O out) const
+  {
+    // consume the leading characters of the pattern that have no special meaning, they
+    // can only match a single path in the trie
+    auto n = root_index;
+    auto k_i = std::size_t(0);
+    auto p_i = std::size_t(0);
+    while (p_i < pattern.size() && !is_special(pattern[p_i]))
     {
-      while (n != nullptr)
+      if (k_i == m_nodes[n].key.size())
       {
-        auto it = m_state.find(n);
-        assert(it != std::end(m_state));
-
-        auto& state = it->second;
-        state.fully_matched_children += 1u;
-        if (!state.node_matched || state.fully_matched_children < n->m_children.size())
+        n = find_child(n, pattern[p_i]);
+        if (n == root_index)
         {
-          // parent is not fully matched, so it cannot contribute to its parents' subtree
-          // match count yet
-          break;
+          return;
         }
+        k_i = 0u;
+      }
+      if (m_nodes[n].key[k_i] != pattern[p_i])
+      {
+        return;
+      }
+      ++k_i;
+      ++p_i;
+    }
 
-        n = it->second.parent;
+    const auto remainder = pattern.substr(p_i);
+    if (remainder.empty())
+    {
+      if (k_i == m_nodes[n].key.size())
+      {
+        get_values(n, out);
       }
     }
-  };
+    else if (remainder == "*")
+    {
+      visit_subtree(n, [&](const node_index i) {
+        get_values(i, out);
+        return true;
+      });
+    }
+    else if (remainder == "%*")
+    {
+      // every node whose remaining key consists of digits matches, but its descendants
+      // can only match if it does
+      visit_subtree(n, [&](const node_index i) {
+        const auto key = std::string_view{m_nodes[i].key}.substr(i == n ? k_i : 0u);
+        if (!std::all_of(std::begin(key), std::end(key), is_digit))
+        {
+          return false;
+        }
+        get_values(i, out);
+        return true;
+      });
+    }
+    else
+    {
+      find_matches(pattern, n, k_i, p_i, out);
+    }
+  }
 
   /**
-   * A trie node. Children are stored in a set ordered by `node_cmp`. Each node can store
-   * a given value multiple times.
-   *
-   * A trie node has only const methods and therefore appears to be immutable, but this is
-   * not the case. All of its members are actually declared as mutable and may be modified
-   * by the `insert` or `remove` member functions. The reason for this peculiar design
-   * choice is that trie nodes are stored by value in a `std::set`, and `std::set` does
-   * not allow its contents to be modified, since that might affect the position of the
-   * value in the set.
-   *
-   * But in this particular case, the position of a node in the containing set depends
-   * only on the node's key, and the node's key is changed only in ways that does not
-   * affect its position. The key can only become shorter or longer, that is, key "abc"
-   * might be changed to "ab" or "abcd", and neither of these changes affects how the key
-   * compares to other keys due to the order introduce by `node_cmp`, which consideres two
-   * keys equivalent if they share a non-empty prefix.
-   *
-   * This implies that the following two conditions hold for a node with key "abc":
-   * - There is no sibling node with a key that is a prefix of "abc".
-   * - There is no sibling node with a key that that has "abc" as a prefix.
+   * Adds the keys of all nodes in this trie to the give output iterator.
    *
-   * Therefore, shortening or extending a node's key does not affect its position in the
-   * containing set, and we can update a node's key without violating any invariants of
-   * the containing set.
+   * @tparam O the type of the output iterator
+   * @param out the output iterator
    */
-  class node
+  template <typename O>
+  void get_keys(O out) const
   {
-  private:
-    friend struct node_cmp;
-    friend class match_state;
+    auto key = std::string{};
+    get_keys(root_index, key, out);
+  }
 
-    using value_container = std::unordered_map<V, std::size_t>;
-    using node_set = std::set<node, node_cmp>;
+private:
+  static bool is_special(const char c)
+  {
+    return c == '*' || c == '?' || c == '%' || c == '\\';
+  }
 
-    /**
-     * The partical key of this node.
-     */
-    mutable std::string m_key;
+  static bool is_digit(const char c) { return c >= '0' && c <= '9'; }
 
-    /**
-     * Maps a value to the number of times it was stored in this node.
-     */
-    mutable value_container m_values;
+  node_index create_node(std::string key, const node_index parent)
+  {
+    auto result = node_index(m_nodes.size());
+    if (!m_free_nodes.empty())
+    {
+      result = m_free_nodes.back();
+      m_free_nodes.pop_back();
+    }
+    else
+    {
+      m_nodes.emplace_back();
+    }
 
-    /**
-     * The children of this node.
-     */
-    mutable node_set m_children;
+    auto& n = m_nodes[result];
+    n.key = std::move(key);
+    n.parent = parent;
+    return result;
+  }
 
-  public:
-    /**
-     * Creates a new node with the given key.
-     *
-     * @param key the key
-     */
-    explicit node(std::string key)
-      : m_key(std::move(key))
+  void release_node(const node_index n)
+  {
+    m_nodes[n] = node{};
+    m_free_nodes.push_back(n);
+  }
+
+  auto find_child_position(const node_index n, const char c) const
+  {
+    const auto& children = m_nodes[n].children;
+    return std::lower_bound(
+      std::begin(children),
+      std::end(children),
+      static_cast<unsigned char>(c),
+      [](const child& lhs, const unsigned char rhs) { return lhs.first < rhs; });
+  }
+
+  /**
+   * Returns the index of the child of the given node whose key starts with the given
+   * character, or the root index if no such child exists.
+   */
+  node_index find_child(const node_index n, const char c) const
+  {
+    const auto it = find_child_position(n, c);
+    const auto found = it != std::end(m_nodes[n].children)
+                       && it->first == static_cast<unsigned char>(c);
+    return found ? it->index : root_index;
+  }
+
+  void add_child(const node_index n, const node_index c)
+  {
+    const auto first = m_nodes[c].key[0];
+    const auto it = find_child_position(n, first);
+    assert(
+      it == std::end(m_nodes[n].children)
+      || it->first != static_cast<unsigned char>(first));
+    m_nodes[n].children.insert(it, child{static_cast<unsigned char>(first), c});
+  }
+
+  void remove_child(const node_index n, const node_index c)
+  {
+    auto& children = m_nodes[n].children;
+    const auto it = find_child_position(n, m_nodes[c].key[0]);
+    assert(it != std::end(children) && it->index == c);
+    children.erase(it);
+  }
+
+  void set_parent_of_children(const node_index n)
+  {
+    for (const auto& c : m_nodes[n].children)
     {
+      m_nodes[c.index].parent = n;
     }
+  }
 
-    /**
-     * Inserts the given value into this node's subtree. If this node's key is empty, then
-     * it is the root node.
-     *
-     * Precondition: Unless this node is the root node, the given key must share a
-     * non-empty prefix with this node's key.
-     *
-     * @param key the key to insert
-     * @param value the value to insert
-     */
-    void insert(const std::string_view key, const V& value) const
+  template <typename C>
+  static auto find_value(C& values, const V& value)
+  {
+    return std::find_if(std::begin(values), std::end(values), [&](const auto& v) {
+      return v.first == value;
+    });
+  }
+
+  void insert_value(const node_index n, const V& value)
+  {
+    auto& values = m_nodes[n].values;
+    const auto it = find_value(values, value);
+    if (it != std::end(values))
+    {
+      ++it->second;
+    }
+    else
+    {
+      values.emplace_back(value, 1u);
+    }
+  }
+
+  bool remove_value(const node_index n, const V& value)
+  {
+    auto& values = m_nodes[n].values;
+    const auto it = find_value(values, value);
+    if (it == std::end(values))
     {
-      /*
-       Possible cases for insertion:
-        index: 01234567 |   | #m_key: 6
-        m_key: target   | ^ | #key | conditions              | todo
-       =================|===|======|=========================|======
-        case:  key:     |   |      |                         |
-           0:  blah     | 0 | 4    | ^ = 0                   | this is the root node, find
-       or create child 'blah' and insert there; ^        |   |      | | 1:  targetli | 6 |
-       8    | ^ < #key AND ^ = #m_key | try insert in all children, if none match, create
-       child 'li' and insert there; ^  |   |      |                         | 2:  tarus |
-       3 | 5    | ^ < #key AND ^ < #m_key | split this node in 'tar' and 'get'; create
-       child 'us' and insert there; ^     |   |      |                         | 3:  tar
-       | 3 | 3    | ^ = #key AND ^ < #m_key | split this node in 'tar' and 'get'; insert
-       here; return true; ^     |   |      | | 4:  target   | 6 | 6    | ^ = #key AND ^ =
-       #m_key | insert here; return true; ^  |   |      |                         |
-       ==================================================================================
-        ^ indicates where key and m_key first differ
-       */
-
-      // find the index of the first character where the given key and this node's key
-      // differ
-      const std::size_t mismatch = kdl::cs::str_mismatch(key, m_key);
-      assert(mismatch > 0u || m_key.empty());
-
-      if (mismatch < key.size())
+      return false;
+    }
+
+    if (--it->second == 0u)
+    {
+      *it = std::move(values.back());
+      values.pop_back();
+    }
+    return true;
+  }
+
+  /**
+   * Splits the given node into two nodes at the given index of its key. For example,
+   * given a node n with key "abcd" and index 2, the following will happen:
+   * - n's key will be shortened to "ab"
+   * - a new node c will be created with key "cd"
+   * - all of n's children and values will be moved to c
+   * - c will become the only child of n
+   *
+   * Precondition: the index is chosen in such a way that neither of the resulting keys
+   * is empty.
+   */
+  void split_node(const node_index n, const std::size_t index)
+  {
+    assert(index > 0u && index < m_nodes[n].key.size());
+
+    const auto c = create_node(m_nodes[n].key.substr(index), n);
+    auto& parent = m_nodes[n];
+    auto& new_child = m_nodes[c];
+
+    new_child.children = std::move(parent.children);
+    new_child.values = std::move(parent.values);
+    parent.key.resize(index);
+    parent.children = {child{static_cast<unsigned char>(new_child.key[0]), c}};
+    parent.values.clear();
+
+    set_parent_of_children(c);
+  }
+
+  /**
+   * Removes the given node if it has become empty, and merges nodes that have no values
+   * and only a single child with that child, walking up the trie.
+   */
+  void compact_node(node_index n)
+  {
+    while (n != root_index && m_nodes[n].values.empty())
+    {
+      if (m_nodes[n].children.empty())
       {
-        // cases 0, 1, 2: key and m_key have a common prefix, or m_key is a prefix of key
-        if (mismatch == m_key.size())
-        {
-          // case 0, 1: m_key is a prefix of key, find or create a child that has a common
-          // prefix with the remainder of key and insert there
-          const auto remainder = key.substr(mismatch);
-          const auto& child = *m_children.insert(node(std::string(remainder))).first;
-          child.insert(remainder, value);
-        }
-        else
-        { // mismatch == m_key.size()
-          // case 2: key and m_key have a common prefix, split this node and insert again
-          split_node(mismatch);
-          insert(key, value);
-        }
+        const auto parent = m_nodes[n].parent;
+        remove_child(parent, n);
+        release_node(n);
+        n = parent;
       }
-      else if (mismatch == key.size())
+      else
       {
-        // cases 3, 4: key is a prefix of m_key, or key == m_key
-        if (mismatch < m_key.size())
+        if (m_nodes[n].children.size() == 1u)
         {
-          // case 3: key is a prefix of m_key, split this node
-          split_node(mismatch);
+          merge_node(n);
         }
-        insert_value(value);
+        break;
       }
     }
+  }
 
-    /**
-     * Removes the given value from this node's subtree.
-     *
-     * @param key the key to remove
-     * @param value the value to remove
-     * @return true if the given key and value were removed from this node's subtree
-     */
-    bool remove(const std::string_view key, const V& value) const
+  /**
+   * Merges the given node with its only child. Thereby, the child's key is appended to
+   * the node's key, the child's children and values are moved to the node, and the child
+   * is removed.
+   *
+   * Precondition: the node has only one child, and it has no values of its own.
+   */
+  void merge_node(const node_index n)
+  {
+    assert(m_nodes[n].children.size() == 1u);
+    assert(m_nodes[n].values.empty());
+
+    const auto c = m_nodes[n].children.front().index;
+    auto& parent = m_nodes[n];
+    auto& old_child = m_nodes[c];
+
+    parent.key += old_child.key;
+    parent.children = std::move(old_child.children);
+    parent.values = std::move(old_child.values);
+    release_node(c);
+
+    set_parent_of_children(n);
+  }
+
+  /**
+   * Creates the children of the given node from the given range of sorted entries. Each
+   * of the entries' keys must be longer than the given depth and share the node's full
+   * key as their prefix.
+   */
+  template <typename I>
+  void build_subtree(const node_index n, I begin, const I end, const std::size_t depth)
+  {
+    while (begin != end)
     {
-      bool result = false;
+      const auto first = begin->first[depth];
+      const auto group_end = std::find_if(
+        begin, end, [&](const auto& entry) { return entry.first[depth] != first; });
+      const auto& last_key = std::prev(group_end)->first;
+
+      // the keys are sorted, so the first and the last key of the group share the
+      // longest common prefix of the group
+      const auto prefix_length =
+        depth
+        + kdl::cs::str_mismatch(
+          std::string_view{begin->first}.substr(depth),
+          std::string_view{last_key}.substr(depth));
+
+      const auto c =
+        create_node(begin->first.substr(depth, prefix_length - depth), n);
+      m_nodes[n].children.push_back(child{static_cast<unsigned char>(first), c});
+
+      while (begin != group_end && begin->first.size() == prefix_length)
+      {
+        insert_value(c, begin->second);
+        ++begin;
+      }
+      build_subtree(c, begin, group_end, prefix_length);
+      begin = group_end;
+    }
+  }
 
-      const std::size_t mismatch = kdl::cs::str_mismatch(key, m_key);
-      if (m_key.size() <= key.length() && mismatch == m_key.length())
+  /**
+   * Visits the given node and its descendants in depth first order. The given function
+   * is called for every visited node, and the children of a node are only visited if it
+   * returns `true`.
+   */
+  template <typename F>
+  void visit_subtree(const node_index n, const F& f) const
+  {
+    if (f(n))
+    {
+      for (const auto& c : m_nodes[n].children)
       {
-        // m_key is a prefix of key or m_key == key
-        if (mismatch < key.length())
-        {
-          // m_key is a true prefix of key, continue at the corresponding child node
-          const auto remainder = key.substr(mismatch);
-          const auto it = m_children.find(remainder);
-          assert(it != std::end(m_children));
+        visit_subtree(c.index, f);
+      }
+    }
+  }
 
-          result = it->remove(remainder, value);
-          if (!it->m_key.empty() && it->m_values.empty() && it->m_children.empty())
-          {
-            m_children.erase(it);
-          }
-        }
-        else
-        {
-          // m_key == key
-          result = remove_value(value);
-        }
+  /**
+   * Finds every node whose key matches a pattern starting at the given node, and adds
+   * their values to the given output iterator.
+   *
+   * The matcher explores states consisting of a node, a position in that node's partial
+   * key and a position in the pattern. Wildcards in the pattern can lead to a node being
+   * entered with the same pattern position or being matched in several ways, so these
+   * entries are recorded, and the values of each matched node are only added once.
+   */
+  template <typename O>
+  void find_matches(
+    const std::string_view pattern,
+    const node_index start,
+    const std::size_t start_k_i,
+    const std::size_t start_p_i,
+    O out) const
+  {
+    using match_task = std::tuple<node_index, std::size_t, std::size_t>;
 
-        if (!m_key.empty() && m_values.empty() && m_children.size() == 1u)
+    auto entered = std::unordered_set<std::uint64_t>{};
+    auto matched = std::vector<node_index>{};
+    auto match_tasks = std::vector<match_task>{{start, start_k_i, start_p_i}};
+
+    const auto push_children = [&](const node_index n, const std::size_t p_i) {
+      for (const auto& c : m_nodes[n].children)
+      {
+        match_tasks.emplace_back(c.index, 0u, p_i);
+      }
+    };
+
+    const auto push_child = [&](const node_index n, const char c, const std::size_t p_i) {
+      const auto i = find_child(n, c);
+      if (i != root_index)
+      {
+        match_tasks.emplace_back(i, 0u, p_i);
+      }
+    };
+
+    const auto push_digit_children = [&](const node_index n, const std::size_t p_i) {
+      for (const auto& c : m_nodes[n].children)
+      {
+        if (is_digit(char(c.first)))
         {
-          merge_node();
+          match_tasks.emplace_back(c.index, 0u, p_i);
         }
       }
+    };
 
-      return result;
-    }
-
-    /**
-     * Finds every node in this node's subtree whose keys match a pattern, and adds the
-     * values to the given output iterator.
-     *
-     * The keys are matched against a suffix of the given pattern starting at the given
-     * position. The matching algorithm uses an auxiliary `match_State` to prevent
-     * matching unnecessarily matching nodes. This state is updated in the following
-     * situations:
-     *
-     * - a node is visited for the first time
-     * - a node is matches the given pattern (this might also update the node's parent's
-     * states)
-     * - an entire subtree matches the given pattern (due to a trailing wildcard in the
-     * pattern)
-     *
-     * Using this information, the algorithm will stop matching a node if every node in
-     * its subtree was already matched against the pattern. Furthermore, it will not add a
-     * node's values multiple times if the node's key matches the pattern in more than one
-     * way. The latter situation can arise due to wildcards in the pattern.
-     *
-     * @tparam O the type of the given output iterator
-     * @param pattern the pattern to match
-     * @param pattern_position where to start matching the pattern
-     * @param parent this node's parent (used to update the match_state)
-     * @param match_state the match state
-     * @param out the output iterator to which the values of matched nodes are added
-     *
-     * @throws std::invalid_argument if the given pattern contains an invalid escape
-     * sequence
-     */
-    template <typename O>
-    void find_matches(
-      const std::string_view pattern,
-      const std::size_t pattern_position,
-      const node* parent,
-      match_state& match_state,
-      O out) const
+    while (!match_tasks.empty())
     {
-      using match_task = std::pair<std::size_t, std::size_t>;
+      const auto task = match_tasks.back();
+      match_tasks.pop_back();
+      const auto [n, k_i, p_i] = task;
+      if (k_i == 0u && !entered.insert(std::uint64_t(n) << 32u | p_i).second)
+      {
+        continue;
+      }
+
+      const auto& key = m_nodes[n].key;
 
-      match_state.insert(this, parent);
+      if (k_i == key.size() && p_i == pattern.size())
+      {
+        matched.push_back(n);
+        continue;
+      }
+
+      if (p_i == pattern.size())
+      {
+        // the pattern is consumed but the key isn't, we cannot have a match here
+        continue;
+      }
 
-      std::vector<match_task> match_tasks({{0u, pattern_position}});
-      while (!match_tasks.empty())
+      if (pattern[p_i] == '\\' && p_i < pattern.size() - 1u)
       {
-        if (match_state.is_fully_matched(this))
+        // handle escaped characters in the pattern
+        const auto escaped = pattern[p_i + 1u];
+        if (!is_special(escaped))
         {
-          // this node and all of its subtrees have been fully matched, so we are done
-          // here
-          return;
+          throw std::invalid_argument("invalid escape sequence in pattern");
         }
 
-        const auto [k_i, p_i] = match_tasks.back();
-        match_tasks.pop_back();
-
-        if (k_i == m_key.length() && p_i == pattern.length())
+        if (k_i < key.size())
         {
-          if (match_state.set_matched(this))
+          if (key[k_i] == escaped)
           {
-            // this node was not matched yet, so fetch the results
-            get_values(out);
+            match_tasks.emplace_back(n, k_i + 1u, p_i + 2u);
           }
-
-          // there might still be children of this node that could be matched by a pending
-          // match task, so continue matching
-          continue;
         }
-
-        if (p_i == pattern.length())
+        else
         {
-          // the pattern is consumed by the key isn't, we cannot have a match here
-          continue;
+          push_child(n, escaped, p_i);
         }
-
-        // after this point, we can assume that the pattern is not consumed, but the key
-        // might be
-        if (pattern[p_i] == '\\' && p_i < pattern.length() - 1u)
+      }
+      else if (pattern[p_i] == '*')
+      {
+        if (p_i == pattern.size() - 1u)
         {
-          // handle escaped characters in the pattern
-          const auto& n = pattern[p_i + 1u];
-
-          if (k_i < m_key.length())
-          {
-            // check the next character in the pattern against the next character in the
-            // key
-            if (n == '*' || n == '?' || n == '%' || n == '\\')
-            {
-              if (m_key[k_i] == n)
-              {
-                // the key matches the escaped character, continue
-                match_tasks.emplace_back(k_i + 1u, p_i + 2u);
-              }
-            }
-            else
-            {
-              throw std::invalid_argument("invalid escape sequence in pattern");
-            }
-          }
-          else
-          {
-            // the key is consumed, so continue matching at the children
-            for (const auto& c : {"*", "?", "%", "\\"})
-            {
-              const auto it = m_children.find(c);
-              if (it != std::end(m_children))
-              {
-                it->find_matches(pattern, p_i, this, match_state, out);
-              }
-            }
-          }
+          // the pattern is consumed after the '*', so it matches all keys in this
+          // node's subtree
+          visit_subtree(n, [&](const node_index i) {
+            matched.push_back(i);
+            return true;
+          });
         }
-        else if (pattern[p_i] == '*')
+        else if (k_i < key.size())
         {
-          // handle '*' in the pattern
-          if (p_i == pattern.length() - 1u)
-          {
-            // the pattern is consumed after the '*', so it matches all keys in this
-            // node's subtree
-            match_state.set_fully_matched(this);
-            get_values_and_recurse(out);
-            return;
-          }
-
-          if (k_i < m_key.length())
-          {
-            // '*' matches any character
-            // consume the '*' and continue matching at the current character of the key
-            match_tasks.emplace_back(k_i, p_i + 1u);
-            // consume the current character of the key and continue matching at '*'
-            match_tasks.emplace_back(k_i + 1u, p_i);
-          }
-          else
-          {
-            // the key is consumed, so continue matching at the children
-            for (const auto& child : m_children)
-            {
-              child.find_matches(pattern, p_i, this, match_state, out);
-            }
-          }
+          // consume the '*' and continue matching at the current character of the key
+          match_tasks.emplace_back(n, k_i, p_i + 1u);
+          // consume the current character of the key and continue matching at '*'
+          match_tasks.emplace_back(n, k_i + 1u, p_i);
         }
-        else if (pattern[p_i] == '?')
+        else
         {
-          // handle '?' in the pattern
-          if (k_i < m_key.length())
-          {
-            // '?' matches any character, continue at the next chars in both the pattern
-            // and the key
-            match_tasks.emplace_back(k_i + 1u, p_i + 1u);
-          }
-          else
-          {
-            // the key is consumed, so continue matching at the children
-            for (const auto& child : m_children)
-            {
-              child.find_matches(pattern, p_i, this, match_state, out);
-            }
-          }
+          push_children(n, p_i);
         }
-        else if (pattern[p_i] == '%')
+      }
+      else if (pattern[p_i] == '?')
+      {
+        if (k_i < key.size())
+        {
+          match_tasks.emplace_back(n, k_i + 1u, p_i + 1u);
+        }
+        else
+        {
+          push_children(n, p_i);
+        }
+      }
+      else if (pattern[p_i] == '%')
+      {
+        if (p_i < pattern.size() - 1u && pattern[p_i + 1u] == '*')
         {
-          // handle '%' in the pattern
-          if (p_i < pattern.length() - 1u && pattern[p_i + 1u] == '*')
+          // try to continue matching after "%*"
+          match_tasks.emplace_back(n, k_i, p_i + 2u);
+          if (k_i < key.size())
           {
-            // handle "%*" in the pattern
-            // try to continue matching after "%*"
-            match_tasks.emplace_back(k_i, p_i + 2u);
-            if (k_i < m_key.length())
+            if (is_digit(key[k_i]))
             {
-              if (m_key[k_i] >= '0' && m_key[k_i] <= '9')
-              {
-                // try to match more digits
-                match_tasks.emplace_back(k_i + 1u, p_i);
-              }
-            }
-            else
-            {
-              // the key is consumed, so continue matching at the children
-              for (auto it = m_children.lower_bound("0"),
-                        end = m_children.upper_bound("9");
-                   it != end;
-                   ++it)
-              {
-                it->find_matches(pattern, p_i, this, match_state, out);
-              }
+              // try to match more digits
+              match_tasks.emplace_back(n, k_i + 1u, p_i);
             }
           }
           else
           {
-            if (k_i < m_key.length())
-            {
-              // handle '%' in the pattern (not followed by '*')
-              if (m_key[k_i] >= '0' && m_key[k_i] <= '9')
-              {
-                // continue matching after the digit
-                match_tasks.emplace_back(k_i + 1u, p_i + 1u);
-              }
-            }
-            else
-            {
-              // the key is consumed, so continue matching at the children
-              for (auto it = m_children.lower_bound("0"),
-                        end = m_children.upper_bound("9");
-                   it != end;
-                   ++it)
-              {
-                it->find_matches(pattern, p_i, this, match_state, out);
-              }
-            }
+            push_digit_children(n, p_i);
           }
         }
-        else
+        else if (k_i < key.size())
         {
-          if (k_i < m_key.length())
+          if (is_digit(key[k_i]))
           {
-            if (pattern[p_i] == m_key[k_i])
-            {
-              // handle a regular character in the pattern
-              match_tasks.emplace_back(k_i + 1u, p_i + 1u);
-            }
-          }
-          else
-          {
-            // the key is consumed, so continue matching at the children
-            for (auto [it, end] = m_children.equal_range(pattern.substr(p_i, 1u));
-                 it != end;
-                 ++it)
-            {
-              it->find_matches(pattern, p_i, this, match_state, out);
-            }
+            match_tasks.emplace_back(n, k_i + 1u, p_i + 1u);
           }
         }
-      }
-    }
-
-    /**
-     * Adds the keys of all nodes in this subtree to the given output iterator.
-     *
-     * @tparam O the type of the output iterator
-     * @param prefix the prefix of all keys in this subtree
-     * @param out the output iterator
-     */
-    template <typename O>
-    void get_keys(const std::string& prefix, O out) const
-    {
-      const auto key = prefix + m_key;
-      if (!m_values.empty())
-      {
-        out++ = key;
-      }
-
-      for (const auto& child : m_children)
-      {
-        child.get_keys(key, out);
-      }
-    }
-
-  private:
-    void insert_value(const V& value) const { m_values[value]++; }
-
-    bool remove_value(const V& value) const
-    {
-      auto it = m_values.find(value);
-      if (it == std::end(m_values))
-      {
-        return false;
-      }
-      else
-      {
-        if (--(it->second) == 0u)
+        else
         {
-          m_values.erase(it);
+          push_digit_children(n, p_i);
         }
-        return true;
       }
-    }
-
-    /**
-     * Splits this node into two nodes at the given index of its key. For example, given a
-     * node n with key "abcd" and index 2, the following will happen:
-     * - n's key will be shortened to "ab"
-     * - a new node c will be created to n with key "cd"
-     * - all of n's children and values will be moved to c
-     * - c will be added to n's children
-     *
-     * Precondition: This node's key has at least two characters, and the index is chosen
-     * in such a way that neither of the resulting keys is empty.
-     *
-     * @param index the index at which to split the node's key
-     */
-    void split_node(const std::size_t index) const
-    {
-      assert(m_key.length() > 1u);
-
-      auto new_key = m_key.substr(0u, index);
-      auto remainder = m_key.substr(index);
-
-      assert(!new_key.empty());
-      assert(!remainder.empty());
-
-      using std::swap;
-      node_set new_children;
-      swap(new_children, m_children);
-
-      const node& new_child = *m_children.insert(node(std::move(remainder))).first;
-      swap(new_child.m_children, new_children);
-      swap(new_child.m_values, m_values);
-
-      m_key = std::move(new_key);
-    }
-
-    /**
-     * Merges this node with its only child. Thereby, this child node's key is appended to
-     * this node's key, the child's children and values are moved to this node, and the
-     * child is removed.
-     *
-     * Precondition: This node has only one child, and this node has no values of its own.
-     */
-    void merge_node() const
-    {
-      assert(m_children.size() == 1u);
-      assert(m_values.empty());
-
-      using std::swap;
-      node_set old_children;
-      swap(old_children, m_children);
-
-      const node& child = *std::begin(old_children);
-      swap(m_children, child.m_children);
-      swap(m_values, child.m_values);
-
-      m_key += child.m_key;
-    }
-
-    template <typename O>
-    void get_values(O out) const
-    {
-      for (const auto& [value, count] : m_values)
+      else if (k_i < key.size())
       {
-        for (std::size_t i = 0u; i < count; ++i)
+        if (pattern[p_i] == key[k_i])
         {
-          out++ = value;
+          match_tasks.emplace_back(n, k_i + 1u, p_i + 1u);
         }
       }
-    }
-
-    template <typename O>
-    void get_values_and_recurse(O out) const
-    {
-      get_values(out);
-      for (const auto& child : m_children)
+      else
       {
-        child.get_values_and_recurse(out);
+        push_child(n, pattern[p_i], p_i);
       }
     }
-  };
 
-  /**
-   * Compares nodes against each other or nodes against strings.
-   *
-   * Two nodes are compared by their keys.
-   * A node is compared to a string by comparing its key to the string.
-   *
-   * Two strings are compared by their first character only, soif two nodes share a
-   * non-empty prefix, they are considered equivalent. Therefore, the keys "ab" and "abc"
-   * are equivalent. Conversely, the keys "ab" and "bc" are not equivalent because they do
-   * not share a prefix, more specifically, "ab" is considered less than "bc".
-   *
-   * Precondition: the strings to copmare are not empty.
-   */
-  struct node_cmp
-  {
-    using is_transparent = void;
-
-    bool operator()(const node& lhs, const node& rhs) const
+    std::sort(std::begin(matched), std::end(matched));
+    matched.erase(std::unique(std::begin(matched), std::end(matched)), std::end(matched));
+    for (const auto n : matched)
     {
-      return compare(lhs.m_key, rhs.m_key);
+      get_values(n, out);
     }
+  }
 
-    bool operator()(const std::string_view lhs, const node& rhs) const
+  template <typename O>
+  void get_values(const node_index n, O& out) const
+  {
+    for (const auto& [value, count] : m_nodes[n].values)
     {
-      return compare(lhs, rhs.m_key);
+      for (std::size_t i = 0u; i < count; ++i)
+      {
+        out++ = value;
+      }
     }
+  }
 
-    bool operator()(const node& lhs, const std::string_view rhs) const
+  template <typename O>
+  void get_keys(const node_index n, std::string& key, O& out) const
+  {
+    const auto length = key.size();
+    key += m_nodes[n].key;
+    if (!m_nodes[n].values.empty())
     {
-      return compare(lhs.m_key, rhs);
+      out++ = key;
     }
 
-    bool compare(const std::string_view lhs, const std::string_view& rhs) const
+    for (const auto& c : m_nodes[n].children)
     {
-      assert(!lhs.empty() && !rhs.empty());
-      return lhs[0] < rhs[0];
+      get_keys(c.index, key, out);
     }
-  };
-
-private:
-  node m_root;
-
-public:
-  /**
-   * Creates a new empty trie.
-   */
-  compact_trie()
-    : m_root(node(""))
-  {
-  }
-
-  /**
-   * Inserts the given value under the given key.
-   *
-   * @param key the key to insert
-   * @param value the value to insert
-   */
-  void insert(const std::string_view key, const V& value) { m_root.insert(key, value); }
-
-  /**
-   * Removes the given value using the given key.
-   *
-   * @param key the key to remove
-   * @param value the value to remove
-   * @return `true` if the given value was found under the given key, and `false`
-   * otherwise
-   */
-  bool remove(const std::string_view key, const V& value)
-  {
-    return m_root.remove(key, value);
-  }
-
-  /**
-   * Clears this trie.
-   */
-  void clear() { m_root = node(""); }
-
-  /**
-   * Finds all values whose keys match the given glob pattern. See `kdl::str_matches_glob`
-   * for the definition and semantics of glob patterns and adds the values to the given
-   * output iterator.
-   *
-   * @tparam O the type of the output iterator
-   * @param pattern the pattern to match
-   * @param out the output iterator
-   */
-  template <typename O>
-  void find_matches(const std::string_view pattern, O out) const
-  {
-    match_state match_state;
-    m_root.find_matches(pattern, {0u}, nullptr, match_state, out);
-  }
-
-  /**
-   * Adds the keys of all nodes in this trie to the give output iterator.
-   *
-   * @tparam O the type of the output iterator
-   * @param out the output iterator
-   */
-  template <typename O>
-  void get_keys(O out) const
-  {
-    m_root.get_keys("", out);
+    key.resize(length);
   }
 };
 } // namespace kdl
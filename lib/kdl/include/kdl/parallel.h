@@ -21,16 +21,14 @@
 #ifndef KDL_PARALLEL_H
 #define KDL_PARALLEL_H
 
+#include "kdl/thread_pool.h"
 #include "kdl/vector_utils.h"
 
-#ifdef _WIN32
-#include <ppl.h>
-#endif
-
+#include <algorithm>
 #include <atomic>
-#include <future> // for std::async
+#include <exception>
+#include <mutex>
 #include <optional>
-#include <thread>
 #include <utility> // for std::declval
 #include <vector>
 
@@ -39,87 +37,163 @@ namespace kdl
 /**
  * Runs the given lambda `count` times, passing it indices `0` through `count - 1`.
  *
- * Lambda is executed in parallel, using the number of threads returned by
- * std::thread::hardware_concurrency().
+ * The index range is split into chunks of consecutive indices that are processed by the
+ * worker threads of the given thread pool and by the calling thread. If the lambda throws
+ * an exception, the remaining chunks are skipped and the first exception is rethrown
+ * once all threads have stopped working on the range.
  *
- * Because the threads are spawned with std::async(std::launch::async, ...) and no thread
- * pool is used, there is a relatively large overhead and this should only be used on
- * large/slow to process data sets.
+ * It is safe to call this function from within a task that runs on the given pool. The
+ * calling thread only processes chunks of this range, it never runs unrelated tasks.
  *
  * @tparam L type of lambda
+ * @param pool the thread pool to use
  * @param count the maximum value (exclusive) to pass to lambda
  * @param lambda the lambda to run
+ * @param chunk_size the number of consecutive indices per chunk, if 0, the chunk size is
+ * chosen so that every thread processes about 4 chunks
  */
 template <class L>
-void parallel_for(const size_t count, L&& lambda)
+void parallel_for(
+  thread_pool& pool, const size_t count, L&& lambda, size_t chunk_size = 0)
 {
-#ifdef _WIN32
-  concurrency::parallel_for<size_t>(0, count, lambda);
-#else
-  size_t numThreads = static_cast<size_t>(std::thread::hardware_concurrency());
-  if (numThreads == 0)
+  if (count == 0)
   {
-    numThreads = 1;
+    return;
   }
 
-  std::atomic<size_t> nextIndex(0);
-
-  std::vector<std::future<void>> threads;
-  threads.resize(numThreads);
+  const auto thread_count = pool.thread_count() + 1;
+  if (chunk_size == 0)
+  {
+    chunk_size = std::max(count / (thread_count * 4), size_t(1));
+  }
 
-  for (size_t i = 0; i < numThreads; ++i)
+  const auto chunk_count = (count + chunk_size - 1) / chunk_size;
+  if (chunk_count == 1)
   {
-    threads[i] = std::async(std::launch::async, [&]() {
-      while (true)
+    for (size_t i = 0; i < count; ++i)
+    {
+      lambda(i);
+    }
+    return;
+  }
+
+  auto next_chunk = std::atomic<size_t>{0};
+  auto exception = std::exception_ptr{};
+  auto exception_mutex = std::mutex{};
+
+  const auto run_chunks = [&]() {
+    while (true)
+    {
+      const auto chunk = next_chunk++;
+      if (chunk >= chunk_count)
+      {
+        break;
+      }
+
+      try
+      {
+        const auto end = std::min((chunk + 1) * chunk_size, count);
+        for (auto i = chunk * chunk_size; i < end; ++i)
+        {
+          lambda(i);
+        }
+      }
+      catch (...)
       {
-        const size_t ourIndex = std::atomic_fetch_add(&nextIndex, static_cast<size_t>(1));
-        if (ourIndex >= count)
+        auto lock = std::unique_lock{exception_mutex};
+        if (!exception)
         {
-          break;
+          exception = std::current_exception();
         }
-        lambda(ourIndex);
+        next_chunk = chunk_count;
       }
-    });
+    }
+  };
+
+  const auto helper_count = std::min(pool.thread_count(), chunk_count - 1);
+  auto helpers = std::vector<task_future<void>>{};
+  helpers.reserve(helper_count);
+  for (size_t i = 0; i < helper_count; ++i)
+  {
+    helpers.push_back(pool.submit(run_chunks));
   }
 
-  for (size_t i = 0; i < numThreads; ++i)
+  run_chunks();
+
+  for (auto& helper : helpers)
   {
-    threads[i].wait();
+    pool.wait(helper);
   }
-#endif
+
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+/**
+ * Runs the given lambda `count` times, passing it indices `0` through `count - 1`.
+ *
+ * The lambda is executed in parallel using the process wide thread pool, see
+ * `default_thread_pool`.
+ *
+ * @tparam L type of lambda
+ * @param count the maximum value (exclusive) to pass to lambda
+ * @param lambda the lambda to run
+ */
+template <class L>
+void parallel_for(const size_t count, L&& lambda)
+{
+  parallel_for(default_thread_pool(), count, std::forward<L>(lambda));
 }
 
 /**
  * Applies the given lambda to each element of the input (passing elements as rvalue
  * references), and returns a vector of the resulting values, in their original order.
  *
- * The lambda is executed in parallel, using the number of threads returned by
- * std::thread::hardware_concurrency().
- *
- * Because the threads are spawned with std::async(std::launch::async, ...) and no thread
- * pool is used, there is a relatively large overhead and this should only be used on
- * large/slow to process data sets.
+ * The lambda is executed in parallel using the given thread pool, see `parallel_for`.
  *
  * @tparam T the type of the vector elements
  * @tparam L the type of the lambda to apply
+ * @param pool the thread pool to use
  * @param input the vector
  * @param transform the lambda to apply, must be of type `auto(T&&)`
  * @return a vector containing the transformed values
  */
 template <class T, class L>
-auto vec_parallel_transform(std::vector<T> input, L&& transform)
+auto vec_parallel_transform(thread_pool& pool, std::vector<T> input, L&& transform)
 {
   using ResultType = std::optional<decltype(transform(std::declval<T&&>()))>;
 
   std::vector<ResultType> result;
   result.resize(input.size());
 
-  parallel_for(input.size(), [&](const size_t index) {
+  parallel_for(pool, input.size(), [&](const size_t index) {
     result[index] = transform(std::move(input[index]));
   });
 
   return vec_transform(std::move(result), [](ResultType&& x) { return std::move(*x); });
 }
+
+/**
+ * Applies the given lambda to each element of the input (passing elements as rvalue
+ * references), and returns a vector of the resulting values, in their original order.
+ *
+ * The lambda is executed in parallel using the process wide thread pool, see
+ * `default_thread_pool`.
+ *
+ * @tparam T the type of the vector elements
+ * @tparam L the type of the lambda to apply
+ * @param input the vector
+ * @param transform the lambda to apply, must be of type `auto(T&&)`
+ * @return a vector containing the transformed values
+ */
+template <class T, class L>
+auto vec_parallel_transform(std::vector<T> input, L&& transform)
+{
+  return vec_parallel_transform(
+    default_thread_pool(), std::move(input), std::forward<L>(transform));
+}
 } // namespace kdl
 
 #endif // KDL_PARALLEL_H
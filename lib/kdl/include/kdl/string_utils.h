@@ -24,6 +24,10 @@
 
 #include <algorithm> // for std::search
 #include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 #include <iterator>
 #include <optional>
 #include <sstream>
@@ -498,4 +502,105 @@ inline std::optional<long double> str_to_long_double(const std::string& str)
     return std::nullopt;
   }
 }
+
+namespace detail
+{
+/**
+ * Skips leading whitespace and an optional leading '+' sign in the given range so that
+ * the range conversion functions accept the same inputs as their std::string
+ * counterparts.
+ */
+inline const char* str_skip_number_prefix(const char* begin, const char* end)
+{
+  while (begin != end
+         && (*begin == ' ' || *begin == '\t' || *begin == '\n' || *begin == '\r'
+             || *begin == '\f' || *begin == '\v'))
+  {
+    ++begin;
+  }
+  if (
+    begin != end && *begin == '+' && std::next(begin) != end && *std::next(begin) != '-')
+  {
+    ++begin;
+  }
+  return begin;
+}
+} // namespace detail
+
+/**
+ * Interprets the characters in the given range as a signed long integer and returns it.
+ * If the range cannot be parsed, returns an empty optional.
+ *
+ * Unlike str_to_long, this function does not allocate and does not depend on the current
+ * locale. Leading whitespace is skipped, and trailing characters that are not part of the
+ * number are ignored.
+ *
+ * @param begin the beginning of the range
+ * @param end the end of the range
+ * @return the signed long integer value or an empty optional if the given range cannot
+ * be interpreted as a signed long integer
+ */
+inline std::optional<long> str_to_long(const char* begin, const char* end)
+{
+  begin = detail::str_skip_number_prefix(begin, end);
+
+  auto value = 0l;
+  const auto [ptr, ec] = std::from_chars(begin, end, value);
+  if (ec != std::errc{})
+  {
+    return std::nullopt;
+  }
+  return value;
+}
+
+/**
+ * Interprets the characters in the given range as a 64 bit floating point value and
+ * returns it. If the range cannot be parsed, returns an empty optional.
+ *
+ * Unlike str_to_double, this function does not allocate and does not depend on the
+ * current locale if the standard library provides floating point std::from_chars. Leading
+ * whitespace is skipped, and trailing characters that are not part of the number are
+ * ignored.
+ *
+ * @param begin the beginning of the range
+ * @param end the end of the range
+ * @return the 64 bit floating point value or an empty optional if the given range cannot
+ * be interpreted as a 64 bit floating point value
+ */
+inline std::optional<double> str_to_double(const char* begin, const char* end)
+{
+  begin = detail::str_skip_number_prefix(begin, end);
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  auto value = 0.0;
+  const auto [ptr, ec] = std::from_chars(begin, end, value);
+  if (ec != std::errc{})
+  {
+    return std::nullopt;
+  }
+  return value;
+#else
+  // floating point std::from_chars is not available, so fall back to strtod on a
+  // null terminated copy of the range, which lives on the stack unless it is very long
+  constexpr auto BufferSize = std::size_t(64);
+  const auto length = static_cast<std::size_t>(end - begin);
+  if (length >= BufferSize)
+  {
+    return str_to_double(std::string{begin, end});
+  }
+
+  char buffer[BufferSize];
+  std::memcpy(buffer, begin, length);
+  buffer[length] = '\0';
+
+  char* parseEnd = nullptr;
+  errno = 0;
+  const auto value = std::strtod(buffer, &parseEnd);
+  if (parseEnd == buffer || errno == ERANGE)
+  {
+    return std::nullopt;
+  }
+  return value;
+#endif
+}
 } // namespace kdl
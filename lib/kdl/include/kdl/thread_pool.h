@@ -0,0 +1,367 @@
+/*
+ Copyright 2023 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ software and associated documentation files (the "Software"), to deal in the Software
+ without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace kdl
+{
+class thread_pool;
+
+namespace detail
+{
+struct pool_task
+{
+  std::function<void()> function;
+  std::atomic<bool> claimed = false;
+
+  /**
+   * Returns true exactly once, for the thread that gets to run this task.
+   */
+  bool claim() { return !claimed.exchange(true); }
+
+  void run()
+  {
+    function();
+    // release the captured state, the task object may still be referenced by a queue
+    function = nullptr;
+  }
+};
+} // namespace detail
+
+/**
+ * The result of a task submitted to a thread pool.
+ *
+ * Use `thread_pool::wait` to obtain the result. If no worker thread has started the task
+ * yet, `wait` runs it on the calling thread.
+ */
+template <typename T>
+class task_future
+{
+private:
+  std::shared_ptr<detail::pool_task> m_task;
+  std::future<T> m_future;
+
+  friend class thread_pool;
+
+  task_future(std::shared_ptr<detail::pool_task> task, std::future<T> future)
+    : m_task{std::move(task)}
+    , m_future{std::move(future)}
+  {
+  }
+
+public:
+  task_future() = default;
+
+  /**
+   * Indicates whether this future refers to a task.
+   */
+  bool valid() const { return m_future.valid(); }
+
+  /**
+   * Indicates whether the task has finished.
+   */
+  bool ready() const
+  {
+    return m_future.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+  }
+
+  /**
+   * Blocks until a worker thread has finished the task and returns its result.
+   */
+  T get() { return m_future.get(); }
+};
+
+/**
+ * A work stealing thread pool.
+ *
+ * Every worker thread owns a task queue. Tasks submitted from a worker thread are added
+ * to the worker's own queue, and tasks submitted from other threads are distributed over
+ * the worker queues in a round robin fashion. A worker takes tasks from the back of its
+ * own queue first, and if that is empty, it steals tasks from the front of the other
+ * workers' queues.
+ *
+ * Threads that need to wait for the result of a task should use `wait`. If the task has
+ * not been started yet, `wait` runs it on the calling thread, otherwise it blocks until
+ * the task is done. This makes it safe to submit tasks and wait for them from within a
+ * task that runs on the pool, and a waiting thread never runs unrelated tasks.
+ */
+class thread_pool
+{
+private:
+  using task_ptr = std::shared_ptr<detail::pool_task>;
+
+  struct task_queue
+  {
+    std::mutex mutex;
+    std::deque<task_ptr> tasks;
+  };
+
+  struct worker_id
+  {
+    const thread_pool* pool;
+    size_t index;
+  };
+
+  static inline thread_local worker_id s_current_worker = {nullptr, 0};
+
+  std::vector<std::unique_ptr<task_queue>> m_queues;
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::atomic<size_t> m_pending_count = 0;
+  std::atomic<size_t> m_next_queue = 0;
+  bool m_stop = false;
+
+public:
+  /**
+   * Creates a thread pool with the given number of worker threads. If the given number is
+   * 0, one worker thread is created.
+   */
+  explicit thread_pool(const size_t thread_count)
+  {
+    const auto actual_thread_count = std::max(thread_count, size_t(1));
+
+    m_queues.reserve(actual_thread_count);
+    for (size_t i = 0; i < actual_thread_count; ++i)
+    {
+      m_queues.push_back(std::make_unique<task_queue>());
+    }
+
+    m_threads.reserve(actual_thread_count);
+    for (size_t i = 0; i < actual_thread_count; ++i)
+    {
+      m_threads.emplace_back([this, i]() { run_worker(i); });
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  /**
+   * Runs all remaining tasks and joins the worker threads.
+   */
+  ~thread_pool()
+  {
+    {
+      auto lock = std::unique_lock{m_mutex};
+      m_stop = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+      thread.join();
+    }
+  }
+
+  /**
+   * Returns the number of worker threads.
+   */
+  size_t thread_count() const { return m_threads.size(); }
+
+  /**
+   * Indicates whether the calling thread is one of this pool's worker threads.
+   */
+  bool is_worker_thread() const { return s_current_worker.pool == this; }
+
+  /**
+   * Submits the given function to be run on a worker thread and returns a future for its
+   * result. Exceptions thrown by the function are stored in the returned future.
+   */
+  template <typename F>
+  auto submit(F&& f)
+  {
+    using result_type = std::invoke_result_t<std::decay_t<F>>;
+
+    auto packaged_task =
+      std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+    auto future = packaged_task->get_future();
+
+    auto t = std::make_shared<detail::pool_task>();
+    t->function = [packaged_task = std::move(packaged_task)]() { (*packaged_task)(); };
+    push_task(t);
+
+    return task_future<result_type>{std::move(t), std::move(future)};
+  }
+
+  /**
+   * Waits until the given future becomes ready and returns its result.
+   *
+   * If no worker thread has started the task yet, it is run on the calling thread.
+   * Otherwise, the calling thread blocks until the task is done. No other tasks are run
+   * on the calling thread.
+   */
+  template <typename T>
+  T wait(task_future<T>& future)
+  {
+    if (future.m_task->claim())
+    {
+      future.m_task->run();
+    }
+    return future.m_future.get();
+  }
+
+private:
+  void push_task(task_ptr t)
+  {
+    const auto queue_index = is_worker_thread()
+                               ? s_current_worker.index
+                               : m_next_queue.fetch_add(1) % m_queues.size();
+
+    // increment the counter first so that it never underflows when the task is taken
+    // immediately
+    {
+      auto lock = std::unique_lock{m_mutex};
+      ++m_pending_count;
+    }
+
+    {
+      auto& queue = *m_queues[queue_index];
+      auto lock = std::unique_lock{queue.mutex};
+      queue.tasks.push_back(std::move(t));
+    }
+    m_condition.notify_one();
+  }
+
+  /**
+   * Runs one pending task on the calling worker thread, if there is one. Tasks that were
+   * already run by a waiting thread are skipped.
+   *
+   * @return true if a task was taken from a queue and false otherwise
+   */
+  bool run_pending_task(const size_t own_index)
+  {
+    auto t = task_ptr{};
+    if (pop_task(own_index, t))
+    {
+      if (t->claim())
+      {
+        t->run();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  bool pop_task(const size_t own_index, task_ptr& t)
+  {
+    if (m_pending_count == 0)
+    {
+      return false;
+    }
+
+    // take the most recently pushed task from our own queue
+    {
+      auto& queue = *m_queues[own_index];
+      auto lock = std::unique_lock{queue.mutex};
+      if (!queue.tasks.empty())
+      {
+        t = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        --m_pending_count;
+        return true;
+      }
+    }
+
+    // steal the least recently pushed task from another queue
+    for (size_t i = 1; i < m_queues.size(); ++i)
+    {
+      auto& queue = *m_queues[(own_index + i) % m_queues.size()];
+      auto lock = std::unique_lock{queue.mutex};
+      if (!queue.tasks.empty())
+      {
+        t = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        --m_pending_count;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void run_worker(const size_t index)
+  {
+    s_current_worker = worker_id{this, index};
+
+    while (true)
+    {
+      if (run_pending_task(index))
+      {
+        continue;
+      }
+
+      auto lock = std::unique_lock{m_mutex};
+      m_condition.wait(lock, [&]() { return m_stop || m_pending_count > 0; });
+      if (m_stop && m_pending_count == 0)
+      {
+        return;
+      }
+    }
+  }
+};
+
+namespace detail
+{
+inline std::atomic<size_t>& default_thread_pool_size()
+{
+  static auto size = std::atomic<size_t>{0};
+  return size;
+}
+} // namespace detail
+
+/**
+ * Sets the number of worker threads of the process wide thread pool. If the given number
+ * is 0, one worker thread per hardware thread is created.
+ *
+ * This has no effect if the process wide thread pool was already created.
+ */
+inline void set_default_thread_pool_size(const size_t thread_count)
+{
+  detail::default_thread_pool_size() = thread_count;
+}
+
+/**
+ * Returns the process wide thread pool. The pool is created on first use.
+ */
+inline thread_pool& default_thread_pool()
+{
+  static auto pool = thread_pool{
+    detail::default_thread_pool_size() != 0
+      ? size_t(detail::default_thread_pool_size())
+      : size_t(std::thread::hardware_concurrency())};
+  return pool;
+}
+} // namespace kdl
@@ -19,9 +19,15 @@
 */
 
 #include "kdl/compact_trie.h"
+#include "kdl/string_compare.h"
 #include "kdl/vector_utils.h"
 
 #include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -208,4 +214,124 @@ TEST_CASE("compact_trie_test.get_keys")
     Catch::UnorderedEquals(
       std::vector<std::string>{"key", "key2", "key22", "key22bs", "k1"}));
 }
+
+TEST_CASE("compact_trie_test.find_matches_with_escaped_characters")
+{
+  test_index index;
+  index.insert("a*b", "value");
+  index.insert("axb", "value2");
+  index.insert("a%", "value3");
+  index.insert("a1", "value4");
+
+  assertMatches(index, "a*b", {"value", "value2"});
+  assertMatches(index, "a\\*b", {"value"});
+  assertMatches(index, "a\\%", {"value3"});
+  assertMatches(index, "a%", {"value4"});
+  assertMatches(index, "?\\*?", {"value"});
+
+  std::vector<std::string> matches;
+  CHECK_THROWS_AS(
+    index.find_matches("a\\x*", std::back_inserter(matches)), std::invalid_argument);
+}
+
+TEST_CASE("compact_trie_test.build")
+{
+  test_index index;
+  index.insert("whoops", "value");
+
+  index.build({
+    {"key22", "value2"},
+    {"key", "value"},
+    {"k1", "value3"},
+    {"", "value5"},
+    {"key2", "value"},
+    {"key", "value"},
+    {"test", "value4"},
+  });
+
+  std::vector<std::string> keys;
+  index.get_keys(std::back_inserter(keys));
+  CHECK_THAT(
+    keys,
+    Catch::UnorderedEquals(
+      std::vector<std::string>{"", "key", "key2", "key22", "k1", "test"}));
+
+  assertMatches(index, "whoops", {});
+  assertMatches(index, "", {"value5"});
+  assertMatches(index, "key", {"value", "value"});
+  assertMatches(index, "key%*", {"value", "value", "value", "value2"});
+  assertMatches(
+    index, "*", {"value", "value", "value", "value2", "value3", "value4", "value5"});
+
+  // the trie can be edited after building it
+  CHECK(index.remove("key", "value"));
+  CHECK(index.remove("key", "value"));
+  CHECK_FALSE(index.remove("key", "value"));
+  index.insert("kez", "value6");
+  assertMatches(index, "k*", {"value", "value2", "value3", "value6"});
+
+  index.build({});
+  assertMatches(index, "*", {});
+}
+
+TEST_CASE("compact_trie_test.matches_reference")
+{
+  // compare against a plain list of keys and values using randomly generated short keys,
+  // so that nodes are split, merged and recycled frequently
+  auto engine = std::mt19937{7};
+  const auto random_key = [&]() {
+    static const auto alphabet = std::string{"ab12"};
+    auto length = std::uniform_int_distribution<std::size_t>{0, 6}(engine);
+    auto key = std::string{};
+    while (length-- > 0u)
+    {
+      key += alphabet[std::uniform_int_distribution<std::size_t>{0, 3}(engine)];
+    }
+    return key;
+  };
+
+  test_index index;
+  auto entries = std::vector<std::pair<std::string, std::string>>{};
+
+  const auto expected_matches = [&](const std::string& pattern) {
+    auto result = std::vector<std::string>{};
+    for (const auto& [key, value] : entries)
+    {
+      if (kdl::cs::str_matches_glob(key, pattern))
+      {
+        result.push_back(value);
+      }
+    }
+    return result;
+  };
+
+  for (std::size_t round = 0; round < 20; ++round)
+  {
+    for (std::size_t i = 0; i < 50; ++i)
+    {
+      auto key = random_key();
+      auto value = std::to_string(i % 3u);
+      index.insert(key, value);
+      entries.emplace_back(std::move(key), std::move(value));
+    }
+
+    for (std::size_t i = 0; i < 30 && !entries.empty(); ++i)
+    {
+      const auto j =
+        std::uniform_int_distribution<std::size_t>{0, entries.size() - 1u}(engine);
+      CHECK(index.remove(entries[j].first, entries[j].second));
+      entries.erase(std::next(entries.begin(), std::ptrdiff_t(j)));
+    }
+
+    for (std::size_t i = 0; i < 10; ++i)
+    {
+      const auto key = random_key();
+      CAPTURE(key);
+      assertMatches(index, key, expected_matches(key));
+      assertMatches(index, key + "*", expected_matches(key + "*"));
+      assertMatches(index, key + "%*", expected_matches(key + "%*"));
+      assertMatches(index, key + "?", expected_matches(key + "?"));
+    }
+  }
+}
 } // namespace kdl
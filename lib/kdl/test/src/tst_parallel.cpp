@@ -21,11 +21,12 @@
 #include "test_utils.h"
 
 #include "kdl/parallel.h"
+#include "kdl/thread_pool.h"
 
 #include <array>
 #include <atomic>
-#include <chrono>
-#include <iostream>
+#include <numeric>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -73,6 +74,72 @@ TEST_CASE("for 10000")
   }
 }
 
+TEST_CASE("for with chunk size")
+{
+  auto pool = thread_pool{3};
+
+  for (const size_t chunkSize : {1u, 7u, 100u, 1000u})
+  {
+    auto indices = std::vector<std::atomic<size_t>>(100);
+    kdl::parallel_for(
+      pool, indices.size(), [&](const size_t i) { ++indices[i]; }, chunkSize);
+
+    for (const auto& index : indices)
+    {
+      CHECK(index == 1u);
+    }
+  }
+}
+
+TEST_CASE("for rethrows exception")
+{
+  auto pool = thread_pool{3};
+
+  auto count = std::atomic<size_t>{0};
+  CHECK_THROWS_AS(
+    kdl::parallel_for(
+      pool,
+      10'000,
+      [&](const size_t i) {
+        ++count;
+        if (i == 100)
+        {
+          throw std::runtime_error{"error"};
+        }
+      },
+      10),
+    std::runtime_error);
+
+  // remaining chunks are skipped
+  CHECK(count < 10'000u);
+}
+
+TEST_CASE("nested for")
+{
+  // nested calls must not deadlock even if there is only one worker thread
+  auto pool = thread_pool{1};
+
+  constexpr size_t OuterCount = 20;
+  constexpr size_t InnerCount = 100;
+
+  auto sums = std::vector<size_t>(OuterCount, 0);
+  kdl::parallel_for(
+    pool,
+    OuterCount,
+    [&](const size_t i) {
+      auto inner = std::vector<size_t>(InnerCount, 0);
+      kdl::parallel_for(
+        pool, InnerCount, [&](const size_t j) { inner[j] = i + j; }, 1);
+      sums[i] = std::accumulate(inner.begin(), inner.end(), size_t(0));
+    },
+    1);
+
+  for (size_t i = 0; i < OuterCount; ++i)
+  {
+    CHECK(sums[i] == i * InnerCount + (InnerCount * (InnerCount - 1)) / 2);
+  }
+}
+
 TEST_CASE("transform")
 {
   const auto L = [](const int& v) { return v * 10; };
@@ -98,46 +165,4 @@ TEST_CASE("transform_many")
           return std::to_string(i);
         }));
 }
-
-TEST_CASE("overhead for small work batches")
-{
-  constexpr size_t OuterLoop = 1'000;
-  constexpr size_t InnerLoop = 10;
-  auto counter = std::atomic<size_t>{0};
-  const auto startTime = std::chrono::high_resolution_clock::now();
-
-  SECTION("sequential")
-  {
-    for (size_t i = 0; i < OuterLoop * InnerLoop; ++i)
-    {
-      std::atomic_fetch_add(&counter, static_cast<size_t>(1));
-    }
-
-    const auto endTime = std::chrono::high_resolution_clock::now();
-    std::cout << "sequential took "
-              << std::chrono::duration_cast<std::chrono::microseconds>(
-                   endTime - startTime)
-                   .count()
-              << "us\n";
-  }
-
-  SECTION("run parallel_for on batches of 10")
-  {
-    for (size_t i = 0; i < OuterLoop; ++i)
-    {
-      kdl::parallel_for(InnerLoop, [&](const size_t) {
-        std::atomic_fetch_add(&counter, static_cast<size_t>(1));
-      });
-    }
-
-    const auto endTime = std::chrono::high_resolution_clock::now();
-    std::cout << "small batches took "
-              << std::chrono::duration_cast<std::chrono::microseconds>(
-                   endTime - startTime)
-                   .count()
-              << "us\n";
-  }
-
-  CHECK(static_cast<size_t>(counter) == OuterLoop * InnerLoop);
-}
 } // namespace kdl
@@ -22,6 +22,8 @@
 
 #include <optional>
 #include <ostream>
+#include <string>
+#include <string_view>
 
 #include <catch2/catch.hpp>
 
@@ -241,4 +243,59 @@ TEST_CASE("string_format_test.str_to_long_double")
   CHECK(str_to_long_double(" ") == std::nullopt);
   CHECK(str_to_long_double("") == std::nullopt);
 }
+
+TEST_CASE("string_format_test.str_to_long_range")
+{
+  const auto str_to_long_range = [](const std::string_view str) {
+    return str_to_long(str.data(), str.data() + str.size());
+  };
+
+  CHECK(str_to_long_range("0") == std::optional<long>{0l});
+  CHECK(str_to_long_range("1") == std::optional<long>{1l});
+  CHECK(str_to_long_range("+1") == std::optional<long>{1l});
+  CHECK(str_to_long_range("-123231") == std::optional<long>{-123231l});
+  CHECK(str_to_long_range("2147483647") == std::optional<long>{2147483647l});
+  CHECK(str_to_long_range("123231b") == std::optional<long>{123231l});
+  CHECK(str_to_long_range("   123231   ") == std::optional<long>{123231l});
+  CHECK(str_to_long_range("a123231") == std::nullopt);
+  CHECK(str_to_long_range("+-1") == std::nullopt);
+  CHECK(str_to_long_range("+") == std::nullopt);
+  CHECK(str_to_long_range(" ") == std::nullopt);
+  CHECK(str_to_long_range("") == std::nullopt);
+  CHECK(str_to_long_range("99999999999999999999999") == std::nullopt);
+
+  // only the given range is considered
+  const auto str = std::string{"12345"};
+  CHECK(str_to_long(str.data(), str.data() + 3) == std::optional<long>{123l});
+}
+
+TEST_CASE("string_format_test.str_to_double_range")
+{
+  const auto str_to_double_range = [](const std::string_view str) {
+    return str_to_double(str.data(), str.data() + str.size());
+  };
+
+  CHECK(str_to_double_range("0") == std::optional<double>{0.0});
+  CHECK(str_to_double_range("1.0") == std::optional<double>{1.0});
+  CHECK(str_to_double_range("+1.5") == std::optional<double>{1.5});
+  CHECK(str_to_double_range("-1.5") == std::optional<double>{-1.5});
+  CHECK(str_to_double_range(".5") == std::optional<double>{0.5});
+  CHECK(str_to_double_range("1e3") == std::optional<double>{1000.0});
+  CHECK(str_to_double_range("  2.25  ") == std::optional<double>{2.25});
+  CHECK(str_to_double_range("2.25abc") == std::optional<double>{2.25});
+  CHECK(str_to_double_range("a123231.0") == std::nullopt);
+  CHECK(str_to_double_range(" ") == std::nullopt);
+  CHECK(str_to_double_range("") == std::nullopt);
+
+  // results are identical to the std::string based conversion
+  for (const auto* str :
+       {"0.1", "-1337.03125", "3.14159265358979", "1e-5", "123456789.123"})
+  {
+    CHECK(str_to_double_range(str) == str_to_double(str));
+  }
+
+  // only the given range is considered
+  const auto str = std::string{"1.2345"};
+  CHECK(str_to_double(str.data(), str.data() + 3) == std::optional<double>{1.2});
+}
 } // namespace kdl
@@ -0,0 +1,152 @@
+/*
+ Copyright 2023 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ software and associated documentation files (the "Software"), to deal in the Software
+ without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or
+ substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+*/
+
+#include "kdl/thread_pool.h"
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace kdl
+{
+TEST_CASE("thread_pool.thread_count")
+{
+  CHECK(thread_pool{0}.thread_count() == 1u);
+  CHECK(thread_pool{1}.thread_count() == 1u);
+  CHECK(thread_pool{3}.thread_count() == 3u);
+}
+
+TEST_CASE("thread_pool.submit")
+{
+  auto pool = thread_pool{2};
+
+  SECTION("returns result")
+  {
+    auto future = pool.submit([]() { return std::string{"asdf"}; });
+    CHECK(pool.wait(future) == "asdf");
+  }
+
+  SECTION("runs tasks on worker threads")
+  {
+    CHECK_FALSE(pool.is_worker_thread());
+
+    // don't use pool.wait here because it might run the task on this thread
+    auto future = pool.submit([&]() { return pool.is_worker_thread(); });
+    CHECK(future.get());
+  }
+
+  SECTION("stores exceptions in future")
+  {
+    auto future = pool.submit([]() -> int { throw std::runtime_error{"error"}; });
+    CHECK_THROWS_AS(pool.wait(future), std::runtime_error);
+  }
+
+  SECTION("runs many tasks")
+  {
+    auto counter = std::atomic<size_t>{0};
+    auto futures = std::vector<task_future<void>>{};
+    for (size_t i = 0; i < 1000; ++i)
+    {
+      futures.push_back(pool.submit([&]() { ++counter; }));
+    }
+
+    for (auto& future : futures)
+    {
+      pool.wait(future);
+    }
+
+    CHECK(counter == 1000u);
+  }
+}
+
+TEST_CASE("thread_pool.nested_submit")
+{
+  // a single worker thread would deadlock if waiting tasks did not run the awaited tasks
+  auto pool = thread_pool{1};
+
+  auto outer = pool.submit([&]() {
+    auto inner = std::vector<task_future<size_t>>{};
+    for (size_t i = 0; i < 10; ++i)
+    {
+      inner.push_back(pool.submit([i]() { return i; }));
+    }
+
+    auto sum = size_t(0);
+    for (auto& future : inner)
+    {
+      sum += pool.wait(future);
+    }
+    return sum;
+  });
+
+  CHECK(pool.wait(outer) == 45u);
+}
+
+TEST_CASE("thread_pool.wait")
+{
+  auto pool = thread_pool{1};
+
+  // block the only worker thread until we release it
+  auto started = std::promise<void>{};
+  auto release = std::promise<void>{};
+  auto released = release.get_future().share();
+  auto blocker = pool.submit([&started, released]() {
+    started.set_value();
+    released.wait();
+  });
+  started.get_future().wait();
+
+  auto ranOther = std::atomic<bool>{false};
+  auto other = pool.submit([&]() { ranOther = true; });
+
+  auto ran = false;
+  auto task = pool.submit([&]() { ran = true; });
+
+  // the worker is blocked, so the task can only run if we run it
+  pool.wait(task);
+  CHECK(ran);
+
+  // but waiting must not run unrelated tasks on this thread
+  CHECK_FALSE(ranOther);
+
+  release.set_value();
+  pool.wait(blocker);
+  pool.wait(other);
+  CHECK(ranOther);
+}
+
+TEST_CASE("thread_pool.destructor_runs_remaining_tasks")
+{
+  auto counter = std::atomic<size_t>{0};
+  {
+    auto pool = thread_pool{2};
+    for (size_t i = 0; i < 100; ++i)
+    {
+      pool.submit([&]() { ++counter; });
+    }
+  }
+
+  CHECK(counter == 100u);
+}
+} // namespace kdl